@@ -0,0 +1,10 @@
+#include "LSP/CancelRequest.h"
+
+LSP::CancelRequest::CancelRequest(int id)
+{
+    SetMethod("$/cancelRequest");
+    m_params.reset(new CancelParams());
+    m_params->As<CancelParams>()->SetId(id);
+}
+
+LSP::CancelRequest::~CancelRequest() {}
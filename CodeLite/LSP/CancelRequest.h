@@ -0,0 +1,19 @@
+#ifndef CANCELREQUEST_H
+#define CANCELREQUEST_H
+
+#include "LSP/NotificationMessage.h" // Base class: LSP::NotificationMessage
+
+namespace LSP
+{
+/**
+ * @brief $/cancelRequest: the result of request 'id' is no longer needed
+ */
+class WXDLLIMPEXP_CL CancelRequest : public LSP::NotificationMessage
+{
+public:
+    CancelRequest(int id);
+    virtual ~CancelRequest();
+};
+}; // namespace LSP
+
+#endif // CANCELREQUEST_H
@@ -0,0 +1,45 @@
+#include "LSP/CompletionRequest.h"
+#include "LSP/LSPEvent.h"
+
+LSP::CompletionRequest::CompletionRequest(const wxFileName& filename, size_t line, size_t column)
+    : m_filename(filename)
+    , m_line(line)
+    , m_column(column)
+{
+    SetMethod("textDocument/completion");
+    m_params.reset(new TextDocumentPositionParams());
+    m_params->As<TextDocumentPositionParams>()->SetTextDocument(TextDocumentIdentifier(filename));
+    m_params->As<TextDocumentPositionParams>()->SetPosition(Position(line, column));
+}
+
+LSP::CompletionRequest::~CompletionRequest() {}
+
+void LSP::CompletionRequest::OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    // The result is either a CompletionItem[] or a CompletionList { isIncomplete, items }
+    JSONItem result = response.Get("result");
+    JSONItem items = result.isArray() ? result : result.namedObject("items");
+    std::vector<LSP::CompletionItem> completions;
+    int count = items.arraySize();
+    completions.reserve(count);
+    for(int i = 0; i < count; ++i) {
+        LSP::CompletionItem item;
+        item.FromJSON(items.arrayItem(i));
+        completions.push_back(item);
+    }
+
+    LSPEvent event(wxEVT_LSP_COMPLETION_READY);
+    event.SetCompletions(completions);
+    event.SetFileName(m_filename.GetFullPath());
+    event.SetPosition(Position(m_line, m_column));
+    owner->AddPendingEvent(event);
+}
+
+void LSP::CompletionRequest::OnError(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    wxUnusedVar(response);
+    LSPEvent event(wxEVT_LSP_COMPLETION_READY);
+    event.SetFileName(m_filename.GetFullPath());
+    event.SetPosition(Position(m_line, m_column));
+    owner->AddPendingEvent(event);
+}
@@ -0,0 +1,33 @@
+#ifndef COMPLETIONREQUEST_H
+#define COMPLETIONREQUEST_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+#include <wx/filename.h>
+
+namespace LSP
+{
+/**
+ * @brief textDocument/completion. The response is sent to the owner as wxEVT_LSP_COMPLETION_READY, an error
+ * response is sent as an empty wxEVT_LSP_COMPLETION_READY
+ */
+class WXDLLIMPEXP_CL CompletionRequest : public LSP::RequestMessage
+{
+    wxFileName m_filename;
+    size_t m_line = 0;
+    size_t m_column = 0;
+
+public:
+    CompletionRequest(const wxFileName& filename, size_t line, size_t column);
+    virtual ~CompletionRequest();
+    const wxFileName& GetFilename() const { return m_filename; }
+    size_t GetLine() const { return m_line; }
+    size_t GetColumn() const { return m_column; }
+    void OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+    /**
+     * @brief reported as an empty list of completions
+     */
+    void OnError(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+};
+}; // namespace LSP
+
+#endif // COMPLETIONREQUEST_H
@@ -1,20 +1,16 @@
 #include "LSP/DidChangeTextDocumentRequest.h"
 
-LSP::DidChangeTextDocumentRequest::DidChangeTextDocumentRequest(const wxFileName& filename,
-                                                                     const wxString& fileContent)
+LSP::DidChangeTextDocumentRequest::DidChangeTextDocumentRequest(
+    const wxFileName& filename, int version, const std::vector<TextDocumentContentChangeEvent>& changes)
 {
-    static int counter = 0;
     SetMethod("textDocument/didChange");
     m_params.reset(new DidChangeTextDocumentParams());
 
     VersionedTextDocumentIdentifier id;
-    id.SetVersion(++counter);
+    id.SetVersion(version);
     id.SetFilename(filename);
     m_params->As<DidChangeTextDocumentParams>()->SetTextDocument(id);
-
-    TextDocumentContentChangeEvent changeEvent;
-    changeEvent.SetText(fileContent);
-    m_params->As<DidChangeTextDocumentParams>()->SetContentChanges({ changeEvent });
+    m_params->As<DidChangeTextDocumentParams>()->SetContentChanges(changes);
 }
 
 LSP::DidChangeTextDocumentRequest::~DidChangeTextDocumentRequest() {}
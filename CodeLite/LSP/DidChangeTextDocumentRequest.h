@@ -2,15 +2,21 @@
 #define DIDCHANGE_TEXTDOCUMENTREQUEST_H
 
 #include <wx/filename.h>
-#include "LSP/RequestMessage.h"
+#include <vector>
+#include "LSP/NotificationMessage.h"
 
 namespace LSP
 {
 
-class WXDLLIMPEXP_CL DidChangeTextDocumentRequest : public LSP::RequestMessage
+class WXDLLIMPEXP_CL DidChangeTextDocumentRequest : public LSP::NotificationMessage
 {
 public:
-    DidChangeTextDocumentRequest(const wxFileName& filename, const wxString& fileContent);
+    /**
+     * @param version the document version after applying 'changes'
+     * @param changes the changes, in the order they were made
+     */
+    DidChangeTextDocumentRequest(const wxFileName& filename, int version,
+                                 const std::vector<TextDocumentContentChangeEvent>& changes);
     virtual ~DidChangeTextDocumentRequest();
 };
 
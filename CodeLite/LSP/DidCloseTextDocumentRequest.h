@@ -2,12 +2,12 @@
 #define DIDCLOSETEXTDOCUMENTREQUEST_H
 
 #include <wx/filename.h>
-#include "LSP/RequestMessage.h"
+#include "LSP/NotificationMessage.h"
 
 namespace LSP
 {
 
-class WXDLLIMPEXP_CL DidCloseTextDocumentRequest : public LSP::RequestMessage
+class WXDLLIMPEXP_CL DidCloseTextDocumentRequest : public LSP::NotificationMessage
 {
 public:
     DidCloseTextDocumentRequest(const wxFileName& filename);
@@ -1,13 +1,13 @@
 #ifndef DIDOPENTEXTDOCUMENTREQUEST_H
 #define DIDOPENTEXTDOCUMENTREQUEST_H
 
-#include "RequestMessage.h"
+#include "LSP/NotificationMessage.h"
 #include <wx/filename.h>
 
 namespace LSP
 {
 
-class WXDLLIMPEXP_CL DidOpenTextDocumentRequest : public LSP::RequestMessage
+class WXDLLIMPEXP_CL DidOpenTextDocumentRequest : public LSP::NotificationMessage
 {
 public:
     DidOpenTextDocumentRequest(const wxFileName& filename, const wxString& text, const wxString& langugage);
@@ -2,12 +2,12 @@
 #define DIDSAVE_TEXTDOCUMENTREQUEST_H
 
 #include <wx/filename.h>
-#include "LSP/RequestMessage.h"
+#include "LSP/NotificationMessage.h"
 
 namespace LSP
 {
 
-class WXDLLIMPEXP_CL DidSaveTextDocumentRequest : public LSP::RequestMessage
+class WXDLLIMPEXP_CL DidSaveTextDocumentRequest : public LSP::NotificationMessage
 {
 public:
     DidSaveTextDocumentRequest(const wxFileName& filename, const wxString& fileContent);
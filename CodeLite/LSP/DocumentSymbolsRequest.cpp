@@ -0,0 +1,59 @@
+#include "LSP/DocumentSymbolsRequest.h"
+#include "LSP/LSPEvent.h"
+
+/**
+ * @brief flatten a DocumentSymbol tree into a list of SymbolInformation
+ */
+static void FlattenDocumentSymbols(const JSONItem& symbols, const wxString& uri, const wxString& container,
+                                   std::vector<LSP::SymbolInformation>& result)
+{
+    int count = symbols.arraySize();
+    for(int i = 0; i < count; ++i) {
+        JSONItem symbol = symbols.arrayItem(i);
+        LSP::Range range;
+        range.FromJSON(symbol.namedObject("selectionRange"));
+
+        LSP::SymbolInformation si;
+        si.SetName(symbol.namedObject("name").toString())
+            .SetKind(symbol.namedObject("kind").toInt(0))
+            .SetContainerName(container)
+            .SetLocation(LSP::Location(uri, range));
+        result.push_back(si);
+
+        wxString scope = container.IsEmpty() ? si.GetName() : (container + "::" + si.GetName());
+        FlattenDocumentSymbols(symbol.namedObject("children"), uri, scope, result);
+    }
+}
+
+LSP::DocumentSymbolsRequest::DocumentSymbolsRequest(const wxFileName& filename)
+    : m_filename(filename)
+{
+    SetMethod("textDocument/documentSymbol");
+    m_params.reset(new DocumentSymbolParams());
+    m_params->As<DocumentSymbolParams>()->SetTextDocument(TextDocumentIdentifier(filename));
+}
+
+LSP::DocumentSymbolsRequest::~DocumentSymbolsRequest() {}
+
+void LSP::DocumentSymbolsRequest::OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    // The result is either a flat SymbolInformation[] or a hierarchical DocumentSymbol[] (which has no "location")
+    JSONItem result = response.Get("result");
+    std::vector<LSP::SymbolInformation> symbols;
+    int count = result.arraySize();
+    if(count && result.arrayItem(0).hasNamedObject("location")) {
+        symbols.reserve(count);
+        for(int i = 0; i < count; ++i) {
+            LSP::SymbolInformation si;
+            si.FromJSON(result.arrayItem(i));
+            symbols.push_back(si);
+        }
+    } else {
+        FlattenDocumentSymbols(result, m_filename.GetFullPath(), "", symbols);
+    }
+
+    LSPEvent event(wxEVT_LSP_DOCUMENT_SYMBOLS);
+    event.SetSymbols(symbols);
+    event.SetFileName(m_filename.GetFullPath());
+    owner->AddPendingEvent(event);
+}
@@ -0,0 +1,24 @@
+#ifndef DOCUMENTSYMBOLSREQUEST_H
+#define DOCUMENTSYMBOLSREQUEST_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+#include <wx/filename.h>
+
+namespace LSP
+{
+/**
+ * @brief textDocument/documentSymbol. The response is sent to the owner as wxEVT_LSP_DOCUMENT_SYMBOLS
+ */
+class WXDLLIMPEXP_CL DocumentSymbolsRequest : public LSP::RequestMessage
+{
+    wxFileName m_filename;
+
+public:
+    DocumentSymbolsRequest(const wxFileName& filename);
+    virtual ~DocumentSymbolsRequest();
+    const wxFileName& GetFilename() const { return m_filename; }
+    void OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+};
+}; // namespace LSP
+
+#endif // DOCUMENTSYMBOLSREQUEST_H
@@ -0,0 +1,34 @@
+#include "LSP/FindReferencesRequest.h"
+#include "LSP/LSPEvent.h"
+
+LSP::FindReferencesRequest::FindReferencesRequest(const wxFileName& filename, size_t line, size_t column)
+    : m_filename(filename)
+    , m_line(line)
+    , m_column(column)
+{
+    SetMethod("textDocument/references");
+    m_params.reset(new ReferenceParams());
+    m_params->As<ReferenceParams>()->SetTextDocument(TextDocumentIdentifier(filename));
+    m_params->As<ReferenceParams>()->SetPosition(Position(line, column));
+}
+
+LSP::FindReferencesRequest::~FindReferencesRequest() {}
+
+void LSP::FindReferencesRequest::OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    JSONItem result = response.Get("result");
+    std::vector<LSP::Location> locations;
+    int count = result.arraySize();
+    locations.reserve(count);
+    for(int i = 0; i < count; ++i) {
+        LSP::Location loc;
+        loc.FromJSON(result.arrayItem(i));
+        locations.push_back(loc);
+    }
+
+    LSPEvent event(wxEVT_LSP_REFERENCES);
+    event.SetLocations(locations);
+    event.SetFileName(m_filename.GetFullPath());
+    event.SetPosition(Position(m_line, m_column));
+    owner->AddPendingEvent(event);
+}
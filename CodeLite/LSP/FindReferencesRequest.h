@@ -0,0 +1,28 @@
+#ifndef FINDREFERENCESREQUEST_H
+#define FINDREFERENCESREQUEST_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+#include <wx/filename.h>
+
+namespace LSP
+{
+/**
+ * @brief textDocument/references. The response is sent to the owner as wxEVT_LSP_REFERENCES
+ */
+class WXDLLIMPEXP_CL FindReferencesRequest : public LSP::RequestMessage
+{
+    wxFileName m_filename;
+    size_t m_line = 0;
+    size_t m_column = 0;
+
+public:
+    FindReferencesRequest(const wxFileName& filename, size_t line, size_t column);
+    virtual ~FindReferencesRequest();
+    const wxFileName& GetFilename() const { return m_filename; }
+    size_t GetLine() const { return m_line; }
+    size_t GetColumn() const { return m_column; }
+    void OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+};
+}; // namespace LSP
+
+#endif // FINDREFERENCESREQUEST_H
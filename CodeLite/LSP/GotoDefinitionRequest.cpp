@@ -1,4 +1,5 @@
 #include "GotoDefinitionRequest.h"
+#include "LSP/LSPEvent.h"
 
 LSP::GotoDefinitionRequest::GotoDefinitionRequest(const wxFileName& filename, size_t line, size_t column)
     : m_filename(filename)
@@ -18,10 +19,23 @@ void LSP::GotoDefinitionRequest::OnReponse(const LSP::ResponseMessage& response,
     // {"id":2,"jsonrpc":"2.0","result":[{"range":{"end":{"character":38,"line":73},"start":{"character":32,"line":73}},"uri":"file:///usr/include/c%2b%2b/6/bits/stringfwd.h"},{"range":{"end":{"character":38,"line":73},"start":{"character":32,"line":73}},"uri":"file:///usr/lib/gcc/x86_64-linux-gnu/6.3.0/../../../../include/c%2b%2b/6.3.0/bits/stringfwd.h"}]}
     JSONItem result = response.Get("result");
     if(!result.isOk()) { return; }
-    LSP::Location loc;
+    std::vector<LSP::Location> locations;
     if(result.isArray()) {
-        loc.FromJSON(result.arrayItem(0));
+        int count = result.arraySize();
+        for(int i = 0; i < count; ++i) {
+            LSP::Location loc;
+            loc.FromJSON(result.arrayItem(i));
+            locations.push_back(loc);
+        }
     } else {
+        LSP::Location loc;
         loc.FromJSON(result);
+        locations.push_back(loc);
     }
+
+    LSPEvent event(wxEVT_LSP_DEFINITION);
+    event.SetLocations(locations);
+    event.SetFileName(m_filename.GetFullPath());
+    event.SetPosition(Position(m_line, m_column));
+    owner->AddPendingEvent(event);
 }
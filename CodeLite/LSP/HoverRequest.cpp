@@ -0,0 +1,26 @@
+#include "LSP/HoverRequest.h"
+#include "LSP/LSPEvent.h"
+
+LSP::HoverRequest::HoverRequest(const wxFileName& filename, size_t line, size_t column)
+    : m_filename(filename)
+    , m_line(line)
+    , m_column(column)
+{
+    SetMethod("textDocument/hover");
+    m_params.reset(new TextDocumentPositionParams());
+    m_params->As<TextDocumentPositionParams>()->SetTextDocument(TextDocumentIdentifier(filename));
+    m_params->As<TextDocumentPositionParams>()->SetPosition(Position(line, column));
+}
+
+LSP::HoverRequest::~HoverRequest() {}
+
+void LSP::HoverRequest::OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    // Hover { contents, range? } or null
+    JSONItem result = response.Get("result");
+    LSPEvent event(wxEVT_LSP_HOVER);
+    event.SetString(LSP::MarkupToString(result.namedObject("contents")));
+    event.SetFileName(m_filename.GetFullPath());
+    event.SetPosition(Position(m_line, m_column));
+    owner->AddPendingEvent(event);
+}
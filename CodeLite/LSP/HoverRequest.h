@@ -0,0 +1,28 @@
+#ifndef HOVERREQUEST_H
+#define HOVERREQUEST_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+#include <wx/filename.h>
+
+namespace LSP
+{
+/**
+ * @brief textDocument/hover. The response is sent to the owner as wxEVT_LSP_HOVER
+ */
+class WXDLLIMPEXP_CL HoverRequest : public LSP::RequestMessage
+{
+    wxFileName m_filename;
+    size_t m_line = 0;
+    size_t m_column = 0;
+
+public:
+    HoverRequest(const wxFileName& filename, size_t line, size_t column);
+    virtual ~HoverRequest();
+    const wxFileName& GetFilename() const { return m_filename; }
+    size_t GetLine() const { return m_line; }
+    size_t GetColumn() const { return m_column; }
+    void OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+};
+}; // namespace LSP
+
+#endif // HOVERREQUEST_H
@@ -0,0 +1,40 @@
+#include "LSP/InitializeRequest.h"
+#include "file_logger.h"
+#include <wx/utils.h>
+
+wxDEFINE_EVENT(wxEVT_LSP_INITIALIZED, clCommandEvent);
+
+LSP::InitializeRequest::InitializeRequest(const wxString& rootFolder)
+{
+    SetMethod("initialize");
+    m_params.reset(new InitializeParams());
+    m_params->As<InitializeParams>()->SetProcessId(::wxGetProcessId());
+    m_params->As<InitializeParams>()->SetRootUri(rootFolder);
+}
+
+LSP::InitializeRequest::~InitializeRequest() {}
+
+void LSP::InitializeRequest::OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    // "textDocumentSync" is either a TextDocumentSyncKind or a TextDocumentSyncOptions object
+    // When not specified, the server expects the full document content
+    int syncKind = kSyncFull;
+    JSONItem capabilities = response.Get("result").namedObject("capabilities");
+    if(capabilities.isOk() && capabilities.hasNamedObject("textDocumentSync")) {
+        JSONItem sync = capabilities.namedObject("textDocumentSync");
+        if(sync.isNumber()) {
+            syncKind = sync.toInt(kSyncFull);
+        } else if(sync.hasNamedObject("change")) {
+            syncKind = sync.namedObject("change").toInt(kSyncFull);
+        }
+    }
+    clDEBUG() << "Language server initialized. Text document sync kind:" << syncKind;
+
+    clCommandEvent event(wxEVT_LSP_INITIALIZED);
+    event.SetInt(syncKind);
+    owner->ProcessEvent(event);
+}
+
+LSP::InitializedNotification::InitializedNotification() { SetMethod("initialized"); }
+
+LSP::InitializedNotification::~InitializedNotification() {}
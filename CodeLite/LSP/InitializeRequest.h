@@ -0,0 +1,46 @@
+#ifndef INITIALIZEREQUEST_H
+#define INITIALIZEREQUEST_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+#include "LSP/NotificationMessage.h"
+#include "cl_command_event.h"
+
+namespace LSP
+{
+/**
+ * @brief the text document sync kinds that a server supports (TextDocumentSyncKind)
+ */
+enum eTextDocumentSyncKind {
+    kSyncNone = 0,
+    kSyncFull = 1,
+    kSyncIncremental = 2,
+};
+
+class WXDLLIMPEXP_CL InitializeRequest : public LSP::RequestMessage
+{
+public:
+    InitializeRequest(const wxString& rootFolder);
+    virtual ~InitializeRequest();
+
+    /**
+     * @brief fires wxEVT_LSP_INITIALIZED to the owner. The event's GetInt() holds the server sync kind
+     */
+    void OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+};
+
+/**
+ * @brief the "initialized" notification, sent once the client processed the "initialize" response
+ */
+class WXDLLIMPEXP_CL InitializedNotification : public LSP::NotificationMessage
+{
+public:
+    InitializedNotification();
+    virtual ~InitializedNotification();
+};
+}; // namespace LSP
+
+// Event: clCommandEvent
+// The language server replied to the "initialize" request. event.GetInt() holds the server's TextDocumentSyncKind
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_INITIALIZED, clCommandEvent);
+
+#endif // INITIALIZEREQUEST_H
@@ -0,0 +1,30 @@
+#include "LSP/LSPEvent.h"
+
+wxDEFINE_EVENT(wxEVT_LSP_DEFINITION, LSPEvent);
+wxDEFINE_EVENT(wxEVT_LSP_COMPLETION_READY, LSPEvent);
+wxDEFINE_EVENT(wxEVT_LSP_HOVER, LSPEvent);
+wxDEFINE_EVENT(wxEVT_LSP_SIGNATURE_HELP, LSPEvent);
+wxDEFINE_EVENT(wxEVT_LSP_REFERENCES, LSPEvent);
+wxDEFINE_EVENT(wxEVT_LSP_DOCUMENT_SYMBOLS, LSPEvent);
+
+LSPEvent::LSPEvent(wxEventType commandType, int winid)
+    : clCommandEvent(commandType, winid)
+    , m_position(0, 0)
+{
+}
+
+LSPEvent::LSPEvent(const LSPEvent& src) { *this = src; }
+
+LSPEvent::~LSPEvent() {}
+
+LSPEvent& LSPEvent::operator=(const LSPEvent& src)
+{
+    if(this == &src) { return *this; }
+    clCommandEvent::operator=(src);
+    m_position = src.m_position;
+    m_locations = src.m_locations;
+    m_completions = src.m_completions;
+    m_signatureHelp = src.m_signatureHelp;
+    m_symbols = src.m_symbols;
+    return *this;
+}
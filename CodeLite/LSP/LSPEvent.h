@@ -0,0 +1,58 @@
+#ifndef LSPEVENT_H
+#define LSPEVENT_H
+
+#include "cl_command_event.h"
+#include "LSP/basic_types.h"
+#include <vector>
+
+/**
+ * @class LSPEvent
+ * @brief carries the result of a language server request. The file name is set to the file of the request and
+ * GetPosition() returns the position of the request
+ */
+class WXDLLIMPEXP_CL LSPEvent : public clCommandEvent
+{
+    LSP::Position m_position;
+    std::vector<LSP::Location> m_locations;
+    std::vector<LSP::CompletionItem> m_completions;
+    LSP::SignatureHelp m_signatureHelp;
+    std::vector<LSP::SymbolInformation> m_symbols;
+
+public:
+    LSPEvent(wxEventType commandType = wxEVT_NULL, int winid = 0);
+    LSPEvent(const LSPEvent& src);
+    LSPEvent& operator=(const LSPEvent& src);
+    virtual ~LSPEvent();
+    virtual wxEvent* Clone() const { return new LSPEvent(*this); }
+
+    void SetPosition(const LSP::Position& position) { this->m_position = position; }
+    const LSP::Position& GetPosition() const { return m_position; }
+    void SetLocations(const std::vector<LSP::Location>& locations) { this->m_locations = locations; }
+    const std::vector<LSP::Location>& GetLocations() const { return m_locations; }
+    void SetCompletions(const std::vector<LSP::CompletionItem>& completions) { this->m_completions = completions; }
+    const std::vector<LSP::CompletionItem>& GetCompletions() const { return m_completions; }
+    void SetSignatureHelp(const LSP::SignatureHelp& signatureHelp) { this->m_signatureHelp = signatureHelp; }
+    const LSP::SignatureHelp& GetSignatureHelp() const { return m_signatureHelp; }
+    void SetSymbols(const std::vector<LSP::SymbolInformation>& symbols) { this->m_symbols = symbols; }
+    const std::vector<LSP::SymbolInformation>& GetSymbols() const { return m_symbols; }
+};
+
+typedef void (wxEvtHandler::*LSPEventFunction)(LSPEvent&);
+#define LSPEventHandler(func) wxEVENT_HANDLER_CAST(LSPEventFunction, func)
+
+// The events below are sent by the language server requests to the LanguageServerProtocol that sent them
+
+// textDocument/definition: event.GetLocations()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_DEFINITION, LSPEvent);
+// textDocument/completion: event.GetCompletions()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_COMPLETION_READY, LSPEvent);
+// textDocument/hover: event.GetString() holds the hover text
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_HOVER, LSPEvent);
+// textDocument/signatureHelp: event.GetSignatureHelp()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_SIGNATURE_HELP, LSPEvent);
+// textDocument/references: event.GetLocations()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_REFERENCES, LSPEvent);
+// textDocument/documentSymbol: event.GetSymbols()
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_LSP_DOCUMENT_SYMBOLS, LSPEvent);
+
+#endif // LSPEVENT_H
@@ -0,0 +1,105 @@
+#include "LSP/MessageFramer.h"
+#include "file_logger.h"
+#include <string.h>
+
+#define HEADER_SEPARATOR "\r\n\r\n"
+#define HEADER_CONTENT_LENGTH "content-length"
+
+LSP::MessageFramer::MessageFramer() {}
+
+LSP::MessageFramer::~MessageFramer() {}
+
+void LSP::MessageFramer::Append(const char* data, size_t len)
+{
+    if(data && len) { m_buffer.append(data, len); }
+}
+
+void LSP::MessageFramer::Clear()
+{
+    m_buffer.clear();
+    m_offset = 0;
+    m_contentLength = wxNOT_FOUND;
+}
+
+void LSP::MessageFramer::Compact()
+{
+    // Move the unconsumed bytes to the start of the buffer only when they are less than the consumed ones: this
+    // keeps the total number of bytes moved linear in the size of the output
+    if(m_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_offset = 0;
+    } else if(m_offset > (m_buffer.size() / 2)) {
+        m_buffer.erase(0, m_offset);
+        m_offset = 0;
+    }
+}
+
+long LSP::MessageFramer::ReadContentLength(size_t from, size_t to) const
+{
+    long contentLength = wxNOT_FOUND;
+    while(from < to) {
+        size_t eol = m_buffer.find('\n', from);
+        if(eol == std::string::npos || eol > to) { eol = to; }
+        std::string header = m_buffer.substr(from, eol - from);
+        from = eol + 1;
+
+        size_t colon = header.find(':');
+        if(colon == std::string::npos) { continue; }
+        std::string name = header.substr(0, colon);
+        // skip any leading noise (e.g. an empty line written before the headers)
+        size_t nameStart = name.find_first_not_of(" \t\r\n");
+        if(nameStart == std::string::npos) { continue; }
+        name.erase(0, nameStart);
+        while(!name.empty() && (name.back() == ' ' || name.back() == '\t')) {
+            name.pop_back();
+        }
+        if(strcasecmp(name.c_str(), HEADER_CONTENT_LENGTH) != 0) { continue; }
+
+        char* end = nullptr;
+        const char* value = header.c_str() + colon + 1;
+        long len = strtol(value, &end, 10);
+        if(end != value && len >= 0) { contentLength = len; }
+    }
+    return contentLength;
+}
+
+wxSharedPtr<JSON> LSP::MessageFramer::Next()
+{
+    while(true) {
+        if(m_contentLength == wxNOT_FOUND) {
+            size_t where = m_buffer.find(HEADER_SEPARATOR, m_offset);
+            if(where == std::string::npos) {
+                Compact();
+                return wxSharedPtr<JSON>(nullptr);
+            }
+            m_contentLength = ReadContentLength(m_offset, where);
+            m_offset = where + strlen(HEADER_SEPARATOR);
+            if(m_contentLength == wxNOT_FOUND) {
+                clWARNING() << "Language server message without a Content-Length header. Skipping it" << clEndl;
+                continue;
+            }
+        }
+
+        if((m_buffer.size() - m_offset) < (size_t)m_contentLength) {
+            // the body is not complete yet
+            Compact();
+            return wxSharedPtr<JSON>(nullptr);
+        }
+
+        // Parse the body in place: temporarily terminate it (for the last message in the buffer, this overwrites the
+        // string terminator with itself)
+        size_t end = m_offset + m_contentLength;
+        char saved = m_buffer[end];
+        m_buffer[end] = 0;
+        cJSON* json = cJSON_Parse(&m_buffer[m_offset]);
+        m_buffer[end] = saved;
+
+        m_offset = end;
+        m_contentLength = wxNOT_FOUND;
+        if(!json) {
+            clWARNING() << "Language server sent an invalid JSON message. Skipping it" << clEndl;
+            continue;
+        }
+        return wxSharedPtr<JSON>(new JSON(json));
+    }
+}
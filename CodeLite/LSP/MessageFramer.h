@@ -0,0 +1,59 @@
+#ifndef LSP_MESSAGEFRAMER_H
+#define LSP_MESSAGEFRAMER_H
+
+#include "codelite_exports.h"
+#include "JSON.h"
+#include <string>
+#include <wx/sharedptr.h>
+#include <wx/string.h>
+
+namespace LSP
+{
+/**
+ * @class MessageFramer
+ * @brief splits the output stream of a language server into messages.
+ * Every message is a header section ("Content-Length: <bytes>\r\n...\r\n\r\n") followed by a JSON body of the
+ * given length (in UTF-8 bytes). The output is accumulated in a byte buffer and every complete message is
+ * parsed directly from it, a chunk may contain any number of messages (or only a part of one)
+ */
+class WXDLLIMPEXP_CL MessageFramer
+{
+    std::string m_buffer;
+    size_t m_offset = 0;                // the bytes before m_offset were already consumed
+    long m_contentLength = wxNOT_FOUND; // the length of the current message body, once its headers were read
+
+protected:
+    /**
+     * @brief parse the header section [from, to) and return the value of its Content-Length header
+     */
+    long ReadContentLength(size_t from, size_t to) const;
+    void Compact();
+
+public:
+    MessageFramer();
+    virtual ~MessageFramer();
+
+    /**
+     * @brief append output received from the server, exactly as the server wrote it (Content-Length counts bytes)
+     */
+    void Append(const char* data, size_t len);
+
+    /**
+     * @brief extract the next complete message
+     * @return the parsed message or a null pointer when more output is needed
+     */
+    wxSharedPtr<JSON> Next();
+
+    /**
+     * @brief discard everything (e.g. when the server is restarted)
+     */
+    void Clear();
+
+    /**
+     * @brief the number of bytes received but not consumed yet
+     */
+    size_t GetPendingBytes() const { return m_buffer.size() - m_offset; }
+};
+}; // namespace LSP
+
+#endif // LSP_MESSAGEFRAMER_H
@@ -0,0 +1,17 @@
+#include "LSP/NotificationMessage.h"
+
+LSP::NotificationMessage::NotificationMessage() {}
+
+LSP::NotificationMessage::~NotificationMessage() {}
+
+JSONItem LSP::NotificationMessage::ToJSON(const wxString& name) const
+{
+    JSONItem json = Message::ToJSON(name);
+    json.addProperty("method", GetMethod());
+    if(m_params) {
+        json.append(m_params->ToJSON("params"));
+    } else {
+        json.append(JSONItem::createObject("params"));
+    }
+    return json;
+}
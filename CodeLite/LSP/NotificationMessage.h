@@ -0,0 +1,21 @@
+#ifndef NOTIFICATIONMESSAGE_H
+#define NOTIFICATIONMESSAGE_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+
+namespace LSP
+{
+/**
+ * @class NotificationMessage
+ * @brief a message that the server does not reply to. It is serialized without an "id"
+ */
+class WXDLLIMPEXP_CL NotificationMessage : public LSP::RequestMessage
+{
+public:
+    NotificationMessage();
+    virtual ~NotificationMessage();
+    virtual JSONItem ToJSON(const wxString& name) const;
+};
+}; // namespace LSP
+
+#endif // NOTIFICATIONMESSAGE_H
@@ -28,7 +28,8 @@ wxString LSP::RequestMessage::ToString() const
     JSONItem json = ToJSON("");
 
     wxString data = json.format(false);
-    size_t len = data.length();
+    // Content-Length is the size of the body in bytes (UTF-8), not in characters
+    size_t len = data.utf8_str().length();
 
     // Build the request
     wxString buffer;
@@ -46,6 +46,15 @@ public:
         wxUnusedVar(response);
         wxUnusedVar(owner);
     }
+
+    /**
+     * @brief called by the protocol when the server replied with an error (other than "request cancelled")
+     */
+    virtual void OnError(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+    {
+        wxUnusedVar(response);
+        wxUnusedVar(owner);
+    }
 };
 
 } // namespace LSP
@@ -36,6 +36,16 @@ LSP::ResponseMessage::ResponseMessage(wxString& message)
     }
 }
 
+LSP::ResponseMessage::ResponseMessage(wxSharedPtr<JSON> json)
+    : m_json(json)
+{
+    if(m_json && m_json->isOk()) {
+        FromJSON(m_json->toElement());
+    } else {
+        m_json.reset(nullptr);
+    }
+}
+
 LSP::ResponseMessage::~ResponseMessage() {}
 
 wxString LSP::ResponseMessage::ToString() const { return ""; }
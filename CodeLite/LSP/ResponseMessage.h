@@ -21,6 +21,10 @@ protected:
 
 public:
     ResponseMessage(wxString& message);
+    /**
+     * @brief construct a message from an already parsed JSON (see LSP::MessageFramer)
+     */
+    ResponseMessage(wxSharedPtr<JSON> json);
     virtual ~ResponseMessage();
     virtual JSONItem ToJSON(const wxString& name) const;
     virtual void FromJSON(const JSONItem& json);
@@ -34,6 +38,10 @@ public:
     int GetId() const { return m_id; }
 
     bool IsOk() const { return m_json != nullptr; }
+    /**
+     * @brief notifications and requests sent by the server have a method, responses do not
+     */
+    wxString GetMethod() const { return Get("method").toString(); }
     bool Has(const wxString& property) const;
     JSONItem Get(const wxString& property) const;
 };
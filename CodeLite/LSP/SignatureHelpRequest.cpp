@@ -0,0 +1,27 @@
+#include "LSP/SignatureHelpRequest.h"
+#include "LSP/LSPEvent.h"
+
+LSP::SignatureHelpRequest::SignatureHelpRequest(const wxFileName& filename, size_t line, size_t column)
+    : m_filename(filename)
+    , m_line(line)
+    , m_column(column)
+{
+    SetMethod("textDocument/signatureHelp");
+    m_params.reset(new TextDocumentPositionParams());
+    m_params->As<TextDocumentPositionParams>()->SetTextDocument(TextDocumentIdentifier(filename));
+    m_params->As<TextDocumentPositionParams>()->SetPosition(Position(line, column));
+}
+
+LSP::SignatureHelpRequest::~SignatureHelpRequest() {}
+
+void LSP::SignatureHelpRequest::OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner)
+{
+    LSP::SignatureHelp signatureHelp;
+    signatureHelp.FromJSON(response.Get("result"));
+
+    LSPEvent event(wxEVT_LSP_SIGNATURE_HELP);
+    event.SetSignatureHelp(signatureHelp);
+    event.SetFileName(m_filename.GetFullPath());
+    event.SetPosition(Position(m_line, m_column));
+    owner->AddPendingEvent(event);
+}
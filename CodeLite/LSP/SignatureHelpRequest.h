@@ -0,0 +1,28 @@
+#ifndef SIGNATUREHELPREQUEST_H
+#define SIGNATUREHELPREQUEST_H
+
+#include "LSP/RequestMessage.h" // Base class: LSP::RequestMessage
+#include <wx/filename.h>
+
+namespace LSP
+{
+/**
+ * @brief textDocument/signatureHelp. The response is sent to the owner as wxEVT_LSP_SIGNATURE_HELP
+ */
+class WXDLLIMPEXP_CL SignatureHelpRequest : public LSP::RequestMessage
+{
+    wxFileName m_filename;
+    size_t m_line = 0;
+    size_t m_column = 0;
+
+public:
+    SignatureHelpRequest(const wxFileName& filename, size_t line, size_t column);
+    virtual ~SignatureHelpRequest();
+    const wxFileName& GetFilename() const { return m_filename; }
+    size_t GetLine() const { return m_line; }
+    size_t GetColumn() const { return m_column; }
+    void OnReponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+};
+}; // namespace LSP
+
+#endif // SIGNATUREHELPREQUEST_H
@@ -80,11 +80,17 @@ JSONItem TextDocumentItem::ToJSON(const wxString& name) const
 //===----------------------------------------------------------------------------------
 // TextDocumentContentChangeEvent
 //===----------------------------------------------------------------------------------
-void TextDocumentContentChangeEvent::FromJSON(const JSONItem& json) { m_text = json.namedObject("text").toString(); }
+void TextDocumentContentChangeEvent::FromJSON(const JSONItem& json)
+{
+    m_text = json.namedObject("text").toString();
+    m_hasRange = json.hasNamedObject("range");
+    if(m_hasRange) { m_range.FromJSON(json.namedObject("range")); }
+}
 
 JSONItem TextDocumentContentChangeEvent::ToJSON(const wxString& name) const
 {
     JSONItem json = JSONItem::createObject(name);
+    if(m_hasRange) { json.append(m_range.ToJSON("range")); }
     json.addProperty("text", m_text);
     return json;
 }
@@ -99,7 +105,7 @@ JSONItem Range::ToJSON(const wxString& name) const
 {
     JSONItem json = JSONItem::createObject(name);
     json.append(m_start.ToJSON("start"));
-    json.append(m_start.ToJSON("end"));
+    json.append(m_end.ToJSON("end"));
     return json;
 }
 
@@ -116,4 +122,128 @@ JSONItem Location::ToJSON(const wxString& name) const
     json.append(m_range.ToJSON("range"));
     return json;
 }
+
+wxString MarkupToString(const JSONItem& json)
+{
+    if(!json.isOk()) { return ""; }
+    if(json.isString()) { return json.toString(); }
+    if(json.isArray()) {
+        wxString text;
+        int count = json.arraySize();
+        for(int i = 0; i < count; ++i) {
+            if(!text.IsEmpty()) { text << "\n"; }
+            text << MarkupToString(json.arrayItem(i));
+        }
+        return text;
+    }
+    // MarkupContent or a MarkedString { language, value }
+    return json.namedObject("value").toString();
+}
+
+int UTF16Length(const wxString& text)
+{
+    // Where wxString holds UTF-16 (MSW) a surrogate pair is already 2 characters
+    int len = 0;
+    for(wxString::const_iterator iter = text.begin(); iter != text.end(); ++iter) {
+        len += (wxUniChar(*iter).GetValue() > 0xFFFF) ? 2 : 1;
+    }
+    return len;
+}
+
+void CompletionItem::FromJSON(const JSONItem& json)
+{
+    m_label = json.namedObject("label").toString();
+    m_kind = json.namedObject("kind").toInt(0);
+    m_detail = json.namedObject("detail").toString();
+    m_documentation = MarkupToString(json.namedObject("documentation"));
+    m_insertText = json.namedObject("insertText").toString();
+    if(json.hasNamedObject("textEdit")) {
+        m_insertText = json.namedObject("textEdit").namedObject("newText").toString();
+    }
+    m_filterText = json.namedObject("filterText").toString();
+    m_sortText = json.namedObject("sortText").toString();
+}
+
+JSONItem CompletionItem::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    json.addProperty("label", m_label);
+    json.addProperty("kind", m_kind);
+    json.addProperty("detail", m_detail);
+    json.addProperty("insertText", m_insertText);
+    return json;
+}
+
+void SignatureInformation::FromJSON(const JSONItem& json)
+{
+    m_label = json.namedObject("label").toString();
+    m_documentation = MarkupToString(json.namedObject("documentation"));
+    m_parameters.clear();
+    JSONItem parameters = json.namedObject("parameters");
+    int count = parameters.arraySize();
+    for(int i = 0; i < count; ++i) {
+        // the label is either a string or the [start, end) offsets of the parameter in the signature label
+        JSONItem label = parameters.arrayItem(i).namedObject("label");
+        if(label.isArray() && label.arraySize() == 2) {
+            int start = label.arrayItem(0).toInt();
+            int end = label.arrayItem(1).toInt();
+            m_parameters.Add(m_label.Mid(start, end - start));
+        } else {
+            m_parameters.Add(label.toString());
+        }
+    }
+}
+
+JSONItem SignatureInformation::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    json.addProperty("label", m_label);
+    json.addProperty("documentation", m_documentation);
+    return json;
+}
+
+void SignatureHelp::FromJSON(const JSONItem& json)
+{
+    m_signatures.clear();
+    JSONItem signatures = json.namedObject("signatures");
+    int count = signatures.arraySize();
+    for(int i = 0; i < count; ++i) {
+        SignatureInformation si;
+        si.FromJSON(signatures.arrayItem(i));
+        m_signatures.push_back(si);
+    }
+    m_activeSignature = json.namedObject("activeSignature").toInt(0);
+    m_activeParameter = json.namedObject("activeParameter").toInt(0);
+}
+
+JSONItem SignatureHelp::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    JSONItem signatures = JSONItem::createArray("signatures");
+    for(const SignatureInformation& si : m_signatures) {
+        signatures.arrayAppend(si.ToJSON(""));
+    }
+    json.append(signatures);
+    json.addProperty("activeSignature", m_activeSignature);
+    json.addProperty("activeParameter", m_activeParameter);
+    return json;
+}
+
+void SymbolInformation::FromJSON(const JSONItem& json)
+{
+    m_name = json.namedObject("name").toString();
+    m_kind = json.namedObject("kind").toInt(0);
+    m_containerName = json.namedObject("containerName").toString();
+    m_location.FromJSON(json.namedObject("location"));
+}
+
+JSONItem SymbolInformation::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    json.addProperty("name", m_name);
+    json.addProperty("kind", m_kind);
+    json.addProperty("containerName", m_containerName);
+    json.append(m_location.ToJSON("location"));
+    return json;
+}
 }; // namespace LSP
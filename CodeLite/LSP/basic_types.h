@@ -5,34 +5,11 @@
 #include "JSON.h"
 #include "JSONObject.h"
 #include <wx/sharedptr.h>
+#include <wx/arrstr.h>
+#include <vector>
 
 namespace LSP
 {
-//===----------------------------------------------------------------------------------
-// TextDocumentContentChangeEvent
-//===----------------------------------------------------------------------------------
-class WXDLLIMPEXP_CL TextDocumentContentChangeEvent : public Serializable
-{
-    wxString m_text;
-
-public:
-    virtual JSONItem ToJSON(const wxString& name) const;
-    virtual void FromJSON(const JSONItem& json);
-
-    TextDocumentContentChangeEvent() {}
-    TextDocumentContentChangeEvent(const wxString& text)
-        : m_text(text)
-    {
-    }
-    virtual ~TextDocumentContentChangeEvent() {}
-    TextDocumentContentChangeEvent& SetText(const wxString& text)
-    {
-        this->m_text = text;
-        return *this;
-    }
-    const wxString& GetText() const { return m_text; }
-};
-
 //===----------------------------------------------------------------------------------
 // TextDocumentIdentifier
 //===----------------------------------------------------------------------------------
@@ -146,6 +123,53 @@ public:
     const Position& GetStart() const { return m_start; }
 };
 
+//===----------------------------------------------------------------------------------
+// TextDocumentContentChangeEvent
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL TextDocumentContentChangeEvent : public Serializable
+{
+    wxString m_text;
+    Range m_range;
+    bool m_hasRange = false;
+
+public:
+    virtual JSONItem ToJSON(const wxString& name) const;
+    virtual void FromJSON(const JSONItem& json);
+
+    TextDocumentContentChangeEvent() {}
+    TextDocumentContentChangeEvent(const wxString& text)
+        : m_text(text)
+    {
+    }
+    /**
+     * @brief an incremental change: 'text' replaces the document content in 'range'
+     */
+    TextDocumentContentChangeEvent(const Range& range, const wxString& text)
+        : m_text(text)
+        , m_range(range)
+        , m_hasRange(true)
+    {
+    }
+    virtual ~TextDocumentContentChangeEvent() {}
+    TextDocumentContentChangeEvent& SetText(const wxString& text)
+    {
+        this->m_text = text;
+        return *this;
+    }
+    const wxString& GetText() const { return m_text; }
+    TextDocumentContentChangeEvent& SetRange(const Range& range)
+    {
+        this->m_range = range;
+        this->m_hasRange = true;
+        return *this;
+    }
+    const Range& GetRange() const { return m_range; }
+    /**
+     * @brief when false, the event carries the full content of the document
+     */
+    bool HasRange() const { return m_hasRange; }
+};
+
 class WXDLLIMPEXP_CL Location : public Serializable
 {
     wxString m_uri;
@@ -225,5 +249,141 @@ public:
     int GetVersion() const { return m_version; }
 };
 
+/**
+ * @brief return the text of a MarkupContent, a MarkedString or an array of MarkedString
+ */
+WXDLLIMPEXP_CL wxString MarkupToString(const JSONItem& json);
+
+/**
+ * @brief return the length of 'text' in UTF-16 code units, the unit of Position::character
+ */
+WXDLLIMPEXP_CL int UTF16Length(const wxString& text);
+
+//===----------------------------------------------------------------------------------
+// CompletionItem
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL CompletionItem : public Serializable
+{
+    wxString m_label;
+    int m_kind = 0;
+    wxString m_detail;
+    wxString m_documentation;
+    wxString m_insertText;
+    wxString m_filterText;
+    wxString m_sortText;
+
+public:
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    CompletionItem() {}
+    virtual ~CompletionItem() {}
+    CompletionItem& SetLabel(const wxString& label)
+    {
+        this->m_label = label;
+        return *this;
+    }
+    CompletionItem& SetInsertText(const wxString& insertText)
+    {
+        this->m_insertText = insertText;
+        return *this;
+    }
+    const wxString& GetLabel() const { return m_label; }
+    int GetKind() const { return m_kind; }
+    const wxString& GetDetail() const { return m_detail; }
+    const wxString& GetDocumentation() const { return m_documentation; }
+    /**
+     * @brief the text to insert. Falls back to the label when the server did not provide one
+     */
+    const wxString& GetInsertText() const { return m_insertText.IsEmpty() ? m_label : m_insertText; }
+    const wxString& GetFilterText() const { return m_filterText.IsEmpty() ? m_label : m_filterText; }
+    const wxString& GetSortText() const { return m_sortText.IsEmpty() ? m_label : m_sortText; }
+};
+
+//===----------------------------------------------------------------------------------
+// SignatureInformation
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL SignatureInformation : public Serializable
+{
+    wxString m_label;
+    wxString m_documentation;
+    wxArrayString m_parameters;
+
+public:
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    SignatureInformation() {}
+    virtual ~SignatureInformation() {}
+    const wxString& GetLabel() const { return m_label; }
+    const wxString& GetDocumentation() const { return m_documentation; }
+    /**
+     * @brief the parameters labels
+     */
+    const wxArrayString& GetParameters() const { return m_parameters; }
+};
+
+//===----------------------------------------------------------------------------------
+// SignatureHelp
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL SignatureHelp : public Serializable
+{
+    std::vector<SignatureInformation> m_signatures;
+    int m_activeSignature = 0;
+    int m_activeParameter = 0;
+
+public:
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    SignatureHelp() {}
+    virtual ~SignatureHelp() {}
+    const std::vector<SignatureInformation>& GetSignatures() const { return m_signatures; }
+    int GetActiveSignature() const { return m_activeSignature; }
+    int GetActiveParameter() const { return m_activeParameter; }
+};
+
+//===----------------------------------------------------------------------------------
+// SymbolInformation
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL SymbolInformation : public Serializable
+{
+    wxString m_name;
+    int m_kind = 0;
+    wxString m_containerName;
+    Location m_location;
+
+public:
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    SymbolInformation() {}
+    virtual ~SymbolInformation() {}
+    SymbolInformation& SetName(const wxString& name)
+    {
+        this->m_name = name;
+        return *this;
+    }
+    SymbolInformation& SetKind(int kind)
+    {
+        this->m_kind = kind;
+        return *this;
+    }
+    SymbolInformation& SetContainerName(const wxString& containerName)
+    {
+        this->m_containerName = containerName;
+        return *this;
+    }
+    SymbolInformation& SetLocation(const Location& location)
+    {
+        this->m_location = location;
+        return *this;
+    }
+    const wxString& GetName() const { return m_name; }
+    int GetKind() const { return m_kind; }
+    const wxString& GetContainerName() const { return m_containerName; }
+    const Location& GetLocation() const { return m_location; }
+};
+
 };     // namespace LSP
 #endif // JSONRPC_BASICTYPES_H
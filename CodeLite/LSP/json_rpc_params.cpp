@@ -1,4 +1,5 @@
 #include "LSP/json_rpc_params.h"
+#include <wx/filesys.h>
 
 //===----------------------------------------------------------------------------------
 // TextDocumentPositionParams
@@ -49,6 +50,77 @@ JSONItem DidCloseTextDocumentParams::ToJSON(const wxString& name) const
     return json;
 }
 
+//===----------------------------------------------------------------------------------
+// ReferenceParams
+//===----------------------------------------------------------------------------------
+void ReferenceParams::FromJSON(const JSONItem& json)
+{
+    TextDocumentPositionParams::FromJSON(json);
+    m_includeDeclaration = json.namedObject("context").namedObject("includeDeclaration").toBool(true);
+}
+
+JSONItem ReferenceParams::ToJSON(const wxString& name) const
+{
+    JSONItem json = TextDocumentPositionParams::ToJSON(name);
+    JSONItem context = JSONItem::createObject("context");
+    context.addProperty("includeDeclaration", m_includeDeclaration);
+    json.append(context);
+    return json;
+}
+
+//===----------------------------------------------------------------------------------
+// DocumentSymbolParams
+//===----------------------------------------------------------------------------------
+void DocumentSymbolParams::FromJSON(const JSONItem& json) { m_textDocument.FromJSON(json); }
+
+JSONItem DocumentSymbolParams::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    json.append(m_textDocument.ToJSON("textDocument"));
+    return json;
+}
+
+//===----------------------------------------------------------------------------------
+// CancelParams
+//===----------------------------------------------------------------------------------
+void CancelParams::FromJSON(const JSONItem& json) { m_id = json.namedObject("id").toInt(wxNOT_FOUND); }
+
+JSONItem CancelParams::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    json.addProperty("id", m_id);
+    return json;
+}
+
+//===----------------------------------------------------------------------------------
+// InitializeParams
+//===----------------------------------------------------------------------------------
+InitializeParams::InitializeParams() {}
+
+void InitializeParams::FromJSON(const JSONItem& json)
+{
+    m_processId = json.namedObject("processId").toInt(wxNOT_FOUND);
+    m_rootUri = json.namedObject("rootUri").toString();
+}
+
+JSONItem InitializeParams::ToJSON(const wxString& name) const
+{
+    JSONItem json = JSONItem::createObject(name);
+    json.addProperty("processId", m_processId);
+    if(!m_rootUri.IsEmpty()) { json.addProperty("rootUri", wxFileSystem::FileNameToURL(wxFileName(m_rootUri, ""))); }
+
+    // We only announce what we actually use: document synchronization (with save notifications)
+    JSONItem capabilities = JSONItem::createObject("capabilities");
+    JSONItem textDocument = JSONItem::createObject("textDocument");
+    JSONItem synchronization = JSONItem::createObject("synchronization");
+    synchronization.addProperty("dynamicRegistration", false);
+    synchronization.addProperty("didSave", true);
+    textDocument.append(synchronization);
+    capabilities.append(textDocument);
+    json.append(capabilities);
+    return json;
+}
+
 //===----------------------------------------------------------------------------------
 // DidChangeTextDocumentParams
 //===----------------------------------------------------------------------------------
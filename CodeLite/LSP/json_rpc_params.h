@@ -23,6 +23,27 @@ public:
     template <typename T> T* As() const { return dynamic_cast<T*>(const_cast<Params*>(this)); }
 };
 
+//===----------------------------------------------------------------------------------
+// InitializeParams
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL InitializeParams : public Params
+{
+    int m_processId = wxNOT_FOUND;
+    wxString m_rootUri;
+
+public:
+    InitializeParams();
+    virtual ~InitializeParams() {}
+
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    void SetProcessId(int processId) { this->m_processId = processId; }
+    void SetRootUri(const wxString& rootUri) { this->m_rootUri = rootUri; }
+    int GetProcessId() const { return m_processId; }
+    const wxString& GetRootUri() const { return m_rootUri; }
+};
+
 //===----------------------------------------------------------------------------------
 // TextDocumentPositionParams
 //===----------------------------------------------------------------------------------
@@ -44,6 +65,60 @@ public:
     const TextDocumentIdentifier& GetTextDocument() const { return m_textDocument; }
 };
 
+//===----------------------------------------------------------------------------------
+// ReferenceParams
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL ReferenceParams : public TextDocumentPositionParams
+{
+    bool m_includeDeclaration = true;
+
+public:
+    ReferenceParams() {}
+    virtual ~ReferenceParams() {}
+
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    void SetIncludeDeclaration(bool includeDeclaration) { this->m_includeDeclaration = includeDeclaration; }
+    bool IsIncludeDeclaration() const { return m_includeDeclaration; }
+};
+
+//===----------------------------------------------------------------------------------
+// DocumentSymbolParams
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL DocumentSymbolParams : public Params
+{
+    TextDocumentIdentifier m_textDocument;
+
+public:
+    DocumentSymbolParams() {}
+    virtual ~DocumentSymbolParams() {}
+
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    void SetTextDocument(const TextDocumentIdentifier& textDocument) { this->m_textDocument = textDocument; }
+    const TextDocumentIdentifier& GetTextDocument() const { return m_textDocument; }
+};
+
+//===----------------------------------------------------------------------------------
+// CancelParams
+//===----------------------------------------------------------------------------------
+class WXDLLIMPEXP_CL CancelParams : public Params
+{
+    int m_id = wxNOT_FOUND;
+
+public:
+    CancelParams() {}
+    virtual ~CancelParams() {}
+
+    virtual void FromJSON(const JSONItem& json);
+    virtual JSONItem ToJSON(const wxString& name) const;
+
+    void SetId(int id) { this->m_id = id; }
+    int GetId() const { return m_id; }
+};
+
 //===----------------------------------------------------------------------------------
 // DidOpenTextDocumentParams
 //===----------------------------------------------------------------------------------
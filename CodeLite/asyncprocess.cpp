@@ -25,6 +25,8 @@
 
 class wxEvtHandler;
 class IProcess;
+#include "cl_command_event.h"
+#include "processreaderthread.h"
 #include <wx/string.h>
 
 #ifdef __WXMSW__
@@ -80,6 +82,62 @@ void IProcess::SetProcessExitCode(int pid, int exitCode)
     wxUnusedVar(exitCode);
 }
 
+void IProcess::PostOutput(const char* data, size_t len, bool isStderr)
+{
+    // Nobody is listening (e.g. the process was detached). The callback only receives the stdout output
+    if(len == 0 || (!m_callback && !m_parent)) { return; }
+    if(m_callback && isStderr) { return; }
+
+    clProcessOutputChannel::eStream stream =
+        isStderr ? clProcessOutputChannel::kStderr : clProcessOutputChannel::kStdout;
+    if(!m_outputChannel->Push(stream, data, len)) {
+        // Merged into the output that is already waiting for the main thread
+        return;
+    }
+    DoNotifyOutput(stream);
+}
+
+void IProcess::FlushOutput()
+{
+    if(!m_callback && !m_parent) { return; }
+    if(m_outputChannel->Close(clProcessOutputChannel::kStdout)) { DoNotifyOutput(clProcessOutputChannel::kStdout); }
+    if(!m_callback && m_outputChannel->Close(clProcessOutputChannel::kStderr)) {
+        DoNotifyOutput(clProcessOutputChannel::kStderr);
+    }
+}
+
+void IProcess::DoNotifyOutput(clProcessOutputChannel::eStream stream)
+{
+    // The bytes are taken from the channel only when the main thread handles the notification, so everything that
+    // is read until then is delivered with it
+    clProcessOutputChannel::Ptr_t channel = m_outputChannel;
+    if(m_callback) {
+        IProcessCallback* callback = m_callback;
+        m_callback->CallAfter([=]() {
+            wxString output = channel->TakeString(stream);
+            if(!output.IsEmpty()) { callback->OnProcessOutput(output); }
+        });
+
+    } else {
+        bool isStderr = (stream == clProcessOutputChannel::kStderr);
+        clProcessEvent* event = new clProcessEvent(isStderr ? wxEVT_ASYNC_PROCESS_STDERR : wxEVT_ASYNC_PROCESS_OUTPUT);
+        event->SetProcess(this);
+        event->SetOutputChannel(channel, stream);
+        m_parent->QueueEvent(event);
+    }
+}
+
+bool IProcess::ReadBytes(std::string& buff, std::string& buffErr)
+{
+    wxString out, err;
+    bool res = Read(out, err);
+    const wxCharBuffer outBuffer = out.mb_str(wxConvUTF8);
+    const wxCharBuffer errBuffer = err.mb_str(wxConvUTF8);
+    buff.assign(outBuffer.data(), outBuffer.length());
+    buffErr.assign(errBuffer.data(), errBuffer.length());
+    return res;
+}
+
 void IProcess::WaitForTerminate(wxString& output)
 {
     if(IsRedirect()) {
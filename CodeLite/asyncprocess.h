@@ -26,8 +26,10 @@
 #ifndef I_PROCESS_H
 #define I_PROCESS_H
 
+#include "clProcessOutputChannel.h"
 #include "codelite_exports.h"
 #include <map>
+#include <string>
 #include <wx/event.h>
 #include <wx/sharedptr.h>
 #include <wx/string.h>
@@ -66,6 +68,7 @@ protected:
     bool m_hardKill;
     IProcessCallback* m_callback;
     size_t m_flags; // The creation flags
+    clProcessOutputChannel::Ptr_t m_outputChannel;
 
 public:
     typedef wxSharedPtr<IProcess> Ptr_t;
@@ -77,6 +80,7 @@ public:
         , m_hardKill(false)
         , m_callback(NULL)
         , m_flags(0)
+        , m_outputChannel(new clProcessOutputChannel())
     {
     }
     virtual ~IProcess() {}
@@ -96,6 +100,12 @@ public:
     // Read from process stdout - return immediately if no data is available
     virtual bool Read(wxString& buff, wxString& buffErr) = 0;
 
+    /**
+     * @brief same as Read(), but return the bytes as the process wrote them, without decoding them.
+     * The default implementation encodes the output of Read() as UTF-8
+     */
+    virtual bool ReadBytes(std::string& buff, std::string& buffErr);
+
     // Write to the process stdin
     virtual bool Write(const wxString& buff) = 0;
 
@@ -131,10 +141,37 @@ public:
     bool GetHardKill() const { return m_hardKill; }
     IProcessCallback* GetCallback() { return m_callback; }
 
+    /**
+     * @brief the channel that carries the process output to the main thread. Reader threads should stop reading
+     * while it is full
+     */
+    clProcessOutputChannel::Ptr_t GetOutputChannel() const { return m_outputChannel; }
+
+    /**
+     * @brief output traffic statistics (bytes/events per second etc), for diagnosis
+     */
+    clProcessOutputChannel::Statistics GetOutputStatistics() const { return m_outputChannel->GetStatistics(); }
+
+    /**
+     * @brief deliver bytes read from the process to the callback (stdout only) or to the parent, as
+     * a wxEVT_ASYNC_PROCESS_OUTPUT/STDERR event. Called from the reader thread. The bytes go through the
+     * output channel, so chunks read while the main thread is busy are coalesced into a single event
+     */
+    void PostOutput(const char* data, size_t len, bool isStderr);
+
+    /**
+     * @brief the process ended: deliver the bytes that are still held in the output channel (e.g. the start of
+     * a character that was never completed). Called from the reader thread before the termination is notified
+     */
+    void FlushOutput();
+
     /**
      * @brief do we have process redirect enabled?
      */
     bool IsRedirect() const { return !(m_flags & IProcessNoRedirect); }
+
+protected:
+    void DoNotifyOutput(clProcessOutputChannel::eStream stream);
 };
 
 // Help method
@@ -1,7 +1,18 @@
 #include "clFileSystemWatcher.h"
+#include "file_logger.h"
+#include "fileutils.h"
 #include <algorithm>
+#include <chrono>
 #include <set>
-#include "fileutils.h"
+#include <vector>
+
+#if CL_FSW_USE_INOTIFY
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 wxDEFINE_EVENT(wxEVT_FILE_MODIFIED, clFileSystemEvent);
 wxDEFINE_EVENT(wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
@@ -9,171 +20,404 @@ wxDEFINE_EVENT(wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
 // In milliseconds
 #define FILE_CHECK_INTERVAL 500
 
+// Changes are reported once no new change arrived for this period (in milliseconds)
+#define FSW_COALESCE_INTERVAL 50
+
+// But they are never held longer than this (in milliseconds)
+#define FSW_MAX_LATENCY 250
+
+#define FSW_INOTIFY_MASK \
+    (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR)
+
 clFileSystemWatcher::clFileSystemWatcher()
     : m_owner(NULL)
-#if CL_FSW_USE_TIMER
-    , m_timer(NULL)
-#endif
+    , m_running(false)
 {
-#if CL_FSW_USE_TIMER
-    Bind(wxEVT_TIMER, &clFileSystemWatcher::OnTimer, this);
-#else
-    m_watcher.SetOwner(this);
-    Bind(wxEVT_FSWATCHER, &clFileSystemWatcher::OnFileModified, this);
-#endif
 }
 
-clFileSystemWatcher::~clFileSystemWatcher()
-{
-#if CL_FSW_USE_TIMER
-    Stop();
-    Unbind(wxEVT_TIMER, &clFileSystemWatcher::OnTimer, this);
-#else
-    m_watcher.RemoveAll();
-    Unbind(wxEVT_FSWATCHER, &clFileSystemWatcher::OnFileModified, this);
-#endif
-}
+clFileSystemWatcher::~clFileSystemWatcher() { Stop(); }
 
 void clFileSystemWatcher::SetFile(const wxFileName& filename)
 {
-#if CL_FSW_USE_TIMER
     if(filename.Exists()) {
         m_files.clear();
         File f;
         f.filename = filename;
+        // A write through a symbolic link changes the target, which may live in another folder
+        wxString realPath = FileUtils::RealPath(filename.GetFullPath());
+        if(realPath != filename.GetFullPath()) { f.target = realPath; }
         f.lastModified = FileUtils::GetFileModificationTime(filename);
         f.file_size = FileUtils::GetFileSize(filename);
         m_files.insert(std::make_pair(filename.GetFullPath(), f));
     }
-#else
-    m_watcher.RemoveAll();
-    wxFileName dironly = filename;
-    dironly.SetFullName(""); // must be directory only
-    m_watcher.Add(dironly);
-    m_watchedFile = filename; // but we keep the file name for later usage
-#endif
+    if(m_running) { clFileSystemWatcherService::Get().Watch(this); }
 }
 
 void clFileSystemWatcher::Start()
 {
-#if CL_FSW_USE_TIMER
-    Stop();
-
-    m_timer = new wxTimer(this);
-    m_timer->Start(FILE_CHECK_INTERVAL, true);
-#else
-#endif
+    m_running = true;
+    clFileSystemWatcherService::Get().Watch(this);
 }
 
 void clFileSystemWatcher::Stop()
 {
-#if CL_FSW_USE_TIMER
-    if(m_timer) {
-        m_timer->Stop();
-    }
-    wxDELETE(m_timer);
-#else
-    m_watcher.RemoveAll();
-#endif
+    if(!m_running) { return; }
+    m_running = false;
+    clFileSystemWatcherService::Get().Unwatch(this);
 }
 
 void clFileSystemWatcher::Clear()
 {
-#if CL_FSW_USE_TIMER
     Stop();
     m_files.clear();
-#else
-    m_watcher.RemoveAll();
-#endif
 }
 
-#if CL_FSW_USE_TIMER
-void clFileSystemWatcher::OnTimer(wxTimerEvent& event)
+void clFileSystemWatcher::RemoveFile(const wxFileName& filename)
 {
-    std::set<wxString> nonExistingFiles;
-    std::for_each(m_files.begin(), m_files.end(), [&](const std::pair<wxString, clFileSystemWatcher::File>& p) {
-        const File& f = p.second;
-        const wxFileName& fn = f.filename;
-        if(!fn.Exists()) {
-
-            // fire file not found event
-            if(GetOwner()) {
-                clFileSystemEvent evt(wxEVT_FILE_NOT_FOUND);
-                evt.SetPath(fn.GetFullPath());
-                GetOwner()->AddPendingEvent(evt);
-            }
+    if(m_files.count(filename.GetFullPath())) {
+        m_files.erase(filename.GetFullPath());
+        if(m_running) { clFileSystemWatcherService::Get().Watch(this); }
+    }
+}
+
+bool clFileSystemWatcher::IsRunning() const { return m_running; }
+
+//===------------------------------------------------------------
+// The watcher service
+//===------------------------------------------------------------
 
-            // add the missing file to a set
-            nonExistingFiles.insert(fn.GetFullPath());
+clFileSystemWatcherService::clFileSystemWatcherService()
+    : m_timer(NULL)
+    , m_inotifyFd(wxNOT_FOUND)
+    , m_reader(NULL)
+    , m_overflow(false)
+{
+    m_wakeupPipe[0] = m_wakeupPipe[1] = wxNOT_FOUND;
+    Bind(wxEVT_TIMER, &clFileSystemWatcherService::OnTimer, this);
+}
+
+clFileSystemWatcherService::~clFileSystemWatcherService()
+{
+    DoStopInotify();
+    if(m_timer) { m_timer->Stop(); }
+    wxDELETE(m_timer);
+    Unbind(wxEVT_TIMER, &clFileSystemWatcherService::OnTimer, this);
+}
+
+clFileSystemWatcherService& clFileSystemWatcherService::Get()
+{
+    static clFileSystemWatcherService service;
+    return service;
+}
+
+void clFileSystemWatcherService::Watch(clFileSystemWatcher* watcher)
+{
+    bool first = m_watchers.empty();
+    m_watchers.insert(watcher);
+    if(first) {
+        if(DoStartInotify()) {
+            clDEBUG() << "File system watcher: using inotify" << clEndl;
         } else {
-            
-#ifdef __WXMSW__
-            size_t prev_value = f.file_size;
-            size_t curr_value = FileUtils::GetFileSize(fn);
-#else
-            time_t prev_value = f.lastModified;
-            time_t curr_value = FileUtils::GetFileModificationTime(fn);
-#endif
+            clDEBUG() << "File system watcher: polling every" << FILE_CHECK_INTERVAL << "ms" << clEndl;
+            m_timer = new wxTimer(this);
+            m_timer->Start(FILE_CHECK_INTERVAL, true);
+        }
+    }
+
+    if(IsEventDriven()) {
+        DoSyncWatches();
+    } else {
+        DoSyncPolled();
+    }
+}
+
+void clFileSystemWatcherService::Unwatch(clFileSystemWatcher* watcher)
+{
+    m_watchers.erase(watcher);
+    if(m_watchers.empty()) {
+        // Nothing to watch: release the system resources
+        DoStopInotify();
+        if(m_timer) { m_timer->Stop(); }
+        wxDELETE(m_timer);
+        m_polled.clear();
+
+    } else if(IsEventDriven()) {
+        DoSyncWatches();
+    } else {
+        DoSyncPolled();
+    }
+}
+
+void clFileSystemWatcherService::DoNotify(const wxString& path, bool exists)
+{
+    // Copy the list, an owner might stop its watcher while we are here
+    std::vector<clFileSystemWatcher*> watchers(m_watchers.begin(), m_watchers.end());
+    for(size_t i = 0; i < watchers.size(); ++i) {
+        clFileSystemWatcher* watcher = watchers[i];
+        if(watcher->m_files.count(path) == 0) { continue; }
+        // a removed file is no longer watched
+        if(!exists) { watcher->m_files.erase(path); }
+
+        if(watcher->GetOwner()) {
+            clFileSystemEvent evt(exists ? wxEVT_FILE_MODIFIED : wxEVT_FILE_NOT_FOUND);
+            evt.SetPath(path);
+            watcher->GetOwner()->AddPendingEvent(evt);
+        }
+    }
+}
+
+//===------------------------------------------------------------
+// Polling backend
+//===------------------------------------------------------------
+
+void clFileSystemWatcherService::DoSyncPolled()
+{
+    // Collect the paths to poll, keeping the state of the ones we already know
+    std::map<wxString, clFileSystemWatcher::File> polled;
+    std::for_each(m_watchers.begin(), m_watchers.end(), [&](clFileSystemWatcher* watcher) {
+        std::for_each(watcher->m_files.begin(), watcher->m_files.end(),
+                      [&](const std::pair<wxString, clFileSystemWatcher::File>& p) { polled.insert(p); });
+    });
+
+    std::for_each(polled.begin(), polled.end(), [&](std::pair<const wxString, clFileSystemWatcher::File>& p) {
+        if(m_polled.count(p.first)) { p.second = m_polled[p.first]; }
+    });
+    m_polled.swap(polled);
+}
+
+void clFileSystemWatcherService::DoPoll()
+{
+    std::vector<std::pair<wxString, bool> > changes;
+    std::set<wxString> nonExistingFiles;
+    std::for_each(m_polled.begin(), m_polled.end(), [&](std::pair<const wxString, clFileSystemWatcher::File>& p) {
+        clFileSystemWatcher::File& f = p.second;
+        if(!wxFileName::Exists(p.first)) {
+            changes.push_back(std::make_pair(p.first, false));
+            nonExistingFiles.insert(p.first);
+            return;
+        }
 
-            if(prev_value != curr_value) {
-                // Fire a modified event
-                if(GetOwner()) {
-                    clFileSystemEvent evt(wxEVT_FILE_MODIFIED);
-                    evt.SetPath(fn.GetFullPath());
-                    GetOwner()->AddPendingEvent(evt);
-                }
-            }
 #ifdef __WXMSW__
-            File updatdFile = f;
-            updatdFile.file_size = curr_value;
+        size_t curr_value = FileUtils::GetFileSize(f.filename);
+        if(curr_value != f.file_size) { changes.push_back(std::make_pair(p.first, true)); }
+        f.file_size = curr_value;
 #else
-            // Always update the last modified timestamp
-            File updatdFile = f;
-            updatdFile.lastModified = curr_value;
+        time_t curr_value = FileUtils::GetFileModificationTime(p.first);
+        if(curr_value != f.lastModified) { changes.push_back(std::make_pair(p.first, true)); }
+        // Always update the last modified timestamp
+        f.lastModified = curr_value;
 #endif
-            m_files[fn.GetFullPath()] = updatdFile;
-        }
     });
 
     // Remove the non existing files
-    std::for_each(nonExistingFiles.begin(), nonExistingFiles.end(), [&](const wxString& fn) { m_files.erase(fn); });
+    std::for_each(nonExistingFiles.begin(), nonExistingFiles.end(), [&](const wxString& fn) { m_polled.erase(fn); });
 
-    if(m_timer) {
-        m_timer->Start(FILE_CHECK_INTERVAL, true);
+    for(size_t i = 0; i < changes.size(); ++i) {
+        DoNotify(changes[i].first, changes[i].second);
     }
 }
+
+void clFileSystemWatcherService::OnTimer(wxTimerEvent& event)
+{
+    DoPoll();
+    if(m_timer) { m_timer->Start(FILE_CHECK_INTERVAL, true); }
+}
+
+//===------------------------------------------------------------
+// inotify backend
+//===------------------------------------------------------------
+
+bool clFileSystemWatcherService::DoStartInotify()
+{
+#if CL_FSW_USE_INOTIFY
+    if(m_inotifyFd != wxNOT_FOUND) { return true; }
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0) {
+        clWARNING() << "File system watcher: inotify is not available:" << strerror(errno) << clEndl;
+        return false;
+    }
+
+    if(pipe(m_wakeupPipe) != 0) {
+        close(fd);
+        return false;
+    }
+
+    m_inotifyFd = fd;
+    m_overflow = false;
+    m_reader = new std::thread(&clFileSystemWatcherService::ReaderMain, this);
+    return true;
+#else
+    return false;
 #endif
+}
 
-#if !CL_FSW_USE_TIMER
-void clFileSystemWatcher::OnFileModified(wxFileSystemWatcherEvent& event)
+void clFileSystemWatcherService::DoStopInotify()
 {
-    if(event.GetChangeType() == wxFSW_EVENT_MODIFY) {
-        const wxFileName& modpath = event.GetPath();
-        if(modpath == m_watchedFile) {
-            if(GetOwner()) {
-                clFileSystemEvent evt(wxEVT_FILE_MODIFIED);
-                evt.SetPath(modpath.GetFullPath());
-                GetOwner()->AddPendingEvent(evt);
-            }
+#if CL_FSW_USE_INOTIFY
+    if(m_inotifyFd == wxNOT_FOUND) { return; }
+    if(m_reader) {
+        // wake the reader and wait for it
+        char c = 'x';
+        if(write(m_wakeupPipe[1], &c, 1) != 1) {
+            clWARNING() << "File system watcher: failed to wake the reader thread" << clEndl;
         }
+        m_reader->join();
+        wxDELETE(m_reader);
     }
+    close(m_wakeupPipe[0]);
+    close(m_wakeupPipe[1]);
+    close(m_inotifyFd);
+    m_wakeupPipe[0] = m_wakeupPipe[1] = wxNOT_FOUND;
+    m_inotifyFd = wxNOT_FOUND;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_wdToPath.clear();
+    m_pathToWd.clear();
+    m_changes.clear();
+#endif
 }
+
+void clFileSystemWatcherService::DoAddWatch(const wxString& folder)
+{
+#if CL_FSW_USE_INOTIFY
+    if(m_pathToWd.count(folder)) { return; }
+    int wd = inotify_add_watch(m_inotifyFd, folder.mb_str(wxConvUTF8).data(), FSW_INOTIFY_MASK);
+    if(wd < 0) {
+        clDEBUG1() << "File system watcher: can not watch" << folder << ":" << strerror(errno) << clEndl;
+        return;
+    }
+    m_pathToWd[folder] = wd;
+    m_wdToPath[wd] = folder;
+#else
+    wxUnusedVar(folder);
 #endif
+}
 
-void clFileSystemWatcher::RemoveFile(const wxFileName& filename)
+void clFileSystemWatcherService::DoSyncWatches()
 {
-#if CL_FSW_USE_TIMER
-    if(m_files.count(filename.GetFullPath())) {
-        m_files.erase(filename.GetFullPath());
+#if CL_FSW_USE_INOTIFY
+    // The folders we need: the parent folder of every watched file (watching the folder and not the file itself
+    // lets us catch editors that save by replacing the file) and, for a symbolic link, the folder of its target
+    std::set<wxString> folders;
+    std::for_each(m_watchers.begin(), m_watchers.end(), [&](clFileSystemWatcher* watcher) {
+        std::for_each(watcher->m_files.begin(), watcher->m_files.end(),
+                      [&](const std::pair<wxString, clFileSystemWatcher::File>& p) {
+                          folders.insert(p.second.filename.GetPath());
+                          if(!p.second.target.IsEmpty()) { folders.insert(wxFileName(p.second.target).GetPath()); }
+                      });
+    });
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+
+    // Remove the watches we no longer need
+    std::vector<wxString> stale;
+    std::for_each(m_pathToWd.begin(), m_pathToWd.end(), [&](const std::pair<wxString, int>& p) {
+        if(folders.count(p.first) == 0) { stale.push_back(p.first); }
+    });
+    for(size_t i = 0; i < stale.size(); ++i) {
+        int wd = m_pathToWd[stale[i]];
+        inotify_rm_watch(m_inotifyFd, wd);
+        m_pathToWd.erase(stale[i]);
+        m_wdToPath.erase(wd);
     }
+
+    // And add the new ones
+    std::for_each(folders.begin(), folders.end(), [&](const wxString& folder) { DoAddWatch(folder); });
+    clDEBUG1() << "File system watcher: watching" << m_pathToWd.size() << "folders" << clEndl;
 #endif
 }
 
-bool clFileSystemWatcher::IsRunning() const
+void clFileSystemWatcherService::ReaderMain()
 {
-#if CL_FSW_USE_TIMER
-    return m_timer;
-#else
-    return m_watcher.GetWatchedPathsCount();
+#if CL_FSW_USE_INOTIFY
+    typedef std::chrono::steady_clock Clock_t;
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool hasChanges = false;
+    Clock_t::time_point firstChange;
+    while(true) {
+        // Once we have something to report, wait a little for more changes (e.g. a file that is written in chunks)
+        int timeout = -1;
+        if(hasChanges) {
+            long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock_t::now() - firstChange).count();
+            timeout = (int)std::max(0L, std::min((long)FSW_COALESCE_INTERVAL, FSW_MAX_LATENCY - elapsed));
+        }
+
+        struct pollfd fds[2];
+        fds[0].fd = m_inotifyFd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = m_wakeupPipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        int rc = poll(fds, 2, timeout);
+        if(rc < 0 && errno == EINTR) { continue; }
+        if(rc < 0 || fds[1].revents) { break; }
+
+        if(rc > 0 && (fds[0].revents & POLLIN)) {
+            ssize_t len = read(m_inotifyFd, buffer, sizeof(buffer));
+            std::lock_guard<std::mutex> lk(m_mutex);
+            for(char* ptr = buffer; len > 0 && ptr < buffer + len;) {
+                const struct inotify_event* event = (const struct inotify_event*)ptr;
+                ptr += sizeof(struct inotify_event) + event->len;
+
+                if(event->mask & IN_Q_OVERFLOW) {
+                    // the kernel dropped events, re-check everything
+                    m_overflow = true;
+                    continue;
+                }
+
+                std::map<int, wxString>::iterator iter = m_wdToPath.find(event->wd);
+                if(iter == m_wdToPath.end()) { continue; }
+                if(event->mask & IN_IGNORED) {
+                    // the folder was removed
+                    m_pathToWd.erase(iter->second);
+                    m_wdToPath.erase(iter);
+                    continue;
+                }
+                if(event->len == 0) { continue; }
+
+                m_changes.insert(iter->second + "/" + wxString(event->name, wxConvUTF8));
+            }
+
+            if(!hasChanges && (!m_changes.empty() || m_overflow)) {
+                hasChanges = true;
+                firstChange = Clock_t::now();
+            }
+        }
+
+        if(!hasChanges) { continue; }
+        long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock_t::now() - firstChange).count();
+        if(rc == 0 || elapsed >= FSW_MAX_LATENCY) {
+            hasChanges = false;
+            CallAfter(&clFileSystemWatcherService::DoDispatchChanges);
+        }
+    }
 #endif
 }
+
+void clFileSystemWatcherService::DoDispatchChanges()
+{
+    std::set<wxString> changes;
+    bool overflow = false;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        changes.swap(m_changes);
+        std::swap(overflow, m_overflow);
+    }
+
+    // A change to the target of a symbolic link is reported with the path of the link
+    std::set<wxString> linkChanges;
+    std::for_each(m_watchers.begin(), m_watchers.end(), [&](clFileSystemWatcher* watcher) {
+        std::for_each(watcher->m_files.begin(), watcher->m_files.end(),
+                      [&](const std::pair<wxString, clFileSystemWatcher::File>& p) {
+                          // We don't know what was changed when the queue overflowed: report all the watched files
+                          if(overflow || (!p.second.target.IsEmpty() && changes.count(p.second.target))) {
+                              linkChanges.insert(p.first);
+                          }
+                      });
+    });
+    changes.insert(linkChanges.begin(), linkChanges.end());
+
+    std::for_each(changes.begin(), changes.end(),
+                  [&](const wxString& path) { DoNotify(path, wxFileName::Exists(path)); });
+}
@@ -4,17 +4,16 @@
 #include "codelite_exports.h"
 #include "clFileSystemEvent.h"
 #include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <wx/timer.h>
 #include <wx/filename.h>
 
-#ifdef __WXMSW__
-#define CL_FSW_USE_TIMER 1
+#if defined(__linux__)
+#define CL_FSW_USE_INOTIFY 1
 #else
-#define CL_FSW_USE_TIMER 1
-#endif
-
-#if !CL_FSW_USE_TIMER
-#include <wx/fswatcher.h>
+#define CL_FSW_USE_INOTIFY 0
 #endif
 
 class WXDLLIMPEXP_CL clFileSystemWatcher : public wxEvtHandler
@@ -22,30 +21,19 @@ class WXDLLIMPEXP_CL clFileSystemWatcher : public wxEvtHandler
 public:
     struct File {
         wxFileName filename;
+        wxString target; // the resolved path, when the file is reached through a symbolic link
         time_t lastModified;
         size_t file_size;
         typedef std::map<wxString, File> Map_t;
     };
 
     wxEvtHandler* m_owner;
-#if CL_FSW_USE_TIMER
     clFileSystemWatcher::File::Map_t m_files;
-    wxTimer* m_timer;
-#else
-    wxFileSystemWatcher m_watcher;
-    wxFileName m_watchedFile;
-#endif
+    bool m_running;
 
 public:
     typedef wxSharedPtr<clFileSystemWatcher> Ptr_t;
 
-protected:
-#if CL_FSW_USE_TIMER
-    void OnTimer(wxTimerEvent& event);
-#else
-    void OnFileModified(wxFileSystemWatcherEvent& event);
-#endif
-
 public:
     clFileSystemWatcher();
     virtual ~clFileSystemWatcher();
@@ -66,7 +54,7 @@ public:
     /**
      * @brief start to watching list of files.
      * This object fires the following events (clFileSystemEvent):
-     * wxEVT_FILE_MODIFIED, wxEVT_FILE_DELETED
+     * wxEVT_FILE_MODIFIED, wxEVT_FILE_NOT_FOUND
      */
     void Start();
 
@@ -86,6 +74,74 @@ public:
     bool IsRunning() const;
 };
 
+/**
+ * @class clFileSystemWatcherService
+ * @brief the process wide file system watcher. All the running clFileSystemWatcher objects register their files
+ * here.
+ * On Linux, the service uses inotify: a single thread reads the change notifications of all the watched folders,
+ * coalesces them and delivers the changes to the watchers on the main thread. Where inotify is not available,
+ * the service polls the watched paths with a single timer
+ */
+class WXDLLIMPEXP_CL clFileSystemWatcherService : public wxEvtHandler
+{
+    std::set<clFileSystemWatcher*> m_watchers;
+
+    // polling backend
+    wxTimer* m_timer;
+    std::map<wxString, clFileSystemWatcher::File> m_polled;
+
+    // inotify backend
+    int m_inotifyFd;
+    int m_wakeupPipe[2];
+    std::thread* m_reader;
+    std::mutex m_mutex;
+    std::map<int, wxString> m_wdToPath; // protected by m_mutex
+    std::map<wxString, int> m_pathToWd; // protected by m_mutex
+    std::set<wxString> m_changes;       // protected by m_mutex
+    bool m_overflow;                    // protected by m_mutex
+
+protected:
+    clFileSystemWatcherService();
+    virtual ~clFileSystemWatcherService();
+
+    void OnTimer(wxTimerEvent& event);
+    void DoPoll();
+    void DoSyncPolled();
+
+    bool DoStartInotify();
+    void DoStopInotify();
+    void DoSyncWatches();
+    /**
+     * @brief add an inotify watch for 'folder'. Must be called with m_mutex locked
+     */
+    void DoAddWatch(const wxString& folder);
+    void ReaderMain();
+
+    /**
+     * @brief deliver the collected changes to the watchers (main thread)
+     */
+    void DoDispatchChanges();
+    void DoNotify(const wxString& path, bool exists);
+
+public:
+    static clFileSystemWatcherService& Get();
+
+    /**
+     * @brief register (or update the watched paths of) a running watcher
+     */
+    void Watch(clFileSystemWatcher* watcher);
+
+    /**
+     * @brief unregister a watcher
+     */
+    void Unwatch(clFileSystemWatcher* watcher);
+
+    /**
+     * @brief are we notified by the system (true) or do we poll the watched paths (false)?
+     */
+    bool IsEventDriven() const { return m_inotifyFd != wxNOT_FOUND; }
+};
+
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_MODIFIED, clFileSystemEvent);
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
 
@@ -1,17 +1,358 @@
 #include "clFilesCollector.h"
 #include "file_logger.h"
 #include "fileutils.h"
-#include <queue>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 #include <wx/dir.h>
 #include <wx/filename.h>
+#include <wx/thread.h>
 #include <wx/tokenzr.h>
 
+#ifndef __WXMSW__
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+// Number of files collected by a scanner thread before they are added to the output
+#define SCANNER_BATCH_SIZE 256
+
+clWildMasks::clWildMasks(const wxString& spec)
+{
+    wxArrayString masks = ::wxStringTokenize(spec.Lower(), ";,|", wxTOKEN_STRTOK);
+    for(size_t i = 0; i < masks.size(); ++i) {
+        const wxString& mask = masks.Item(i);
+        if(mask == "*") {
+            m_matchAll = true;
+        } else if(!mask.Contains("*")) {
+            m_exact.insert(mask);
+        } else if(mask.StartsWith("*") && mask.find_first_of("*?[", 1) == wxString::npos) {
+            m_suffixes.push_back(mask.Mid(1));
+        } else {
+            m_wild.push_back(mask);
+        }
+    }
+}
+
+bool clWildMasks::Matches(const wxString& name) const
+{
+    if(m_matchAll) { return true; }
+    if(m_exact.count(name)) { return true; }
+    for(const wxString& suffix : m_suffixes) {
+        if(name.length() >= suffix.length() &&
+           name.compare(name.length() - suffix.length(), suffix.length(), suffix) == 0) {
+            return true;
+        }
+    }
+    for(const wxString& mask : m_wild) {
+        if(::wxMatchWild(mask, name)) { return true; }
+    }
+    return false;
+}
+
+/**
+ * @brief match a path against an anchored pattern, one folder at a time: '*' never crosses a '/' while a "**"
+ * segment matches any number of folders
+ */
+static bool MatchSegments(const wxArrayString& pattern, size_t p, const wxArrayString& path, size_t n)
+{
+    for(; p < pattern.size(); ++p, ++n) {
+        if(pattern.Item(p) == "**") {
+            // A trailing "**" matches everything inside the folder, but not the folder itself
+            size_t first = (p + 1 == pattern.size()) ? n + 1 : n;
+            for(size_t k = first; k <= path.size(); ++k) {
+                if(MatchSegments(pattern, p + 1, path, k)) { return true; }
+            }
+            return false;
+        }
+        if(n >= path.size() || !::wxMatchWild(pattern.Item(p), path.Item(n), false)) { return false; }
+    }
+    return n == path.size();
+}
+
+clGitIgnoreRules::Ptr_t clGitIgnoreRules::Load(const wxString& folder, Ptr_t parent)
+{
+    wxFileName fn(folder, ".gitignore");
+    wxString content;
+    if(!fn.FileExists() || !FileUtils::ReadFileContent(fn, content)) { return parent; }
+    return Parse(fn.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR), content, parent);
+}
+
+clGitIgnoreRules::Ptr_t clGitIgnoreRules::Parse(const wxString& folder, const wxString& content, Ptr_t parent)
+{
+    Ptr_t rules(new clGitIgnoreRules());
+    rules->m_folder = folder;
+    rules->m_parent = parent;
+
+    wxArrayString lines = ::wxStringTokenize(content, "\r\n", wxTOKEN_STRTOK);
+    for(size_t i = 0; i < lines.size(); ++i) {
+        wxString line = lines.Item(i);
+        line.Trim();
+        if(line.IsEmpty() || line.StartsWith("#")) { continue; }
+
+        Rule rule;
+        if(line.StartsWith("!")) {
+            rule.negate = true;
+            line.Remove(0, 1);
+        }
+        if(line.EndsWith("/")) {
+            rule.dirOnly = true;
+            line.RemoveLast();
+        }
+        // A pattern that contains a separator (a leading one included) is matched against the path relative to
+        // the .gitignore folder
+        rule.anchored = line.Contains("/");
+        if(line.StartsWith("/")) { line.Remove(0, 1); }
+        rule.pattern = line;
+        if(rule.anchored) { rule.segments = ::wxStringTokenize(line, "/", wxTOKEN_STRTOK); }
+        if(!rule.pattern.IsEmpty()) { rules->m_rules.push_back(rule); }
+    }
+    return rules;
+}
+
+bool clGitIgnoreRules::IsIgnored(const clGitIgnoreRules* rules, const wxString& fullpath, const wxString& name,
+                                 bool isDir)
+{
+    for(; rules; rules = rules->m_parent.get()) {
+        if(!fullpath.StartsWith(rules->m_folder)) { continue; }
+        wxArrayString relpath;
+        for(auto iter = rules->m_rules.rbegin(); iter != rules->m_rules.rend(); ++iter) {
+            const Rule& rule = *iter;
+            if(rule.dirOnly && !isDir) { continue; }
+            bool match = false;
+            if(rule.anchored) {
+                if(relpath.IsEmpty()) {
+                    wxString path = fullpath.Mid(rules->m_folder.length());
+                    path.Replace("\\", "/");
+                    relpath = ::wxStringTokenize(path, "/", wxTOKEN_STRTOK);
+                }
+                match = MatchSegments(rule.segments, 0, relpath, 0);
+            } else {
+                match = ::wxMatchWild(rule.pattern, name, false);
+            }
+            if(match) { return !rule.negate; }
+        }
+    }
+    return false;
+}
+
+struct clScanDirEntry {
+    wxString path;
+    clGitIgnoreRules::Ptr_t ignoreRules;
+};
+
+/**
+ * @brief the state shared by all the scanner threads
+ */
+struct clScannerContext {
+    clWildMasks spec;
+    clWildMasks excludeSpec;
+    const wxStringSet_t& excludeFolders;
+    size_t flags;
+
+    std::mutex queueLock;
+    std::condition_variable queueCond;
+    std::deque<clScanDirEntry> queue;
+    size_t busyWorkers = 0;
+
+    std::mutex outputLock;
+    std::vector<wxString>& output;
+
+    std::mutex visitedLock;
+    wxStringSet_t visitedLinks; // real path of the symlinked folders we already traversed
+
+    clScannerContext(const wxString& filespec, const wxString& excludeFilespec, const wxStringSet_t& exclude,
+                     size_t scanFlags, std::vector<wxString>& filesOutput)
+        : spec(filespec)
+        , excludeSpec(excludeFilespec)
+        , excludeFolders(exclude)
+        , flags(scanFlags)
+        , output(filesOutput)
+    {
+    }
+
+    void PushDir(const clScanDirEntry& entry)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            queue.push_back(entry);
+        }
+        queueCond.notify_one();
+    }
+
+    /**
+     * @brief pop the next folder to scan, blocks until one is available or the scan is completed
+     */
+    bool PopDir(clScanDirEntry& entry)
+    {
+        std::unique_lock<std::mutex> lock(queueLock);
+        queueCond.wait(lock, [&]() { return !queue.empty() || busyWorkers == 0; });
+        if(queue.empty()) {
+            // No more work
+            queueCond.notify_all();
+            return false;
+        }
+        entry = queue.front();
+        queue.pop_front();
+        ++busyWorkers;
+        return true;
+    }
+
+    void DirDone()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            --busyWorkers;
+        }
+        queueCond.notify_all();
+    }
+
+    void Flush(std::vector<wxString>& batch)
+    {
+        if(batch.empty()) { return; }
+        {
+            std::lock_guard<std::mutex> lock(outputLock);
+            output.insert(output.end(), batch.begin(), batch.end());
+        }
+        batch.clear();
+    }
+};
+
+static bool IsVcsFolder(const wxString& name)
+{
+    return name == ".git" || name == ".svn" || name == ".hg" || name == ".bzr";
+}
+
+/**
+ * @brief list the content of a folder. Uses the dirent type when available so no stat is needed per entry
+ */
+static void ListDir(const wxString& dirpath, std::vector<wxString>& files, std::vector<wxString>& folders,
+                    std::vector<wxString>& linkedFolders)
+{
+#ifdef __WXMSW__
+    wxDir dir(dirpath);
+    if(!dir.IsOpened()) { return; }
+    wxString filename;
+    bool cont = dir.GetFirst(&filename);
+    while(cont) {
+        wxString fullpath;
+        fullpath << dir.GetNameWithSep() << filename;
+        if(wxFileName::DirExists(fullpath)) {
+            folders.push_back(filename);
+        } else {
+            files.push_back(filename);
+        }
+        cont = dir.GetNext(&filename);
+    }
+#else
+    const wxCharBuffer cpath = dirpath.mb_str(wxConvUTF8);
+    DIR* dir = opendir(cpath.data());
+    if(!dir) { return; }
+
+    struct dirent* entry = nullptr;
+    while((entry = readdir(dir))) {
+        const char* cname = entry->d_name;
+        if(cname[0] == '.' && (cname[1] == 0 || (cname[1] == '.' && cname[2] == 0))) { continue; }
+
+        wxString name(cname, wxConvUTF8);
+        if(name.IsEmpty()) { name = wxString::From8BitData(cname); }
+
+        unsigned char type = DT_UNKNOWN;
+#ifdef _DIRENT_HAVE_D_TYPE
+        type = entry->d_type;
+#endif
+        if(type == DT_DIR) {
+            folders.push_back(name);
+        } else if(type == DT_REG) {
+            files.push_back(name);
+        } else if(type == DT_LNK || type == DT_UNKNOWN) {
+            // Only now we pay for a stat() (it follows symlinks)
+            wxString fullpath;
+            fullpath << dirpath << wxFILE_SEP_PATH << name;
+            struct stat st;
+            if(::stat(fullpath.mb_str(wxConvUTF8).data(), &st) != 0) { continue; }
+            if(S_ISDIR(st.st_mode) && (type == DT_LNK)) {
+                linkedFolders.push_back(name);
+            } else if(S_ISDIR(st.st_mode)) {
+                folders.push_back(name);
+            } else if(S_ISREG(st.st_mode)) {
+                files.push_back(name);
+            }
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+static void ScanWorker(clScannerContext& ctx)
+{
+    std::vector<wxString> batch;
+    std::vector<wxString> files, folders, linkedFolders;
+    clScanDirEntry dirEntry;
+    while(ctx.PopDir(dirEntry)) {
+        files.clear();
+        folders.clear();
+        linkedFolders.clear();
+
+        clGitIgnoreRules::Ptr_t ignoreRules = dirEntry.ignoreRules;
+        if(ctx.flags & clFilesScanner::kHonourGitIgnore) {
+            ignoreRules = clGitIgnoreRules::Load(dirEntry.path, ignoreRules);
+        }
+
+        ListDir(dirEntry.path, files, folders, linkedFolders);
+        wxString prefix = dirEntry.path;
+        if(!prefix.EndsWith(wxFILE_SEP_PATH)) { prefix << wxFILE_SEP_PATH; }
+
+        // Folders: prune before we descend
+        auto handleFolder = [&](const wxString& name, bool isLink) {
+            if((ctx.flags & clFilesScanner::kSkipVcsFolders) && IsVcsFolder(name)) { return; }
+            wxString fullpath = prefix + name;
+            if(ignoreRules && clGitIgnoreRules::IsIgnored(ignoreRules.get(), fullpath, name, true)) { return; }
+            if(isLink || !ctx.excludeFolders.empty()) {
+                // Use FileUtils::RealPath() here to cope with symlinks on Linux
+                wxString realPath = FileUtils::RealPath(fullpath);
+                if(ctx.excludeFolders.count(realPath)) { return; }
+                if(isLink) {
+                    // Protect ourselves against symlink loops
+                    std::lock_guard<std::mutex> lock(ctx.visitedLock);
+                    if(!ctx.visitedLinks.insert(realPath).second) { return; }
+                }
+            }
+            clScanDirEntry child;
+            child.path = fullpath;
+            child.ignoreRules = ignoreRules;
+            ctx.PushDir(child);
+        };
+        for(const wxString& name : folders) {
+            handleFolder(name, false);
+        }
+        for(const wxString& name : linkedFolders) {
+            handleFolder(name, true);
+        }
+
+        for(const wxString& name : files) {
+            wxString lcName = name.Lower();
+            if(ctx.excludeSpec.Matches(lcName) || !ctx.spec.Matches(lcName)) { continue; }
+            wxString fullpath = prefix + name;
+            if(ignoreRules && clGitIgnoreRules::IsIgnored(ignoreRules.get(), fullpath, name, false)) { continue; }
+            batch.push_back(fullpath);
+            if(batch.size() >= SCANNER_BATCH_SIZE) { ctx.Flush(batch); }
+        }
+        ctx.DirDone();
+    }
+    ctx.Flush(batch);
+}
 clFilesScanner::clFilesScanner() {}
 
 clFilesScanner::~clFilesScanner() {}
 
 size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& filesOutput, const wxString& filespec,
-                            const wxString& excludeFilespec, const wxStringSet_t& excludeFolders)
+                            const wxString& excludeFilespec, const wxStringSet_t& excludeFolders, size_t flags)
 {
     filesOutput.clear();
     if(!wxFileName::DirExists(rootFolder)) {
@@ -19,37 +360,27 @@ size_t clFilesScanner::Scan(const wxString& rootFolder, std::vector<wxString>& f
         return 0;
     }
 
-    wxArrayString specArr = ::wxStringTokenize(filespec.Lower(), ";,|", wxTOKEN_STRTOK);
-    wxArrayString excludeSpecArr = ::wxStringTokenize(excludeFilespec.Lower(), ";,|", wxTOKEN_STRTOK);
-    std::queue<wxString> Q;
-    Q.push(rootFolder);
+    clScannerContext ctx(filespec, excludeFilespec, excludeFolders, flags, filesOutput);
+    if(ctx.spec.IsEmpty()) { return 0; }
 
-    while(!Q.empty()) {
-        wxString dirpath = Q.front();
-        Q.pop();
+    clScanDirEntry root;
+    root.path = rootFolder;
+    ctx.queue.push_back(root);
 
-        wxDir dir(dirpath);
-        if(!dir.IsOpened()) { continue; }
+    // Directory listing is I/O bound, a handful of threads is enough to keep the disk busy
+    int cpus = wxThread::GetCPUCount();
+    size_t threadsCount = (cpus > 1) ? std::min((size_t)cpus, (size_t)8) : 2;
 
-        wxString filename;
-        bool cont = dir.GetFirst(&filename);
-        while(cont) {
-            // Check to see if this is a folder
-            wxString fullpath;
-            fullpath << dir.GetNameWithSep() << filename;
-            bool isDirectory = wxFileName::DirExists(fullpath);
-            // Use FileUtils::RealPath() here to cope with symlinks on Linux
-            if(isDirectory && (excludeFolders.count(FileUtils::RealPath(fullpath)) == 0)) {
-                // Traverse into this folder
-                Q.push(fullpath);
-            } else if(!isDirectory && FileUtils::WildMatch(excludeSpecArr, filename)) {
-                // Do nothing
-            } else if(!isDirectory && FileUtils::WildMatch(specArr, filename)) {
-                // Include this file
-                filesOutput.push_back(fullpath);
-            }
-            cont = dir.GetNext(&filename);
-        }
+    std::vector<std::thread> threads;
+    threads.reserve(threadsCount);
+    for(size_t i = 0; i < threadsCount; ++i) {
+        threads.emplace_back(&ScanWorker, std::ref(ctx));
     }
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+
+    // The threads finish the folders in any order
+    std::sort(filesOutput.begin(), filesOutput.end());
     return filesOutput.size();
-}
\ No newline at end of file
+}
@@ -3,25 +3,95 @@
 
 #include "codelite_exports.h"
 #include "macros.h"
+#include <memory>
 #include <vector>
+#include <wx/arrstr.h>
 #include <wx/string.h>
 
+/**
+ * @brief a pre-compiled list of wildcard masks (lower case)
+ */
+class WXDLLIMPEXP_CL clWildMasks
+{
+    bool m_matchAll = false;
+    wxStringSet_t m_exact;
+    std::vector<wxString> m_suffixes; // "*.cpp" -> ".cpp"
+    std::vector<wxString> m_wild;
+
+public:
+    clWildMasks(const wxString& spec);
+
+    bool IsEmpty() const { return !m_matchAll && m_exact.empty() && m_suffixes.empty() && m_wild.empty(); }
+
+    /**
+     * @brief match a file name, 'name' is expected to be lower case
+     */
+    bool Matches(const wxString& name) const;
+};
+
+/**
+ * @brief the ignore rules read from a single .gitignore file. Rules are inherited by the sub folders
+ */
+struct WXDLLIMPEXP_CL clGitIgnoreRules {
+    struct Rule {
+        wxString pattern;
+        wxArrayString segments; // anchored patterns only: the pattern split at '/'
+        bool negate = false;
+        bool dirOnly = false;
+        bool anchored = false; // pattern is relative to the .gitignore folder
+    };
+    typedef std::shared_ptr<clGitIgnoreRules> Ptr_t;
+
+    wxString m_folder; // with trailing separator
+    std::vector<Rule> m_rules;
+    Ptr_t m_parent;
+
+    /**
+     * @brief load the .gitignore file of 'folder'
+     * @return the new rules, or 'parent' if the folder has no .gitignore
+     */
+    static Ptr_t Load(const wxString& folder, Ptr_t parent);
+
+    /**
+     * @brief parse the content of a .gitignore file
+     * @param folder the folder of the .gitignore file, with a trailing separator
+     */
+    static Ptr_t Parse(const wxString& folder, const wxString& content, Ptr_t parent);
+
+    /**
+     * @brief is 'fullpath' ignored? later rules (and deeper files) win
+     */
+    static bool IsIgnored(const clGitIgnoreRules* rules, const wxString& fullpath, const wxString& name, bool isDir);
+};
+
 class WXDLLIMPEXP_CL clFilesScanner
 {
+public:
+    enum eScanFlags {
+        kScanDefault = 0,
+        /// Do not descend into version control folders (.git, .svn...)
+        kSkipVcsFolders = (1 << 0),
+        /// Do not descend into folders (or collect files) ignored by a .gitignore file
+        kHonourGitIgnore = (1 << 1),
+    };
+
 public:
     clFilesScanner();
     virtual ~clFilesScanner();
 
     /**
-     * @brief collect all files matching a given pattern from a root folder
+     * @brief collect all files matching a given pattern from a root folder. The folders are listed by a pool of
+     * threads, the result is sorted
      * @param rootFolder the scan root folder
      * @param filesOutput [output] output result full path entries
      * @param filespec files spec
      * @param excludeFolders list of folder to exclude from the search
+     * @param flags scan flags, see eScanFlags
      * @return number of files found
      */
     size_t Scan(const wxString& rootFolder, std::vector<wxString>& filesOutput, const wxString& filespec = "",
-                const wxString& excludeFilespec = "", const wxStringSet_t& excludeFolders = wxStringSet_t());
+                const wxString& excludeFilespec = "", const wxStringSet_t& excludeFolders = wxStringSet_t(),
+                size_t flags = kScanDefault);
 };
 
 #endif // CLFILESCOLLECTOR_H
@@ -0,0 +1,140 @@
+#include "clProcessOutputChannel.h"
+#include <algorithm>
+#include <wx/time.h>
+
+wxString clProcessOutputChannel::Statistics::ToString() const
+{
+    wxString s;
+    s << bytes << " bytes in " << chunks << " reads, " << events << " events ("
+      << wxString::Format("%.0f bytes/sec, %.1f events/sec", GetBytesPerSecond(), GetEventsPerSecond())
+      << "), peak pending: " << peakPending << " bytes, stalls: " << stalls;
+    return s;
+}
+
+clProcessOutputChannel::clProcessOutputChannel(size_t capacity)
+    : m_roomAvailable(m_mutex)
+    , m_closed(false)
+    , m_capacity(capacity)
+    , m_start(0)
+{
+    m_eventPending[kStdout] = false;
+    m_eventPending[kStderr] = false;
+}
+
+clProcessOutputChannel::~clProcessOutputChannel() {}
+
+bool clProcessOutputChannel::Push(eStream stream, const char* data, size_t len)
+{
+    wxMutexLocker locker(m_mutex);
+    if(m_stats.chunks == 0) { m_start = wxGetLocalTimeMillis(); }
+    m_pending[stream].append(data, len);
+    m_stats.bytes += len;
+    m_stats.chunks++;
+
+    size_t pending = DoGetPendingBytes();
+    m_stats.peakPending = std::max(m_stats.peakPending, pending);
+    if(pending >= m_capacity) { m_stats.stalls++; }
+
+    if(m_eventPending[stream]) {
+        // The main thread did not pick up the previous chunks yet, they will all be delivered together
+        return false;
+    }
+    m_eventPending[stream] = true;
+    m_stats.events++;
+    return true;
+}
+
+std::string clProcessOutputChannel::Take(eStream stream)
+{
+    wxMutexLocker locker(m_mutex);
+    std::string bytes;
+    bytes.swap(m_pending[stream]);
+    m_eventPending[stream] = false;
+    m_roomAvailable.Broadcast();
+    return bytes;
+}
+
+wxString clProcessOutputChannel::TakeString(eStream stream)
+{
+    std::string bytes;
+    {
+        wxMutexLocker locker(m_mutex);
+        bytes.swap(m_pending[stream]);
+        if(!m_closed) {
+            // Keep the start of a split character, the rest of it is in the next chunk
+            size_t complete = GetCompleteLength(bytes);
+            m_pending[stream] = bytes.substr(complete);
+            bytes.erase(complete);
+        }
+        m_eventPending[stream] = false;
+        m_roomAvailable.Broadcast();
+    }
+    return Decode(bytes);
+}
+
+bool clProcessOutputChannel::Close(eStream stream)
+{
+    wxMutexLocker locker(m_mutex);
+    m_closed = true;
+    if(m_pending[stream].empty() || m_eventPending[stream]) { return false; }
+    m_eventPending[stream] = true;
+    m_stats.events++;
+    return true;
+}
+
+size_t clProcessOutputChannel::GetCompleteLength(const std::string& bytes)
+{
+    // A UTF-8 sequence is at most 4 bytes long: look for its lead byte among the last 3 bytes
+    size_t len = bytes.length();
+    for(size_t i = 1; i <= 3 && i <= len; ++i) {
+        unsigned char ch = bytes[len - i];
+        if((ch & 0xC0) == 0x80) { continue; } // continuation byte
+
+        size_t seqLen = 1;
+        if((ch & 0xE0) == 0xC0) {
+            seqLen = 2;
+        } else if((ch & 0xF0) == 0xE0) {
+            seqLen = 3;
+        } else if((ch & 0xF8) == 0xF0) {
+            seqLen = 4;
+        }
+        return seqLen > i ? (len - i) : len;
+    }
+    return len;
+}
+
+wxString clProcessOutputChannel::Decode(const std::string& bytes)
+{
+    if(bytes.empty()) { return wxEmptyString; }
+
+    size_t complete = GetCompleteLength(bytes);
+    wxString output(bytes.c_str(), wxConvUTF8, complete);
+    if(output.IsEmpty() && complete > 0) {
+        output = wxString::From8BitData(bytes.c_str(), bytes.length());
+    } else if(complete < bytes.length()) {
+        output << wxString::From8BitData(bytes.c_str() + complete, bytes.length() - complete);
+    }
+    return output;
+}
+
+bool clProcessOutputChannel::IsFull() const
+{
+    wxMutexLocker locker(m_mutex);
+    return DoGetPendingBytes() >= m_capacity;
+}
+
+bool clProcessOutputChannel::WaitForRoom(unsigned long milliseconds)
+{
+    wxMutexLocker locker(m_mutex);
+    if(DoGetPendingBytes() < m_capacity) { return true; }
+    m_roomAvailable.WaitTimeout(milliseconds);
+    return DoGetPendingBytes() < m_capacity;
+}
+
+clProcessOutputChannel::Statistics clProcessOutputChannel::GetStatistics() const
+{
+    wxMutexLocker locker(m_mutex);
+    Statistics stats = m_stats;
+    if(stats.chunks) { stats.seconds = (wxGetLocalTimeMillis() - m_start).ToDouble() / 1000.0; }
+    return stats;
+}
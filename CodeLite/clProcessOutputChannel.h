@@ -0,0 +1,114 @@
+#ifndef CLPROCESSOUTPUTCHANNEL_H
+#define CLPROCESSOUTPUTCHANNEL_H
+
+#include "codelite_exports.h"
+#include <memory>
+#include <string>
+#include <wx/longlong.h>
+#include <wx/string.h>
+#include <wx/thread.h>
+
+/**
+ * @class clProcessOutputChannel
+ * @brief a bounded buffer between the thread that reads a process output and the main thread.
+ * Chunks that arrive while the main thread did not yet pick up the previous ones are appended to the pending
+ * bytes instead of firing another event, so a chatty process costs one event per main loop iteration instead of
+ * one event per read. Once the pending bytes exceed the channel capacity the reader stops reading (IsFull())
+ * until the main thread catches up, which in turn blocks the child process on its writes
+ */
+class WXDLLIMPEXP_CL clProcessOutputChannel
+{
+public:
+    typedef std::shared_ptr<clProcessOutputChannel> Ptr_t;
+    enum eStream {
+        kStdout = 0,
+        kStderr = 1,
+    };
+
+    struct WXDLLIMPEXP_CL Statistics {
+        wxUint64 bytes = 0;     ///< Total bytes read from the process
+        wxUint64 chunks = 0;    ///< Number of reads
+        wxUint64 events = 0;    ///< Number of events (or callbacks) sent to the main thread
+        wxUint64 stalls = 0;    ///< How many times the channel filled up and the reader had to wait
+        size_t peakPending = 0; ///< Largest number of bytes that were waiting for the main thread
+        double seconds = 0.0;   ///< Time elapsed since the first read
+
+        double GetBytesPerSecond() const { return seconds > 0.0 ? (bytes / seconds) : 0.0; }
+        double GetEventsPerSecond() const { return seconds > 0.0 ? (events / seconds) : 0.0; }
+        wxString ToString() const;
+    };
+
+    static const size_t DEFAULT_CAPACITY = 1024 * 1024;
+
+protected:
+    mutable wxMutex m_mutex;
+    wxCondition m_roomAvailable;
+    std::string m_pending[2];
+    bool m_eventPending[2];
+    bool m_closed;
+    size_t m_capacity;
+    Statistics m_stats;
+    wxLongLong m_start;
+
+protected:
+    size_t DoGetPendingBytes() const { return m_pending[kStdout].length() + m_pending[kStderr].length(); }
+
+    /**
+     * @brief the length of 'bytes' without a trailing multi byte UTF-8 sequence that was split by the read
+     */
+    static size_t GetCompleteLength(const std::string& bytes);
+
+public:
+    clProcessOutputChannel(size_t capacity = DEFAULT_CAPACITY);
+    virtual ~clProcessOutputChannel();
+
+    /**
+     * @brief append bytes read from the process. Called from the reader thread
+     * @return true if the caller should notify the main thread (by sending an event that will Take() the bytes),
+     * false if a notification for this stream is already on its way
+     */
+    bool Push(eStream stream, const char* data, size_t len);
+
+    /**
+     * @brief take all the pending bytes of a stream. Called from the main thread
+     */
+    std::string Take(eStream stream);
+
+    /**
+     * @brief same as Take(), decoded as UTF-8 (with a fallback to 8 bit data). A multi byte UTF-8 sequence that
+     * was split between two reads is left in the channel and delivered with the next chunk, unless the channel
+     * was closed
+     */
+    wxString TakeString(eStream stream);
+
+    /**
+     * @brief the process ended: no more bytes will be pushed. Called from the reader thread
+     * @return true if the caller should notify the main thread to take the bytes that are left in the stream
+     */
+    bool Close(eStream stream);
+
+    /**
+     * @brief decode bytes read from a process: UTF-8, or 8 bit data if they are not valid UTF-8. An incomplete
+     * UTF-8 sequence at the end of the bytes does not make the rest of them fall back to 8 bit data
+     */
+    static wxString Decode(const std::string& bytes);
+
+    /**
+     * @brief is the channel over its capacity?
+     */
+    bool IsFull() const;
+
+    /**
+     * @brief block the calling (reader) thread until the main thread takes some of the pending bytes, or until
+     * 'milliseconds' have passed
+     * @return true if there is room in the channel
+     */
+    bool WaitForRoom(unsigned long milliseconds);
+
+    /**
+     * @brief return the traffic statistics of this channel
+     */
+    Statistics GetStatistics() const;
+};
+
+#endif // CLPROCESSOUTPUTCHANNEL_H
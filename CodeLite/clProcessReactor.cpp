@@ -0,0 +1,230 @@
+#include "clProcessReactor.h"
+
+#if defined(__linux__)
+#include "file_logger.h"
+#include "unixprocess_impl.h"
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+// How long (ms) epoll_wait blocks before checking TestDestroy() and the polled (or paused) processes
+static int WAIT_TIMEOUT = 500;
+static int POLL_TIMEOUT = 50;
+
+static int OpenPidFd(int pid)
+{
+    // Returns -1 (ENOSYS) on kernels older than 5.3
+    return (int)::syscall(SYS_pidfd_open, pid, 0);
+}
+
+static clProcessReactor* reactor = nullptr;
+clProcessReactor& clProcessReactor::Get()
+{
+    if(!reactor) {
+        reactor = new clProcessReactor();
+        reactor->Create();
+        reactor->Run();
+    }
+    return *reactor;
+}
+
+clProcessReactor::clProcessReactor()
+    : wxThread(wxTHREAD_JOINABLE)
+{
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    if(m_epoll < 0) { clERROR() << "Process reactor: epoll_create1 error:" << strerror(errno); }
+}
+
+clProcessReactor::~clProcessReactor()
+{
+    if(m_epoll >= 0) { ::close(m_epoll); }
+}
+
+void clProcessReactor::Add(UnixProcessImpl* process)
+{
+    wxMutexLocker locker(m_mutex);
+    if(process->IsRedirect()) {
+        DoAddFd(process->GetReadHandle(), process, kStdout);
+        if(process->GetStderrHandle() != wxNOT_FOUND) {
+            // We own the read end of the stderr pipe, so it can be non-blocking. The pty master is also used to
+            // write to the process and stays blocking, it is only read when epoll reports it as readable
+            int flags = ::fcntl(process->GetStderrHandle(), F_GETFL);
+            ::fcntl(process->GetStderrHandle(), F_SETFL, flags | O_NONBLOCK);
+            DoAddFd(process->GetStderrHandle(), process, kStderr);
+        }
+
+    } else {
+        // We only need to know when the process exits
+        int pidfd = OpenPidFd(process->GetPid());
+        if(pidfd < 0) {
+            clDEBUG1() << "pidfd_open is not available (" << strerror(errno) << "), polling process"
+                       << process->GetPid();
+            m_polled.push_back(process);
+        } else {
+            ::fcntl(pidfd, F_SETFD, FD_CLOEXEC);
+            DoAddFd(pidfd, process, kExit);
+        }
+    }
+}
+
+void clProcessReactor::Remove(UnixProcessImpl* process)
+{
+    wxMutexLocker locker(m_mutex);
+    DoRemoveProcess(process);
+}
+
+void clProcessReactor::DoAddFd(int fd, UnixProcessImpl* process, eWatchKind kind)
+{
+    Watch watch;
+    watch.process = process;
+    watch.kind = kind;
+    watch.id = ++m_nextId;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = ((wxUint64)watch.id << 32) | (wxUint32)fd;
+    if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        clWARNING() << "Process reactor: failed to watch fd" << fd << ":" << strerror(errno);
+        if(kind == kExit) {
+            ::close(fd);
+            m_polled.push_back(process);
+        }
+        return;
+    }
+    m_watches[fd] = watch;
+}
+
+void clProcessReactor::DoRemoveFd(int fd)
+{
+    std::unordered_map<int, Watch>::iterator iter = m_watches.find(fd);
+    if(iter == m_watches.end()) { return; }
+    ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, NULL);
+
+    // The output handles belong to the process, the pidfd is ours
+    if(iter->second.kind == kExit) { ::close(fd); }
+    if(iter->second.paused) { --m_pausedCount; }
+    m_watches.erase(iter);
+}
+
+void clProcessReactor::DoRemoveProcess(UnixProcessImpl* process)
+{
+    std::vector<int> fds;
+    std::for_each(m_watches.begin(), m_watches.end(), [&](const std::unordered_map<int, Watch>::value_type& vt) {
+        if(vt.second.process == process) { fds.push_back(vt.first); }
+    });
+    std::for_each(fds.begin(), fds.end(), [&](int fd) { DoRemoveFd(fd); });
+    m_polled.erase(std::remove(m_polled.begin(), m_polled.end(), process), m_polled.end());
+}
+
+void clProcessReactor::DoSetPaused(int fd, Watch& watch, bool paused)
+{
+    if(watch.paused == paused) { return; }
+
+    // A paused fd is still reported on hangup, so we still learn about the process termination
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = paused ? 0 : EPOLLIN;
+    ev.data.u64 = ((wxUint64)watch.id << 32) | (wxUint32)fd;
+    if(::epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        clWARNING() << "Process reactor: failed to modify fd" << fd << ":" << strerror(errno);
+        return;
+    }
+    watch.paused = paused;
+    paused ? ++m_pausedCount : --m_pausedCount;
+}
+
+void clProcessReactor::DoResumePaused()
+{
+    if(m_pausedCount == 0) { return; }
+    std::for_each(m_watches.begin(), m_watches.end(), [&](std::unordered_map<int, Watch>::value_type& vt) {
+        if(vt.second.paused && !vt.second.process->GetOutputChannel()->IsFull()) {
+            DoSetPaused(vt.first, vt.second, false);
+        }
+    });
+}
+
+void clProcessReactor::DoHandleEvent(wxUint64 data)
+{
+    int fd = (int)(data & 0xFFFFFFFF);
+    std::unordered_map<int, Watch>::iterator iter = m_watches.find(fd);
+    if(iter == m_watches.end() || iter->second.id != (wxUint32)(data >> 32)) {
+        // Removed while we were waiting
+        return;
+    }
+
+    Watch watch = iter->second;
+    switch(watch.kind) {
+    case kStdout:
+        if(!watch.process->ReadAsync(fd, false)) {
+            // The pty was closed: the process terminated
+            DoRemoveProcess(watch.process);
+            watch.process->NotifyTerminated();
+        } else if(watch.process->GetOutputChannel()->IsFull()) {
+            DoSetPaused(fd, iter->second, true);
+        }
+        break;
+    case kStderr:
+        if(!watch.process->ReadAsync(fd, true)) {
+            // Keep reading stdout, it tells us when the process terminates
+            DoRemoveFd(fd);
+        } else if(watch.process->GetOutputChannel()->IsFull()) {
+            DoSetPaused(fd, iter->second, true);
+        }
+        break;
+    case kExit:
+        DoRemoveProcess(watch.process);
+        watch.process->NotifyTerminated();
+        break;
+    }
+}
+
+void clProcessReactor::DoCheckPolled()
+{
+    std::vector<UnixProcessImpl*> polled = m_polled;
+    for(size_t i = 0; i < polled.size(); ++i) {
+        UnixProcessImpl* process = polled[i];
+        if(::kill(process->GetPid(), 0) != 0) {
+            DoRemoveProcess(process);
+            process->NotifyTerminated();
+        }
+    }
+}
+
+void* clProcessReactor::Entry()
+{
+    const int MAX_EVENTS = 64;
+    struct epoll_event events[MAX_EVENTS];
+    while(!TestDestroy()) {
+        int timeout = WAIT_TIMEOUT;
+        {
+            wxMutexLocker locker(m_mutex);
+            if(!m_polled.empty() || m_pausedCount) { timeout = POLL_TIMEOUT; }
+        }
+
+        int count = ::epoll_wait(m_epoll, events, MAX_EVENTS, timeout);
+        if(count < 0 && errno != EINTR) {
+            clWARNING() << "Process reactor: epoll_wait error:" << strerror(errno);
+            wxThread::Sleep(timeout);
+            continue;
+        }
+
+        wxMutexLocker locker(m_mutex);
+        for(int i = 0; i < count; ++i) {
+            DoHandleEvent(events[i].data.u64);
+        }
+        DoCheckPolled();
+        DoResumePaused();
+    }
+    return NULL;
+}
+#endif // __linux__
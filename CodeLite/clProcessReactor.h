@@ -0,0 +1,72 @@
+#ifndef CLPROCESSREACTOR_H
+#define CLPROCESSREACTOR_H
+
+#if defined(__linux__)
+#include "codelite_exports.h"
+#include <unordered_map>
+#include <vector>
+#include <wx/thread.h>
+
+class UnixProcessImpl;
+/**
+ * @class clProcessReactor
+ * @brief a single thread that waits (using epoll) on the output of all the asynchronous child processes,
+ * instead of running a ProcessReaderThread per process. Processes that do not redirect their output are
+ * watched for termination using a pidfd
+ */
+class WXDLLIMPEXP_CL clProcessReactor : public wxThread
+{
+    enum eWatchKind {
+        kStdout,
+        kStderr,
+        kExit,
+    };
+
+    struct Watch {
+        UnixProcessImpl* process = nullptr;
+        eWatchKind kind = kStdout;
+        wxUint32 id = 0;
+        /// The process output channel is full: the fd is not read until the main thread catches up
+        bool paused = false;
+    };
+
+    int m_epoll = wxNOT_FOUND;
+    /// Every watch gets a new id, so an event that was already collected for a removed (and possibly reused)
+    /// fd is ignored
+    wxUint32 m_nextId = 0;
+    /// Protects the tables below. Held by the reactor thread while it dispatches, so once Remove() returns
+    /// the process is no longer referenced by the reactor
+    wxMutex m_mutex;
+    std::unordered_map<int, Watch> m_watches;
+    /// Processes without pidfd support (kernels older than 5.3), checked with kill(pid, 0) instead
+    std::vector<UnixProcessImpl*> m_polled;
+    size_t m_pausedCount = 0;
+
+protected:
+    clProcessReactor();
+    virtual ~clProcessReactor();
+    void* Entry();
+
+    void DoAddFd(int fd, UnixProcessImpl* process, eWatchKind kind);
+    void DoRemoveFd(int fd);
+    void DoRemoveProcess(UnixProcessImpl* process);
+    void DoSetPaused(int fd, Watch& watch, bool paused);
+    void DoResumePaused();
+    void DoHandleEvent(wxUint64 data);
+    void DoCheckPolled();
+
+public:
+    static clProcessReactor& Get();
+
+    /**
+     * @brief start watching a process. Called from the main thread
+     */
+    void Add(UnixProcessImpl* process);
+
+    /**
+     * @brief stop watching a process. When this call returns, the reactor no longer uses 'process'
+     */
+    void Remove(UnixProcessImpl* process);
+};
+#endif // __linux__
+#endif // CLPROCESSREACTOR_H
@@ -0,0 +1,431 @@
+#include "clSymbolIndex.h"
+#include "file_logger.h"
+#include "wxStringHash.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <wx/stopwatch.h>
+
+// When more files than this are modified at once (e.g. a full retag), rebuild the index instead of
+// re-reading every file
+#define MAX_DIRTY_FILES 1000
+
+#define SYMBOLS_QUERY "select ID, name, scope, path, kind, file from tags"
+
+typedef clSymbolIndex::SymbolId_t SymbolId_t;
+typedef std::vector<SymbolId_t> SymbolIdVec_t;
+
+class clSymbolIndexData
+{
+public:
+    struct Entry {
+        int name;
+        int scope;
+        int path;
+        int kind;
+        int file;
+    };
+
+    // Interned strings (and their lower case version)
+    std::vector<wxString> m_strings;
+    std::vector<wxString> m_lowerStrings;
+    std::unordered_map<wxString, int> m_stringIds;
+
+    std::unordered_map<SymbolId_t, Entry> m_entries;
+    // lower case name -> tags, sorted so we can use it for prefix lookups
+    std::map<wxString, SymbolIdVec_t> m_byName;
+    // scope -> its children
+    std::unordered_map<int, SymbolIdVec_t> m_byScope;
+    std::unordered_map<int, SymbolIdVec_t> m_byFile;
+    // the content of the FILES table
+    std::set<wxString> m_files;
+
+public:
+    int Intern(const wxString& str)
+    {
+        std::unordered_map<wxString, int>::iterator iter = m_stringIds.find(str);
+        if(iter != m_stringIds.end()) { return iter->second; }
+        int id = (int)m_strings.size();
+        m_strings.push_back(str);
+        m_lowerStrings.push_back(str.Lower());
+        m_stringIds.insert(std::make_pair(str, id));
+        return id;
+    }
+
+    int Lookup(const wxString& str) const
+    {
+        std::unordered_map<wxString, int>::const_iterator iter = m_stringIds.find(str);
+        return iter == m_stringIds.end() ? wxNOT_FOUND : iter->second;
+    }
+
+    void AddRow(wxSQLite3ResultSet& res)
+    {
+        SymbolId_t id = res.GetInt64(0).GetValue();
+        if(m_entries.count(id)) { return; }
+
+        Entry entry;
+        entry.name = Intern(res.GetString(1));
+        entry.scope = Intern(res.GetString(2));
+        entry.path = Intern(res.GetString(3));
+        entry.kind = Intern(res.GetString(4));
+        entry.file = Intern(res.GetString(5));
+        m_entries.insert(std::make_pair(id, entry));
+
+        m_byName[m_lowerStrings[entry.name]].push_back(id);
+        m_byScope[entry.scope].push_back(id);
+        m_byFile[entry.file].push_back(id);
+    }
+
+    void RemoveFile(const wxString& file)
+    {
+        int fileId = Lookup(file);
+        if(fileId == wxNOT_FOUND) { return; }
+
+        std::unordered_map<int, SymbolIdVec_t>::iterator iter = m_byFile.find(fileId);
+        if(iter == m_byFile.end()) { return; }
+
+        std::unordered_set<SymbolId_t> removed(iter->second.begin(), iter->second.end());
+        std::set<int> scopes;
+        for(SymbolId_t id : iter->second) {
+            std::unordered_map<SymbolId_t, Entry>::iterator entryIter = m_entries.find(id);
+            if(entryIter == m_entries.end()) { continue; }
+            scopes.insert(entryIter->second.scope);
+
+            std::map<wxString, SymbolIdVec_t>::iterator nameIter =
+                m_byName.find(m_lowerStrings[entryIter->second.name]);
+            if(nameIter != m_byName.end()) {
+                SymbolIdVec_t& ids = nameIter->second;
+                ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+                if(ids.empty()) { m_byName.erase(nameIter); }
+            }
+            m_entries.erase(entryIter);
+        }
+
+        // A scope may have many children (e.g. <global>), remove them all in a single pass
+        for(int scope : scopes) {
+            SymbolIdVec_t& ids = m_byScope[scope];
+            ids.erase(std::remove_if(ids.begin(), ids.end(), [&](SymbolId_t id) { return removed.count(id) > 0; }),
+                      ids.end());
+            if(ids.empty()) { m_byScope.erase(scope); }
+        }
+        m_byFile.erase(iter);
+    }
+};
+
+clSymbolIndex::clSymbolIndex()
+    : m_loader(nullptr)
+    , m_loading(false)
+    , m_reloadRequested(false)
+    , m_shutdown(false)
+{
+}
+
+clSymbolIndex::~clSymbolIndex() { Clear(); }
+
+clSymbolIndex& clSymbolIndex::Get()
+{
+    static clSymbolIndex index;
+    return index;
+}
+
+void clSymbolIndex::Load(const wxFileName& dbfile)
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if(m_dbfile == dbfile && (m_data || m_loading)) { return; }
+    }
+
+    Clear();
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    try {
+        m_db.Open(dbfile.GetFullPath());
+        m_db.SetBusyTimeout(10);
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Symbol index: failed to open" << dbfile << ":" << e.GetMessage() << clEndl;
+        return;
+    }
+    m_dbfile = dbfile;
+    DoStartLoader();
+}
+
+void clSymbolIndex::Clear()
+{
+    // Detach the index from the database first: from this point, the storage notifications are
+    // ignored and no new loader can be started
+    std::thread* loader = nullptr;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_shutdown = true;
+        m_data.reset(nullptr);
+        m_dirtyFiles.clear();
+        m_dbfile.Clear();
+        if(m_db.IsOpen()) { m_db.Close(); }
+        m_reloadRequested = false;
+        std::swap(loader, m_loader);
+    }
+
+    if(loader) {
+        loader->join();
+        wxDELETE(loader);
+    }
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_loading = false;
+    m_shutdown = false;
+}
+
+void clSymbolIndex::Reload(const wxFileName& dbfile)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(!m_db.IsOpen() || m_dbfile != dbfile) { return; }
+
+    // Until the new index is ready, lookups are done by the database
+    m_data.reset(nullptr);
+    m_dirtyFiles.clear();
+
+    // The database file might have been deleted and re-created, re-open it
+    try {
+        m_db.Close();
+        m_db.Open(m_dbfile.GetFullPath());
+        m_db.SetBusyTimeout(10);
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Symbol index: failed to open" << m_dbfile << ":" << e.GetMessage() << clEndl;
+        return;
+    }
+    DoStartLoader();
+}
+
+void clSymbolIndex::MarkFilesDirty(const wxFileName& dbfile, const wxStringSet_t& files)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(!m_db.IsOpen() || m_dbfile != dbfile) { return; }
+
+    m_dirtyFiles.insert(files.begin(), files.end());
+    if(m_dirtyFiles.size() > MAX_DIRTY_FILES) {
+        m_dirtyFiles.clear();
+        m_data.reset(nullptr);
+        DoStartLoader();
+    }
+}
+
+void clSymbolIndex::DoStartLoader()
+{
+    if(m_loading) {
+        // The running loader might have already read the database, ask it to start over
+        m_reloadRequested = true;
+        return;
+    }
+
+    // A previous loader has completed its work, but was not joined yet
+    if(m_loader) {
+        m_loader->join();
+        wxDELETE(m_loader);
+    }
+
+    m_loading = true;
+    m_reloadRequested = false;
+    m_loader = new std::thread(&clSymbolIndex::LoaderMain, this, m_dbfile);
+}
+
+void clSymbolIndex::LoaderMain(const wxFileName& dbfile)
+{
+    while(true) {
+        wxStopWatch sw;
+        clSymbolIndexData* data = DoBuild(dbfile);
+
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if(m_shutdown || m_dbfile != dbfile) {
+            wxDELETE(data);
+            m_loading = false;
+            return;
+        }
+
+        if(m_reloadRequested) {
+            // The database was modified while we were reading it
+            wxDELETE(data);
+            m_reloadRequested = false;
+            continue;
+        }
+
+        if(data) {
+            clDEBUG() << "Symbol index: loaded" << data->m_entries.size() << "symbols in" << sw.Time() << "ms"
+                      << clEndl;
+        }
+        m_data.reset(data);
+        m_loading = false;
+        return;
+    }
+}
+
+clSymbolIndexData* clSymbolIndex::DoBuild(const wxFileName& dbfile)
+{
+    // Use our own connection, the main one is used for syncing the dirty files
+    std::unique_ptr<clSymbolIndexData> data(new clSymbolIndexData());
+    try {
+        wxSQLite3Database db;
+        db.Open(dbfile.GetFullPath());
+        db.SetBusyTimeout(10);
+
+        size_t rows = 0;
+        wxSQLite3ResultSet res = db.ExecuteQuery(SYMBOLS_QUERY);
+        while(res.NextRow()) {
+            data->AddRow(res);
+            if((++rows % 10000) == 0 && m_shutdown) { return nullptr; }
+        }
+        res.Finalize();
+
+        res = db.ExecuteQuery("select file from files");
+        while(res.NextRow()) {
+            data->m_files.insert(res.GetString(0));
+        }
+        res.Finalize();
+        db.Close();
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Symbol index: failed to load" << dbfile << ":" << e.GetMessage() << clEndl;
+        return nullptr;
+    }
+    return data.release();
+}
+
+bool clSymbolIndex::DoIsUsable(const wxFileName& dbfile) const
+{
+    return m_data && m_db.IsOpen() && m_dbfile == dbfile;
+}
+
+bool clSymbolIndex::DoSync()
+{
+    if(m_dirtyFiles.empty()) { return true; }
+    try {
+        for(const wxString& file : m_dirtyFiles) {
+            m_data->RemoveFile(file);
+
+            wxSQLite3Statement st = m_db.PrepareStatement(SYMBOLS_QUERY " where file=?");
+            st.Bind(1, file);
+            wxSQLite3ResultSet res = st.ExecuteQuery();
+            while(res.NextRow()) {
+                m_data->AddRow(res);
+            }
+            res.Finalize();
+
+            wxSQLite3Statement fileSt = m_db.PrepareStatement("select 1 from files where file=?");
+            fileSt.Bind(1, file);
+            wxSQLite3ResultSet fileRes = fileSt.ExecuteQuery();
+            if(fileRes.NextRow()) {
+                m_data->m_files.insert(file);
+            } else {
+                m_data->m_files.erase(file);
+            }
+            fileRes.Finalize();
+        }
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Symbol index: sync error:" << e.GetMessage() << clEndl;
+        // We no longer know what the index contains
+        m_data.reset(nullptr);
+        m_dirtyFiles.clear();
+        DoStartLoader();
+        return false;
+    }
+    m_dirtyFiles.clear();
+    return true;
+}
+
+bool clSymbolIndex::FindByScopeAndName(const wxFileName& dbfile, const wxString& scope, const wxString& name,
+                                       bool partial, bool caseInsensitive, size_t limit, std::vector<SymbolId_t>& ids)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(!DoIsUsable(dbfile) || !DoSync()) { return false; }
+
+    bool isGlobal = (scope.IsEmpty() || scope == "<global>");
+    int scopeId = m_data->Lookup(isGlobal ? wxString("<global>") : scope);
+    if(scopeId == wxNOT_FOUND) { return true; }
+
+    wxString lowerName = name.Lower();
+    auto Matches = [&](SymbolId_t id) -> bool {
+        const clSymbolIndexData::Entry& entry = m_data->m_entries[id];
+        if(entry.scope != scopeId) { return false; }
+        if(!partial) { return m_data->m_strings[entry.name] == name; }
+        if(caseInsensitive) { return m_data->m_lowerStrings[entry.name].StartsWith(lowerName); }
+        return m_data->m_strings[entry.name].StartsWith(name);
+    };
+
+    if(isGlobal) {
+        // The global scope is huge, start from the name
+        std::map<wxString, SymbolIdVec_t>::const_iterator iter = m_data->m_byName.lower_bound(lowerName);
+        for(; iter != m_data->m_byName.end() && iter->first.StartsWith(lowerName); ++iter) {
+            if(!partial && iter->first != lowerName) { break; }
+            for(SymbolId_t id : iter->second) {
+                if(!Matches(id)) { continue; }
+                ids.push_back(id);
+                if(ids.size() >= limit) { return true; }
+            }
+        }
+
+    } else {
+        const SymbolIdVec_t& children = m_data->m_byScope[scopeId];
+        for(SymbolId_t id : children) {
+            if(!Matches(id)) { continue; }
+            ids.push_back(id);
+            if(ids.size() >= limit) { return true; }
+        }
+    }
+    return true;
+}
+
+bool clSymbolIndex::FindByPartName(const wxFileName& dbfile, const wxString& partname, size_t limit,
+                                   std::vector<SymbolId_t>& ids)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(!DoIsUsable(dbfile) || !DoSync()) { return false; }
+
+    // Every unique name is checked only once
+    wxString lowerPart = partname.Lower();
+    for(const std::pair<const wxString, SymbolIdVec_t>& p : m_data->m_byName) {
+        if(p.first.Find(lowerPart) == wxNOT_FOUND) { continue; }
+        for(SymbolId_t id : p.second) {
+            ids.push_back(id);
+            if(ids.size() >= limit) { return true; }
+        }
+    }
+    return true;
+}
+
+bool clSymbolIndex::FindByPathParts(const wxFileName& dbfile, const wxArrayString& parts, size_t limit,
+                                    std::vector<SymbolId_t>& ids)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(!DoIsUsable(dbfile) || !DoSync()) { return false; }
+
+    wxArrayString lowerParts;
+    for(size_t i = 0; i < parts.size(); ++i) {
+        lowerParts.Add(parts.Item(i).Lower());
+    }
+
+    for(const std::pair<const SymbolId_t, clSymbolIndexData::Entry>& p : m_data->m_entries) {
+        const wxString& path = m_data->m_lowerStrings[p.second.path];
+        bool match = true;
+        for(size_t i = 0; i < lowerParts.size() && match; ++i) {
+            match = (path.Find(lowerParts.Item(i)) != wxNOT_FOUND);
+        }
+        if(!match) { continue; }
+        ids.push_back(p.first);
+        if(ids.size() >= limit) { return true; }
+    }
+    return true;
+}
+
+bool clSymbolIndex::FindFiles(const wxFileName& dbfile, const wxString& part, wxArrayString& files)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if(!DoIsUsable(dbfile) || !DoSync()) { return false; }
+
+    wxString lowerPart = part.Lower();
+    for(const wxString& file : m_data->m_files) {
+        if(file.Lower().Find(lowerPart) == wxNOT_FOUND) { continue; }
+        files.Add(file);
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef CLSYMBOLINDEX_H
+#define CLSYMBOLINDEX_H
+
+#include "codelite_exports.h"
+#include "macros.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+#include <wx/wxsqlite3.h>
+
+class clSymbolIndexData;
+
+/**
+ * @class clSymbolIndex
+ * @brief a resident index of the symbols stored in the workspace tags database.
+ * The index keeps, for every tag, its interned name, scope, path, kind and file and answers the code completion
+ * lookups (by name prefix, by scope, by partial name and the include files completion) without scanning the
+ * tags table. The lookups return tags IDs, the caller fetches the matching rows by their primary key.
+ *
+ * The index is built by a background thread when the database is opened (until it is ready, the lookups return
+ * false and the caller should fallback to SQL). When the tags of a file are modified, the storage marks the file
+ * as "dirty" and its symbols are re-read from the database by the next lookup
+ */
+class WXDLLIMPEXP_CL clSymbolIndex
+{
+public:
+    typedef long long SymbolId_t;
+
+protected:
+    std::mutex m_mutex;
+    wxFileName m_dbfile;
+    wxSQLite3Database m_db;
+    std::unique_ptr<clSymbolIndexData> m_data;
+    wxStringSet_t m_dirtyFiles;
+    std::thread* m_loader;
+    bool m_loading;
+    bool m_reloadRequested;
+    std::atomic_bool m_shutdown;
+
+protected:
+    clSymbolIndex();
+    virtual ~clSymbolIndex();
+
+    void DoStartLoader();
+    void LoaderMain(const wxFileName& dbfile);
+    clSymbolIndexData* DoBuild(const wxFileName& dbfile);
+
+    /**
+     * @brief re-read the symbols of the dirty files. Must be called with m_mutex locked
+     * @return false if the index can not be used
+     */
+    bool DoSync();
+    bool DoIsUsable(const wxFileName& dbfile) const;
+
+public:
+    static clSymbolIndex& Get();
+
+    /**
+     * @brief start building the index for a tags database
+     */
+    void Load(const wxFileName& dbfile);
+
+    /**
+     * @brief discard the index
+     */
+    void Clear();
+
+    /**
+     * @brief rebuild the entire index (e.g. after the database was recreated)
+     */
+    void Reload(const wxFileName& dbfile);
+
+    /**
+     * @brief the tags of 'files' were modified (and committed) in 'dbfile'
+     */
+    void MarkFilesDirty(const wxFileName& dbfile, const wxStringSet_t& files);
+
+    /**
+     * @brief find tags by scope and name
+     * @param partial when set, 'name' is a prefix
+     * @param caseInsensitive (partial match only) ignore case when comparing the prefix
+     * @return false if the index is not ready for 'dbfile'
+     */
+    bool FindByScopeAndName(const wxFileName& dbfile, const wxString& scope, const wxString& name, bool partial,
+                            bool caseInsensitive, size_t limit, std::vector<SymbolId_t>& ids);
+
+    /**
+     * @brief find tags that their name contains 'partname' (ignoring case)
+     */
+    bool FindByPartName(const wxFileName& dbfile, const wxString& partname, size_t limit,
+                        std::vector<SymbolId_t>& ids);
+
+    /**
+     * @brief find tags that their path contains all the 'parts' (ignoring case)
+     */
+    bool FindByPathParts(const wxFileName& dbfile, const wxArrayString& parts, size_t limit,
+                         std::vector<SymbolId_t>& ids);
+
+    /**
+     * @brief return the list of files (sorted) known to the database that contain 'part'
+     */
+    bool FindFiles(const wxFileName& dbfile, const wxString& part, wxArrayString& files);
+};
+
+#endif // CLSYMBOLINDEX_H
@@ -0,0 +1,595 @@
+#include "clTrigramIndex.h"
+#include "file_logger.h"
+#include "fileutils.h"
+#include "wxStringHash.h"
+#include <algorithm>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/tokenzr.h>
+
+// Files larger than this are not indexed (they are always searched)
+#define TRIGRAM_MAX_FILE_SIZE (8 * 1024 * 1024)
+
+// Number of file IDs per posting blob. Adding a file rewrites the last blob of each of its trigrams, this keeps
+// the cost of indexing a single (saved) file bounded
+#define TRIGRAM_SEGMENT_SIZE 1024
+
+// Compact the postings once there are more deleted files than this (and more than half of the indexed files)
+#define TRIGRAM_COMPACT_THRESHOLD 1000
+
+static inline int MakeTrigram(unsigned char a, unsigned char b, unsigned char c) { return (a << 16) | (b << 8) | c; }
+static inline unsigned char AsciiLower(unsigned char ch) { return (ch >= 'A' && ch <= 'Z') ? (ch - 'A' + 'a') : ch; }
+
+// A trigram fits in 24 bits
+static inline wxInt64 MakePostingKey(wxInt64 segment, int trigram) { return (segment << 24) | trigram; }
+static inline int PostingKeyTrigram(wxInt64 key) { return (int)(key & 0xFFFFFF); }
+static inline wxInt64 PostingKeySegment(wxInt64 key) { return key >> 24; }
+
+/**
+ * @brief collect the trigrams of a buffer. Matching is done line by line, so trigrams crossing a line break
+ * are not needed
+ */
+static void CollectTrigrams(const char* buffer, size_t len, std::unordered_set<int>& trigrams)
+{
+    if(len < 3) { return; }
+    for(size_t i = 0; i + 2 < len; ++i) {
+        unsigned char a = AsciiLower(buffer[i]);
+        unsigned char b = AsciiLower(buffer[i + 1]);
+        unsigned char c = AsciiLower(buffer[i + 2]);
+        if(a == '\n' || b == '\n' || c == '\n') { continue; }
+        trigrams.insert(MakeTrigram(a, b, c));
+    }
+}
+
+/**
+ * @brief append the file IDs stored in a posting blob (native byte order, the index is a local cache)
+ */
+static void AppendPostings(const unsigned char* blob, int len, std::vector<wxUint32>& ids)
+{
+    size_t count = (len > 0) ? ((size_t)len / sizeof(wxUint32)) : 0;
+    if(count == 0) { return; }
+    size_t offset = ids.size();
+    ids.resize(offset + count);
+    memcpy(&ids[offset], blob, count * sizeof(wxUint32));
+}
+
+static bool GetFileState(const wxString& filename, time_t& lastModified, wxInt64& size)
+{
+    wxStructStat buff;
+    if(wxStat(filename, &buff) != 0) { return false; }
+    lastModified = buff.st_mtime;
+    size = buff.st_size;
+    return true;
+}
+
+struct IndexedFile {
+    wxLongLong id;
+    time_t lastModified;
+    wxInt64 size;
+    wxString hash;
+};
+
+/**
+ * @brief read an IndexedFile from a "select ID, LAST_MODIFIED, FILE_SIZE, CONTENT_HASH" row
+ */
+static void ReadIndexedFile(wxSQLite3ResultSet& res, int firstColumn, IndexedFile& file)
+{
+    file.id = res.GetInt64(firstColumn);
+    file.lastModified = (time_t)res.GetInt64(firstColumn + 1).GetValue();
+    file.size = res.GetInt64(firstColumn + 2).GetValue();
+    file.hash = res.GetString(firstColumn + 3);
+}
+
+/**
+ * @brief does the index entry still describe the file on disk? The modification time has a one second
+ * granularity, so the entries of files that were modified in the second they were indexed also keep a content hash
+ */
+static bool IsUpToDate(const wxString& filename, const IndexedFile& file)
+{
+    time_t lastModified = 0;
+    wxInt64 size = 0;
+    if(!GetFileState(filename, lastModified, size)) { return false; }
+    if(lastModified != file.lastModified || size != file.size) { return false; }
+    return file.hash.IsEmpty() || (FileUtils::GetFileContentHash(filename) == file.hash);
+}
+
+clTrigramIndex::clTrigramIndex() {}
+
+clTrigramIndex::~clTrigramIndex() { Close(); }
+
+wxFileName clTrigramIndex::GetIndexFileName(const wxFileName& tagsDatabase)
+{
+    if(!tagsDatabase.IsOk()) { return wxFileName(); }
+    wxFileName fn(tagsDatabase);
+    fn.SetExt("trigrams");
+    return fn;
+}
+
+bool clTrigramIndex::Open(const wxFileName& indexFile)
+{
+    Close();
+    try {
+        m_db.Open(indexFile.GetFullPath());
+        m_db.SetBusyTimeout(10);
+        CreateSchema();
+        return true;
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Failed to open trigram index:" << indexFile << "." << e.GetMessage() << clEndl;
+    }
+    return false;
+}
+
+void clTrigramIndex::Close()
+{
+    m_pendingPostings.clear();
+    if(m_db.IsOpen()) { m_db.Close(); }
+}
+
+wxString clTrigramIndex::GetSchemaVersion()
+{
+    try {
+        wxSQLite3ResultSet res = m_db.ExecuteQuery("select VERSION from TRIGRAM_SCHEMA");
+        if(res.NextRow()) { return res.GetString(0); }
+    } catch(wxSQLite3Exception& e) {
+        wxUnusedVar(e);
+    }
+    return "";
+}
+
+void clTrigramIndex::CreateSchema()
+{
+    static const wxString CURR_SCHEMA = "2.0.0";
+    if(GetSchemaVersion() != CURR_SCHEMA) {
+        // Drop the tables and recreate the schema
+        try {
+            m_db.ExecuteUpdate("drop table if exists TRIGRAM_SCHEMA");
+            m_db.ExecuteUpdate("drop table if exists TRIGRAM_META");
+            m_db.ExecuteUpdate("drop table if exists TRIGRAMS");
+            m_db.ExecuteUpdate("drop table if exists POSTINGS");
+            m_db.ExecuteUpdate("drop table if exists FILES");
+            m_db.ExecuteUpdate("drop index if exists TRIGRAMS_IDX1");
+            m_db.ExecuteUpdate("drop index if exists TRIGRAMS_IDX2");
+            m_db.ExecuteUpdate("drop index if exists FILES_IDX1");
+        } catch(wxSQLite3Exception& e) {
+            wxUnusedVar(e);
+        }
+    }
+
+    m_db.ExecuteUpdate("PRAGMA journal_mode= OFF");
+    m_db.ExecuteUpdate("PRAGMA synchronous = OFF");
+    m_db.ExecuteUpdate("PRAGMA temp_store = MEMORY");
+    m_db.ExecuteUpdate("create table if not exists TRIGRAM_SCHEMA (VERSION string primary key)");
+    m_db.ExecuteUpdate("create table if not exists TRIGRAM_META (NAME string primary key, VALUE INTEGER)");
+    m_db.ExecuteUpdate("insert or ignore into TRIGRAM_META values ('DELETED_FILES', 0)");
+    m_db.ExecuteUpdate("create table if not exists FILES (ID INTEGER PRIMARY KEY AUTOINCREMENT, FILE_NAME "
+                       "VARCHAR(256), LAST_MODIFIED INTEGER, FILE_SIZE INTEGER, CONTENT_HASH VARCHAR(16))");
+    m_db.ExecuteUpdate("create unique index if not exists FILES_IDX1 on FILES(FILE_NAME)");
+    m_db.ExecuteUpdate("create table if not exists POSTINGS (TRIGRAM INTEGER, SEGMENT INTEGER, FILE_IDS BLOB, "
+                       "PRIMARY KEY(TRIGRAM, SEGMENT))");
+
+    wxString sql = wxString("replace into TRIGRAM_SCHEMA values ('") << CURR_SCHEMA << "')";
+    m_db.ExecuteUpdate(sql);
+}
+
+wxLongLong clTrigramIndex::GetFileID(const wxString& filename)
+{
+    try {
+        wxSQLite3Statement st = m_db.PrepareStatement("select ID from FILES where FILE_NAME=?");
+        st.Bind(1, filename);
+        wxSQLite3ResultSet res = st.ExecuteQuery();
+        if(res.NextRow()) { return res.GetInt64(0); }
+    } catch(wxSQLite3Exception& e) {
+        wxUnusedVar(e);
+    }
+    return wxNOT_FOUND;
+}
+
+void clTrigramIndex::DoDeleteFile(wxLongLong fileID)
+{
+    // The file ID is left in the postings: FilterFiles() only looks up the IDs of the indexed files and
+    // DoCompact() drops the stale IDs once there are enough of them
+    wxSQLite3Statement st = m_db.PrepareStatement("delete from FILES where ID=?");
+    st.Bind(1, fileID);
+    st.ExecuteUpdate();
+    m_db.ExecuteUpdate("update TRIGRAM_META set VALUE=VALUE+1 where NAME='DELETED_FILES'");
+}
+
+bool clTrigramIndex::DoIndexFile(const wxString& filename)
+{
+    time_t lastModified = 0;
+    wxInt64 size = 0;
+    if(!GetFileState(filename, lastModified, size)) { return false; }
+    if(size > TRIGRAM_MAX_FILE_SIZE) { return false; }
+
+    time_t indexTime = time(NULL);
+    wxFFile fp(filename, "rb");
+    if(!fp.IsOpened()) { return false; }
+
+    wxFileOffset len = fp.Length();
+    if(len < 0 || len > TRIGRAM_MAX_FILE_SIZE) { return false; }
+
+    std::string buffer;
+    buffer.resize((size_t)len);
+    if(len && (fp.Read(&buffer[0], buffer.size()) != buffer.size())) { return false; }
+    fp.Close();
+
+    // Binary files are not indexed
+    if(buffer.find('\0') != std::string::npos) { return false; }
+
+    std::unordered_set<int> trigrams;
+    CollectTrigrams(buffer.c_str(), buffer.length(), trigrams);
+
+    // The file can still be modified within the same second without changing its modification time
+    wxString hash;
+    if(lastModified >= indexTime) { hash = FileUtils::GetContentHash(buffer.c_str(), buffer.length()); }
+
+    wxSQLite3Statement fileSt = m_db.PrepareStatement(
+        "insert into FILES (ID, FILE_NAME, LAST_MODIFIED, FILE_SIZE, CONTENT_HASH) values (NULL, ?, ?, ?, ?)");
+    fileSt.Bind(1, filename);
+    fileSt.Bind(2, wxLongLong(lastModified));
+    fileSt.Bind(3, wxLongLong(size));
+    fileSt.Bind(4, hash);
+    fileSt.ExecuteUpdate();
+    wxInt64 fileID = m_db.GetLastRowId().GetValue();
+
+    // The IDs are never reused (AUTOINCREMENT), new postings are always appended at the end of their segment
+    wxInt64 segment = fileID / TRIGRAM_SEGMENT_SIZE;
+    if(!m_pendingPostings.empty() && PostingKeySegment(m_pendingPostings.begin()->first) != segment) {
+        DoFlushPostings();
+    }
+    for(int trigram : trigrams) {
+        m_pendingPostings[MakePostingKey(segment, trigram)].push_back((wxUint32)fileID);
+    }
+    return true;
+}
+
+void clTrigramIndex::DoFlushPostings()
+{
+    if(m_pendingPostings.empty()) { return; }
+
+    wxSQLite3Statement selectSt = m_db.PrepareStatement("select FILE_IDS from POSTINGS where TRIGRAM=? and SEGMENT=?");
+    wxSQLite3Statement replaceSt = m_db.PrepareStatement("replace into POSTINGS values (?, ?, ?)");
+    std::vector<wxUint32> ids;
+    for(const auto& vt : m_pendingPostings) {
+        int trigram = PostingKeyTrigram(vt.first);
+        wxLongLong segment = PostingKeySegment(vt.first);
+
+        ids.clear();
+        selectSt.Bind(1, trigram);
+        selectSt.Bind(2, segment);
+        {
+            wxSQLite3ResultSet res = selectSt.ExecuteQuery();
+            if(res.NextRow()) {
+                int len = 0;
+                const unsigned char* blob = res.GetBlob(0, len);
+                AppendPostings(blob, len, ids);
+            }
+        }
+        selectSt.Reset();
+
+        bool sorted = ids.empty() || (ids.back() < vt.second.front());
+        ids.insert(ids.end(), vt.second.begin(), vt.second.end());
+        if(!sorted) { std::sort(ids.begin(), ids.end()); }
+
+        replaceSt.Bind(1, trigram);
+        replaceSt.Bind(2, segment);
+        replaceSt.Bind(3, (const unsigned char*)&ids[0], (int)(ids.size() * sizeof(wxUint32)));
+        replaceSt.ExecuteUpdate();
+        replaceSt.Reset();
+    }
+    m_pendingPostings.clear();
+}
+
+bool clTrigramIndex::DoCompact(const StopCallback_t& shouldStop)
+{
+    std::unordered_set<wxUint32> liveIDs;
+    {
+        wxSQLite3ResultSet res = m_db.ExecuteQuery("select ID from FILES");
+        while(res.NextRow()) {
+            liveIDs.insert((wxUint32)res.GetInt64(0).GetValue());
+        }
+    }
+
+    std::vector<wxLongLong> segments;
+    {
+        wxSQLite3ResultSet res = m_db.ExecuteQuery("select distinct SEGMENT from POSTINGS");
+        while(res.NextRow()) {
+            segments.push_back(res.GetInt64(0));
+        }
+    }
+
+    // One transaction per segment
+    for(size_t i = 0; i < segments.size(); ++i) {
+        if(shouldStop && shouldStop()) { return false; }
+
+        std::vector<std::pair<int, std::vector<wxUint32> > > rows;
+        {
+            wxSQLite3Statement st = m_db.PrepareStatement("select TRIGRAM, FILE_IDS from POSTINGS where SEGMENT=?");
+            st.Bind(1, segments[i]);
+            wxSQLite3ResultSet res = st.ExecuteQuery();
+            while(res.NextRow()) {
+                int len = 0;
+                rows.push_back({ res.GetInt(0), std::vector<wxUint32>() });
+                const unsigned char* blob = res.GetBlob(1, len);
+                AppendPostings(blob, len, rows.back().second);
+            }
+        }
+
+        m_db.Begin();
+        wxSQLite3Statement deleteSt = m_db.PrepareStatement("delete from POSTINGS where TRIGRAM=? and SEGMENT=?");
+        wxSQLite3Statement replaceSt = m_db.PrepareStatement("replace into POSTINGS values (?, ?, ?)");
+        for(size_t n = 0; n < rows.size(); ++n) {
+            std::vector<wxUint32>& ids = rows[n].second;
+            size_t count = ids.size();
+            ids.erase(std::remove_if(ids.begin(), ids.end(), [&](wxUint32 id) { return liveIDs.count(id) == 0; }),
+                      ids.end());
+            if(ids.size() == count) { continue; }
+
+            if(ids.empty()) {
+                deleteSt.Bind(1, rows[n].first);
+                deleteSt.Bind(2, segments[i]);
+                deleteSt.ExecuteUpdate();
+                deleteSt.Reset();
+            } else {
+                replaceSt.Bind(1, rows[n].first);
+                replaceSt.Bind(2, segments[i]);
+                replaceSt.Bind(3, (const unsigned char*)&ids[0], (int)(ids.size() * sizeof(wxUint32)));
+                replaceSt.ExecuteUpdate();
+                replaceSt.Reset();
+            }
+        }
+        m_db.Commit();
+    }
+    m_db.ExecuteUpdate("update TRIGRAM_META set VALUE=0 where NAME='DELETED_FILES'");
+    clDEBUG() << "Trigram index: compacted" << segments.size() << "segments" << clEndl;
+    return true;
+}
+
+size_t clTrigramIndex::UpdateFiles(const wxArrayString& files, const StopCallback_t& shouldStop)
+{
+    if(!IsOpen()) { return 0; }
+
+    size_t processed = 0;
+    try {
+        // A file entry and its postings are always committed together
+        m_db.Begin();
+        wxSQLite3Statement st =
+            m_db.PrepareStatement("select ID, LAST_MODIFIED, FILE_SIZE, CONTENT_HASH from FILES where FILE_NAME=?");
+        for(; processed < files.size(); ++processed) {
+            if(shouldStop && shouldStop()) { break; }
+
+            const wxString& filename = files.Item(processed);
+            IndexedFile file;
+            bool found = false;
+            st.Bind(1, filename);
+            {
+                wxSQLite3ResultSet res = st.ExecuteQuery();
+                if(res.NextRow()) {
+                    ReadIndexedFile(res, 0, file);
+                    found = true;
+                }
+            }
+            st.Reset();
+
+            if(found && IsUpToDate(filename, file)) { continue; }
+            if(found) { DoDeleteFile(file.id); }
+            // Deleted files are only removed from the index
+            DoIndexFile(filename);
+        }
+        DoFlushPostings();
+        m_db.Commit();
+
+        if(processed == files.size()) {
+            // Drop the IDs of the deleted files from the postings once they take a significant part of the index
+            int deleted = m_db.ExecuteScalar("select VALUE from TRIGRAM_META where NAME='DELETED_FILES'");
+            int indexed = m_db.ExecuteScalar("select count(*) from FILES");
+            if(deleted > TRIGRAM_COMPACT_THRESHOLD && deleted > (indexed / 2)) { DoCompact(shouldStop); }
+        }
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Trigram index update error:" << e.GetMessage() << clEndl;
+        m_pendingPostings.clear();
+        try {
+            m_db.Rollback();
+        } catch(wxSQLite3Exception& e) {
+            wxUnusedVar(e);
+        }
+        // Do not retry
+        processed = files.size();
+    }
+    return processed;
+}
+
+void clTrigramIndex::DeleteFiles(const wxArrayString& files)
+{
+    if(!IsOpen()) { return; }
+    try {
+        m_db.Begin();
+        for(size_t i = 0; i < files.size(); ++i) {
+            wxLongLong fileID = GetFileID(files.Item(i));
+            if(fileID != wxNOT_FOUND) { DoDeleteFile(fileID); }
+        }
+        m_db.Commit();
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Trigram index delete error:" << e.GetMessage() << clEndl;
+        try {
+            m_db.Rollback();
+        } catch(wxSQLite3Exception& e) {
+            wxUnusedVar(e);
+        }
+    }
+}
+
+bool clTrigramIndex::GetLiterals(const wxString& pattern, bool isRegex, bool pipeSupport, wxArrayString& literals)
+{
+    literals.clear();
+    if(!isRegex) {
+        wxArrayString parts;
+        if(pipeSupport) {
+            parts = ::wxStringTokenize(pattern, "|", wxTOKEN_STRTOK);
+        } else {
+            parts.Add(pattern);
+        }
+        for(size_t i = 0; i < parts.size(); ++i) {
+            // Only ASCII sequences can be looked up: the index lower cases ASCII bytes only and
+            // the file encoding of non ASCII characters is unknown at this point
+            wxString run;
+            for(size_t n = 0; n < parts.Item(i).length(); ++n) {
+                wxUniChar ch = parts.Item(i)[n];
+                if(ch.IsAscii() && ch != '\n') {
+                    run << ch;
+                } else {
+                    if(run.length() >= 3) { literals.Add(run); }
+                    run.clear();
+                }
+            }
+            if(run.length() >= 3) { literals.Add(run); }
+        }
+        return !literals.IsEmpty();
+    }
+
+    // Simple regular expressions only: alternation and groups can make a literal optional
+    static const wxString unsupported = "|()";
+    static const wxString special = ".^$+";
+    wxString run;
+    auto addRun = [&]() {
+        if(run.length() >= 3) { literals.Add(run); }
+        run.clear();
+    };
+
+    for(size_t i = 0; i < pattern.length(); ++i) {
+        wxUniChar ch = pattern[i];
+        if(unsupported.Find(ch) != wxNOT_FOUND) {
+            literals.clear();
+            return false;
+        }
+
+        if(ch == '*' || ch == '?' || ch == '{') {
+            // The previous character is optional
+            if(!run.IsEmpty()) { run.RemoveLast(); }
+            addRun();
+            if(ch == '{') {
+                // Skip the repetition count
+                while(i < pattern.length() && pattern[i] != '}') {
+                    ++i;
+                }
+            }
+
+        } else if(ch == '[') {
+            // A character class: unknown character
+            addRun();
+            ++i;
+            if(i < pattern.length() && pattern[i] == ']') { ++i; }
+            while(i < pattern.length() && pattern[i] != ']') {
+                ++i;
+            }
+
+        } else if(ch == '\\') {
+            ++i;
+            if(i >= pattern.length()) { break; }
+            wxUniChar escaped = pattern[i];
+            if(escaped.IsAscii() && !wxIsalnum(escaped)) {
+                // An escaped literal, e.g. "\."
+                run << escaped;
+            } else {
+                // A class escape (\d, \w...) or a back reference
+                addRun();
+            }
+
+        } else if(special.Find(ch) != wxNOT_FOUND || !ch.IsAscii()) {
+            addRun();
+
+        } else {
+            run << ch;
+        }
+    }
+    addRun();
+    return !literals.IsEmpty();
+}
+
+bool clTrigramIndex::FilterFiles(const wxArrayString& literals, wxArrayString& files)
+{
+    if(!IsOpen() || literals.IsEmpty()) { return false; }
+
+    try {
+        // Collect the distinct trigrams of all the literals
+        std::unordered_set<int> trigrams;
+        for(size_t i = 0; i < literals.size(); ++i) {
+            const wxCharBuffer cb = literals.Item(i).mb_str(wxConvUTF8);
+            CollectTrigrams(cb.data(), strlen(cb.data()), trigrams);
+        }
+        if(trigrams.empty()) { return false; }
+
+        // Intersect the posting lists. The segments are read in order, so each list is sorted
+        std::vector<wxUint32> candidates;
+        bool first = true;
+        wxSQLite3Statement st = m_db.PrepareStatement("select FILE_IDS from POSTINGS where TRIGRAM=? order by SEGMENT");
+        for(int trigram : trigrams) {
+            std::vector<wxUint32> ids;
+            st.Bind(1, trigram);
+            {
+                wxSQLite3ResultSet res = st.ExecuteQuery();
+                while(res.NextRow()) {
+                    int len = 0;
+                    const unsigned char* blob = res.GetBlob(0, len);
+                    AppendPostings(blob, len, ids);
+                }
+            }
+            st.Reset();
+
+            if(first) {
+                candidates.swap(ids);
+                first = false;
+            } else {
+                std::vector<wxUint32> tmp;
+                std::set_intersection(candidates.begin(), candidates.end(), ids.begin(), ids.end(),
+                                      std::back_inserter(tmp));
+                candidates.swap(tmp);
+            }
+            if(candidates.empty()) { break; }
+        }
+
+        // Load the indexed files
+        std::unordered_map<wxString, IndexedFile> indexed;
+        wxSQLite3ResultSet res =
+            m_db.ExecuteQuery("select FILE_NAME, ID, LAST_MODIFIED, FILE_SIZE, CONTENT_HASH from FILES");
+        while(res.NextRow()) {
+            IndexedFile f;
+            ReadIndexedFile(res, 1, f);
+            indexed.insert({ res.GetString(0), f });
+        }
+
+        wxArrayString filtered;
+        filtered.reserve(files.size());
+        for(size_t i = 0; i < files.size(); ++i) {
+            const wxString& filename = files.Item(i);
+            auto iter = indexed.find(filename);
+            if(iter == indexed.end()) {
+                // Not indexed, we must search it
+                filtered.Add(filename);
+                continue;
+            }
+
+            wxUint32 fileID = (wxUint32)iter->second.id.GetValue();
+            bool isCandidate = std::binary_search(candidates.begin(), candidates.end(), fileID);
+            if(isCandidate || !IsUpToDate(filename, iter->second)) {
+                filtered.Add(filename);
+            }
+        }
+
+        clDEBUG() << "Trigram index: searching" << filtered.size() << "out of" << files.size() << "files" << clEndl;
+        files.swap(filtered);
+        return true;
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "Trigram index query error:" << e.GetMessage() << clEndl;
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+#ifndef CLTRIGRAMINDEX_H
+#define CLTRIGRAMINDEX_H
+
+#include "codelite_exports.h"
+#include "macros.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+#include <wx/wxsqlite3.h>
+
+/**
+ * @class clTrigramIndex
+ * @brief an on-disk index that maps every 3 bytes sequence (lower cased) to the list of files containing it.
+ * The index lives next to the workspace tags database and is used by the find in files to open only the
+ * files that can possibly contain the searched string.
+ * Each trigram keeps its file IDs as a sorted array (a "posting" blob), one row per 1024 file IDs
+ */
+class WXDLLIMPEXP_CL clTrigramIndex
+{
+public:
+    typedef std::function<bool()> StopCallback_t;
+
+protected:
+    wxSQLite3Database m_db;
+    // New postings that were not written yet, keyed by (segment, trigram)
+    std::unordered_map<wxInt64, std::vector<wxUint32> > m_pendingPostings;
+
+protected:
+    void CreateSchema();
+    wxString GetSchemaVersion();
+    wxLongLong GetFileID(const wxString& filename);
+    void DoDeleteFile(wxLongLong fileID);
+    bool DoIndexFile(const wxString& filename);
+    void DoFlushPostings();
+    bool DoCompact(const StopCallback_t& shouldStop);
+
+public:
+    clTrigramIndex();
+    virtual ~clTrigramIndex();
+
+    /**
+     * @brief return the index file that belongs to the given tags database
+     */
+    static wxFileName GetIndexFileName(const wxFileName& tagsDatabase);
+
+    /**
+     * @brief extract the literal strings that must all appear on a matching line
+     * @param pattern the searched string (including the '|' filters when pipe support is enabled)
+     * @param isRegex is pattern a regular expression?
+     * @param pipeSupport when set, everything after the first '|' is a list of filters that must also match
+     * @param literals [output]
+     * @return false if the pattern is too complex or does not contain a literal long enough to be looked up
+     */
+    static bool GetLiterals(const wxString& pattern, bool isRegex, bool pipeSupport, wxArrayString& literals);
+
+    bool Open(const wxFileName& indexFile);
+    void Close();
+    bool IsOpen() const { return m_db.IsOpen(); }
+
+    /**
+     * @brief (re)index the files that were modified since they were last indexed
+     * @param shouldStop called between files, when it returns true the update stops and keeps what was
+     * indexed so far
+     * @return the number of files processed. This is less than files.size() only when the update was stopped
+     */
+    size_t UpdateFiles(const wxArrayString& files, const StopCallback_t& shouldStop = StopCallback_t());
+
+    /**
+     * @brief remove files from the index
+     */
+    void DeleteFiles(const wxArrayString& files);
+
+    /**
+     * @brief remove from 'files' the entries that are known to the index, are up to date and can not contain all the
+     * literals. Files that are not indexed (or were modified since) are kept
+     * @return false if the index could not be used, in this case 'files' is left untouched
+     */
+    bool FilterFiles(const wxArrayString& literals, wxArrayString& files);
+};
+
+#endif // CLTRIGRAMINDEX_H
@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "cl_command_event.h"
+#include "clProcessOutputChannel.h"
 
 clCommandEvent::clCommandEvent(wxEventType commandType, int winid)
     : wxCommandEvent(commandType, winid)
@@ -415,24 +416,79 @@ clParseEvent& clParseEvent::operator=(const clParseEvent& src)
 // clProcessEvent
 //-------------------------------------------------------------------
 
-clProcessEvent::clProcessEvent(const clProcessEvent& event) { *this = event; }
+clProcessEvent::clProcessEvent(const clProcessEvent& event)
+    : m_outputDecoded(true)
+    , m_stream(0)
+    , m_process(NULL)
+{
+    *this = event;
+}
 
 clProcessEvent::clProcessEvent(wxEventType commandType, int winid)
     : clCommandEvent(commandType, winid)
+    , m_outputDecoded(true)
+    , m_stream(0)
     , m_process(NULL)
 {
 }
 
-clProcessEvent::~clProcessEvent() {}
+clProcessEvent::~clProcessEvent()
+{
+    // Nobody asked for the output: drop it, so the channel sends a new event for the next chunk
+    if(m_channel) { m_channel->Take((clProcessOutputChannel::eStream)m_stream); }
+}
 
 clProcessEvent& clProcessEvent::operator=(const clProcessEvent& src)
 {
     clCommandEvent::operator=(src);
     m_process = src.m_process;
+    // Only one event may take the output from the channel
+    src.DoTakeOutput();
     m_output = src.m_output;
+    m_outputBytes = src.m_outputBytes;
+    m_outputDecoded = src.m_outputDecoded;
+    m_channel.reset();
+    m_stream = src.m_stream;
     return *this;
 }
 
+void clProcessEvent::DoTakeOutput() const
+{
+    if(m_channel) {
+        m_outputBytes = m_channel->Take((clProcessOutputChannel::eStream)m_stream);
+        m_outputDecoded = false;
+        m_channel.reset();
+    }
+}
+
+const wxString& clProcessEvent::GetOutput() const
+{
+    if(m_channel) {
+        // Decode in the channel, it keeps a character that was split between two reads for the next event
+        m_output = m_channel->TakeString((clProcessOutputChannel::eStream)m_stream);
+        m_outputBytes.clear();
+        m_outputDecoded = true;
+        m_channel.reset();
+    }
+    DoTakeOutput();
+    if(!m_outputDecoded) {
+        m_output = clProcessOutputChannel::Decode(m_outputBytes);
+        m_outputDecoded = true;
+    }
+    return m_output;
+}
+
+const std::string& clProcessEvent::GetOutputBytes() const
+{
+    DoTakeOutput();
+    if(m_outputBytes.empty() && !m_output.IsEmpty()) {
+        // The output was set as a string
+        const wxCharBuffer cb = m_output.mb_str(wxConvUTF8);
+        m_outputBytes.assign(cb.data(), cb.length());
+    }
+    return m_outputBytes;
+}
+
 // --------------------------------------------------------------
 // Compiler event
 // --------------------------------------------------------------
@@ -472,3 +528,31 @@ clGotoEvent& clGotoEvent::operator=(const clGotoEvent& src)
     m_entry = src.m_entry;
     return *this;
 }
+
+// --------------------------------------------------------------
+// Editor text changed event
+// --------------------------------------------------------------
+clEditorTextChangedEvent::clEditorTextChangedEvent(wxEventType commandType, int winid)
+    : clCommandEvent(commandType, winid)
+    , m_startLine(0)
+    , m_startColumn(0)
+    , m_endLine(0)
+    , m_endColumn(0)
+{
+}
+
+clEditorTextChangedEvent::clEditorTextChangedEvent(const clEditorTextChangedEvent& src) { *this = src; }
+
+clEditorTextChangedEvent::~clEditorTextChangedEvent() {}
+
+clEditorTextChangedEvent& clEditorTextChangedEvent::operator=(const clEditorTextChangedEvent& src)
+{
+    if(this == &src) { return *this; }
+    clCommandEvent::operator=(src);
+    m_startLine = src.m_startLine;
+    m_startColumn = src.m_startColumn;
+    m_endLine = src.m_endLine;
+    m_endColumn = src.m_endColumn;
+    m_text = src.m_text;
+    return *this;
+}
@@ -31,6 +31,8 @@
 #include "codelite_exports.h"
 #include "entry.h"
 #include "wxCodeCompletionBoxEntry.h"
+#include <memory>
+#include <string>
 #include <vector>
 #include <wx/arrstr.h>
 #include <wx/event.h>
@@ -516,11 +518,19 @@ typedef void (wxEvtHandler::*clGotoEventFunction)(clGotoEvent&);
 // Processs event
 // --------------------------------------------------------------
 class IProcess;
+class clProcessOutputChannel;
 class WXDLLIMPEXP_CL clProcessEvent : public clCommandEvent
 {
-    wxString m_output;
+    mutable wxString m_output;
+    mutable std::string m_outputBytes;
+    mutable bool m_outputDecoded;
+    mutable std::shared_ptr<clProcessOutputChannel> m_channel;
+    int m_stream;
     IProcess* m_process;
 
+protected:
+    void DoTakeOutput() const;
+
 public:
     clProcessEvent(wxEventType commandType = wxEVT_NULL, int winid = 0);
     clProcessEvent(const clProcessEvent& event);
@@ -528,9 +538,32 @@ public:
     virtual ~clProcessEvent();
     virtual wxEvent* Clone() const { return new clProcessEvent(*this); }
 
-    void SetOutput(const wxString& output) { this->m_output = output; }
+    void SetOutput(const wxString& output)
+    {
+        this->m_output = output;
+        this->m_outputBytes.clear();
+        this->m_outputDecoded = true;
+        this->m_channel.reset();
+    }
+    /**
+     * @brief the output is taken from 'channel' the first time GetOutput() or GetOutputBytes() is called, so it
+     * includes everything the process wrote until the event was handled. Copying the event takes the output as well
+     */
+    void SetOutputChannel(std::shared_ptr<clProcessOutputChannel> channel, int stream)
+    {
+        this->m_channel = channel;
+        this->m_stream = stream;
+    }
     void SetProcess(IProcess* process) { this->m_process = process; }
-    const wxString& GetOutput() const { return m_output; }
+    /**
+     * @brief the process output, decoded as UTF-8 (or as 8 bit data if it is not valid UTF-8). A character that
+     * the process did not finish writing yet is delivered with the next event
+     */
+    const wxString& GetOutput() const;
+    /**
+     * @brief the process output, exactly as the process wrote it. Use this for protocols that count bytes
+     */
+    const std::string& GetOutputBytes() const;
     IProcess* GetProcess() { return m_process; }
 };
 
@@ -727,4 +760,48 @@ public:
 typedef void (wxEvtHandler::*clEditorConfigEventFunction)(clEditorConfigEvent&);
 #define clEditorConfigEventHandler(func) wxEVENT_HANDLER_CAST(clEditorConfigEventFunction, func)
 
+// --------------------------------------------------------------
+// Editor text changed event
+// --------------------------------------------------------------
+/**
+ * @brief a text insertion or deletion in an editor. The range is expressed in the coordinates of the document
+ * before the change (0 based lines and columns). For an insertion, the range is empty and GetText() returns the
+ * inserted text. For a deletion, GetText() is empty
+ */
+class WXDLLIMPEXP_CL clEditorTextChangedEvent : public clCommandEvent
+{
+    int m_startLine;
+    int m_startColumn;
+    int m_endLine;
+    int m_endColumn;
+    wxString m_text;
+
+public:
+    clEditorTextChangedEvent(wxEventType commandType = wxEVT_NULL, int winid = 0);
+    clEditorTextChangedEvent(const clEditorTextChangedEvent& src);
+    clEditorTextChangedEvent& operator=(const clEditorTextChangedEvent& src);
+    virtual ~clEditorTextChangedEvent();
+    virtual wxEvent* Clone() const { return new clEditorTextChangedEvent(*this); }
+
+    void SetStart(int line, int column)
+    {
+        m_startLine = line;
+        m_startColumn = column;
+    }
+    void SetEnd(int line, int column)
+    {
+        m_endLine = line;
+        m_endColumn = column;
+    }
+    void SetText(const wxString& text) { this->m_text = text; }
+    int GetStartLine() const { return m_startLine; }
+    int GetStartColumn() const { return m_startColumn; }
+    int GetEndLine() const { return m_endLine; }
+    int GetEndColumn() const { return m_endColumn; }
+    const wxString& GetText() const { return m_text; }
+};
+
+typedef void (wxEvtHandler::*clEditorTextChangedEventFunction)(clEditorTextChangedEvent&);
+#define clEditorTextChangedEventHandler(func) wxEVENT_HANDLER_CAST(clEditorTextChangedEventFunction, func)
+
 #endif // CLCOMMANDEVENT_H
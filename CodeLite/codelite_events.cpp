@@ -153,6 +153,7 @@ wxDEFINE_EVENT(wxEVT_FILE_CLOSED, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_CL_FRAME_TITLE, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_BEFORE_EDITOR_SAVE, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_EDITOR_MODIFIED, clCommandEvent);
+wxDEFINE_EVENT(wxEVT_EDITOR_TEXT_CHANGED, clEditorTextChangedEvent);
 wxDEFINE_EVENT(wxEVT_CLANG_CODE_COMPLETE_MESSAGE, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_GOING_DOWN, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_PROJ_RENAMED, clCommandEvent);
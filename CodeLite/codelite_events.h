@@ -717,6 +717,12 @@ wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_BEFORE_EDITOR_SAVE, clCommandEven
 // Editor has been modified. Use event.GetFilename() to get the file name of the editor
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_EDITOR_MODIFIED, clCommandEvent);
 
+// Event: clEditorTextChangedEvent
+// Text was inserted into (or deleted from) an editor by the user. Use event.GetFileName() to get the file name
+// of the editor and event.GetStartLine()/GetEndLine()... to get the modified range.
+// This event is not sent while the editor (re)loads its file: a wxEVT_FILE_LOADED event follows instead
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_EDITOR_TEXT_CHANGED, clEditorTextChangedEvent);
+
 // Event: clCommandEvent
 // Sent when clang code completion encountered an error
 // use: event.GetString() to get the error message
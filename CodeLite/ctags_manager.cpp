@@ -29,6 +29,7 @@
 #include "cl_indexer_reply.h"
 #include "cl_indexer_request.h"
 #include "cl_standard_paths.h"
+#include "clSymbolIndex.h"
 #include "clindexerprotocol.h"
 #include "code_completion_api.h"
 #include "codelite_exports.h"
@@ -50,8 +51,12 @@
 #include "wx/tokenzr.h"
 #include "wxStringHash.h"
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <wx/app.h>
 #include <wx/busyinfo.h>
 #include <wx/file.h>
@@ -114,6 +119,57 @@ struct tagParseResult {
     wxString fileName;
 };
 
+// Maximum number of indexer processes used for parsing in parallel
+#define MAX_INDEXER_POOL_SIZE 8
+
+// How many files the indexers may parse ahead of the (single) consumer
+#define INDEXER_QUEUE_WINDOW 256
+
+/**
+ * @brief return the unique string that identifies indexer 'index' of this process.
+ * The main indexer uses our PID, the pool indexers use PID_<index>
+ */
+static wxString GetIndexerChannelId(size_t index)
+{
+    wxString id;
+    id << wxGetProcessId();
+    if(index) { id << "_" << index; }
+    return id;
+}
+
+static std::string GetIndexerChannelName(size_t index)
+{
+    char channel_name[1024];
+    memset(channel_name, 0, sizeof(channel_name));
+    sprintf(channel_name, PIPE_NAME, GetIndexerChannelId(index).mb_str(wxConvUTF8).data());
+    return channel_name;
+}
+
+/**
+ * @class clIndexerJobQueue
+ * @brief the state shared between the indexer pool threads and the consumer of their output
+ */
+class clIndexerJobQueue
+{
+public:
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<wxString> m_results;
+    std::vector<char> m_ready;
+    size_t m_next;     // next file to send to an indexer
+    size_t m_consumed; // number of files handed to the callback
+    bool m_stop;
+
+    clIndexerJobQueue(size_t count)
+        : m_results(count)
+        , m_ready(count, 0)
+        , m_next(0)
+        , m_consumed(0)
+        , m_stop(false)
+    {
+    }
+};
+
 //////////////////////////////////////
 // Adapter class to TagsManager
 //////////////////////////////////////
@@ -140,6 +196,8 @@ TagsManager::TagsManager()
     : wxEvtHandler()
     , m_codeliteIndexerPath(wxT("codelite_indexer"))
     , m_codeliteIndexerProcess(NULL)
+    , m_indexerPoolSize(0)
+    , m_indexerPoolUsers(0)
     , m_canRestartIndexer(true)
     , m_lang(NULL)
     , m_evtHandler(NULL)
@@ -159,34 +217,42 @@ TagsManager::TagsManager()
     m_CppIgnoreKeyWords.insert(wxT("for"));
     m_CppIgnoreKeyWords.insert(wxT("switch"));
     m_symbolsCache.reset(new clCxxFileCacheSymbols());
+
+    // One indexer per core (the main indexer included)
+    int cpus = wxThread::GetCPUCount();
+    if(cpus > 1) { m_indexerPoolSize = (size_t)std::min(cpus, MAX_INDEXER_POOL_SIZE) - 1; }
 }
 
 TagsManager::~TagsManager()
 {
     m_symbolsCache.reset(nullptr);
-    if(m_codeliteIndexerProcess) {
 
-        // Dont kill the indexer process, just terminate the
-        // reader-thread (this is done by deleting the indexer object)
-        m_canRestartIndexer = false;
+    // Dont kill the indexer process, just terminate the
+    // reader-thread (this is done by deleting the indexer object)
+    m_canRestartIndexer = false;
 
+    std::vector<IProcess*> indexers;
+    indexers.push_back(m_codeliteIndexerProcess);
+    {
+        std::lock_guard<std::mutex> lk(m_indexerPoolMutex);
+        indexers.insert(indexers.end(), m_indexerPool.begin(), m_indexerPool.end());
+        m_indexerPool.clear();
+    }
+    for(size_t i = 0; i < indexers.size(); ++i) {
+        if(!indexers[i]) { continue; }
 #ifndef __WXMSW__
-        m_codeliteIndexerProcess->Terminate();
+        indexers[i]->Terminate();
 #endif
-        delete m_codeliteIndexerProcess;
+        delete indexers[i];
 
 #ifndef __WXMSW__
         // Clear the socket file
-        std::stringstream s;
-        s << wxGetProcessId();
-
-        char channel_name[1024];
-        memset(channel_name, 0, sizeof(channel_name));
-        sprintf(channel_name, PIPE_NAME, s.str().c_str());
-        ::unlink(channel_name);
-        ::remove(channel_name);
+        std::string channel_name = GetIndexerChannelName(i);
+        ::unlink(channel_name.c_str());
+        ::remove(channel_name.c_str());
 #endif
     }
+    m_codeliteIndexerProcess = NULL;
 }
 
 void TagsManager::OpenDatabase(const wxFileName& fileName)
@@ -214,6 +280,10 @@ void TagsManager::OpenDatabase(const wxFileName& fileName)
             m_evtHandler->ProcessEvent(event);
         }
     }
+
+    // Build the in-memory symbol index in the background
+    clSymbolIndex::Get().Load(fileName);
+
 #if wxUSE_GUI
     if(retagIsRequired && m_evtHandler) {
         wxCommandEvent e(wxEVT_COMMAND_MENU_SELECTED, XRCID("retag_workspace"));
@@ -296,24 +366,61 @@ void TagsManager::StartCodeLiteIndexer()
 {
     if(!m_canRestartIndexer) return;
 
-    // Run ctags process
-    wxString cmd;
-    wxString ctagsCmd;
-
-    // build the command, we surround ctags name with double quatations
-    wxString uid;
-    uid << wxGetProcessId();
-
     if(m_codeliteIndexerPath.FileExists() == false) {
         CL_ERROR(wxT("ERROR: Could not locate indexer: %s"), m_codeliteIndexerPath.GetFullPath().c_str());
         m_codeliteIndexerProcess = NULL;
         return;
     }
 
+    if(!m_codeliteIndexerProcess) { m_codeliteIndexerProcess = DoStartIndexer(0); }
+}
+
+void TagsManager::DoStartIndexerPool()
+{
+    // Only the missing processes are started
+    std::lock_guard<std::mutex> lk(m_indexerPoolMutex);
+    ++m_indexerPoolUsers;
+    if(!m_canRestartIndexer || !m_codeliteIndexerPath.FileExists()) { return; }
+    m_indexerPool.resize(m_indexerPoolSize, NULL);
+    for(size_t i = 0; i < m_indexerPool.size(); ++i) {
+        if(!m_indexerPool[i]) { m_indexerPool[i] = DoStartIndexer(i + 1); }
+    }
+}
+
+void TagsManager::DoStopIndexerPool()
+{
+    // The processes are deleted by OnIndexerTerminated()
+    std::lock_guard<std::mutex> lk(m_indexerPoolMutex);
+    if(m_indexerPoolUsers == 0 || --m_indexerPoolUsers > 0) { return; }
+    for(size_t i = 0; i < m_indexerPool.size(); ++i) {
+        if(m_indexerPool[i]) { m_indexerPool[i]->Terminate(); }
+    }
+}
+
+bool TagsManager::DoWaitForIndexer(size_t channel)
+{
+    std::string channel_name = GetIndexerChannelName(channel);
+    for(size_t i = 0; i < 100; ++i) {
+        clNamedPipeClient client(channel_name.c_str());
+        if(client.connect()) { return true; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    clWARNING() << "Indexer" << GetIndexerChannelId(channel) << "is not responding" << clEndl;
+    return false;
+}
+
+IProcess* TagsManager::DoStartIndexer(size_t index)
+{
+    // build the command, we surround ctags name with double quatations
     // concatenate the PID to identifies this channel to this instance of codelite
-    cmd << wxT("\"") << m_codeliteIndexerPath.GetFullPath() << wxT("\" ") << uid << wxT(" --pid");
-    m_codeliteIndexerProcess =
-        CreateAsyncProcess(this, cmd, IProcessCreateDefault, clStandardPaths::Get().GetUserDataDir());
+    wxString cmd;
+    cmd << wxT("\"") << m_codeliteIndexerPath.GetFullPath() << wxT("\" ") << GetIndexerChannelId(index)
+        << wxT(" --pid");
+    if(index) {
+        // The channel ID is not our PID, pass it explicitly
+        cmd << wxT(" ") << wxGetProcessId();
+    }
+    return CreateAsyncProcess(this, cmd, IProcessCreateDefault, clStandardPaths::Get().GetUserDataDir());
 }
 
 void TagsManager::RestartCodeLiteIndexer()
@@ -328,24 +435,103 @@ void TagsManager::SetCodeLiteIndexerPath(const wxString& path) { m_codeliteIndex
 
 void TagsManager::OnIndexerTerminated(clProcessEvent& event)
 {
-    wxUnusedVar(event);
-    wxDELETE(m_codeliteIndexerProcess);
-    StartCodeLiteIndexer();
+    IProcess* process = event.GetProcess();
+    if(process == m_codeliteIndexerProcess) {
+        wxDELETE(m_codeliteIndexerProcess);
+        StartCodeLiteIndexer();
+        return;
+    }
+
+    // A pool indexer: restart it only while a retag is using the pool
+    std::lock_guard<std::mutex> lk(m_indexerPoolMutex);
+    std::vector<IProcess*>::iterator iter = std::find(m_indexerPool.begin(), m_indexerPool.end(), process);
+    if(iter == m_indexerPool.end()) { return; }
+    wxDELETE(*iter);
+    if(m_indexerPoolUsers && m_canRestartIndexer) { *iter = DoStartIndexer((iter - m_indexerPool.begin()) + 1); }
 }
 
 //---------------------------------------------------------------------
 // Parsing
 //---------------------------------------------------------------------
-void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
+void TagsManager::SourceToTags(const wxFileName& source, wxString& tags) { DoSourceToTags(source, tags, 0); }
+
+void TagsManager::SourceToTags(const std::vector<wxFileName>& files, const SourceToTagsCallback_t& callback)
 {
-    std::stringstream s;
-    s << wxGetProcessId();
+    size_t channels = std::min(m_indexerPoolSize + 1, files.size());
+    if(channels < 2) {
+        for(size_t i = 0; i < files.size(); ++i) {
+            wxString tags;
+            SourceToTags(files[i], tags);
+            if(!callback(i, tags)) { break; }
+        }
+        return;
+    }
 
-    char channel_name[1024];
-    memset(channel_name, 0, sizeof(channel_name));
-    sprintf(channel_name, PIPE_NAME, s.str().c_str());
+    // The extra indexers only live for the duration of this call (and of the calls nested in 'callback')
+    DoStartIndexerPool();
+
+    // Every thread owns a connection to a different indexer process and pulls files from the shared queue.
+    // The results are handed to the callback from this thread, in the original order
+    clIndexerJobQueue queue(files.size());
+    std::vector<std::thread*> threads;
+    for(size_t channel = 0; channel < channels; ++channel) {
+        threads.push_back(new std::thread([this, channel, &files, &queue]() {
+            // A pool indexer that fails to start leaves its share of the files to the other channels
+            if(channel && !DoWaitForIndexer(channel)) { return; }
+            while(true) {
+                size_t index = 0;
+                {
+                    std::unique_lock<std::mutex> lk(queue.m_mutex);
+                    queue.m_cv.wait(lk, [&queue]() {
+                        return queue.m_stop || queue.m_next < (queue.m_consumed + INDEXER_QUEUE_WINDOW);
+                    });
+                    if(queue.m_stop || queue.m_next >= files.size()) { break; }
+                    index = queue.m_next++;
+                }
+
+                wxString tags;
+                // A pool indexer might be restarting, fallback to the main indexer
+                if(!DoSourceToTags(files[index], tags, channel) && channel) { DoSourceToTags(files[index], tags, 0); }
+                {
+                    std::lock_guard<std::mutex> lk(queue.m_mutex);
+                    queue.m_results[index].swap(tags);
+                    queue.m_ready[index] = 1;
+                }
+                queue.m_cv.notify_all();
+            }
+        }));
+    }
 
-    clNamedPipeClient client(channel_name);
+    for(size_t i = 0; i < files.size(); ++i) {
+        wxString tags;
+        {
+            std::unique_lock<std::mutex> lk(queue.m_mutex);
+            queue.m_cv.wait(lk, [&queue, i]() { return queue.m_ready[i] != 0; });
+            tags.swap(queue.m_results[i]);
+            queue.m_consumed = i + 1;
+        }
+        queue.m_cv.notify_all();
+
+        if(!callback(i, tags)) { break; }
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(queue.m_mutex);
+        queue.m_stop = true;
+    }
+    queue.m_cv.notify_all();
+
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+        wxDELETE(threads[i]);
+    }
+    DoStopIndexerPool();
+}
+
+bool TagsManager::DoSourceToTags(const wxFileName& source, wxString& tags, size_t channel)
+{
+    std::string channel_name = GetIndexerChannelName(channel);
+    clNamedPipeClient client(channel_name.c_str());
 
     // Build a request for the indexer
     clIndexerRequest req;
@@ -366,14 +552,14 @@ void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
     clDEBUG1() << "Sending CTAGS command:" << ctagsCmd << clEndl;
     // connect to the indexer
     if(!client.connect()) {
-        clWARNING() << "Failed to connect to indexer process. Indexer ID:" << wxGetProcessId() << clEndl;
-        return;
+        clWARNING() << "Failed to connect to indexer process. Indexer ID:" << GetIndexerChannelId(channel) << clEndl;
+        return false;
     }
 
     // send the request
     if(!clIndexerProtocol::SendRequest(&client, req)) {
-        clWARNING() << "Failed to send request to indexer. Indexer ID:" << wxGetProcessId() << clEndl;
-        return;
+        clWARNING() << "Failed to send request to indexer. Indexer ID:" << GetIndexerChannelId(channel) << clEndl;
+        return false;
     }
 
     // read the reply
@@ -383,13 +569,14 @@ void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
         std::string errmsg;
         if(!clIndexerProtocol::ReadReply(&client, reply, errmsg)) {
             clWARNING() << "Failed to read indexer reply: " << (wxString() << errmsg) << clEndl;
-            RestartCodeLiteIndexer();
-            return;
+            // A pool indexer is restarted once it exits
+            if(channel == 0) { RestartCodeLiteIndexer(); }
+            return false;
         }
     } catch(std::bad_alloc& ex) {
         clWARNING() << "std::bad_alloc exception caught" << clEndl;
         tags.Clear();
-        return;
+        return true;
     }
 
     clDEBUG1() << "SourceToTags: [" << reply.getTags() << "]" << clEndl;
@@ -402,6 +589,7 @@ void TagsManager::SourceToTags(const wxFileName& source, wxString& tags)
     if(tags.empty()) { tags = wxString::From8BitData(reply.getTags().c_str()); }
 
     clDEBUG1() << "Tags:\n" << tags << clEndl;
+    return true;
 }
 
 TagTreePtr TagsManager::TreeFromTags(const wxString& tags, int& count)
@@ -1645,6 +1833,9 @@ void TagsManager::GetFunctionTipFromTags(const std::vector<TagEntryPtr>& tags, c
 
 void TagsManager::CloseDatabase()
 {
+    // Requests queued for this database are obsolete now
+    if(m_dbFile.IsOk()) { ParseThreadST::Get()->CancelRequests(m_dbFile.GetFullPath()); }
+    clSymbolIndex::Get().Clear();
     m_dbFile.Clear();
     m_db = NULL; // Free the current database
     m_db = new TagsStorageSQLite();
@@ -2224,11 +2415,12 @@ void TagsManager::DeleteTagsByFilePrefix(const wxString& dbfileName, const wxStr
     delete db;
 }
 
-void TagsManager::UpdateFilesRetagTimestamp(const wxArrayString& files, ITagsStoragePtr db)
+void TagsManager::UpdateFilesRetagTimestamp(const wxArrayString& files, const wxArrayString& contentHashes,
+                                            ITagsStoragePtr db)
 {
     db->Begin();
     for(size_t i = 0; i < files.GetCount(); i++) {
-        db->InsertFileEntry(files.Item(i), (int)time(NULL));
+        db->InsertFileEntry(files.Item(i), (int)time(NULL), contentHashes.Item(i));
     }
     db->Commit();
 }
@@ -2238,6 +2430,7 @@ void TagsManager::FilterNonNeededFilesForRetaging(wxArrayString& strFiles, ITags
     std::vector<FileEntryPtr> files_entries;
     db->GetFiles(files_entries);
     std::unordered_set<wxString> files_set;
+    std::vector<FileEntryPtr> touchedFiles;
 
     for(size_t i = 0; i < strFiles.GetCount(); i++) {
         files_set.insert(strFiles.Item(i));
@@ -2257,8 +2450,26 @@ void TagsManager::FilterNonNeededFilesForRetaging(wxArrayString& strFiles, ITags
             if(stat(cname.data(), &buff) == 0) { modified = (int)buff.st_mtime; }
 
             // if the timestamp from the database < then the actual timestamp, re-tag the file
-            if(fe->GetLastRetaggedTimestamp() >= modified) { files_set.erase(iter); }
+            if(fe->GetLastRetaggedTimestamp() >= modified) {
+                files_set.erase(iter);
+
+            } else if(!fe->GetContentHash().IsEmpty() &&
+                      fe->GetContentHash() == FileUtils::GetFileContentHash(fe->GetFile())) {
+                // The file was touched (e.g. branch switch) but its content did not change
+                files_set.erase(iter);
+                touchedFiles.push_back(fe);
+            }
+        }
+    }
+
+    // Update the timestamp of the touched files so we won't need to hash them again
+    if(!touchedFiles.empty()) {
+        clDEBUG() << "Skipping retag of" << touchedFiles.size() << "unmodified files" << clEndl;
+        db->Begin();
+        for(size_t i = 0; i < touchedFiles.size(); i++) {
+            db->UpdateFileEntry(touchedFiles[i]->GetFile(), (int)time(NULL), touchedFiles[i]->GetContentHash());
         }
+        db->Commit();
     }
 
     // copy back the files to the array
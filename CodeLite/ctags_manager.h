@@ -45,6 +45,8 @@
 #include "wx/event.h"
 #include "wx/process.h"
 #include "wxStringHash.h"
+#include <functional>
+#include <mutex>
 #include <set>
 #include <wx/stopwatch.h>
 #include <wx/thread.h>
@@ -139,12 +141,21 @@ public:
     enum RetagType { Retag_Full, Retag_Quick, Retag_Quick_No_Scan };
     enum eLanguage { kCxx, kJavaScript };
 
+    /**
+     * @brief called by SourceToTags() with the ctags output of every file. Return false to stop
+     */
+    typedef std::function<bool(size_t, const wxString&)> SourceToTagsCallback_t;
+
 public:
     wxCriticalSection m_crawlerLocker;
 
 private:
     wxFileName m_codeliteIndexerPath;
     IProcess* m_codeliteIndexerProcess;
+    std::vector<IProcess*> m_indexerPool;
+    size_t m_indexerPoolSize;
+    size_t m_indexerPoolUsers;
+    std::mutex m_indexerPoolMutex;
     wxString m_ctagsCmd;
     wxStopWatch m_watch;
     TagsOptionsData m_tagsOptions;
@@ -294,7 +305,8 @@ public:
     void Delete(const wxFileName& path, const wxString& fileName);
 
     /**
-     * Start a codelite_indexer process
+     * Start a codelite_indexer process. The indexers pool is only started for the duration of a
+     * multi-file SourceToTags()
      */
     void StartCodeLiteIndexer();
 
@@ -532,6 +544,16 @@ public:
      */
     void SourceToTags(const wxFileName& source, wxString& tags);
 
+    /**
+     * @brief parse a list of files using a pool of indexers in parallel. The pool is started on demand and
+     * stopped once all the files were parsed.
+     * 'callback' is called from the calling thread, in the order of 'files'. This allows the caller
+     * to store the results (the only writer to the database) while the next files are being parsed
+     * @param files the files to parse
+     * @param callback called with the file index and its ctags output
+     */
+    void SourceToTags(const std::vector<wxFileName>& files, const SourceToTagsCallback_t& callback);
+
     /**
      * return list of files from the database(s). The returned list is ordered
      * by name (ascending)
@@ -772,9 +794,10 @@ public:
     /**
      * @brief update the 'last_retagged' column in the 'files' table for the current timestamp
      * @param files list of files
+     * @param contentHashes the content hash of each file, taken before the files were parsed
      * @brief db    database to use
      */
-    void UpdateFilesRetagTimestamp(const wxArrayString& files, ITagsStoragePtr db);
+    void UpdateFilesRetagTimestamp(const wxArrayString& files, const wxArrayString& contentHashes, ITagsStoragePtr db);
 
     /**
      * @brief accept as input ctags pattern of a function and tries to evaluate the
@@ -845,6 +868,31 @@ protected:
      */
     void OnIndexerTerminated(clProcessEvent& event);
 
+    /**
+     * @brief start an indexer process. Index 0 is the main indexer, the others are used
+     * by the parallel SourceToTags()
+     */
+    IProcess* DoStartIndexer(size_t index);
+
+    /**
+     * @brief start (stop) the extra indexers used by the parallel SourceToTags()
+     * SourceToTags() can run nested (a file saved while a retag serves the interactive requests), so the pool is
+     * reference counted: it is stopped when its last user is done with it
+     */
+    void DoStartIndexerPool();
+    void DoStopIndexerPool();
+
+    /**
+     * @brief wait until the indexer listening on 'channel' accepts connections
+     * @return false if it did not within a few seconds
+     */
+    bool DoWaitForIndexer(size_t channel);
+
+    /**
+     * @brief send a file to the indexer listening on 'channel'
+     */
+    bool DoSourceToTags(const wxFileName& source, wxString& tags, size_t channel);
+
 private:
     /**
      * Construct a TagsManager object, for internal use
@@ -25,13 +25,275 @@
 
 #include "cl_standard_paths.h"
 #include "file_logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdlib.h>
+#include <string>
 #include <sys/time.h>
+#include <thread>
 #include <wx/crt.h>
+#include <wx/filefn.h>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/stdpaths.h>
 #include <wx/utils.h>
 
+// Number of lines that can wait for the writer thread (must be a power of 2)
+#define LOG_QUEUE_SIZE 8192
+
+// Maximum number of lines written in a single write
+#define LOG_BATCH_SIZE 512
+
+// Default size of the log file before it is rotated
+#define LOG_MAX_FILE_SIZE (10 * 1024 * 1024)
+
+/**
+ * @class FileLoggerQueue
+ * @brief a bounded, lock free, multiple producers / single consumer queue of log lines
+ */
+class FileLoggerQueue
+{
+    struct Slot {
+        std::atomic<size_t> m_seq;
+        std::string m_line;
+    };
+
+    Slot* m_slots;
+    std::atomic<size_t> m_head;
+    size_t m_tail; // only accessed by the consumer
+
+public:
+    FileLoggerQueue()
+        : m_slots(new Slot[LOG_QUEUE_SIZE])
+        , m_head(0)
+        , m_tail(0)
+    {
+        for(size_t i = 0; i < LOG_QUEUE_SIZE; ++i) {
+            m_slots[i].m_seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~FileLoggerQueue() { delete[] m_slots; }
+
+    /**
+     * @brief add a line to the queue (any thread). On success, 'line' is left empty
+     * @return false if the queue is full
+     */
+    bool Push(std::string& line)
+    {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        Slot* slot = NULL;
+        while(true) {
+            slot = &m_slots[pos & (LOG_QUEUE_SIZE - 1)];
+            size_t seq = slot->m_seq.load(std::memory_order_acquire);
+            long diff = (long)seq - (long)pos;
+            if(diff == 0) {
+                // the slot is free, try to claim it
+                if(m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+            } else if(diff < 0) {
+                // the consumer did not release this slot yet: full
+                return false;
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->m_line.swap(line);
+        slot->m_seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief take the oldest line from the queue (writer thread only)
+     */
+    bool Pop(std::string& line)
+    {
+        Slot& slot = m_slots[m_tail & (LOG_QUEUE_SIZE - 1)];
+        if(slot.m_seq.load(std::memory_order_acquire) != (m_tail + 1)) { return false; }
+        line.swap(slot.m_line);
+        slot.m_line.clear();
+        slot.m_seq.store(m_tail + LOG_QUEUE_SIZE, std::memory_order_release);
+        ++m_tail;
+        return true;
+    }
+};
+
+/**
+ * @class FileLoggerWriter
+ * @brief the thread that owns the log file. It collects the queued lines and writes them in batches
+ */
+class FileLoggerWriter
+{
+    FileLoggerQueue m_queue;
+    std::thread* m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    wxString m_filename; // protected by m_mutex
+    bool m_filenameChanged;
+    std::atomic_bool m_stop;
+    std::atomic_bool m_running;
+    std::atomic<size_t> m_dropped;
+    std::atomic<size_t> m_maxFileSize;
+    FILE* m_fp;
+    size_t m_fileSize;
+
+protected:
+    void DoOpenFile()
+    {
+        wxString filename;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            filename = m_filename;
+            m_filenameChanged = false;
+        }
+        if(m_fp) { fclose(m_fp); }
+        m_fp = filename.IsEmpty() ? NULL : wxFopen(filename, wxT("a+"));
+        m_fileSize = 0;
+        if(m_fp) {
+            fseek(m_fp, 0, SEEK_END);
+            long size = ftell(m_fp);
+            m_fileSize = (size > 0) ? (size_t)size : 0;
+        }
+    }
+
+    void DoRotate()
+    {
+        wxString filename;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            filename = m_filename;
+        }
+        fclose(m_fp);
+        m_fp = NULL;
+
+        wxString backup = filename + ".1";
+        if(wxFileExists(backup)) { wxRemoveFile(backup); }
+        wxRenameFile(filename, backup);
+        DoOpenFile();
+    }
+
+    void DoWrite(const std::string& buffer)
+    {
+        if(m_fp == NULL || buffer.empty()) { return; }
+        fwrite(buffer.c_str(), 1, buffer.length(), m_fp);
+        fflush(m_fp);
+        m_fileSize += buffer.length();
+        if(m_fileSize > m_maxFileSize.load()) { DoRotate(); }
+    }
+
+    void Main()
+    {
+        std::string line;
+        std::string batch;
+        size_t droppedReported = 0;
+        while(true) {
+            // wait until a producer has something for us (or for the next poll)
+            bool stop = m_stop.load();
+            bool reopen = false;
+            {
+                std::unique_lock<std::mutex> lk(m_mutex);
+                if(!stop) {
+                    m_cv.wait_for(lk, std::chrono::milliseconds(100));
+                    stop = m_stop.load();
+                }
+                reopen = m_filenameChanged;
+            }
+            if(reopen) { DoOpenFile(); }
+
+            // drain the queue, a batch at a time
+            size_t count = 0;
+            do {
+                count = 0;
+                while(count < LOG_BATCH_SIZE && m_queue.Pop(line)) {
+                    batch.append(line);
+                    ++count;
+                }
+
+                size_t dropped = m_dropped.load();
+                if(dropped != droppedReported) {
+                    batch.append(FileLogger::Prefix(FileLogger::System).mb_str(wxConvUTF8).data());
+                    batch.append(" FileLogger: ")
+                        .append(std::to_string(dropped - droppedReported))
+                        .append(" log lines were dropped\n");
+                    droppedReported = dropped;
+                }
+                DoWrite(batch);
+                batch.clear();
+            } while(count == LOG_BATCH_SIZE);
+
+            if(stop) { break; }
+        }
+
+        if(m_fp) {
+            fclose(m_fp);
+            m_fp = NULL;
+        }
+    }
+
+public:
+    FileLoggerWriter()
+        : m_thread(NULL)
+        , m_filenameChanged(false)
+        , m_stop(false)
+        , m_running(false)
+        , m_dropped(0)
+        , m_maxFileSize(LOG_MAX_FILE_SIZE)
+        , m_fp(NULL)
+        , m_fileSize(0)
+    {
+    }
+
+    ~FileLoggerWriter() { Stop(); }
+
+    static FileLoggerWriter& Get()
+    {
+        // Never deleted: loggers might be used by static objects destructors
+        static FileLoggerWriter* writer = new FileLoggerWriter();
+        return *writer;
+    }
+
+    void SetFileName(const wxString& filename)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_filename = filename;
+            m_filenameChanged = true;
+            if(m_thread || m_stop.load()) { return; }
+            m_running.store(true);
+            m_thread = new std::thread(&FileLoggerWriter::Main, this);
+        }
+    }
+
+    void Stop()
+    {
+        std::thread* thread = NULL;
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_running.store(false);
+            m_stop.store(true);
+            std::swap(thread, m_thread);
+        }
+        m_cv.notify_one();
+        if(thread) {
+            thread->join();
+            wxDELETE(thread);
+        }
+    }
+
+    void Add(const wxString& line)
+    {
+        if(!m_running.load()) { return; }
+        std::string str = line.mb_str(wxConvUTF8).data();
+        if(!m_queue.Push(str)) {
+            ++m_dropped;
+            return;
+        }
+        m_cv.notify_one();
+    }
+
+    size_t GetDropped() const { return m_dropped.load(); }
+    void SetMaxFileSize(size_t bytes) { m_maxFileSize.store(bytes); }
+};
+
 int FileLogger::m_verbosity = FileLogger::Error;
 wxString FileLogger::m_logfile;
 std::unordered_map<wxThreadIdType, wxString> FileLogger::m_threads;
@@ -39,31 +301,26 @@ wxCriticalSection FileLogger::m_cs;
 
 FileLogger::FileLogger(int requestedVerbo)
     : _requestedLogLevel(requestedVerbo)
-    , m_fp(NULL)
 {
-    m_fp = wxFopen(m_logfile, wxT("a+"));
 }
 
 FileLogger::~FileLogger()
 {
-    if(m_fp) {
-        // flush any content that remain
-        Flush();
-        fclose(m_fp);
-        m_fp = NULL;
-    }
+    // flush any content that remain
+    Flush();
 }
 
+void FileLogger::DoWrite(const wxString& line) { FileLoggerWriter::Get().Add(line); }
+
 void FileLogger::AddLogLine(const wxString& msg, int verbosity)
 {
     if(msg.IsEmpty()) return;
-    if((m_verbosity >= verbosity) && m_fp) {
+    if(m_verbosity >= verbosity) {
         wxString formattedMsg = Prefix(verbosity);
         formattedMsg << " " << msg;
         formattedMsg.Trim().Trim(false);
         formattedMsg << wxT("\n");
-        wxFprintf(m_fp, wxT("%s"), formattedMsg.c_str());
-        fflush(m_fp);
+        DoWrite(formattedMsg);
     }
 }
 
@@ -124,8 +381,15 @@ void FileLogger::OpenLog(const wxString& fullName, int verbosity)
     m_logfile.Clear();
     m_logfile << clStandardPaths::Get().GetUserDataDir() << wxFileName::GetPathSeparator() << fullName;
     m_verbosity = verbosity;
+    FileLoggerWriter::Get().SetFileName(m_logfile);
 }
 
+void FileLogger::SetMaxFileSize(size_t bytes) { FileLoggerWriter::Get().SetMaxFileSize(bytes); }
+
+size_t FileLogger::GetDroppedLinesCount() { return FileLoggerWriter::Get().GetDropped(); }
+
+void FileLogger::Shutdown() { FileLoggerWriter::Get().Stop(); }
+
 void FileLogger::AddLogLine(const wxArrayString& arr, int verbosity)
 {
     for(size_t i = 0; i < arr.GetCount(); ++i) {
@@ -136,13 +400,16 @@ void FileLogger::AddLogLine(const wxArrayString& arr, int verbosity)
 void FileLogger::Flush()
 {
     if(m_buffer.IsEmpty()) { return; }
-    wxFprintf(m_fp, "%s\n", m_buffer);
-    fflush(m_fp);
+    m_buffer << "\n";
+    DoWrite(m_buffer);
     m_buffer.Clear();
 }
 
 wxString FileLogger::Prefix(int verbosity)
 {
+    // Don't pay for the timestamp of a line that is not going to be logged
+    if(verbosity > m_verbosity) { return wxEmptyString; }
+
     wxString prefix;
     timeval tim;
     gettimeofday(&tim, NULL);
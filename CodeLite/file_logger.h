@@ -46,7 +46,6 @@ protected:
     static int m_verbosity;
     static wxString m_logfile;
     int _requestedLogLevel;
-    FILE* m_fp;
     wxString m_buffer;
     static std::unordered_map<wxThreadIdType, wxString> m_threads;
     static wxCriticalSection m_cs;
@@ -54,6 +53,12 @@ protected:
 protected:
     static wxString GetCurrentThreadName();
 
+    /**
+     * @brief queue a formatted line to the log writer thread. Never blocks: if the writer can not keep up,
+     * the line is dropped (and counted)
+     */
+    static void DoWrite(const wxString& line);
+
 public:
     FileLogger(int requestedVerbo);
     ~FileLogger();
@@ -96,6 +101,23 @@ public:
      * @brief open the log file
      */
     static void OpenLog(const wxString& fullName, int verbosity);
+
+    /**
+     * @brief the log file is rotated (renamed to <logfile>.1) once it grows beyond 'bytes'
+     */
+    static void SetMaxFileSize(size_t bytes);
+
+    /**
+     * @brief number of lines that were dropped because the writer thread could not keep up
+     */
+    static size_t GetDroppedLinesCount();
+
+    /**
+     * @brief write everything that was logged so far to the disk and stop the writer thread
+     * Lines logged after this call are discarded. Applications that open a log file must call this from their
+     * wxApp::OnExit(): joining a thread from an atexit() handler deadlocks on Windows (DLL detach)
+     */
+    static void Shutdown();
     // Various util methods
     static wxString GetVerbosityAsString(int verbosity);
     static int GetVerbosityAsNumber(const wxString& verbosity);
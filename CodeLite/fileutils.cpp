@@ -47,6 +47,12 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #endif
+#ifndef __WXMSW__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 void FileUtils::OpenFileExplorer(const wxString& path)
 {
@@ -424,6 +430,145 @@ size_t FileUtils::GetFileSize(const wxFileName& filename)
     }
 }
 
+//----------------------------------------------------------------------
+// XXH64
+//----------------------------------------------------------------------
+static const wxUint64 XXH_PRIME64_1 = wxULL(0x9E3779B185EBCA87);
+static const wxUint64 XXH_PRIME64_2 = wxULL(0xC2B2AE3D27D4EB4F);
+static const wxUint64 XXH_PRIME64_3 = wxULL(0x165667B19E3779F9);
+static const wxUint64 XXH_PRIME64_4 = wxULL(0x85EBCA77C2B2AE63);
+static const wxUint64 XXH_PRIME64_5 = wxULL(0x27D4EB2F165667C5);
+
+static inline wxUint64 XXH_Rotl64(wxUint64 x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline wxUint64 XXH_Read64(const unsigned char* p)
+{
+    wxUint64 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline wxUint32 XXH_Read32(const unsigned char* p)
+{
+    wxUint32 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline wxUint64 XXH_Round(wxUint64 acc, wxUint64 input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = XXH_Rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline wxUint64 XXH_MergeRound(wxUint64 acc, wxUint64 val)
+{
+    acc ^= XXH_Round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static wxUint64 XXH64(const unsigned char* p, size_t len, wxUint64 seed)
+{
+    const unsigned char* end = p + len;
+    wxUint64 h64;
+
+    if(len >= 32) {
+        const unsigned char* limit = end - 32;
+        wxUint64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        wxUint64 v2 = seed + XXH_PRIME64_2;
+        wxUint64 v3 = seed;
+        wxUint64 v4 = seed - XXH_PRIME64_1;
+        do {
+            v1 = XXH_Round(v1, XXH_Read64(p));
+            v2 = XXH_Round(v2, XXH_Read64(p + 8));
+            v3 = XXH_Round(v3, XXH_Read64(p + 16));
+            v4 = XXH_Round(v4, XXH_Read64(p + 24));
+            p += 32;
+        } while(p <= limit);
+
+        h64 = XXH_Rotl64(v1, 1) + XXH_Rotl64(v2, 7) + XXH_Rotl64(v3, 12) + XXH_Rotl64(v4, 18);
+        h64 = XXH_MergeRound(h64, v1);
+        h64 = XXH_MergeRound(h64, v2);
+        h64 = XXH_MergeRound(h64, v3);
+        h64 = XXH_MergeRound(h64, v4);
+    } else {
+        h64 = seed + XXH_PRIME64_5;
+    }
+
+    h64 += (wxUint64)len;
+    while(p + 8 <= end) {
+        h64 ^= XXH_Round(0, XXH_Read64(p));
+        h64 = XXH_Rotl64(h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+
+    if(p + 4 <= end) {
+        h64 ^= (wxUint64)XXH_Read32(p) * XXH_PRIME64_1;
+        h64 = XXH_Rotl64(h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    while(p < end) {
+        h64 ^= (*p) * XXH_PRIME64_5;
+        h64 = XXH_Rotl64(h64, 11) * XXH_PRIME64_1;
+        ++p;
+    }
+
+    h64 ^= h64 >> 33;
+    h64 *= XXH_PRIME64_2;
+    h64 ^= h64 >> 29;
+    h64 *= XXH_PRIME64_3;
+    h64 ^= h64 >> 32;
+    return h64;
+}
+
+wxString FileUtils::GetFileContentHash(const wxFileName& filename)
+{
+    wxUint64 hash = 0;
+#ifdef __WXMSW__
+    wxFFile fp(filename.GetFullPath(), "rb");
+    if(!fp.IsOpened()) { return wxEmptyString; }
+    wxFileOffset length = fp.Length();
+    if(length < 0) { return wxEmptyString; }
+    size_t fileSize = (size_t)length;
+    std::string buffer(fileSize, 0);
+    if(fileSize && fp.Read(&buffer[0], fileSize) != fileSize) { return wxEmptyString; }
+    hash = XXH64((const unsigned char*)buffer.data(), buffer.size(), 0);
+#else
+    const wxCharBuffer cname = filename.GetFullPath().mb_str(wxConvUTF8);
+    int fd = ::open(cname.data(), O_RDONLY);
+    if(fd < 0) { return wxEmptyString; }
+
+    struct stat buff;
+    if(::fstat(fd, &buff) < 0) {
+        ::close(fd);
+        return wxEmptyString;
+    }
+
+    size_t fileSize = (size_t)buff.st_size;
+    if(fileSize == 0) {
+        hash = XXH64(NULL, 0, 0);
+    } else {
+        void* data = ::mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED) {
+            ::close(fd);
+            return wxEmptyString;
+        }
+        hash = XXH64((const unsigned char*)data, fileSize, 0);
+        ::munmap(data, fileSize);
+    }
+    ::close(fd);
+#endif
+    return wxString::Format("%016" wxLongLongFmtSpec "x", hash);
+}
+
+wxString FileUtils::GetContentHash(const char* data, size_t len)
+{
+    wxUint64 hash = XXH64((const unsigned char*)data, len, 0);
+    return wxString::Format("%016" wxLongLongFmtSpec "x", hash);
+}
+
 wxString FileUtils::EscapeString(const wxString& str)
 {
     wxString modstr = str;
@@ -190,6 +190,17 @@ public:
      */
     static size_t GetFileSize(const wxFileName& filename);
 
+    /**
+     * @brief return a 64 bit hash (XXH64) of the file content as a hex string
+     * @return empty string if the file could not be read
+     */
+    static wxString GetFileContentHash(const wxFileName& filename);
+
+    /**
+     * @brief return the hash of a memory buffer, in the same format as GetFileContentHash()
+     */
+    static wxString GetContentHash(const char* data, size_t len);
+
     /**
      * @brief replace any unwanted characters with underscore
      * The chars that we replace are:
@@ -230,17 +230,19 @@ public:
     /**
      * @brief insert entry by file name
      * @param filename
+     * @param contentHash the file content hash (see FileUtils::GetFileContentHash)
      * @return
      */
-    virtual int InsertFileEntry(const wxString& filename, int timestamp) = 0;
+    virtual int InsertFileEntry(const wxString& filename, int timestamp, const wxString& contentHash = "") = 0;
 
     /**
      * @brief update file entry using file name as key
      * @param filename
      * @param timestamp new timestamp
+     * @param contentHash the file content hash (see FileUtils::GetFileContentHash)
      * @return
      */
-    virtual int UpdateFileEntry(const wxString& filename, int timestamp) = 0;
+    virtual int UpdateFileEntry(const wxString& filename, int timestamp, const wxString& contentHash = "") = 0;
 
     // -------------------------- TagEntry -------------------------------------------
     /**
@@ -327,6 +329,14 @@ public:
      */
     virtual void Store(TagTreePtr tree, const wxFileName& path, bool autoCommit = true) = 0;
 
+    /**
+     * @brief start / end a bulk load of tags (e.g. full workspace retag). The storage may trade
+     * durability and query performance for insertion speed between these two calls
+     */
+    virtual void BeginBulkLoad(bool deferIndexes) = 0;
+    virtual void EndBulkLoad() = 0;
+    virtual bool IsBulkLoad() const = 0;
+
     /**
      * A very dengerous API call, which drops all tables from the database
      * and recreate the schema from fresh. It is used when upgrading database between different
@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "CxxScannerTokens.h"
 #include "CxxVariableScanner.h"
+#include "clTrigramIndex.h"
 #include "cl_command_event.h"
 #include "cl_standard_paths.h"
 #include "cpp_scanner.h"
@@ -37,17 +38,26 @@
 #include "pptable.h"
 #include "precompiled_header.h"
 #include "tags_storage_sqlite3.h"
+#include <algorithm>
+#include <chrono>
 #include <set>
 #include <tags_options_data.h>
+#include <unordered_set>
 #include <wx/ffile.h>
 #include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
 
 #define DEBUG_MESSAGE(x) CL_DEBUG1(x.c_str())
 
+// Number of files stored per transaction when storing many files
+#define FILES_PER_TRANSACTION 500
+
+// A retag of at least this number of files drops the search indexes and rebuilds them once when done
+#define BULK_LOAD_DEFER_INDEXES_THRESHOLD 200
+
 #define TEST_DESTROY()                                                                                        \
     {                                                                                                         \
-        if(TestDestroy()) {                                                                                   \
+        if(IsCancelled()) {                                                                                   \
             DEBUG_MESSAGE(wxString::Format(wxT("ParseThread::ProcessIncludes -> received 'TestDestroy()'"))); \
             return;                                                                                           \
         }                                                                                                     \
@@ -95,10 +105,187 @@ static const wxString& WriteCodeLiteCCHelperFile()
 
 ParseThread::ParseThread()
     : WorkerThread()
+    , m_cancelRunning(false)
+    , m_servingInteractive(false)
+{
+}
+
+ParseThread::~ParseThread()
+{
+    std::for_each(m_interactiveQueue.begin(), m_interactiveQueue.end(), [&](ParseRequest* req) { delete req; });
+    std::for_each(m_backgroundQueue.begin(), m_backgroundQueue.end(), [&](ParseRequest* req) { delete req; });
+    std::for_each(m_lowPriorityQueue.begin(), m_lowPriorityQueue.end(), [&](ParseRequest* req) { delete req; });
+    m_interactiveQueue.clear();
+    m_backgroundQueue.clear();
+    m_lowPriorityQueue.clear();
+}
+
+static bool IsSameTarget(const ParseRequest* a, const ParseRequest* b)
+{
+    return a->getType() == b->getType() && a->_evtHandler == b->_evtHandler && a->getDbfile() == b->getDbfile();
+}
+
+/**
+ * @brief try to merge 'req' into a pending request of 'queue'
+ * @return true if 'req' was merged (and deleted), false if it should be queued
+ */
+static bool CoalesceRequest(std::deque<ParseRequest*>& queue, ParseRequest* req)
+{
+    if(req->IsInteractive()) {
+        // The source-to-tags replies are matched by their unique ID, each request must get its own reply
+        if(req->getType() == ParseRequest::PR_SOURCE_TO_TAGS || req->getFile().IsEmpty()) { return false; }
+
+        // A file request reads the file when it is processed: the newer request replaces the pending one
+        for(size_t i = 0; i < queue.size(); ++i) {
+            if(IsSameTarget(queue[i], req) && queue[i]->getFile() == req->getFile()) {
+                clDEBUG1() << "ParseThread: merging request for file" << req->getFile() << clEndl;
+                delete queue[i];
+                queue[i] = req;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Background requests are merged only with the last pending request, so the order of
+    // deletions and stores of the same files is never changed
+    if(queue.empty() || !IsSameTarget(queue.back(), req)) { return false; }
+    ParseRequest* pending = queue.back();
+    switch(req->getType()) {
+    case ParseRequest::PR_PARSEINCLUDES:
+        // A newer workspace retag: it has the up to date list of files
+        req->_quickRetag = (req->_quickRetag && pending->_quickRetag);
+        delete pending;
+        queue.back() = req;
+        break;
+    case ParseRequest::PR_PARSE_AND_STORE:
+    case ParseRequest::PR_PARSE_FILE_NO_INCLUDES:
+    case ParseRequest::PR_DELETE_TAGS_OF_FILES:
+    case ParseRequest::PR_UPDATE_SEARCH_INDEX: {
+        std::unordered_set<std::string> files(pending->_workspaceFiles.begin(), pending->_workspaceFiles.end());
+        for(size_t i = 0; i < req->_workspaceFiles.size(); ++i) {
+            const std::string& file = req->_workspaceFiles[i];
+            if(files.insert(file).second) { pending->_workspaceFiles.push_back(file); }
+        }
+        delete req;
+        break;
+    }
+    default:
+        return false;
+    }
+    clDEBUG1() << "ParseThread: merged a background request of type" << pending->getType() << clEndl;
+    return true;
+}
+
+void ParseThread::Add(ThreadRequest* request)
+{
+    if(!request) { return; }
+    ParseRequest* req = (ParseRequest*)request;
+    {
+        std::lock_guard<std::mutex> lk(m_queueMutex);
+        std::deque<ParseRequest*>& queue = req->IsInteractive()
+                                               ? m_interactiveQueue
+                                               : (req->IsLowPriority() ? m_lowPriorityQueue : m_backgroundQueue);
+        if(!CoalesceRequest(queue, req)) { queue.push_back(req); }
+    }
+    m_queueCond.notify_one();
+}
+
+ThreadRequest* ParseThread::GetNextRequest(long timeout)
 {
+    std::unique_lock<std::mutex> lk(m_queueMutex);
+    m_runningDbfile.clear();
+    if(!m_queueCond.wait_for(lk, std::chrono::milliseconds(timeout), [this]() {
+           return !m_interactiveQueue.empty() || !m_backgroundQueue.empty() || !m_lowPriorityQueue.empty();
+       })) {
+        return NULL;
+    }
+
+    std::deque<ParseRequest*>& queue = !m_interactiveQueue.empty()
+                                           ? m_interactiveQueue
+                                           : (!m_backgroundQueue.empty() ? m_backgroundQueue : m_lowPriorityQueue);
+    ParseRequest* req = queue.front();
+    queue.pop_front();
+    m_runningDbfile = req->getDbfile();
+    m_cancelRunning = false;
+    return req;
 }
 
-ParseThread::~ParseThread() {}
+void ParseThread::CancelRequests(const wxString& dbfile)
+{
+    std::vector<ParseRequest*> cancelled;
+    {
+        std::lock_guard<std::mutex> lk(m_queueMutex);
+        std::deque<ParseRequest*>* queues[] = { &m_interactiveQueue, &m_backgroundQueue, &m_lowPriorityQueue };
+        for(size_t i = 0; i < 3; ++i) {
+            std::deque<ParseRequest*>& queue = *queues[i];
+            std::deque<ParseRequest*> keep;
+            for(size_t j = 0; j < queue.size(); ++j) {
+                if(dbfile.IsEmpty() || queue[j]->getDbfile() == dbfile) {
+                    cancelled.push_back(queue[j]);
+                } else {
+                    keep.push_back(queue[j]);
+                }
+            }
+            queue.swap(keep);
+        }
+        if(!m_runningDbfile.IsEmpty() && (dbfile.IsEmpty() || m_runningDbfile == dbfile)) { m_cancelRunning = true; }
+    }
+
+    // The callers are waiting for these requests to complete
+    for(size_t i = 0; i < cancelled.size(); ++i) {
+        if(!cancelled[i]->IsLowPriority()) { DoNotifyReady(cancelled[i]->_evtHandler, cancelled[i]->getType()); }
+        delete cancelled[i];
+    }
+    if(!cancelled.empty()) {
+        clDEBUG() << "ParseThread: cancelled" << cancelled.size() << "pending requests" << clEndl;
+    }
+}
+
+bool ParseThread::IsCancelled() { return TestDestroy() || m_cancelRunning; }
+
+static bool IsServable(const ParseRequest* req, bool allowWrites) { return allowWrites || req->IsReadOnly(); }
+
+bool ParseThread::HasInteractiveRequests(bool allowWrites)
+{
+    if(m_servingInteractive) { return false; }
+    std::lock_guard<std::mutex> lk(m_queueMutex);
+    for(size_t i = 0; i < m_interactiveQueue.size(); ++i) {
+        if(IsServable(m_interactiveQueue[i], allowWrites)) { return true; }
+    }
+    return false;
+}
+
+bool ParseThread::HasPendingRequests()
+{
+    std::lock_guard<std::mutex> lk(m_queueMutex);
+    return !m_interactiveQueue.empty() || !m_backgroundQueue.empty();
+}
+
+void ParseThread::ServeInteractiveRequests(bool allowWrites)
+{
+    // Do not nest: an interactive request may call us again
+    if(m_servingInteractive) { return; }
+    m_servingInteractive = true;
+    while(!TestDestroy()) {
+        ParseRequest* req = NULL;
+        {
+            std::lock_guard<std::mutex> lk(m_queueMutex);
+            for(std::deque<ParseRequest*>::iterator iter = m_interactiveQueue.begin();
+                iter != m_interactiveQueue.end(); ++iter) {
+                if(IsServable(*iter, allowWrites)) {
+                    req = *iter;
+                    m_interactiveQueue.erase(iter);
+                    break;
+                }
+            }
+        }
+        if(!req) { break; }
+        ProcessRequest(req);
+        wxDELETE(req);
+    }
+    m_servingInteractive = false;
+}
 
 void ParseThread::ProcessRequest(ThreadRequest* request)
 {
@@ -131,10 +318,13 @@ void ParseThread::ProcessRequest(ThreadRequest* request)
     case ParseRequest::PR_SOURCE_TO_TAGS:
         ProcessSourceToTags(req);
         break;
+    case ParseRequest::PR_UPDATE_SEARCH_INDEX:
+        ProcessUpdateSearchIndex(req);
+        break;
     }
 
-    // Always notify when ready
-    DoNotifyReady(req->_evtHandler, req->getType());
+    // Always notify when ready. Nobody waits for the low priority (housekeeping) requests
+    if(!req->IsLowPriority()) { DoNotifyReady(req->_evtHandler, req->getType()); }
 }
 
 void ParseThread::ParseIncludeFiles(ParseRequest* req, const wxString& filename, ITagsStoragePtr db)
@@ -157,13 +347,14 @@ TagTreePtr ParseThread::DoTreeFromTags(const wxString& tags, int& count)
     return TagsManagerST::Get()->TreeFromTags(tags, count);
 }
 
-void ParseThread::DoStoreTags(const wxString& tags, const wxString& filename, int& count, ITagsStoragePtr db)
+void ParseThread::DoStoreTags(const wxString& tags, const wxString& filename, int& count, ITagsStoragePtr db,
+                              bool autoCommit)
 {
     TagTreePtr ttp = DoTreeFromTags(tags, count);
-    db->Begin();
+    if(autoCommit) db->Begin();
     db->DeleteByFileName(wxFileName(), filename, false);
     db->Store(ttp, wxFileName(), false);
-    db->Commit();
+    if(autoCommit) db->Commit();
 }
 
 void ParseThread::SetCrawlerEnabeld(bool b)
@@ -235,6 +426,9 @@ void ParseThread::ProcessSimple(ParseRequest* req)
     ITagsStoragePtr db(new TagsStorageSQLite());
     db->OpenDatabase(dbfile);
 
+    // Hash the content that is about to be parsed, not what the file holds once we are done with it
+    wxString contentHash = FileUtils::GetFileContentHash(file);
+
     // convert the file content into tags
     wxString tags;
     wxString file_name(req->getFile());
@@ -249,7 +443,7 @@ void ParseThread::ProcessSimple(ParseRequest* req)
     ///////////////////////////////////////////
     // update the file retag timestamp
     ///////////////////////////////////////////
-    db->InsertFileEntry(file, (int)time(NULL));
+    db->InsertFileEntry(file, (int)time(NULL), contentHash);
 
     ////////////////////////////////////////////////
     // Parse and store the macros found in this file
@@ -261,6 +455,9 @@ void ParseThread::ProcessSimple(ParseRequest* req)
 
     db->Commit();
 
+    // Keep the find-in-files index in sync with the saved file
+    UpdateSearchIndex(dbfile, wxArrayString(1, &file));
+
     // Parse the saved file to get a list of files to include
     ParseIncludeFiles(req, file, db);
 
@@ -324,21 +521,49 @@ void ParseThread::ParseAndStoreFiles(ParseRequest* req, const wxArrayString& arr
     // Loop over the files and parse them
     int totalSymbols(0);
     DEBUG_MESSAGE(wxString::Format(wxT("Parsing and saving files to database....")));
+
+    // The hashes are taken before the files are parsed: a file modified while we are parsing it must not be
+    // recorded as up to date
+    std::vector<wxFileName> files;
+    wxArrayString contentHashes;
+    files.reserve(arrFiles.GetCount());
+    contentHashes.Alloc(arrFiles.GetCount());
     for(size_t i = 0; i < arrFiles.GetCount(); i++) {
+        files.push_back(wxFileName(arrFiles.Item(i)));
+        contentHashes.Add(FileUtils::GetFileContentHash(files.back()));
+    }
 
-        // give a shutdown request a chance
-        TEST_DESTROY();
+    // Store the files in batches, a transaction per file is way too slow
+    bool aborted = false;
+    db->Begin();
+    TagsManagerST::Get()->SourceToTags(files, [&](size_t i, const wxString& tags) -> bool {
+        // give a shutdown (or a cancel) request a chance
+        if(IsCancelled()) {
+            aborted = true;
+            return false;
+        }
 
-        wxString tags; // output
-        TagsManagerST::Get()->SourceToTags(arrFiles.Item(i), tags);
+        if(tags.IsEmpty() == false) { DoStoreTags(tags, arrFiles.Item(i), totalSymbols, db, false); }
 
-        if(tags.IsEmpty() == false) { DoStoreTags(tags, arrFiles.Item(i), totalSymbols, db); }
+        if(i && ((i % FILES_PER_TRANSACTION) == 0 || HasInteractiveRequests(true))) {
+            db->Commit();
+            // the editor is waiting for these
+            ServeInteractiveRequests(true);
+            db->Begin();
+        }
+        return true;
+    });
+
+    if(aborted) {
+        db->Rollback();
+        return;
     }
+    db->Commit();
 
     DEBUG_MESSAGE(wxString(wxT("Done")));
 
     // Update the retagging timestamp
-    TagsManagerST::Get()->UpdateFilesRetagTimestamp(arrFiles, db);
+    TagsManagerST::Get()->UpdateFilesRetagTimestamp(arrFiles, contentHashes, db);
 
     if(req->_evtHandler) {
         wxCommandEvent e(wxEVT_PARSE_THREAD_MESSAGE);
@@ -380,6 +605,8 @@ void ParseThread::ProcessDeleteTagsOfFiles(ParseRequest* req)
 
     db->DeleteFromFiles(file_array);
     db->Commit();
+
+    DeleteFromSearchIndex(dbfile, file_array);
     DEBUG_MESSAGE(wxString(wxT("ParseThread::ProcessDeleteTagsOfFile - completed")));
 }
 
@@ -399,7 +626,12 @@ void ParseThread::ProcessParseAndStore(ParseRequest* req)
     ITagsStoragePtr db(new TagsStorageSQLite());
     db->OpenDatabase(dbfile);
 
-    // We commit every 10 files
+    // Large retag: switch the database to bulk load mode and store many files per transaction.
+    // Small retag (e.g. a quick retag after few files were modified) keeps the search indexes
+    // so we don't rebuild them for the entire table
+    wxStopWatch sw;
+    bool deferIndexes = (req->_workspaceFiles.size() >= BULK_LOAD_DEFER_INDEXES_THRESHOLD);
+    db->BeginBulkLoad(deferIndexes);
     db->Begin();
     int precent(0);
     int lastPercentageReported(0);
@@ -409,17 +641,11 @@ void ParseThread::ProcessParseAndStore(ParseRequest* req)
     req->_workspaceFiles.insert(req->_workspaceFiles.begin(), hackfile.ToStdString());
     PPTable::Instance()->Clear();
 
-    for(size_t i = 0; i < maxVal; i++) {
-
-        // give a shutdown request a chance
-        if(TestDestroy()) {
-            // Do an ordered shutdown:
-            // rollback any transaction
-            // and close the database
-            db->Rollback();
-            return;
-        }
-
+    std::vector<wxFileName> files;
+    std::vector<wxString> contentHashes;
+    files.reserve(req->_workspaceFiles.size());
+    contentHashes.reserve(req->_workspaceFiles.size());
+    for(size_t i = 0; i < req->_workspaceFiles.size(); i++) {
         wxFileName curFile(wxString(req->_workspaceFiles[i].c_str(), wxConvUTF8));
 
         // Skip binary files
@@ -427,9 +653,26 @@ void ParseThread::ProcessParseAndStore(ParseRequest* req)
             DEBUG_MESSAGE(wxString::Format(wxT("Skipping binary file %s"), curFile.GetFullPath().c_str()));
             continue;
         }
+        files.push_back(curFile);
+        // Keep the hash of the content the indexer is about to parse, so the next retag can skip this file if it
+        // was only touched. A file modified while it is being parsed gets a hash that no longer matches
+        contentHashes.push_back(FileUtils::GetFileContentHash(curFile));
+    }
+
+    // The files are parsed by the indexers pool, we are the only writer: we store each file's tags
+    // (in the original order) while the indexers are working on the next files
+    bool aborted = false;
+    TagsManagerST::Get()->SourceToTags(files, [&](size_t i, const wxString& tags) -> bool {
+        // give a shutdown (or a cancel) request a chance
+        if(IsCancelled()) {
+            aborted = true;
+            return false;
+        }
+
+        const wxFileName& curFile = files[i];
 
         // Send notification to the main window with our progress report
-        precent = (int)((i / maxVal) * 100);
+        precent = (int)((i / (double)files.size()) * 100);
 
         if(req->_evtHandler && lastPercentageReported != precent) {
             lastPercentageReported = precent;
@@ -438,20 +681,35 @@ void ParseThread::ProcessParseAndStore(ParseRequest* req)
             req->_evtHandler->AddPendingEvent(retaggingProgressEvent);
         }
 
-        TagTreePtr tree = TagsManagerST::Get()->ParseSourceFile(curFile);
+        int count(0);
+        TagTreePtr tree = DoTreeFromTags(tags, count);
         PPScan(curFile.GetFullPath(), false);
 
         db->Store(tree, wxFileName(), false);
-        if(db->InsertFileEntry(curFile.GetFullPath(), (int)time(NULL)) == TagExist) {
-            db->UpdateFileEntry(curFile.GetFullPath(), (int)time(NULL));
+
+        const wxString& contentHash = contentHashes[i];
+        if(db->InsertFileEntry(curFile.GetFullPath(), (int)time(NULL), contentHash) == TagExist) {
+            db->UpdateFileEntry(curFile.GetFullPath(), (int)time(NULL), contentHash);
         }
 
-        if(i % 50 == 0) {
+        if(i && ((i % FILES_PER_TRANSACTION) == 0 || HasInteractiveRequests(false))) {
             // Commit what we got so far
             db->Commit();
+            // Serve the editor requests that do not write to the database: a saved file would be
+            // stored without the secondary indexes and would reset the macros table we are collecting
+            ServeInteractiveRequests(false);
             // Start a new transaction
             db->Begin();
         }
+        return true;
+    });
+
+    if(aborted) {
+        // Do an ordered shutdown: rollback any transaction and leave the bulk load mode. The completion queries
+        // of the main thread need the search indexes back now, not the next time the database is opened
+        db->Rollback();
+        db->EndBulkLoad();
+        return;
     }
 
     // Process the macros
@@ -463,10 +721,20 @@ void ParseThread::ProcessParseAndStore(ParseRequest* req)
 
     // Commit whats left
     db->Commit();
+    db->EndBulkLoad();
+    clDEBUG() << "Stored" << req->_workspaceFiles.size() << "files in" << sw.Time() << "ms" << clEndl;
 
     // Clear the results
     PPTable::Instance()->Clear();
 
+    // Queue the find-in-files index update (skipping our hack file)
+    wxArrayString indexFiles;
+    indexFiles.Alloc(req->_workspaceFiles.size());
+    for(size_t i = 1; i < req->_workspaceFiles.size(); ++i) {
+        indexFiles.Add(wxString(req->_workspaceFiles[i].c_str(), wxConvUTF8));
+    }
+    UpdateSearchIndex(dbfile, indexFiles);
+
     /// Send notification to the main window with our progress report
     if(req->_evtHandler) {
         wxCommandEvent retaggingCompletedEvent(wxEVT_PARSE_THREAD_RETAGGING_COMPLETED);
@@ -520,7 +788,7 @@ void ParseThread::FindIncludedFiles(ParseRequest* req, std::set<wxString>* newSe
         for(size_t i = 0; i < filteredFileList.GetCount(); i++) {
             const wxCharBuffer cfile = filteredFileList.Item(i).mb_str(wxConvUTF8);
             crawlerScan(cfile.data());
-            if(TestDestroy()) { return; }
+            if(IsCancelled()) { return; }
         }
         newSet->insert(fcFileOpener::Get()->GetResults().begin(), fcFileOpener::Get()->GetResults().end());
     }
@@ -550,6 +818,33 @@ ParseRequest& ParseRequest::operator=(const ParseRequest& rhs)
 
 void ParseRequest::setFile(const wxString& file) { _file = file.c_str(); }
 
+bool ParseRequest::IsInteractive() const
+{
+    switch(_type) {
+    case PR_FILESAVED:
+    case PR_PARSE_INCLUDE_STATEMENTS:
+    case PR_SUGGEST_HIGHLIGHT_WORDS:
+    case PR_SOURCE_TO_TAGS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ParseRequest::IsLowPriority() const { return _type == PR_UPDATE_SEARCH_INDEX; }
+
+bool ParseRequest::IsReadOnly() const
+{
+    switch(_type) {
+    case PR_PARSE_INCLUDE_STATEMENTS:
+    case PR_SUGGEST_HIGHLIGHT_WORDS:
+    case PR_SOURCE_TO_TAGS:
+        return true;
+    default:
+        return false;
+    }
+}
+
 ParseRequest::~ParseRequest() {}
 
 // Adaptor to the parse thread
@@ -704,3 +999,49 @@ void ParseThread::ProcessSourceToTags(ParseRequest* req)
     event.SetInt(req->_uid); // send back the unique ID
     req->_evtHandler->AddPendingEvent(event);
 }
+
+void ParseThread::UpdateSearchIndex(const wxString& dbfile, const wxArrayString& files)
+{
+    if(dbfile.IsEmpty() || files.IsEmpty()) { return; }
+    ParseRequest* req = new ParseRequest(NULL);
+    req->setType(ParseRequest::PR_UPDATE_SEARCH_INDEX);
+    req->setDbFile(dbfile);
+    req->_workspaceFiles.reserve(files.size());
+    for(size_t i = 0; i < files.size(); ++i) {
+        req->_workspaceFiles.push_back(files.Item(i).mb_str(wxConvUTF8).data());
+    }
+    Add(req);
+}
+
+void ParseThread::ProcessUpdateSearchIndex(ParseRequest* req)
+{
+    clTrigramIndex index;
+    if(!index.Open(clTrigramIndex::GetIndexFileName(req->getDbfile()))) { return; }
+
+    wxArrayString files;
+    files.Alloc(req->_workspaceFiles.size());
+    for(size_t i = 0; i < req->_workspaceFiles.size(); ++i) {
+        files.Add(wxString(req->_workspaceFiles[i].c_str(), wxConvUTF8));
+    }
+
+    // Yield as soon as anything else is queued
+    size_t count = index.UpdateFiles(files, [&]() { return IsCancelled() || HasPendingRequests(); });
+    clDEBUG1() << "Search index: processed" << count << "out of" << files.size() << "files" << clEndl;
+    if(count < files.size() && !IsCancelled()) {
+        // Continue once the queue is idle again
+        wxArrayString rest;
+        rest.Alloc(files.size() - count);
+        for(size_t i = count; i < files.size(); ++i) {
+            rest.Add(files.Item(i));
+        }
+        UpdateSearchIndex(req->getDbfile(), rest);
+    }
+}
+
+void ParseThread::DeleteFromSearchIndex(const wxString& dbfile, const wxArrayString& files)
+{
+    if(dbfile.IsEmpty() || files.IsEmpty()) { return; }
+    clTrigramIndex index;
+    if(!index.Open(clTrigramIndex::GetIndexFileName(dbfile))) { return; }
+    index.DeleteFiles(files);
+}
@@ -27,7 +27,11 @@
 
 #include "entry.h"
 #include "singleton.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <memory>
 #include <wx/stopwatch.h>
@@ -72,6 +76,7 @@ public:
         PR_PARSE_INCLUDE_STATEMENTS,
         PR_SUGGEST_HIGHLIGHT_WORDS,
         PR_SOURCE_TO_TAGS,
+        PR_UPDATE_SEARCH_INDEX,
     };
 
 public:
@@ -104,6 +109,23 @@ public:
 
     void setType(int _type) { this->_type = _type; }
     int getType() const { return _type; }
+
+    /**
+     * @brief interactive requests (the active editor is waiting for them) are served before
+     * the background (retag) requests
+     */
+    bool IsInteractive() const;
+
+    /**
+     * @brief low priority requests (e.g. updating the find-in-files index) are served only when there is
+     * nothing else to do and yield as soon as another request is queued
+     */
+    bool IsLowPriority() const;
+
+    /**
+     * @brief does this request only read from the database?
+     */
+    bool IsReadOnly() const;
     // copy ctor
     ParseRequest(const ParseRequest& rhs);
 
@@ -127,12 +149,35 @@ class WXDLLIMPEXP_CL ParseThread : public WorkerThread
     bool m_crawlerEnabled;
     wxCriticalSection m_cs;
 
+    // The request scheduler: three lanes, the interactive requests are always served first and the low
+    // priority requests last
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCond;
+    std::deque<ParseRequest*> m_interactiveQueue;
+    std::deque<ParseRequest*> m_backgroundQueue;
+    std::deque<ParseRequest*> m_lowPriorityQueue;
+    wxString m_runningDbfile;
+    std::atomic_bool m_cancelRunning;
+    bool m_servingInteractive;
+
 public:
     void SetCrawlerEnabeld(bool b);
     void SetSearchPaths(const wxArrayString& paths, const wxArrayString& exlucdePaths);
     void GetSearchPaths(wxArrayString& paths, wxArrayString& excludePaths);
     bool IsCrawlerEnabled();
 
+    /**
+     * @brief queue a request. A request that duplicates a pending one (e.g. the same file was saved twice) is
+     * merged into the pending request instead of being queued
+     */
+    void Add(ThreadRequest* request);
+
+    /**
+     * @brief drop the pending requests for 'dbfile' (all the pending requests if 'dbfile' is empty)
+     * and ask the running request to stop if it works on this database
+     */
+    void CancelRequests(const wxString& dbfile = wxEmptyString);
+
 private:
     /**
      * Default constructor.
@@ -144,11 +189,32 @@ private:
      */
     virtual ~ParseThread();
 
-    void DoStoreTags(const wxString& tags, const wxString& filename, int& count, ITagsStoragePtr db);
+    void DoStoreTags(const wxString& tags, const wxString& filename, int& count, ITagsStoragePtr db,
+                     bool autoCommit = true);
     TagTreePtr DoTreeFromTags(const wxString& tags, int& count);
     void DoNotifyReady(wxEvtHandler* caller, int requestType);
 
+    /**
+     * @brief return true if the thread is going down or the running request was cancelled
+     */
+    bool IsCancelled();
+
+    /**
+     * @brief serve the pending interactive requests from within a long background request.
+     * Called between transactions
+     * @param allowWrites when false, requests that modify the database are left in the queue
+     */
+    void ServeInteractiveRequests(bool allowWrites);
+    bool HasInteractiveRequests(bool allowWrites);
+
+    /**
+     * @brief is there an interactive or a background request waiting?
+     */
+    bool HasPendingRequests();
+
 private:
+    ThreadRequest* GetNextRequest(long timeout);
+
     /**
      * Process request from the editor.
      * \param request the request to process
@@ -170,9 +236,16 @@ private:
     void ProcessSimpleNoIncludes(ParseRequest* req);
     void ProcessIncludeStatements(ParseRequest* req);
     void ProcessColourRequest(ParseRequest* req);
+    void ProcessUpdateSearchIndex(ParseRequest* req);
     void GetFileListToParse(const wxString& filename, wxArrayString& arrFiles);
     void ParseAndStoreFiles(ParseRequest* req, const wxArrayString& arrFiles, int initalCount, ITagsStoragePtr db);
 
+    /**
+     * @brief queue a low priority update of the find-in-files trigram index that lives next to 'dbfile'
+     */
+    void UpdateSearchIndex(const wxString& dbfile, const wxArrayString& files);
+    void DeleteFromSearchIndex(const wxString& dbfile, const wxArrayString& files);
+
     void FindIncludedFiles(ParseRequest* req, std::set<wxString>* newSet);
 };
 
@@ -23,6 +23,7 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 #include "asyncprocess.h"
+#include "file_logger.h"
 #include "processreaderthread.h"
 
 wxDEFINE_EVENT(wxEVT_ASYNC_PROCESS_OUTPUT, clProcessEvent);
@@ -49,34 +50,19 @@ void* ProcessReaderThread::Entry()
         if(TestDestroy()) { break; }
 
         if(m_process) {
-            wxString buff;
-            wxString buffErr;
+            std::string buff;
+            std::string buffErr;
             if(m_process->IsRedirect()) {
-                if(m_process->Read(buff, buffErr)) {
-                    if(!buff.IsEmpty() || !buffErr.IsEmpty()) {
-                        // If we got a callback object, use it
-                        if(m_process && m_process->GetCallback()) {
-                            m_process->GetCallback()->CallAfter(&IProcessCallback::OnProcessOutput, buff);
+                // Backpressure: don't read more while the main thread is behind. The process blocks
+                // once the pipe is full
+                if(!m_process->GetOutputChannel()->WaitForRoom(50)) { continue; }
 
-                        } else {
-                            // We fire an event per data (stderr/stdout)
-                            if(!buff.IsEmpty()) {
-                                // fallback to the event system
-                                // we got some data, send event to parent
-                                clProcessEvent e(wxEVT_ASYNC_PROCESS_OUTPUT);
-                                e.SetOutput(buff);
-                                e.SetProcess(m_process);
-                                if(m_notifiedWindow) { m_notifiedWindow->AddPendingEvent(e); }
-                            }
-                            if(!buffErr.IsEmpty()) {
-                                // we got some data, send event to parent
-                                clProcessEvent e(wxEVT_ASYNC_PROCESS_STDERR);
-                                e.SetOutput(buffErr);
-                                e.SetProcess(m_process);
-                                if(m_notifiedWindow) { m_notifiedWindow->AddPendingEvent(e); }
-                            }
-                        }
-                    }
+                if(m_process->ReadBytes(buff, buffErr)) {
+                    // Chunks are coalesced in the process output channel: an event (or callback) is sent
+                    // only if the main thread already took the previous output. The bytes are passed as-is,
+                    // they are decoded on the main thread only if someone asks for text
+                    if(!buff.empty()) { m_process->PostOutput(buff.data(), buff.length(), false); }
+                    if(!buffErr.empty()) { m_process->PostOutput(buffErr.data(), buffErr.length(), true); }
                 } else {
 
                     // Process terminated, exit
@@ -123,6 +109,11 @@ void ProcessReaderThread::Start(int priority)
 
 void ProcessReaderThread::NotifyTerminated()
 {
+    if(m_process) {
+        m_process->FlushOutput();
+        clDEBUG1() << "Process" << m_process->GetPid() << "output:" << m_process->GetOutputStatistics().ToString();
+    }
+
     // Process terminated, exit
     // If we got a callback object, use it
     if(m_process && m_process->GetCallback()) {
@@ -27,6 +27,9 @@
 #include "winprocess.h"
 
 #include <stdio.h>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
 #ifdef __WXMSW__
 #include "wx/msw/private.h"
 #include "wx/textbuf.h"
@@ -537,6 +540,29 @@ void ProcUtils::SafeExecuteCommand(const wxString& command, wxArrayString& outpu
 #endif
 }
 
+size_t ProcUtils::GetProcessMemoryUsage(long pid)
+{
+#if defined(__linux__)
+    // /proc/<pid>/statm: size resident shared text lib data dt (in pages)
+    wxString statm;
+    statm << "/proc/" << pid << "/statm";
+    FILE* fp = fopen(statm.mb_str(wxConvUTF8).data(), "r");
+    if(!fp) {
+        return 0;
+    }
+    unsigned long size = 0, resident = 0;
+    int count = fscanf(fp, "%lu %lu", &size, &resident);
+    fclose(fp);
+    if(count != 2) {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+#else
+    wxUnusedVar(pid);
+    return 0; // Not implemented yet
+#endif
+}
+
 wxString ProcUtils::SafeExecuteCommand(const wxString& command)
 {
     wxString strOut;
@@ -60,6 +60,11 @@ public:
     static void GetChildren(long pid, std::vector<long> &children);
     static bool Shell(const wxString& programConsoleCommand);
     static bool Locate(const wxString &name, wxString &where);
+
+    /**
+     * @brief return the resident memory (in bytes) of a process. Returns 0 if it can not be determined
+     */
+    static size_t GetProcessMemoryUsage(long pid);
     
     /**
      * \brief a safe function that executes 'command' and returns its output. This function
@@ -23,6 +23,7 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 #include "clFilesCollector.h"
+#include "clTrigramIndex.h"
 #include "cppwordscanner.h"
 #include "dirtraverser.h"
 #include "fileutils.h"
@@ -30,9 +31,14 @@
 #include "search_thread.h"
 #include "wx/event.h"
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <set>
+#include <string.h>
+#include <thread>
+#include <vector>
 #include <wx/dir.h>
+#include <wx/ffile.h>
 #if wxUSE_GUI
 #include <wx/fontmap.h>
 #endif
@@ -45,6 +51,13 @@
 #include "cl_command_event.h" // Needed for the definition of wxCommandEvent
 #endif
 
+#ifndef __WXMSW__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_MATCHFOUND, wxCommandEvent);
 wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_SEARCHEND, wxCommandEvent);
 wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_SEARCHCANCELED, wxCommandEvent);
@@ -58,6 +71,126 @@ wxDEFINE_EVENT(wxEVT_SEARCH_THREAD_SEARCHSTARTED, wxCommandEvent);
     }                                         \
     wxThread::Sleep(1);
 
+/**
+ * @class SearchMappedFile
+ * @brief read-only view of a file content. On POSIX the file is mapped into memory,
+ * on Windows we simply read it into a buffer
+ */
+class SearchMappedFile
+{
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef __WXMSW__
+    std::string m_buffer;
+#endif
+
+public:
+    SearchMappedFile() {}
+    ~SearchMappedFile()
+    {
+#ifndef __WXMSW__
+        if(m_data && m_size) { munmap((void*)m_data, m_size); }
+#endif
+    }
+
+    bool Open(const wxString& fileName)
+    {
+#ifdef __WXMSW__
+        wxFFile fp(fileName, "rb");
+        if(!fp.IsOpened()) { return false; }
+        wxFileOffset len = fp.Length();
+        if(len <= 0) { return true; }
+        m_buffer.resize((size_t)len);
+        if(fp.Read(&m_buffer[0], m_buffer.size()) != m_buffer.size()) { return false; }
+        m_data = m_buffer.c_str();
+        m_size = m_buffer.size();
+        return true;
+#else
+        int fd = ::open(fileName.mb_str(wxConvUTF8).data(), O_RDONLY);
+        if(fd < 0) { return false; }
+        struct stat st;
+        if((::fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+        if(st.st_size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* addr = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(addr == MAP_FAILED) { return false; }
+#ifdef MADV_SEQUENTIAL
+        ::madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+        m_data = (const char*)addr;
+        m_size = (size_t)st.st_size;
+        return true;
+#endif
+    }
+
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+};
+
+static inline char AsciiToUpper(char ch) { return (ch >= 'a' && ch <= 'z') ? (ch - 'a' + 'A') : ch; }
+static inline char AsciiToLower(char ch) { return (ch >= 'A' && ch <= 'Z') ? (ch - 'A' + 'a') : ch; }
+
+/**
+ * @brief find the first occurrence of 'needle' in [p, end). The first byte of the needle is located with memchr
+ * (which the C library vectorizes), the rest is verified only on candidates. When 'matchCase' is false the needle is
+ * expected to be in lower case (ASCII only)
+ */
+static const char* FindLiteral(const char* p, const char* end, const std::string& needle, bool matchCase)
+{
+    const size_t needleLen = needle.length();
+    if((size_t)(end - p) < needleLen) { return nullptr; }
+    const char* last = end - needleLen + 1;
+
+    if(matchCase) {
+        const char first = needle[0];
+        while(p < last) {
+            p = (const char*)memchr(p, first, last - p);
+            if(!p) { return nullptr; }
+            if(memcmp(p + 1, needle.c_str() + 1, needleLen - 1) == 0) { return p; }
+            ++p;
+        }
+        return nullptr;
+    }
+
+    const char lower = needle[0];
+    const char upper = AsciiToUpper(lower);
+    while(p < last) {
+        const char* candLower = (const char*)memchr(p, lower, last - p);
+        const char* candUpper =
+            (upper == lower) ? nullptr : (const char*)memchr(p, upper, (candLower ? candLower : last) - p);
+        const char* cand = candUpper ? candUpper : candLower;
+        if(!cand) { return nullptr; }
+
+        size_t i = 1;
+        while(i < needleLen && AsciiToLower(cand[i]) == needle[i]) {
+            ++i;
+        }
+        if(i == needleLen) { return cand; }
+        p = cand + 1;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief return the number of characters (as counted by wxString) in the byte range
+ */
+static inline size_t CountChars(const char* p, const char* end, bool isUTF8)
+{
+    if(!isUTF8) { return end - p; }
+    size_t count = 0;
+    for(; p < end; ++p) {
+        // skip UTF-8 continuation bytes
+        if(((unsigned char)*p & 0xC0) != 0x80) { ++count; }
+    }
+    return count;
+}
+
 //----------------------------------------------------------------
 // SearchData
 //----------------------------------------------------------------
@@ -77,6 +210,7 @@ SearchData& SearchData::Copy(const SearchData& other)
     m_owner = other.m_owner;
     m_encoding = other.m_encoding.c_str();
     m_replaceWith = other.m_replaceWith;
+    m_indexFile = other.m_indexFile;
     m_excludePatterns.clear();
     m_excludePatterns.insert(m_excludePatterns.end(), other.m_excludePatterns.begin(), other.m_excludePatterns.end());
     m_files.clear();
@@ -164,7 +298,8 @@ void SearchThread::GetFiles(const SearchData* data, wxArrayString& files)
         // make sure it's really a dir (not a fifo, etc.)
         clFilesScanner scanner;
         std::vector<wxString> filesV;
-        if(scanner.Scan(rootDirs.Item(i), filesV, data->GetExtensions())) {
+        size_t flags = data->IsSkipVcsFolders() ? clFilesScanner::kSkipVcsFolders : clFilesScanner::kScanDefault;
+        if(scanner.Scan(rootDirs.Item(i), filesV, data->GetExtensions(), "", wxStringSet_t(), flags)) {
             std::for_each(filesV.begin(), filesV.end(), [&](const wxString& file) { scannedFiles.insert(file); });
         }
     }
@@ -175,6 +310,16 @@ void SearchThread::GetFiles(const SearchData* data, wxArrayString& files)
 
     // Filter all non matching files
     FilterFiles(files, data);
+
+    // Use the trigram index to skip the files that can not contain a match
+    if(data->IsUseIndex() && wxFileName::FileExists(data->GetIndexFile())) {
+        wxArrayString literals;
+        if(clTrigramIndex::GetLiterals(data->GetFindString(), data->IsRegularExpression(),
+                                       data->IsEnablePipeSupport(), literals)) {
+            clTrigramIndex index;
+            if(index.Open(data->GetIndexFile())) { index.FilterFiles(literals, files); }
+        }
+    }
 }
 
 void SearchThread::DoSearchFiles(ThreadRequest* req)
@@ -205,6 +350,11 @@ void SearchThread::DoSearchFiles(ThreadRequest* req)
         }
     }
 
+    if(CanSearchParallel(data)) {
+        DoSearchFilesParallel(fileList, data);
+        return;
+    }
+
     for(size_t i = 0; i < fileList.Count(); i++) {
         m_summary.SetNumFileScanned((int)i + 1);
 
@@ -283,12 +433,13 @@ void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data
     }
 
     int lineOffset = 0;
+    size_t resultsCount = m_results.size();
     if(data->IsRegularExpression()) {
         // regular expression search
         while(tkz.HasMoreTokens()) {
             // Read the next line
             wxString line = tkz.NextToken();
-            DoSearchLineRE(line, lineNumber, lineOffset, fileName, data, states);
+            DoSearchLineRE(line, lineNumber, lineOffset, fileName, data, states, m_results);
             lineOffset += line.Length() + 1;
             lineNumber++;
         }
@@ -296,38 +447,240 @@ void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data
         // simple search
         wxString findString;
         wxArrayString filters;
-        findString = data->GetFindString();
-        if(data->IsEnablePipeSupport()) {
-            if(data->GetFindString().Find('|') != wxNOT_FOUND) {
-                findString = data->GetFindString().BeforeFirst('|');
-
-                wxString filtersString = data->GetFindString().AfterFirst('|');
-                filters = ::wxStringTokenize(filtersString, "|", wxTOKEN_STRTOK);
-                if(!data->IsMatchCase()) {
-                    for(size_t i = 0; i < filters.size(); ++i) {
-                        filters.Item(i).MakeLower();
-                    }
-                }
-            }
-        }
-
-        if(!data->IsMatchCase()) { findString.MakeLower(); }
+        GetFindWhatAndFilters(data, findString, filters);
 
         while(tkz.HasMoreTokens()) {
 
             // Read the next line
             wxString line = tkz.NextToken();
-            DoSearchLine(line, lineNumber, lineOffset, fileName, data, findString, filters, states);
+            DoSearchLine(line, lineNumber, lineOffset, fileName, data, findString, filters, states, m_results);
             lineOffset += line.Length() + 1;
             lineNumber++;
         }
     }
+    m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + (int)(m_results.size() - resultsCount));
 
     if(m_results.empty() == false) { SendEvent(wxEVT_SEARCH_THREAD_MATCHFOUND, data->GetOwner()); }
 }
 
+void SearchThread::GetFindWhatAndFilters(const SearchData* data, wxString& findWhat, wxArrayString& filters) const
+{
+    findWhat = data->GetFindString();
+    filters.clear();
+    if(data->IsEnablePipeSupport()) {
+        if(data->GetFindString().Find('|') != wxNOT_FOUND) {
+            findWhat = data->GetFindString().BeforeFirst('|');
+
+            wxString filtersString = data->GetFindString().AfterFirst('|');
+            filters = ::wxStringTokenize(filtersString, "|", wxTOKEN_STRTOK);
+            if(!data->IsMatchCase()) {
+                for(size_t i = 0; i < filters.size(); ++i) {
+                    filters.Item(i).MakeLower();
+                }
+            }
+        }
+    }
+
+    if(!data->IsMatchCase()) { findWhat.MakeLower(); }
+}
+
+bool SearchThread::CanSearchParallel(const SearchData* data) const
+{
+    if(!data->IsMultiThreaded() || data->IsRegularExpression()) { return false; }
+
+    wxString findWhat;
+    wxArrayString filters;
+    GetFindWhatAndFilters(data, findWhat, filters);
+    if(findWhat.IsEmpty()) { return false; }
+
+    // Case insensitive search is done on the raw bytes, so we can only lower ASCII characters
+    if(!data->IsMatchCase()) {
+        for(size_t i = 0; i < findWhat.length(); ++i) {
+            if(!findWhat[i].IsAscii()) { return false; }
+        }
+    }
+
+#if wxUSE_GUI
+    // The byte scan requires an encoding where a '\n' byte is always a line break
+    // and where the needle can be converted byte by byte
+    wxFontEncoding enc = wxFontMapper::GetEncodingFromName(data->GetEncoding().c_str());
+    bool is8Bit = (enc >= wxFONTENCODING_ISO8859_1 && enc <= wxFONTENCODING_ISO8859_MAX);
+    return (enc == wxFONTENCODING_UTF8) || is8Bit;
+#else
+    return true;
+#endif
+}
+
+void SearchThread::DoSearchFilesParallel(const wxArrayString& files, const SearchData* data)
+{
+    wxString findWhat;
+    wxArrayString filters;
+    GetFindWhatAndFilters(data, findWhat, filters);
+
+#if wxUSE_GUI
+    wxCSConv conv(wxFontMapper::GetEncodingFromName(data->GetEncoding().c_str()));
+#else
+    const wxMBConv& conv = wxConvLibc;
+#endif
+
+    // The needle in the file's encoding
+    const wxCharBuffer cb = findWhat.mb_str(conv);
+    std::string needle(cb.data() ? cb.data() : "");
+    if(needle.empty()) {
+        // Could not convert the find string, nothing can match
+        m_summary.SetNumFileScanned((int)files.size());
+        return;
+    }
+
+    // The workers finish the files in any order. Each file has its own slot, and the slots are emitted in the
+    // order of 'files', so the matches come out exactly as a serial search would report them
+    struct FileSlot {
+        bool done = false;
+        bool failed = false;
+        SearchResultList results;
+    };
+    std::vector<FileSlot> slots(files.size());
+    size_t nextToEmit = 0;
+
+    std::atomic_size_t nextFile(0);
+    std::atomic_size_t filesScanned(0);
+    std::atomic_bool cancelled(false);
+
+    auto worker = [&]() {
+        size_t i = nextFile++;
+        while(i < files.size()) {
+            if(cancelled.load() || TestStopSearch()) {
+                cancelled.store(true);
+                break;
+            }
+            SearchResultList results;
+            bool ok = DoSearchFileMapped(files.Item(i), data, needle, findWhat, filters, results);
+            {
+                wxCriticalSectionLocker locker(m_resultsCS);
+                slots[i].results.swap(results);
+                slots[i].failed = !ok;
+                slots[i].done = true;
+            }
+            ++filesScanned;
+            i = nextFile++;
+        }
+    };
+
+    // Move the results of the files that are done, up to the first file that is not, to m_results
+    auto emitCompleted = [&]() {
+        wxCriticalSectionLocker locker(m_resultsCS);
+        for(; nextToEmit < slots.size() && slots[nextToEmit].done; ++nextToEmit) {
+            FileSlot& slot = slots[nextToEmit];
+            if(slot.failed) { m_summary.GetFailedFiles().Add(files.Item(nextToEmit)); }
+            m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + (int)slot.results.size());
+            m_results.splice(m_results.end(), slot.results);
+        }
+    };
+
+    int cpus = wxThread::GetCPUCount();
+    size_t threadsCount = (cpus > 1) ? (size_t)cpus : 2;
+    threadsCount = std::min(threadsCount, files.size());
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadsCount);
+    for(size_t i = 0; i < threadsCount; ++i) {
+        threads.emplace_back(worker);
+    }
+
+    // Stream the matches to the owner while the workers are busy
+    while(filesScanned.load() < files.size() && !cancelled.load()) {
+        wxThread::Sleep(50);
+        emitCompleted();
+        FlushResults(data->GetOwner());
+        if(TestStopSearch()) { cancelled.store(true); }
+    }
+
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    // The rest of the matches are sent with the search end (or cancel) event
+    emitCompleted();
+    m_summary.SetNumFileScanned((int)filesScanned.load());
+
+    if(cancelled.load()) {
+        SendEvent(wxEVT_SEARCH_THREAD_SEARCHCANCELED, data->GetOwner());
+        StopSearch(false);
+    }
+}
+
+bool SearchThread::DoSearchFileMapped(const wxString& fileName, const SearchData* data, const std::string& needle,
+                                      const wxString& findWhat, const wxArrayString& filters,
+                                      SearchResultList& results)
+{
+    SearchMappedFile file;
+    if(!file.Open(fileName)) { return false; }
+    if(file.GetSize() == 0) { return true; }
+
+#if wxUSE_GUI
+    wxFontEncoding enc = wxFontMapper::GetEncodingFromName(data->GetEncoding().c_str());
+    wxCSConv conv(enc);
+    bool isUTF8 = (enc == wxFONTENCODING_UTF8);
+#else
+    const wxMBConv& conv = wxConvLibc;
+    bool isUTF8 = true;
+#endif
+
+    const char* begin = file.GetData();
+    const char* end = begin + file.GetSize();
+    const char* p = begin;
+
+    // Line bookkeeping: 'lineStart' is the start of line number 'lineNumber'
+    // and 'lineOffset' its offset in characters from the start of the file
+    const char* lineStart = begin;
+    int lineNumber = 1;
+    int lineOffset = 0;
+
+    while(p < end) {
+        const char* hit = FindLiteral(p, end, needle, data->IsMatchCase());
+        if(!hit) { break; }
+
+        // Advance the line bookkeeping up to the line containing the hit
+        const char* nl = (const char*)memchr(lineStart, '\n', hit - lineStart);
+        while(nl) {
+            lineOffset += (int)CountChars(lineStart, nl + 1, isUTF8);
+            lineStart = nl + 1;
+            ++lineNumber;
+            nl = (const char*)memchr(lineStart, '\n', hit - lineStart);
+        }
+
+        const char* lineEnd = (const char*)memchr(hit, '\n', end - hit);
+        if(!lineEnd) { lineEnd = end; }
+
+        // Only now decode the line, the rest of the logic is shared with the single threaded search
+        wxString line(lineStart, conv, lineEnd - lineStart);
+        if(line.IsEmpty()) { line = wxString::From8BitData(lineStart, lineEnd - lineStart); }
+        DoSearchLine(line, lineNumber, lineOffset, fileName, data, findWhat, filters, NULL, results);
+
+        // Continue from the next line
+        p = lineEnd + 1;
+    }
+    return true;
+}
+
+void SearchThread::FlushResults(wxEvtHandler* owner)
+{
+    if(!m_notifiedWindow && !owner) return;
+
+    SearchResultList results;
+    {
+        wxCriticalSectionLocker locker(m_resultsCS);
+        results.swap(m_results);
+    }
+    if(results.empty()) return;
+
+    wxCommandEvent event(wxEVT_SEARCH_THREAD_MATCHFOUND, GetId());
+    event.SetClientData(new SearchResultList(results));
+    SEND_ST_EVENT();
+}
+
 void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const int lineOffset,
-                                  const wxString& fileName, const SearchData* data, TextStatesPtr statesPtr)
+                                  const wxString& fileName, const SearchData* data, TextStatesPtr statesPtr,
+                                  SearchResultList& results)
 {
     wxRegEx& re = GetRegex(data->GetFindString(), data->IsMatchCase());
     size_t col = 0;
@@ -394,10 +747,7 @@ void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const
                 }
             }
 
-            if(canAdd) {
-                m_results.push_back(result);
-                m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + 1);
-            }
+            if(canAdd) { results.push_back(result); }
 
             col += len;
 
@@ -410,7 +760,7 @@ void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const
 
 void SearchThread::DoSearchLine(const wxString& line, const int lineNum, const int lineOffset, const wxString& fileName,
                                 const SearchData* data, const wxString& findWhat, const wxArrayString& filters,
-                                TextStatesPtr statesPtr)
+                                TextStatesPtr statesPtr, SearchResultList& results)
 {
     wxString modLine = line;
 
@@ -521,10 +871,7 @@ void SearchThread::DoSearchLine(const wxString& line, const int lineNum, const i
                 }
             }
 
-            if(canAdd) {
-                m_results.push_back(result);
-                m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + 1);
-            }
+            if(canAdd) { results.push_back(result); }
 
             if(!AdjustLine(modLine, pos, findWhat)) { break; }
             col += (int)findWhat.Length();
@@ -532,7 +879,7 @@ void SearchThread::DoSearchLine(const wxString& line, const int lineNum, const i
     }
 }
 
-bool SearchThread::AdjustLine(wxString& line, int& pos, const wxString& findString)
+bool SearchThread::AdjustLine(wxString& line, int& pos, const wxString& findString) const
 {
     // adjust the current line
     if(line.Length() - (pos + findString.Length()) >= findString.Length()) {
@@ -59,6 +59,9 @@ enum {
     wxSD_COLOUR_COMMENTS = 0x00000100,
     wxSD_WILDCARD = 0x00000200,
     wxSD_ENABLE_PIPE_SUPPORT = 0x00000400,
+    wxSD_MULTI_THREADED = 0x00000800,
+    wxSD_USE_INDEX = 0x00001000,
+    wxSD_SKIP_VCS_FOLDERS = 0x00002000,
 };
 
 class WXDLLIMPEXP_CL SearchData : public ThreadRequest
@@ -73,6 +76,7 @@ class WXDLLIMPEXP_CL SearchData : public ThreadRequest
     wxEvtHandler* m_owner;
     wxString m_encoding;
     wxArrayString m_excludePatterns;
+    wxString m_indexFile;
     friend class SearchThread;
 
 private:
@@ -110,6 +114,17 @@ public:
     bool IsMatchCase() const { return m_flags & wxSD_MATCHCASE ? true : false; }
     bool IsEnablePipeSupport() const { return m_flags & wxSD_ENABLE_PIPE_SUPPORT; }
     void SetEnablePipeSupport(bool b) { SetOption(wxSD_ENABLE_PIPE_SUPPORT, b); }
+    bool IsMultiThreaded() const { return m_flags & wxSD_MULTI_THREADED; }
+    void SetMultiThreaded(bool b) { SetOption(wxSD_MULTI_THREADED, b); }
+    bool IsUseIndex() const { return m_flags & wxSD_USE_INDEX; }
+    void SetUseIndex(bool b) { SetOption(wxSD_USE_INDEX, b); }
+    bool IsSkipVcsFolders() const { return m_flags & wxSD_SKIP_VCS_FOLDERS; }
+    void SetSkipVcsFolders(bool b) { SetOption(wxSD_SKIP_VCS_FOLDERS, b); }
+    /**
+     * @brief the trigram index to consult when IsUseIndex() is set (see clTrigramIndex)
+     */
+    void SetIndexFile(const wxString& indexFile) { this->m_indexFile = indexFile; }
+    const wxString& GetIndexFile() const { return m_indexFile; }
     bool IsMatchWholeWord() const { return m_flags & wxSD_MATCHWHOLEWORD ? true : false; }
     bool IsRegularExpression() const { return m_flags & wxSD_REGULAREXPRESSION ? true : false; }
     const wxArrayString& GetRootDirs() const { return m_rootDirs; }
@@ -332,6 +347,7 @@ class WXDLLIMPEXP_CL SearchThread : public WorkerThread
     wxRegEx m_regex;
     bool m_matchCase;
     wxCriticalSection m_cs;
+    wxCriticalSection m_resultsCS; //< Protects m_results and m_summary while the worker pool is running
 
 private:
     /**
@@ -393,17 +409,44 @@ private:
      */
     void DoSearchFiles(ThreadRequest* data);
 
+    /**
+     * @brief search the files using a pool of worker threads. Each worker maps its file into memory
+     * and scans the raw bytes for the literal, decoding only the lines that contain a hit
+     */
+    void DoSearchFilesParallel(const wxArrayString& files, const SearchData* data);
+
+    /**
+     * @brief can 'data' be served by the parallel, byte oriented search?
+     * Only plain literal searches on an 8-bit compatible encoding qualify
+     */
+    bool CanSearchParallel(const SearchData* data) const;
+
+    /**
+     * @brief scan a memory mapped file for 'needle' (in the file's encoding). Runs on a worker thread
+     * @return false if the file could not be opened
+     */
+    bool DoSearchFileMapped(const wxString& fileName, const SearchData* data, const std::string& needle,
+                            const wxString& findWhat, const wxArrayString& filters, SearchResultList& results);
+
+    /**
+     * @brief post the results collected so far by the worker threads to the owner
+     */
+    void FlushResults(wxEvtHandler* owner);
+
+    // Split the find string into the actual string to search and the pipe filters
+    void GetFindWhatAndFilters(const SearchData* data, wxString& findWhat, wxArrayString& filters) const;
+
     // Perform search on a single file
     void DoSearchFile(const wxString& fileName, const SearchData* data);
 
     // Perform search on a line
     void DoSearchLine(const wxString& line, const int lineNum, const int lineOffset, const wxString& fileName,
                       const SearchData* data, const wxString& findWhat, const wxArrayString& filters,
-                      TextStatesPtr statesPtr);
+                      TextStatesPtr statesPtr, SearchResultList& results);
 
     // Perform search on a line using regular expression
     void DoSearchLineRE(const wxString& line, const int lineNum, const int lineOffset, const wxString& fileName,
-                        const SearchData* data, TextStatesPtr statesPtr);
+                        const SearchData* data, TextStatesPtr statesPtr, SearchResultList& results);
 
     // Send an event to the notified window
     void SendEvent(wxEventType type, wxEvtHandler* owner);
@@ -412,7 +455,7 @@ private:
     wxRegEx& GetRegex(const wxString& expr, bool matchCase);
 
     // Internal function
-    bool AdjustLine(wxString& line, int& pos, const wxString& findString);
+    bool AdjustLine(wxString& line, int& pos, const wxString& findString) const;
 
     // filter 'files' according to the files spec
     void FilterFiles(wxArrayString& files, const SearchData* data);
@@ -35,6 +35,10 @@
 //-------------------------------------------------
 TagsStorageSQLite::TagsStorageSQLite()
     : ITagsStorage()
+    , m_bulkLoad(false)
+    , m_bulkLoadDeferIndexes(false)
+    , m_savedCacheSize(2000)
+    , m_symbolIndexReload(false)
 {
     m_db = new clSqliteDB();
     SetUseCache(true);
@@ -90,16 +94,14 @@ void TagsStorageSQLite::CreateSchema()
     // improve performace by using pragma command:
     // (this needs to be done before the creation of the
     // tables and indices)
+    DoSetJournalMode();
     try {
-        sql = wxT("PRAGMA journal_mode= OFF;");
-        m_db->ExecuteUpdate(sql);
-
         sql = wxT("PRAGMA synchronous = OFF;");
         m_db->ExecuteUpdate(sql);
 
         sql = wxT("PRAGMA temp_store = MEMORY;");
         m_db->ExecuteUpdate(sql);
-        
+
         sql = wxT("create  table if not exists tags (ID INTEGER PRIMARY KEY AUTOINCREMENT, name string, file string, "
                   "line integer, kind string, access string, signature string, pattern string, parent string, inherits "
                   "string, path string, typeref string, scope string, return_value string);");
@@ -110,7 +112,7 @@ void TagsStorageSQLite::CreateSchema()
         m_db->ExecuteUpdate(sql);
 
         sql = wxT("create  table if not exists FILES (ID INTEGER PRIMARY KEY AUTOINCREMENT, file string, last_retagged "
-                  "integer);");
+                  "integer, content_hash string);");
         m_db->ExecuteUpdate(sql);
 
         sql = wxT("create  table if not exists MACROS (ID INTEGER PRIMARY KEY AUTOINCREMENT, file string, line "
@@ -142,36 +144,17 @@ void TagsStorageSQLite::CreateSchema()
         sql = wxT("CREATE UNIQUE INDEX IF NOT EXISTS TAGS_UNIQ on tags(kind, path, signature, typeref);");
         m_db->ExecuteUpdate(sql);
 
-        sql = wxT("CREATE INDEX IF NOT EXISTS KIND_IDX on tags(kind);");
-        m_db->ExecuteUpdate(sql);
-
         sql = wxT("CREATE INDEX IF NOT EXISTS FILE_IDX on tags(file);");
         m_db->ExecuteUpdate(sql);
 
         sql = wxT("CREATE UNIQUE INDEX IF NOT EXISTS MACROS_UNIQ on MACROS(name);");
         m_db->ExecuteUpdate(sql);
 
-        sql = wxT("CREATE INDEX IF NOT EXISTS global_tags_idx_1 on global_tags(name);");
-        m_db->ExecuteUpdate(sql);
-
         sql = wxT("CREATE INDEX IF NOT EXISTS global_tags_idx_2 on global_tags(tag_id);");
         m_db->ExecuteUpdate(sql);
 
         // Create search indexes
-        sql = wxT("CREATE INDEX IF NOT EXISTS TAGS_NAME on tags(name);");
-        m_db->ExecuteUpdate(sql);
-
-        sql = wxT("CREATE INDEX IF NOT EXISTS TAGS_SCOPE on tags(scope);");
-        m_db->ExecuteUpdate(sql);
-
-        sql = wxT("CREATE INDEX IF NOT EXISTS TAGS_PATH on tags(path);");
-        m_db->ExecuteUpdate(sql);
-
-        sql = wxT("CREATE INDEX IF NOT EXISTS TAGS_PARENT on tags(parent);");
-        m_db->ExecuteUpdate(sql);
-
-        sql = wxT("CREATE INDEX IF NOT EXISTS TAGS_TYPEREF on tags(typeref);");
-        m_db->ExecuteUpdate(sql);
+        DoCreateSecondaryIndexes();
 
         sql = wxT("CREATE INDEX IF NOT EXISTS MACROS_NAME on MACROS(name);");
         m_db->ExecuteUpdate(sql);
@@ -193,6 +176,175 @@ void TagsStorageSQLite::CreateSchema()
     }
 }
 
+void TagsStorageSQLite::DoCreateSecondaryIndexes()
+{
+    // These indexes are used for searching only, they are not needed for storing tags
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS KIND_IDX on tags(kind);"));
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS global_tags_idx_1 on global_tags(name);"));
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS TAGS_NAME on tags(name);"));
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS TAGS_SCOPE on tags(scope);"));
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS TAGS_PATH on tags(path);"));
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS TAGS_PARENT on tags(parent);"));
+    m_db->ExecuteUpdate(wxT("CREATE INDEX IF NOT EXISTS TAGS_TYPEREF on tags(typeref);"));
+}
+
+void TagsStorageSQLite::DoDropSecondaryIndexes()
+{
+    // Keep TAGS_UNIQ (used by 'INSERT OR REPLACE'), FILE_IDX (used when deleting a file's tags)
+    // and global_tags_idx_2 (used by the 'tags_delete' trigger). TAGS_NAME and TAGS_SCOPE are kept as well: code
+    // completion keeps querying the database by name and scope while the workspace is being retagged
+    m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS KIND_IDX"));
+    m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS global_tags_idx_1"));
+    m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_PATH"));
+    m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_PARENT"));
+    m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS TAGS_TYPEREF"));
+}
+
+void TagsStorageSQLite::DoSetJournalMode()
+{
+    // EndBulkLoad() may fail to leave WAL mode (another connection was reading the database), so the journal mode
+    // is set again every time the database is opened
+    try {
+        wxSQLite3ResultSet res = m_db->ExecuteQuery(wxT("PRAGMA journal_mode = OFF;"));
+        wxString mode = res.NextRow() ? res.GetString(0) : wxString();
+        res.Finalize();
+        if(mode.CmpNoCase(wxT("off")) != 0) {
+            clDEBUG() << "TagsStorageSQLite: the database is still in" << mode << "journal mode" << clEndl;
+        }
+
+    } catch(wxSQLite3Exception& e) {
+        clDEBUG() << "TagsStorageSQLite: failed to set the journal mode:" << e.GetMessage() << clEndl;
+    }
+}
+
+void TagsStorageSQLite::DoNotifySymbolIndex()
+{
+    // Changes are visible to the symbol index connection only once committed
+    if(!m_db->IsOpen() || !m_db->GetAutoCommit()) { return; }
+
+    // A bulk load rebuilds the entire index when done
+    if(m_bulkLoad) {
+        m_modifiedFiles.clear();
+        return;
+    }
+
+    if(m_symbolIndexReload) {
+        clSymbolIndex::Get().Reload(m_fileName);
+    } else if(!m_modifiedFiles.empty()) {
+        clSymbolIndex::Get().MarkFilesDirty(m_fileName, m_modifiedFiles);
+    }
+    m_symbolIndexReload = false;
+    m_modifiedFiles.clear();
+}
+
+void TagsStorageSQLite::DoFetchTagsByIds(const std::vector<clSymbolIndex::SymbolId_t>& ids,
+                                         std::vector<TagEntryPtr>& tags)
+{
+    if(ids.empty()) { return; }
+
+    // The IDs are bound in fixed size batches, so the statement is compiled once. A short batch repeats its last ID
+    static const size_t BATCH_SIZE = 32;
+    static wxString sql;
+    if(sql.IsEmpty()) {
+        sql << wxT("select * from tags where ID in (");
+        for(size_t i = 0; i < BATCH_SIZE; ++i) {
+            sql << wxT("?,");
+        }
+        sql.RemoveLast();
+        sql << wxT(")");
+    }
+
+    std::unordered_map<clSymbolIndex::SymbolId_t, TagEntryPtr> fetched;
+    try {
+        for(size_t first = 0; first < ids.size(); first += BATCH_SIZE) {
+            wxSQLite3Statement& statement = m_db->GetPrepareStatement(sql);
+            for(size_t i = 0; i < BATCH_SIZE; ++i) {
+                statement.Bind((int)i + 1, wxLongLong(ids[std::min(first + i, ids.size() - 1)]));
+            }
+            wxSQLite3ResultSet rs = statement.ExecuteQuery();
+            while(rs.NextRow()) {
+                fetched[rs.GetInt64(0).GetValue()] = TagEntryPtr(FromSQLite3ResultSet(rs));
+            }
+            statement.Reset();
+        }
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "TagsStorageSQLite::DoFetchTagsByIds() error:" << e.GetMessage() << clEndl;
+    }
+
+    // The symbol index returns the IDs ranked, the database returns them in its own order
+    tags.reserve(tags.size() + fetched.size());
+    for(size_t i = 0; i < ids.size(); ++i) {
+        std::unordered_map<clSymbolIndex::SymbolId_t, TagEntryPtr>::iterator iter = fetched.find(ids[i]);
+        if(iter == fetched.end()) { continue; }
+        tags.push_back(iter->second);
+        fetched.erase(iter); // An ID that appears twice is reported once, like 'ID in (...)' does
+    }
+}
+
+void TagsStorageSQLite::BeginBulkLoad(bool deferIndexes)
+{
+    if(m_bulkLoad || !IsOpen()) return;
+
+    m_bulkLoad = true;
+    m_bulkLoadDeferIndexes = deferIndexes;
+    ClearCache();
+
+    try {
+        // Remember the current cache size so we can restore it when done
+        wxSQLite3ResultSet res = m_db->ExecuteQuery(wxT("PRAGMA cache_size;"));
+        if(res.NextRow()) { m_savedCacheSize = res.GetInt(0); }
+        res.Finalize();
+
+        // WAL allows the other connections (e.g. code completion) to keep reading while we write
+        m_db->ExecuteUpdate(wxT("PRAGMA journal_mode = WAL;"));
+        m_db->ExecuteUpdate(wxT("PRAGMA synchronous = OFF;"));
+        // 64MB page cache (negative value means KiB)
+        m_db->ExecuteUpdate(wxT("PRAGMA cache_size = -65536;"));
+
+        if(m_bulkLoadDeferIndexes) { DoDropSecondaryIndexes(); }
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "TagsStorageSQLite::BeginBulkLoad:" << e.GetMessage() << clEndl;
+    }
+}
+
+void TagsStorageSQLite::EndBulkLoad()
+{
+    if(!m_bulkLoad) return;
+    m_bulkLoad = false;
+
+    try {
+        // Build the search indexes once, over the complete table
+        if(m_bulkLoadDeferIndexes) { DoCreateSecondaryIndexes(); }
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "TagsStorageSQLite::EndBulkLoad: failed to create the indexes:" << e.GetMessage() << clEndl;
+    }
+
+    try {
+        m_db->ExecuteUpdate(wxString() << wxT("PRAGMA cache_size = ") << m_savedCacheSize << wxT(";"));
+
+    } catch(wxSQLite3Exception& e) {
+        clWARNING() << "TagsStorageSQLite::EndBulkLoad: failed to restore the cache size:" << e.GetMessage()
+                    << clEndl;
+    }
+
+    try {
+        m_db->ExecuteUpdate(wxT("PRAGMA wal_checkpoint;"));
+
+    } catch(wxSQLite3Exception& e) {
+        clDEBUG() << "TagsStorageSQLite::EndBulkLoad: checkpoint failed:" << e.GetMessage() << clEndl;
+    }
+    // Leaving WAL mode requires that no other connection is using the database (which is usually not the case
+    // while code completion is running). If this fails we stay in WAL mode until the database is opened again
+    DoSetJournalMode();
+    m_bulkLoadDeferIndexes = false;
+    ClearCache();
+
+    m_modifiedFiles.clear();
+    clSymbolIndex::Get().Reload(m_fileName);
+}
+
 void TagsStorageSQLite::RecreateDatabase()
 {
     try {
@@ -243,6 +395,9 @@ void TagsStorageSQLite::RecreateDatabase()
             m_fileName.Clear();
             OpenDatabase(filename);
         }
+
+        m_modifiedFiles.clear();
+        clSymbolIndex::Get().Reload(m_fileName);
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
     }
@@ -289,10 +444,13 @@ void TagsStorageSQLite::Store(TagTreePtr tree, const wxFileName& path, bool auto
             // Skip root node
             if(walker.GetNode() == tree->GetRoot()) continue;
 
-            DoInsertTagEntry(walker.GetNode()->GetData());
+            const TagEntry& tag = walker.GetNode()->GetData();
+            if(tag.IsOk()) { m_modifiedFiles.insert(tag.GetFile()); }
+            DoInsertTagEntry(tag);
         }
 
         if(autoCommit) m_db->Commit();
+        DoNotifySymbolIndex();
 
     } catch(wxSQLite3Exception& e) {
         try {
@@ -330,14 +488,14 @@ void TagsStorageSQLite::DeleteByFileName(const wxFileName& path, const wxString&
 
         if(autoCommit) m_db->Begin();
 
-        wxString sql = wxString::Format(wxT("Delete from tags where File='%s'"), fileName.GetData());
-        //#ifdef __WXMSW__
-        //        sql << " COLLATE NOCASE ";
-        //#endif
-        CL_DEBUG("TagsStorageSQLite: DeleteByFileName: '%s'", sql);
-        m_db->ExecuteUpdate(sql);
+        CL_DEBUG("TagsStorageSQLite: DeleteByFileName: '%s'", fileName);
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(wxT("Delete from tags where File=?"));
+        statement.Bind(1, fileName);
+        statement.ExecuteUpdate();
+        m_modifiedFiles.insert(fileName);
 
         if(autoCommit) m_db->Commit();
+        DoNotifySymbolIndex();
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
         if(autoCommit) m_db->Rollback();
@@ -379,17 +537,26 @@ void TagsStorageSQLite::GetFilesForCC(const wxString& userTyped, wxArrayString&
         // separator
         tmpName.Replace("\\", "/");
         tmpName.Replace("/", wxString() << wxFILE_SEP_PATH);
-        tmpName.Replace(wxT("_"), wxT("^_"));
-        query << wxT("select * from files where file like '%%") << tmpName << wxT("%%' ESCAPE '^' ")
-              << wxT("order by file");
+
+        // Try the symbol index first
+        wxArrayString files;
+        if(!clSymbolIndex::Get().FindFiles(m_fileName, tmpName, files)) {
+            tmpName.Replace(wxT("_"), wxT("^_"));
+            query << wxT("select * from files where file like '%%") << tmpName << wxT("%%' ESCAPE '^' ")
+                  << wxT("order by file");
+
+            wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
+            while(res.NextRow()) {
+                files.Add(res.GetString(1));
+            }
+        }
 
         wxString pattern = userTyped;
         pattern.Replace("\\", "/");
 
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
-        while(res.NextRow()) {
+        for(size_t i = 0; i < files.size(); ++i) {
             // Keep the part from where the user typed and until the end of the file name
-            wxString matchedFile = res.GetString(1);
+            wxString matchedFile = files.Item(i);
             matchedFile.Replace("\\", "/");
 
             int where = matchedFile.Find(pattern);
@@ -421,6 +588,7 @@ void TagsStorageSQLite::GetFiles(const wxString& partialName, std::vector<FileEn
             fe->SetId(res.GetInt(0));
             fe->SetFile(res.GetString(1));
             fe->SetLastRetaggedTimestamp(res.GetInt(2));
+            fe->SetContentHash(res.GetString(3));
 
             wxFileName fileName(fe->GetFile());
             wxString match = match_path ? fileName.GetFullPath() : fileName.GetFullName();
@@ -459,6 +627,8 @@ void TagsStorageSQLite::DeleteByFilePrefix(const wxFileName& dbpath, const wxStr
 
         sql << wxT("delete from tags where file like '") << name << wxT("%%' ESCAPE '^' ");
         m_db->ExecuteUpdate(sql);
+        m_symbolIndexReload = true;
+        DoNotifySymbolIndex();
 
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
@@ -477,6 +647,7 @@ void TagsStorageSQLite::GetFiles(std::vector<FileEntryPtr>& files)
             fe->SetId(res.GetInt(0));
             fe->SetFile(res.GetString(1));
             fe->SetLastRetaggedTimestamp(res.GetInt(2));
+            fe->SetContentHash(res.GetString(3));
 
             files.push_back(fe);
         }
@@ -503,6 +674,8 @@ void TagsStorageSQLite::DeleteFromFiles(const wxArrayString& files)
 
     try {
         m_db->ExecuteQuery(query);
+        m_modifiedFiles.insert(files.begin(), files.end());
+        DoNotifySymbolIndex();
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
     }
@@ -520,6 +693,8 @@ void TagsStorageSQLite::DeleteFromFilesByPrefix(const wxFileName& dbpath, const
 
         sql << wxT("delete from FILES where file like '") << name << wxT("%%' ESCAPE '^' ");
         m_db->ExecuteUpdate(sql);
+        m_symbolIndexReload = true;
+        DoNotifySymbolIndex();
 
     } catch(wxSQLite3Exception& e) {
         wxUnusedVar(e);
@@ -647,6 +822,14 @@ void TagsStorageSQLite::GetTagsByScopeAndName(const wxString& scope, const wxStr
 {
     if(name.IsEmpty()) return;
 
+    // Try the symbol index first
+    std::vector<clSymbolIndex::SymbolId_t> ids;
+    if(clSymbolIndex::Get().FindByScopeAndName(m_fileName, scope, name, partialNameAllowed, m_enableCaseInsensitive,
+                                               DoGetSearchLimit(tags), ids)) {
+        DoFetchTagsByIds(ids, tags);
+        return;
+    }
+
     wxString sql;
     sql << wxT("select * from tags where ");
 
@@ -809,9 +992,11 @@ void TagsStorageSQLite::GetTagsByKindAndFile(const wxArrayString& kind, const wx
 int TagsStorageSQLite::DeleteFileEntry(const wxString& filename)
 {
     try {
-        wxSQLite3Statement statement = m_db->GetPrepareStatement(wxT("DELETE FROM FILES WHERE FILE=?"));
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(wxT("DELETE FROM FILES WHERE FILE=?"));
         statement.Bind(1, filename);
         statement.ExecuteUpdate();
+        m_modifiedFiles.insert(filename);
+        DoNotifySymbolIndex();
 
     } catch(wxSQLite3Exception& exc) {
         if(exc.ErrorCodeAsString(exc.GetErrorCode()) == wxT("SQLITE_CONSTRAINT")) return TagExist;
@@ -820,14 +1005,17 @@ int TagsStorageSQLite::DeleteFileEntry(const wxString& filename)
     return TagOk;
 }
 
-int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp)
+int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp, const wxString& contentHash)
 {
     try {
-        wxSQLite3Statement statement =
-            m_db->GetPrepareStatement(wxT("INSERT OR REPLACE INTO FILES VALUES(NULL, ?, ?)"));
+        wxSQLite3Statement& statement =
+            m_db->GetPrepareStatement(wxT("INSERT OR REPLACE INTO FILES VALUES(NULL, ?, ?, ?)"));
         statement.Bind(1, filename);
         statement.Bind(2, timestamp);
+        statement.Bind(3, contentHash);
         statement.ExecuteUpdate();
+        m_modifiedFiles.insert(filename);
+        DoNotifySymbolIndex();
 
     } catch(wxSQLite3Exception& exc) {
         return TagError;
@@ -835,14 +1023,17 @@ int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp)
     return TagOk;
 }
 
-int TagsStorageSQLite::UpdateFileEntry(const wxString& filename, int timestamp)
+int TagsStorageSQLite::UpdateFileEntry(const wxString& filename, int timestamp, const wxString& contentHash)
 {
     try {
-        wxSQLite3Statement statement =
-            m_db->GetPrepareStatement(wxT("UPDATE OR REPLACE FILES SET last_retagged=? WHERE file=?"));
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(
+            wxT("UPDATE OR REPLACE FILES SET last_retagged=?, content_hash=? WHERE file=?"));
         statement.Bind(1, timestamp);
-        statement.Bind(2, filename);
+        statement.Bind(2, contentHash);
+        statement.Bind(3, filename);
         statement.ExecuteUpdate();
+        m_modifiedFiles.insert(filename);
+        DoNotifySymbolIndex();
 
     } catch(wxSQLite3Exception& exc) {
         return TagError;
@@ -856,10 +1047,11 @@ int TagsStorageSQLite::DoInsertTagEntry(const TagEntry& tag)
     if(!tag.IsOk()) return TagOk;
 
     // does not matter if we insert or update, the cache must be cleared for any related tags
-    if(GetUseCache()) { ClearCache(); }
+    // (during a bulk load, the cache is cleared once by BeginBulkLoad / EndBulkLoad)
+    if(GetUseCache() && !m_bulkLoad) { ClearCache(); }
 
     try {
-        wxSQLite3Statement statement = m_db->GetPrepareStatement(
+        wxSQLite3Statement& statement = m_db->GetPrepareStatement(
             wxT("INSERT OR REPLACE INTO TAGS VALUES (NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
         statement.Bind(1, tag.GetName());
         statement.Bind(2, tag.GetFile());
@@ -1172,6 +1364,21 @@ void TagsStorageSQLite::GetTagsByScopeAndName(const wxArrayString& scope, const
     }
 
     if(scopes.IsEmpty() == false) {
+        // Try the symbol index first
+        std::vector<clSymbolIndex::SymbolId_t> ids;
+        size_t limit = DoGetSearchLimit(tags);
+        bool indexed = true;
+        for(size_t i = 0; i < scopes.GetCount() && ids.size() < limit; i++) {
+            indexed = clSymbolIndex::Get().FindByScopeAndName(m_fileName, scopes.Item(i), name, partialNameAllowed,
+                                                              m_enableCaseInsensitive, limit, ids);
+            if(!indexed) { break; }
+        }
+
+        if(indexed) {
+            DoFetchTagsByIds(ids, tags);
+            return;
+        }
+
         wxString sql;
         sql << wxT("select * from tags where scope in(");
 
@@ -1411,9 +1618,9 @@ PPToken TagsStorageSQLite::GetMacro(const wxString& name)
 void TagsStorageSQLite::StoreMacros(const std::map<wxString, PPToken>& table)
 {
     try {
-        wxSQLite3Statement stmntCC =
+        wxSQLite3Statement& stmntCC =
             m_db->GetPrepareStatement(wxT("insert or replace into MACROS values(NULL, ?, ?, ?, ?, ?, ?)"));
-        wxSQLite3Statement stmntSimple =
+        wxSQLite3Statement& stmntSimple =
             m_db->GetPrepareStatement(wxT("insert or replace into SIMPLE_MACROS values(NULL, ?, ?)"));
 
         std::map<wxString, PPToken>::const_iterator iter = table.begin();
@@ -1538,6 +1745,13 @@ void TagsStorageSQLite::DoAddNamePartToQuery(wxString& sql, const wxString& name
     }
 }
 
+size_t TagsStorageSQLite::DoGetSearchLimit(const std::vector<TagEntryPtr>& tags) const
+{
+    // Same as DoAddLimitPartToQuery()
+    size_t limit = (size_t)GetSingleSearchLimit();
+    return tags.size() >= limit ? 1 : limit - tags.size();
+}
+
 void TagsStorageSQLite::DoAddLimitPartToQuery(wxString& sql, const std::vector<TagEntryPtr>& tags)
 {
     if(tags.size() >= (size_t)GetSingleSearchLimit()) {
@@ -1575,6 +1789,13 @@ void TagsStorageSQLite::GetTagsByPartName(const wxString& partname, std::vector<
     try {
         if(partname.IsEmpty()) return;
 
+        // Try the symbol index first
+        std::vector<clSymbolIndex::SymbolId_t> ids;
+        if(clSymbolIndex::Get().FindByPartName(m_fileName, partname, DoGetSearchLimit(tags), ids)) {
+            DoFetchTagsByIds(ids, tags);
+            return;
+        }
+
         wxString tmpName(partname);
         tmpName.Replace(wxT("_"), wxT("^_"));
 
@@ -1656,7 +1877,7 @@ void TagsStorageSQLite::RemoveNonWorkspaceSymbols(const std::vector<wxString>& s
 
 const wxString& TagsStorageSQLite::GetVersion() const
 {
-    static const wxString gTagsDatabaseVersion(wxT("CodeLite Version 11.1"));
+    static const wxString gTagsDatabaseVersion(wxT("CodeLite Version 11.2"));
     return gTagsDatabaseVersion;
 }
 
@@ -1666,6 +1887,13 @@ void TagsStorageSQLite::GetTagsByPartName(const wxArrayString& parts, std::vecto
     try {
         if(parts.IsEmpty()) { return; }
 
+        // Try the symbol index first
+        std::vector<clSymbolIndex::SymbolId_t> ids;
+        if(clSymbolIndex::Get().FindByPathParts(m_fileName, parts, DoGetSearchLimit(tags), ids)) {
+            DoFetchTagsByIds(ids, tags);
+            return;
+        }
+
         wxString filterQuery = "where ";
         for(size_t i = 0; i < parts.size(); ++i) {
             wxString tmpName = parts.Item(i);
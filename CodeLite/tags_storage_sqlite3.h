@@ -30,6 +30,7 @@
 #include <wx/filename.h>
 #include <unordered_map>
 #include "fileentry.h"
+#include "clSymbolIndex.h"
 #include "istorage.h"
 #include <wx/wxsqlite3.h>
 #include "codelite_exports.h"
@@ -121,18 +122,40 @@ public:
 
     void Close()
     {
-        if(IsOpen()) wxSQLite3Database::Close();
-
+        // Statements must be finalized before the database is closed
         m_statements.clear();
+        if(IsOpen()) wxSQLite3Database::Close();
     }
 
-    wxSQLite3Statement GetPrepareStatement(const wxString& sql) { return wxSQLite3Database::PrepareStatement(sql); }
+    /**
+     * @brief return a prepared statement for 'sql'. The statement is compiled once and re-used
+     * by subsequent calls (it is reset and its bindings are cleared before it is returned).
+     * The returned reference remains valid until the database is closed
+     */
+    wxSQLite3Statement& GetPrepareStatement(const wxString& sql)
+    {
+        std::unordered_map<wxString, wxSQLite3Statement>::iterator iter = m_statements.find(sql);
+        if(iter == m_statements.end()) {
+            wxSQLite3Statement statement = wxSQLite3Database::PrepareStatement(sql);
+            iter = m_statements.insert(std::make_pair(sql, statement)).first;
+        } else {
+            iter->second.Reset();
+            iter->second.ClearBindings();
+        }
+        return iter->second;
+    }
 };
 
 class WXDLLIMPEXP_CL TagsStorageSQLite : public ITagsStorage
 {
     clSqliteDB* m_db;
     TagsStorageSQLiteCache m_cache;
+    bool m_bulkLoad;
+    bool m_bulkLoadDeferIndexes;
+    long m_savedCacheSize;
+    // Files modified by the current transaction, reported to the symbol index once committed
+    wxStringSet_t m_modifiedFiles;
+    bool m_symbolIndexReload;
 
 private:
     /**
@@ -151,7 +174,25 @@ private:
 
     void DoAddNamePartToQuery(wxString& sql, const wxString& name, bool partial, bool prependAnd);
     void DoAddLimitPartToQuery(wxString& sql, const std::vector<TagEntryPtr>& tags);
+    size_t DoGetSearchLimit(const std::vector<TagEntryPtr>& tags) const;
     int DoInsertTagEntry(const TagEntry& tag);
+    void DoCreateSecondaryIndexes();
+    void DoDropSecondaryIndexes();
+
+    /**
+     * @brief switch the database (back) to 'journal_mode = OFF'
+     */
+    void DoSetJournalMode();
+
+    /**
+     * @brief fetch tags by their IDs (as returned by the symbol index)
+     */
+    void DoFetchTagsByIds(const std::vector<clSymbolIndex::SymbolId_t>& ids, std::vector<TagEntryPtr>& tags);
+
+    /**
+     * @brief report the modified files to the symbol index (only when there is no open transaction)
+     */
+    void DoNotifySymbolIndex();
 
 public:
     static TagEntry* FromSQLite3ResultSet(wxSQLite3ResultSet& rs);
@@ -205,6 +246,25 @@ public:
      */
     void Store(TagTreePtr tree, const wxFileName& path, bool autoCommit = true);
 
+    /**
+     * @brief prepare the database for storing a large number of files.
+     * Switch to WAL journaling with a larger page cache and (optionally) drop the search indexes so
+     * they are built once by EndBulkLoad() instead of being updated for every inserted tag. The name and scope
+     * indexes are never dropped, code completion needs them while the bulk load runs
+     * @param deferIndexes drop the secondary indexes until EndBulkLoad() is called
+     */
+    virtual void BeginBulkLoad(bool deferIndexes);
+
+    /**
+     * @brief restore the settings modified by BeginBulkLoad() and rebuild the secondary indexes
+     */
+    virtual void EndBulkLoad();
+
+    /**
+     * @brief are we inside a BeginBulkLoad() / EndBulkLoad() block?
+     */
+    virtual bool IsBulkLoad() const { return m_bulkLoad; }
+
     /**
      * Return a result set of tags according to file name.
      * @param file Source file name
@@ -278,12 +338,18 @@ public:
         } catch(wxSQLite3Exception& e) {
             wxUnusedVar(e);
         }
+        DoNotifySymbolIndex();
     }
 
     /**
      * Rollback transaction.
      */
-    void Rollback() { return m_db->Rollback(); }
+    void Rollback()
+    {
+        m_modifiedFiles.clear();
+        m_symbolIndexReload = false;
+        return m_db->Rollback();
+    }
 
     /**
      * Test whether the database is opened
@@ -491,17 +557,19 @@ public:
     /**
      * @brief insert entry by file name
      * @param filename
+     * @param contentHash the file content hash
      * @return
      */
-    virtual int InsertFileEntry(const wxString& filename, int timestamp);
+    virtual int InsertFileEntry(const wxString& filename, int timestamp, const wxString& contentHash = "");
 
     /**
     * @brief update file entry using file name as key
     * @param filename
     * @param timestamp new timestamp
+    * @param contentHash the file content hash
     * @return
     */
-    virtual int UpdateFileEntry(const wxString& filename, int timestamp);
+    virtual int UpdateFileEntry(const wxString& filename, int timestamp, const wxString& contentHash = "");
 
     /**
      * @brief return true if type exist under a given scope.
@@ -30,6 +30,7 @@
 
 #if defined(__WXMAC__) || defined(__WXGTK__)
 
+#include "clProcessReactor.h"
 #include "procutils.h"
 #include <errno.h>
 #include <signal.h>
@@ -301,15 +302,11 @@ UnixProcessImpl::~UnixProcessImpl() { Cleanup(); }
 
 void UnixProcessImpl::Cleanup()
 {
+    // Stop reading before the handles are closed (and their numbers reused)
+    StopReaderThread();
     close(GetReadHandle());
     close(GetWriteHandle());
     if(GetStderrHandle() != wxNOT_FOUND) { close(GetStderrHandle()); }
-    if(m_thr) {
-        // Stop the reader thread
-        m_thr->Stop();
-        delete m_thr;
-    }
-    m_thr = NULL;
 
     if(GetPid() != wxNOT_FOUND) {
         wxKill(GetPid(), GetHardKill() ? wxSIGKILL : wxSIGTERM, NULL, wxKILL_CHILDREN);
@@ -321,32 +318,68 @@ void UnixProcessImpl::Cleanup()
 
 bool UnixProcessImpl::IsAlive() { return kill(m_pid, 0) == 0; }
 
-bool UnixProcessImpl::ReadFromFd(int fd, fd_set& rset, wxString& output)
+bool UnixProcessImpl::ReadFromFd(int fd, fd_set& rset, std::string& output)
 {
     if(fd == wxNOT_FOUND) { return false; }
     if(FD_ISSET(fd, &rset)) {
         // there is something to read
         char buffer[BUFF_SIZE + 1]; // our read buffer
         memset(buffer, 0, sizeof(buffer));
-        int bytesRead = read(fd, buffer, sizeof(buffer));
+        // leave room for the terminator: a full read must not lose its last byte
+        int bytesRead = read(fd, buffer, BUFF_SIZE);
         if(bytesRead > 0) {
             buffer[BUFF_SIZE] = 0; // always place a terminator
 
             // Remove coloring chars from the incomnig buffer
             // colors are marked with ESC and terminates with lower case 'm'
             RemoveTerminalColoring(buffer);
-
-            wxString convBuff = wxString(buffer, wxConvUTF8);
-            if(convBuff.IsEmpty()) { convBuff = wxString::From8BitData(buffer); }
-
-            output = convBuff;
+            output.assign(buffer, strlen(buffer));
             return true;
         }
     }
     return false;
 }
 
+bool UnixProcessImpl::ReadAsync(int fd, bool isStderr)
+{
+    char buffer[BUFF_SIZE + 1]; // our read buffer
+    int bytesRead = read(fd, buffer, BUFF_SIZE);
+    if(bytesRead == 0) { return false; }
+    if(bytesRead < 0) { return (errno == EAGAIN || errno == EINTR); }
+    buffer[bytesRead] = 0;
+
+    // Remove coloring chars from the incomnig buffer
+    // colors are marked with ESC and terminates with lower case 'm'
+    RemoveTerminalColoring(buffer);
+    // Pass the bytes as-is, they are decoded on the main thread only if someone reads them
+    PostOutput(buffer, strlen(buffer), isStderr);
+    return true;
+}
+
+void UnixProcessImpl::NotifyTerminated()
+{
+    FlushOutput();
+    clDEBUG1() << "Process" << GetPid() << "output:" << GetOutputStatistics().ToString();
+    if(m_callback) {
+        m_callback->CallAfter(&IProcessCallback::OnProcessTerminated);
+
+    } else if(m_parent) {
+        clProcessEvent e(wxEVT_ASYNC_PROCESS_TERMINATED);
+        e.SetProcess(this);
+        m_parent->AddPendingEvent(e);
+    }
+}
+
 bool UnixProcessImpl::Read(wxString& buff, wxString& buffErr)
+{
+    std::string out, err;
+    bool res = ReadBytes(out, err);
+    buff = clProcessOutputChannel::Decode(out);
+    buffErr = clProcessOutputChannel::Decode(err);
+    return res;
+}
+
+bool UnixProcessImpl::ReadBytes(std::string& buff, std::string& buffErr)
 {
     fd_set rs;
     timeval timeout;
@@ -361,7 +394,8 @@ bool UnixProcessImpl::Read(wxString& buff, wxString& buffErr)
     int errCode(0);
     errno = 0;
 
-    buff.Clear();
+    buff.clear();
+    buffErr.clear();
     int maxFd = wxMax(GetStderrHandle(), GetReadHandle());
     int rc = select(maxFd + 1, &rs, NULL, NULL, &timeout);
     errCode = errno;
@@ -515,11 +549,31 @@ IProcess* UnixProcessImpl::Execute(wxEvtHandler* parent, const wxString& cmd, si
 
 void UnixProcessImpl::StartReaderThread()
 {
+#if defined(__linux__)
+    // A single epoll thread serves all the processes
+    clProcessReactor::Get().Add(this);
+    m_watched = true;
+#else
     // Launch the 'Reader' thread
     m_thr = new ProcessReaderThread();
     m_thr->SetProcess(this);
     m_thr->SetNotifyWindow(m_parent);
     m_thr->Start();
+#endif
+}
+
+void UnixProcessImpl::StopReaderThread()
+{
+#if defined(__linux__)
+    if(m_watched) { clProcessReactor::Get().Remove(this); }
+    m_watched = false;
+#endif
+    if(m_thr) {
+        // Stop the reader thread
+        m_thr->Stop();
+        delete m_thr;
+    }
+    m_thr = NULL;
 }
 
 void UnixProcessImpl::Terminate()
@@ -540,14 +594,6 @@ bool UnixProcessImpl::WriteToConsole(const wxString& buff)
     return bytes == (int)tmpbuf.length();
 }
 
-void UnixProcessImpl::Detach()
-{
-    if(m_thr) {
-        // Stop the reader thread
-        m_thr->Stop();
-        delete m_thr;
-    }
-    m_thr = NULL;
-}
+void UnixProcessImpl::Detach() { StopReaderThread(); }
 
 #endif //#if defined(__WXMAC )||defined(__WXGTK__)
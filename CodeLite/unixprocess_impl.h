@@ -31,6 +31,8 @@
 #include "processreaderthread.h"
 #include "codelite_exports.h"
 
+class clProcessReactor;
+
 class wxTerminal;
 class WXDLLIMPEXP_CL UnixProcessImpl : public IProcess
 {
@@ -38,12 +40,23 @@ class WXDLLIMPEXP_CL UnixProcessImpl : public IProcess
     int m_stderrHandle = wxNOT_FOUND;
     int m_writeHandle;
     ProcessReaderThread* m_thr = nullptr;
+    bool m_watched = false; // Is this process watched by the clProcessReactor?
 
     friend class wxTerminal;
+    friend class clProcessReactor;
 
 private:
     void StartReaderThread();
-    bool ReadFromFd(int fd, fd_set& rset, wxString& output);
+    void StopReaderThread();
+    bool ReadFromFd(int fd, fd_set& rset, std::string& output);
+
+    /**
+     * @brief read the available output from 'fd' and pass it to the callback or the parent.
+     * Called by the clProcessReactor
+     * @return false if there is nothing more to read from 'fd'
+     */
+    bool ReadAsync(int fd, bool isStderr);
+    void NotifyTerminated();
     
 public:
     UnixProcessImpl(wxEvtHandler* parent);
@@ -63,6 +76,7 @@ public:
     virtual void Cleanup();
     virtual bool IsAlive();
     virtual bool Read(wxString& buff, wxString& buffErr);
+    virtual bool ReadBytes(std::string& buff, std::string& buffErr);
     virtual bool Write(const wxString& buff);
     virtual void Terminate();
     virtual bool WriteToConsole(const wxString& buff);
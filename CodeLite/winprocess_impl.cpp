@@ -280,11 +280,20 @@ WinProcessImpl::WinProcessImpl(wxEvtHandler* parent)
 WinProcessImpl::~WinProcessImpl() { Cleanup(); }
 
 bool WinProcessImpl::Read(wxString& buff, wxString& buffErr)
+{
+    std::string out, err;
+    bool res = ReadBytes(out, err);
+    buff = clProcessOutputChannel::Decode(out);
+    buffErr = clProcessOutputChannel::Decode(err);
+    return res;
+}
+
+bool WinProcessImpl::ReadBytes(std::string& buff, std::string& buffErr)
 {
     DWORD le1(-1);
     DWORD le2(-1);
-    buff.Clear();
-    buffErr.Clear();
+    buff.clear();
+    buffErr.clear();
 
     // Sanity
     if(!IsRedirect()) { return false; }
@@ -298,7 +307,7 @@ bool WinProcessImpl::Read(wxString& buff, wxString& buffErr)
             return true;
         }
     }
-    bool success = !buff.IsEmpty() || !buffErr.IsEmpty();
+    bool success = !buff.empty() || !buffErr.empty();
     if(!success) {
         DWORD dwExitCode;
         if(GetExitCodeProcess(piProcInfo.hProcess, &dwExitCode)) { SetProcessExitCode(GetPid(), (int)dwExitCode); }
@@ -397,12 +406,11 @@ void WinProcessImpl::StartReaderThread()
     m_thr->Start();
 }
 
-bool WinProcessImpl::DoReadFromPipe(HANDLE pipe, wxString& buff)
+bool WinProcessImpl::DoReadFromPipe(HANDLE pipe, std::string& buff)
 {
     DWORD dwRead;
     DWORD dwMode;
     DWORD dwTimeout;
-    memset(m_buffer, 0, sizeof(m_buffer));
 
     // Make the pipe to non-blocking mode
     dwMode = PIPE_READMODE_BYTE | PIPE_NOWAIT;
@@ -411,15 +419,8 @@ bool WinProcessImpl::DoReadFromPipe(HANDLE pipe, wxString& buff)
 
     BOOL bRes = ReadFile(pipe, m_buffer, 65536, &dwRead, NULL);
     if(bRes) {
-        wxString tmpBuff;
-        // Success read
-        m_buffer[dwRead / sizeof(char)] = 0;
-        tmpBuff = wxString(m_buffer, wxConvUTF8);
-        if(tmpBuff.IsEmpty() && dwRead > 0) {
-            // conversion failed
-            tmpBuff = wxString::From8BitData(m_buffer);
-        }
-        buff << tmpBuff;
+        // Success read. Keep the bytes as they are, they are decoded by whoever needs text
+        buff.append(m_buffer, dwRead);
         return true;
     }
 
@@ -41,7 +41,7 @@ class WXDLLIMPEXP_CL WinProcessImpl : public IProcess
 
 protected:
     void StartReaderThread();
-    bool DoReadFromPipe(HANDLE pipe, wxString& buff);
+    bool DoReadFromPipe(HANDLE pipe, std::string& buff);
     bool DoReadFromConsoleBuffer(HANDLE handle, wxString& buff);
 
 public:
@@ -59,6 +59,7 @@ public:
      * @return return true on success or timeout, flase otherwise, incase of false the reader thread will terminate
      */
     virtual bool Read(wxString& buff, wxString& buffErr);
+    virtual bool ReadBytes(std::string& buff, std::string& buffErr);
 
     // Write to the process stdin
     virtual bool Write(const wxString& buff);
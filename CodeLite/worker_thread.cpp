@@ -37,8 +37,8 @@ void* WorkerThread::Entry()
     while(true) {
         // Did we get a request to terminate?
         if(TestDestroy()) break;
-        ThreadRequest* request = NULL;
-        if(m_queue.ReceiveTimeout(50, request) == wxMSGQUEUE_NO_ERROR) {
+        ThreadRequest* request = GetNextRequest(50);
+        if(request) {
             // Call user's implementation for processing request
             ProcessRequest(request);
             wxDELETE(request);
@@ -47,6 +47,13 @@ void* WorkerThread::Entry()
     return NULL;
 }
 
+ThreadRequest* WorkerThread::GetNextRequest(long timeout)
+{
+    ThreadRequest* request = NULL;
+    if(m_queue.ReceiveTimeout(timeout, request) == wxMSGQUEUE_NO_ERROR) { return request; }
+    return NULL;
+}
+
 void WorkerThread::Add(ThreadRequest* request)
 {
     if(!request) { return; }
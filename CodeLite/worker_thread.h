@@ -77,7 +77,7 @@ public:
      * Add a request to the worker thread
      * \param request request to execute.
      */
-    void Add(ThreadRequest* request);
+    virtual void Add(ThreadRequest* request);
 
     /**
      * Set the window to be notified when a change was done
@@ -105,6 +105,14 @@ public:
      * \param request ThreadRequest object to process
      */
     virtual void ProcessRequest(ThreadRequest* request) = 0;
+
+protected:
+    /**
+     * Wait for the next request to process
+     * \param timeout maximum time to wait, in milliseconds
+     * \return the next request or NULL if no request arrived in time
+     */
+    virtual ThreadRequest* GetNextRequest(long timeout);
 };
 
 #endif // WORKER_THREAD_H
@@ -1,5 +1,7 @@
 #include "CxxTokenizer.h"
 #include "CxxVariableScanner.h"
+#include "LSP/MessageFramer.h"
+#include "clFilesCollector.h"
 #include "ctags_manager.h"
 #include "fileutils.h"
 #include "tester.h"
@@ -188,6 +190,139 @@ TEST_FUNC(test_local_in_std_for_each)
     return true;
 }
 
+static std::string MakeLSPMessage(const std::string& body)
+{
+    char header[64];
+    sprintf(header, "Content-Length: %u\r\n\r\n", (unsigned int)body.length());
+    return header + body;
+}
+
+TEST_FUNC(test_lsp_framer_split_header)
+{
+    std::string message = MakeLSPMessage("{\"id\":1}");
+    // split inside the header name and inside the header separator
+    size_t splits[] = { 10, message.find("\r\n\r\n") + 2 };
+    for(size_t split : splits) {
+        LSP::MessageFramer framer;
+        framer.Append(message.data(), split);
+        CHECK_BOOL(!framer.Next());
+        framer.Append(message.data() + split, message.length() - split);
+        wxSharedPtr<JSON> json = framer.Next();
+        CHECK_BOOL(json);
+        CHECK_BOOL(json->toElement().namedObject("id").toInt() == 1);
+        CHECK_SIZE(framer.GetPendingBytes(), 0);
+    }
+    return true;
+}
+
+TEST_FUNC(test_lsp_framer_split_utf8)
+{
+    // "h\u00e9llo \u20ac": 2 and 3 bytes sequences. Feed the message one byte at a time so every sequence is split
+    std::string message = MakeLSPMessage("{\"text\":\"h\xc3\xa9llo \xe2\x82\xac\"}");
+    LSP::MessageFramer framer;
+    wxSharedPtr<JSON> json;
+    size_t messages = 0;
+    for(size_t i = 0; i < message.length(); ++i) {
+        framer.Append(message.data() + i, 1);
+        wxSharedPtr<JSON> next = framer.Next();
+        if(next) {
+            json = next;
+            ++messages;
+        }
+    }
+    CHECK_SIZE(messages, 1);
+    CHECK_BOOL(json->toElement().namedObject("text").toString() == wxString::FromUTF8("h\xc3\xa9llo \xe2\x82\xac"));
+    return true;
+}
+
+TEST_FUNC(test_lsp_framer_multiple_messages)
+{
+    std::string chunk;
+    for(int i = 1; i <= 3; ++i) {
+        chunk += MakeLSPMessage("{\"id\":" + std::to_string(i) + "}");
+    }
+    std::string last = MakeLSPMessage("{\"id\":4}");
+    chunk += last.substr(0, last.length() - 3);
+
+    LSP::MessageFramer framer;
+    framer.Append(chunk.data(), chunk.length());
+    for(int i = 1; i <= 3; ++i) {
+        wxSharedPtr<JSON> json = framer.Next();
+        CHECK_BOOL(json);
+        CHECK_BOOL(json->toElement().namedObject("id").toInt() == i);
+    }
+    CHECK_BOOL(!framer.Next());
+    framer.Append(last.data() + last.length() - 3, 3);
+    wxSharedPtr<JSON> json = framer.Next();
+    CHECK_BOOL(json);
+    CHECK_BOOL(json->toElement().namedObject("id").toInt() == 4);
+    CHECK_BOOL(!framer.Next());
+    return true;
+}
+
+TEST_FUNC(test_wild_masks)
+{
+    clWildMasks masks("*.cpp;*.H;Makefile;test_*.txt");
+    CHECK_BOOL(!masks.IsEmpty());
+    CHECK_BOOL(masks.Matches("main.cpp"));
+    CHECK_BOOL(masks.Matches("main.h"));
+    CHECK_BOOL(masks.Matches("makefile"));
+    CHECK_BOOL(masks.Matches("test_1.txt"));
+    CHECK_BOOL(!masks.Matches("main.hpp"));
+    CHECK_BOOL(!masks.Matches("main.cpp.orig"));
+    CHECK_BOOL(!masks.Matches("makefile.am"));
+    CHECK_BOOL(!masks.Matches("readme.txt"));
+
+    CHECK_BOOL(clWildMasks("*").Matches("anything"));
+    CHECK_BOOL(clWildMasks("").IsEmpty());
+    return true;
+}
+
+TEST_FUNC(test_gitignore_rules)
+{
+    wxString content;
+    content << "# comment\n"
+            << "build/\n"
+            << "*.o\n"
+            << "!keep.o\n"
+            << "/root_only.txt\n"
+            << "docs/**/*.md\n"
+            << "**/generated\n"
+            << "out/**\n";
+    clGitIgnoreRules::Ptr_t rules = clGitIgnoreRules::Parse("/ws/", content, clGitIgnoreRules::Ptr_t());
+    const clGitIgnoreRules* r = rules.get();
+
+    // Folder only rules
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/build", "build", true));
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/src/build", "build", true));
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(r, "/ws/build", "build", false));
+
+    // Later rules win
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/src/a.o", "a.o", false));
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(r, "/ws/src/keep.o", "keep.o", false));
+
+    // A leading '/' anchors the pattern to the .gitignore folder
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/root_only.txt", "root_only.txt", false));
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(r, "/ws/src/root_only.txt", "root_only.txt", false));
+
+    // "**" matches any number of folders, '*' does not cross a '/'
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/docs/a.md", "a.md", false));
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/docs/x/y/a.md", "a.md", false));
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(r, "/ws/src/docs/a.md", "a.md", false));
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/generated", "generated", true));
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/a/b/generated", "generated", true));
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(r, "/ws/out/x/y.txt", "y.txt", false));
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(r, "/ws/out", "out", true));
+
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(r, "/ws/src/main.cpp", "main.cpp", false));
+
+    // Rules are inherited by the sub folders, the deeper .gitignore wins
+    clGitIgnoreRules::Ptr_t sub = clGitIgnoreRules::Parse("/ws/src/", "!*.o\n", rules);
+    CHECK_BOOL(!clGitIgnoreRules::IsIgnored(sub.get(), "/ws/src/a.o", "a.o", false));
+    CHECK_BOOL(clGitIgnoreRules::IsIgnored(sub.get(), "/ws/lib/a.o", "a.o", false));
+    return true;
+}
+
 int main(int argc, char** argv)
 {
     wxInitializer initializer(argc, argv);
@@ -1278,6 +1278,16 @@ bool DbgCmdListChildren::ProcessOutput(const wxString& line)
         e.m_varObjChildren.push_back(FromParserOutput(info.children.at(i)));
     }
 
+    // Only a page was requested and there are more children: add a placeholder for them
+    if(info.children.size() > 0 && info.has_more && m_nextChildIndex != wxNOT_FOUND) {
+        VariableObjChild more;
+        more.gdbId = m_variable;
+        more.varName = wxT("...");
+        more.isAFake = true;
+        more.nextChildIndex = m_nextChildIndex;
+        e.m_varObjChildren.push_back(more);
+    }
+
     if(info.children.size() > 0) {
         e.m_updateReason = DBG_UR_LISTCHILDREN;
         e.m_expression = m_variable;
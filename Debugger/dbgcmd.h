@@ -446,12 +446,15 @@ class DbgCmdListChildren : public DbgCmdHandler
 {
     wxString m_variable;
     int m_userReason;
+    int m_nextChildIndex; // index of the first child not requested (paged listing), wxNOT_FOUND if all were
 
 public:
-    DbgCmdListChildren(IDebuggerObserver* observer, const wxString& variable, int userReason)
+    DbgCmdListChildren(IDebuggerObserver* observer, const wxString& variable, int userReason,
+                       int nextChildIndex = wxNOT_FOUND)
         : DbgCmdHandler(observer)
         , m_variable(variable)
         , m_userReason(userReason)
+        , m_nextChildIndex(nextChildIndex)
     {
     }
 
@@ -138,6 +138,68 @@ static void StripString(wxString& string)
     string = string.Trim();
 }
 
+/**
+ * @brief the class of a GDB/MI output record, see "GDB/MI Output Syntax" in the gdb manual
+ */
+enum eGdbMiRecordType {
+    kMiRecordUnknown = 0,
+    kMiRecordResult,      // ^done, ^running, ^error ...
+    kMiRecordExecAsync,   // *stopped, *running
+    kMiRecordStatusAsync, // +download
+    kMiRecordNotifyAsync, // =thread-group-started, =library-loaded ...
+    kMiRecordConsole,     // ~"..."
+    kMiRecordTarget,      // @"..."
+    kMiRecordLog,         // &"..."
+};
+
+/**
+ * @brief classify a single line of gdb output without using any regular expression.
+ * 'token' is set to the command token (the digits prefixing the record, if any) and 'offset' to the
+ * position of the record class character
+ */
+static eGdbMiRecordType ClassifyMiRecord(const wxString& line, wxString& token, size_t& offset)
+{
+    offset = 0;
+    token.Clear();
+    wxString::const_iterator iter = line.begin();
+    for(; iter != line.end() && (*iter >= '0' && *iter <= '9'); ++iter) {
+        ++offset;
+    }
+    if(iter == line.end()) { return kMiRecordUnknown; }
+    if(offset) { token = line.Mid(0, offset); }
+
+    switch((wxChar)*iter) {
+    case '^':
+        return kMiRecordResult;
+    case '*':
+        return kMiRecordExecAsync;
+    case '+':
+        return kMiRecordStatusAsync;
+    case '=':
+        return kMiRecordNotifyAsync;
+    case '~':
+        return token.IsEmpty() ? kMiRecordConsole : kMiRecordUnknown;
+    case '@':
+        return token.IsEmpty() ? kMiRecordTarget : kMiRecordUnknown;
+    case '&':
+        return token.IsEmpty() ? kMiRecordLog : kMiRecordUnknown;
+    default:
+        return kMiRecordUnknown;
+    }
+}
+
+/**
+ * @brief does 'line' (its quoted part, if it has one) start with '>'? (i.e. it is an echo of a shell/user command
+ * line). Same as calling StripString() + Trim() and testing the first char, without copying the whole line
+ */
+static bool IsShellLine(const wxString& line)
+{
+    size_t where = line.find('"');
+    // An unquoted line is tested as is
+    where = line.find_first_not_of(" \t\r\n", (where == wxString::npos) ? 0 : where + 1);
+    return where != wxString::npos && line[where] == '>';
+}
+
 static wxString MakeId()
 {
     static unsigned int counter(0);
@@ -345,7 +407,7 @@ void DbgGdb::DoCleanup()
     SetIsRemoteDebugging(false);
     SetIsRemoteExtended(false);
     EmptyQueue();
-    m_gdbOutputArr.Clear();
+    m_gdbOutputArr.clear();
     m_bpList.clear();
     m_debuggeeProjectName.Clear();
 
@@ -596,7 +658,13 @@ bool DbgGdb::QueryFileLine()
     return true;
 }
 
-bool DbgGdb::QueryLocals() { return WriteCommand(wxT("-stack-list-variables 2"), new DbgCmdHandlerLocals(m_observer)); }
+bool DbgGdb::QueryLocals()
+{
+    // In lazy mode we only ask for the names: nothing is evaluated until the user expands a local, which creates
+    // its variable object
+    wxString cmd = m_info.lazyLocals ? wxT("-stack-list-variables --no-values") : wxT("-stack-list-variables 2");
+    return WriteCommand(cmd, new DbgCmdHandlerLocals(m_observer));
+}
 
 bool DbgGdb::ExecuteCmd(const wxString& cmd)
 {
@@ -663,24 +731,22 @@ bool DbgGdb::FilterMessage(const wxString& msg)
 
 void DbgGdb::Poke()
 {
-    static wxRegEx reCommand(wxT("^([0-9]{8})"));
-
     // poll the debugger output
     wxString curline;
-    if(!m_gdbProcess || m_gdbOutputArr.IsEmpty()) { return; }
+    wxString id;
+    size_t offset = 0;
+    if(!m_gdbProcess || m_gdbOutputArr.empty()) { return; }
 
     while(DoGetNextLine(curline)) {
 
         GetDebugeePID(curline);
 
-        // For string manipulations without damaging the original line read
-        wxString tmpline(curline);
-        StripString(tmpline);
-        tmpline.Trim().Trim(false);
+        eGdbMiRecordType recordType = ClassifyMiRecord(curline, id, offset);
+        bool isShellLine = IsShellLine(curline);
         if(m_info.enableDebugLog) {
             // Is logging enabled?
 
-            if(curline.IsEmpty() == false && !tmpline.StartsWith(wxT(">"))) {
+            if(curline.IsEmpty() == false && !isShellLine) {
                 wxString strdebug(wxT("DEBUG>>"));
                 strdebug << curline;
                 clDEBUG() << strdebug << clEndl;
@@ -688,7 +754,8 @@ void DbgGdb::Poke()
             }
         }
 
-        if(reConnectionRefused.Matches(curline)) {
+        // Avoid running the regex on every line
+        if(curline.Contains(wxT("refused")) && reConnectionRefused.Matches(curline)) {
             StripString(curline);
 #ifdef __WXGTK__
             m_consoleFinder.FreeConsole();
@@ -710,21 +777,17 @@ void DbgGdb::Poke()
             return;
         }
 
-        if(tmpline.StartsWith(wxT(">"))) {
+        if(isShellLine) {
             // Shell line, probably user command line
             continue;
         }
 
-        if(curline.StartsWith(wxT("~")) || curline.StartsWith(wxT("&")) || curline.StartsWith("@")) {
+        if(recordType == kMiRecordConsole || recordType == kMiRecordTarget || recordType == kMiRecordLog) {
 
             // lines starting with ~ are considered "console stream" message
             // and are important to the CLI handler
-            bool consoleStream(false);
-            bool targetConsoleStream(false);
-
-            if(curline.StartsWith(wxT("~"))) { consoleStream = true; }
-
-            if(curline.StartsWith(wxT("@"))) { targetConsoleStream = true; }
+            bool consoleStream = (recordType == kMiRecordConsole);
+            bool targetConsoleStream = (recordType == kMiRecordTarget);
 
             // Filter out some gdb error lines...
             if(FilterMessage(curline)) { continue; }
@@ -744,11 +807,9 @@ void DbgGdb::Poke()
                 m_observer->UpdateAddLine(curline);
             }
 
-        } else if(reCommand.Matches(curline)) {
+        } else if(!id.IsEmpty() && recordType != kMiRecordUnknown) {
 
             // not a gdb message, get the command associated with the message
-            wxString id = reCommand.GetMatch(curline, 1);
-
             if(GetCliHandler() && GetCliHandler()->GetCommandId() == id) {
                 // probably the "^done" message of the CLI command
                 GetCliHandler()->ProcessOutput(curline);
@@ -756,10 +817,11 @@ void DbgGdb::Poke()
 
             } else {
                 // strip the id from the line
-                curline = curline.Mid(8);
+                curline.erase(0, offset);
                 DoProcessAsyncCommand(curline, id);
             }
-        } else if(curline.StartsWith(wxT("^done")) || curline.StartsWith(wxT("*stopped"))) {
+        } else if((recordType == kMiRecordResult && curline.StartsWith(wxT("^done"))) ||
+                  (recordType == kMiRecordExecAsync && curline.StartsWith(wxT("*stopped")))) {
             // Unregistered command, use the default AsyncCommand handler to process the line
             DbgCmdHandlerAsyncCmd cmd(m_observer, this);
             cmd.ProcessOutput(curline);
@@ -1115,11 +1177,18 @@ void DbgGdb::SetCliHandler(DbgCmdCLIHandler* handler)
 
 DbgCmdCLIHandler* DbgGdb::GetCliHandler() { return m_cliHandler; }
 
-bool DbgGdb::ListChildren(const wxString& name, int userReason)
+bool DbgGdb::ListChildren(const wxString& name, int userReason, int from)
 {
     wxString cmd;
     cmd << wxT("-var-list-children ") << name;
-    return WriteCommand(cmd, new DbgCmdListChildren(m_observer, name, userReason));
+
+    // List a single page of children, gdb reports 'has_more' when there are more
+    int nextChildIndex = wxNOT_FOUND;
+    if(m_info.maxVarObjChildren > 0) {
+        nextChildIndex = from + m_info.maxVarObjChildren;
+        cmd << wxT(" ") << from << wxT(" ") << nextChildIndex;
+    }
+    return WriteCommand(cmd, new DbgCmdListChildren(m_observer, name, userReason, nextChildIndex));
 }
 
 bool DbgGdb::CreateVariableObject(const wxString& expression, bool persistent, int userReason)
@@ -1159,29 +1228,30 @@ void DbgGdb::OnDataRead(clProcessEvent& e)
     if(!m_gdbProcess || !m_gdbProcess->IsAlive()) return;
 
     CL_DEBUG("GDB>> %s", bufferRead);
-    wxArrayString lines = wxStringTokenize(bufferRead, wxT("\n"), wxTOKEN_STRTOK);
-    if(lines.IsEmpty()) return;
 
-    // Prepend the partially saved line from previous iteration to the first line
-    // of this iteration
-    lines.Item(0).Prepend(m_gdbOutputIncompleteLine);
-    m_gdbOutputIncompleteLine.Clear();
-
-    // If the last line is in-complete, remove it from the array and keep it for next iteration
-    if(!bufferRead.EndsWith(wxT("\n"))) {
-        m_gdbOutputIncompleteLine = lines.Last();
-        lines.RemoveAt(lines.GetCount() - 1);
-    }
-
-    for(size_t i = 0; i < lines.GetCount(); i++) {
-        wxString line = lines.Item(i);
+    // Split the buffer into lines. The partially saved line from the previous iteration is the beginning of
+    // the first line, and an in-complete last line is kept for the next iteration
+    size_t start = 0;
+    size_t where = bufferRead.find('\n');
+    while(where != wxString::npos) {
+        wxString line = m_gdbOutputIncompleteLine;
+        line.append(bufferRead, start, where - start);
+        m_gdbOutputIncompleteLine.Clear();
 
-        line.Replace(wxT("(gdb)"), wxT(""));
+        // The MI prompt "(gdb) " is printed on a line of its own
         line.Trim().Trim(false);
-        if(line.IsEmpty() == false) { m_gdbOutputArr.Add(line); }
+        if(line.StartsWith(wxT("(gdb)"))) {
+            line.erase(0, 5);
+            line.Trim(false);
+        }
+        if(line.IsEmpty() == false) { m_gdbOutputArr.push_back(line); }
+
+        start = where + 1;
+        where = bufferRead.find('\n', start);
     }
+    if(start < bufferRead.length()) { m_gdbOutputIncompleteLine.append(bufferRead, start, wxString::npos); }
 
-    if(m_gdbOutputArr.IsEmpty() == false) {
+    if(m_gdbOutputArr.empty() == false) {
         // Trigger GDB processing
         Poke();
     }
@@ -1190,13 +1260,11 @@ void DbgGdb::OnDataRead(clProcessEvent& e)
 bool DbgGdb::DoGetNextLine(wxString& line)
 {
     line.Clear();
-    if(m_gdbOutputArr.IsEmpty()) { return false; }
-    line = m_gdbOutputArr.Item(0);
-    m_gdbOutputArr.RemoveAt(0);
-    line.Replace(wxT("(gdb)"), wxT(""));
-    line.Trim().Trim(false);
-    if(line.IsEmpty()) { return false; }
-    return true;
+    if(m_gdbOutputArr.empty()) { return false; }
+    // The lines were already trimmed and stripped from the prompt by OnDataRead()
+    line.swap(m_gdbOutputArr.front());
+    m_gdbOutputArr.pop_front();
+    return !line.IsEmpty();
 }
 
 void DbgGdb::SetInternalMainBpID(int bpId) { m_internalBpId = bpId; }
@@ -1277,10 +1345,10 @@ void DbgGdb::GetDebugeePID(const wxString& line)
                 } else if(line.Contains(wxT("=thread-group-created")) && reGroupStarted.Matches(line)) {
                     debuggeePidStr = reGroupStarted.GetMatch(line, 1);
 
-                } else if(reDebuggerPidWin.Matches(line)) {
+                } else if(line.Contains(wxT("New Thread")) && reDebuggerPidWin.Matches(line)) {
                     debuggeePidStr = reDebuggerPidWin.GetMatch(line, 1);
 
-                } else if(reSwitchToThread.Matches(line)) {
+                } else if(line.Contains(wxT("Switching to process")) && reSwitchToThread.Matches(line)) {
                     debuggeePidStr = reSwitchToThread.GetMatch(line, 1);
                 }
 
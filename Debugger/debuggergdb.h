@@ -32,6 +32,8 @@
 #include <wx/hashmap.h>
 #include "consolefinder.h"
 #include "cl_command_event.h"
+#include <deque>
+#include <unordered_map>
 
 #ifdef MSVC_VER
 // declare the debugger function creation
@@ -51,7 +53,7 @@ class DbgCmdHandler;
 class DbgCmdCLIHandler;
 class IProcess;
 
-typedef std::map<wxString, DbgCmdHandler*> HandlersMap_t;
+typedef std::unordered_map<wxString, DbgCmdHandler*> HandlersMap_t;
 
 extern const wxEventType wxEVT_GDB_STOP_DEBUGGER;
 
@@ -63,7 +65,7 @@ class DbgGdb : public wxEvtHandler, public IDebugger
     std::vector<BreakpointInfo> m_bpList;
     DbgCmdCLIHandler* m_cliHandler;
     IProcess* m_gdbProcess;
-    wxArrayString m_gdbOutputArr;
+    std::deque<wxString> m_gdbOutputArr;
     wxString m_gdbOutputIncompleteLine;
     bool m_break_at_main;
     bool m_attachedMode;
@@ -149,7 +151,7 @@ public:
     virtual bool SetMemory(const wxString& address, size_t count, const wxString& hex_value);
     virtual void SetDebuggerInformation(const DebuggerInformation& info);
     virtual void BreakList();
-    virtual bool ListChildren(const wxString& name, int userReason);
+    virtual bool ListChildren(const wxString& name, int userReason, int from = 0);
     virtual bool CreateVariableObject(const wxString& expression, bool persistent, int userReason);
     virtual bool DeleteVariableObject(const wxString& name);
     virtual bool EvaluateVariableObject(const wxString& name, int userReason);
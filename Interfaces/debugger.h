@@ -107,9 +107,12 @@ struct VariableObjChild {
     wxString value;
     bool isAFake; // Sets to true of this variable object is a fake node
     wxString type;
+    int nextChildIndex; // When not wxNOT_FOUND, this is not a real child but a placeholder for the children of
+                        // 'gdbId' that were not listed yet, starting at this index
     VariableObjChild()
         : numChilds(0)
         , isAFake(false)
+        , nextChildIndex(wxNOT_FOUND)
     {
     }
 };
@@ -442,7 +445,9 @@ public:
     bool charArrAsPtr;
     bool enableGDBPrettyPrinting;
     bool defaultHexDisplay;
-    size_t flags; // see eGdbFlags
+    size_t flags;          // see eGdbFlags
+    bool lazyLocals;       // List only the names of the locals, their value is fetched when expanded
+    int maxVarObjChildren; // Number of children listed at a time for a variable object, 0 lists them all
 
 public:
     DebuggerInformation()
@@ -468,6 +473,8 @@ public:
         , enableGDBPrettyPrinting(true)
         , defaultHexDisplay(false)
         , flags(0)
+        , lazyLocals(false)
+        , maxVarObjChildren(100)
     {
     }
 
@@ -498,6 +505,8 @@ public:
         arch.Write(wxT("enableGDBPrettyPrinting"), enableGDBPrettyPrinting);
         arch.Write(wxT("defaultHexDisplay"), defaultHexDisplay);
         arch.Write("flags", flags);
+        arch.Write("lazyLocals", lazyLocals);
+        arch.Write("maxVarObjChildren", maxVarObjChildren);
     }
 
     void DeSerialize(Archive& arch)
@@ -531,6 +540,8 @@ public:
         arch.Read(wxT("enableGDBPrettyPrinting"), enableGDBPrettyPrinting);
         arch.Read(wxT("defaultHexDisplay"), defaultHexDisplay);
         arch.Read("flags", flags);
+        arch.Read("lazyLocals", lazyLocals);
+        arch.Read("maxVarObjChildren", maxVarObjChildren);
     }
 };
 
@@ -906,10 +917,13 @@ public:
     // with an empty implementation
     // ----------------------------------------------------------------------------------------
     /**
-     * @brief list the children of a variable object
+     * @brief list the children of a variable object. The children are listed in pages of
+     * DebuggerInformation::maxVarObjChildren, when more children exist the list ends with a placeholder child
+     * (see VariableObjChild::nextChildIndex)
      * @param name
+     * @param from index of the first child to list
      */
-    virtual bool ListChildren(const wxString& name, int userReason) = 0;
+    virtual bool ListChildren(const wxString& name, int userReason, int from = 0) = 0;
 
     /**
      * @brief create variable object from a given expression
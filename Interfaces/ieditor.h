@@ -416,6 +416,14 @@ public:
      */
     virtual wxStyledTextCtrl* GetCtrl() = 0;
 
+    /**
+     * @brief run the code completion of the editor's language (ctags / clang for C++), without sending
+     * wxEVT_CC_CODE_COMPLETE first. Used by a plugin that handled that event but has nothing to show
+     * @param memberCompletion true to complete the members after '.', '->' or '::', false to complete the word
+     * under the caret
+     */
+    virtual void BuiltinCodeComplete(bool memberCompletion) = 0;
+
     /**
      * @brief set the focus to the current editor
      */
@@ -6,15 +6,44 @@
 #include "ieditor.h"
 #include <wx/stc/stc.h>
 #include "globals.h"
+#include "imanager.h"
+#include "wxCodeCompletionBox.h"
+#include "wxCodeCompletionBoxManager.h"
+#include "file_logger.h"
+#include "procutils.h"
+
+// How often (in milliseconds) we check the running servers for idleness and memory usage
+#define HEALTH_CHECK_INTERVAL 30000
+
+/**
+ * @brief the LSP column of 'pos': the number of UTF-16 code units from the start of the line
+ */
+static int GetCharacterColumn(wxStyledTextCtrl* ctrl, int pos)
+{
+    int line = ctrl->LineFromPosition(pos);
+    return LSP::UTF16Length(ctrl->GetTextRange(ctrl->PositionFromLine(line), pos));
+}
 
 LanguageServerCluster::LanguageServerCluster()
 {
     EventNotifier::Get()->Bind(wxEVT_CC_FIND_SYMBOL, &LanguageServerCluster::OnFindSymbold, this);
+    EventNotifier::Get()->Bind(wxEVT_CC_CODE_COMPLETE, &LanguageServerCluster::OnCodeComplete, this);
+    EventNotifier::Get()->Bind(wxEVT_FILE_LOADED, &LanguageServerCluster::OnFileLoaded, this);
+
+    m_healthTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &LanguageServerCluster::OnHealthCheck, this, m_healthTimer->GetId());
+    m_healthTimer->Start(HEALTH_CHECK_INTERVAL);
 }
 
 LanguageServerCluster::~LanguageServerCluster()
 {
     EventNotifier::Get()->Unbind(wxEVT_CC_FIND_SYMBOL, &LanguageServerCluster::OnFindSymbold, this);
+    EventNotifier::Get()->Unbind(wxEVT_CC_CODE_COMPLETE, &LanguageServerCluster::OnCodeComplete, this);
+    EventNotifier::Get()->Unbind(wxEVT_FILE_LOADED, &LanguageServerCluster::OnFileLoaded, this);
+
+    m_healthTimer->Stop();
+    Unbind(wxEVT_TIMER, &LanguageServerCluster::OnHealthCheck, this, m_healthTimer->GetId());
+    wxDELETE(m_healthTimer);
 }
 
 void LanguageServerCluster::Reload()
@@ -29,19 +58,110 @@ void LanguageServerCluster::Reload()
     // If we are not enabled, stop here
     if(!LanguageServerConfig::Get().IsEnabled()) { return; }
 
-    // create a new list
+    // create a new list. The servers are started on demand
     const LanguageServerEntry::Map_t& servers = LanguageServerConfig::Get().GetServers();
     for(const LanguageServerEntry::Map_t::value_type& vt : servers) {
         const LanguageServerEntry& entry = vt.second;
         if(entry.IsEnabled()) {
             LanguageServerProtocol::Ptr_t lsp(new LanguageServerProtocol());
-            wxString command = entry.GetExepath();
-            ::WrapWithQuotes(command);
-            if(!entry.GetArgs().IsEmpty()) { command << " " << entry.GetArgs(); }
-            lsp->Start(command, entry.GetWorkingDirectory(), entry.GetLanguages());
+            lsp->Bind(wxEVT_LSP_COMPLETION_READY, &LanguageServerCluster::OnCompletionReady, this);
             m_servers.insert({ entry.GetName(), lsp });
         }
     }
+
+    // Start the servers needed by the files that are already open
+    IEditor::List_t editors;
+    clGetManager()->GetAllEditors(editors);
+    for(IEditor* editor : editors) {
+        DoStartServerForFile(editor->GetFileName());
+    }
+
+    // Don't hold the caller: the warm servers are started once we are back in the event loop
+    CallAfter(&LanguageServerCluster::DoStartWarmServers);
+}
+
+void LanguageServerCluster::DoStartServer(const wxString& name)
+{
+    auto iter = m_servers.find(name);
+    if(iter == m_servers.end() || iter->second->IsRunning()) { return; }
+
+    const LanguageServerEntry::Map_t& servers = LanguageServerConfig::Get().GetServers();
+    auto entryIter = servers.find(name);
+    if(entryIter == servers.end()) { return; }
+
+    const LanguageServerEntry& entry = entryIter->second;
+    wxString command = entry.GetExepath();
+    ::WrapWithQuotes(command);
+    if(!entry.GetArgs().IsEmpty()) { command << " " << entry.GetArgs(); }
+    clDEBUG() << "Starting language server:" << name << clEndl;
+    iter->second->Start(command, entry.GetWorkingDirectory(), entry.GetLanguages());
+}
+
+void LanguageServerCluster::DoStartServerForFile(const wxFileName& filename)
+{
+    for(const auto& vt : m_servers) {
+        if(vt.second->CanHandle(filename)) {
+            if(!vt.second->IsRunning()) { DoStartServer(vt.first); }
+            return;
+        }
+    }
+}
+
+void LanguageServerCluster::DoStartWarmServers()
+{
+    const LanguageServerEntry::Map_t& servers = LanguageServerConfig::Get().GetServers();
+    for(const auto& vt : servers) {
+        if(vt.second.IsWarmStandby()) { DoStartServer(vt.first); }
+    }
+}
+
+bool LanguageServerCluster::HasEditorsFor(LanguageServerProtocol::Ptr_t server) const
+{
+    IEditor::List_t editors;
+    clGetManager()->GetAllEditors(editors);
+    for(IEditor* editor : editors) {
+        if(server->CanHandle(editor->GetFileName())) { return true; }
+    }
+    return false;
+}
+
+void LanguageServerCluster::OnFileLoaded(clCommandEvent& event)
+{
+    event.Skip();
+    if(m_servers.empty()) { return; }
+
+    // Start the server after all the wxEVT_FILE_LOADED handlers were called: once started, the server opens all
+    // the editors it handles, including this one
+    CallAfter(&LanguageServerCluster::DoStartServerForFile, wxFileName(event.GetFileName()));
+}
+
+void LanguageServerCluster::OnHealthCheck(wxTimerEvent& event)
+{
+    const LanguageServerConfig& config = LanguageServerConfig::Get();
+    const LanguageServerEntry::Map_t& entries = config.GetServers();
+    time_t now = time(nullptr);
+    for(const auto& vt : m_servers) {
+        LanguageServerProtocol::Ptr_t server = vt.second;
+        if(!server->IsRunning()) { continue; }
+
+        // Memory limit
+        size_t memoryLimit = config.GetMemoryLimit() * 1024 * 1024;
+        size_t memoryUsage = ProcUtils::GetProcessMemoryUsage(server->GetProcessId());
+        if(memoryLimit && memoryUsage > memoryLimit) {
+            clWARNING() << "Language server" << vt.first << "uses" << (memoryUsage / 1024 / 1024)
+                        << "MB (limit is" << config.GetMemoryLimit() << "MB). Restarting it" << clEndl;
+            server->Restart();
+            continue;
+        }
+
+        // Idle timeout
+        auto entryIter = entries.find(vt.first);
+        bool isWarm = (entryIter != entries.end()) && entryIter->second.IsWarmStandby();
+        if(isWarm || config.GetIdleTimeout() == 0) { continue; }
+        if((size_t)(now - server->GetLastActivity()) < config.GetIdleTimeout() || HasEditorsFor(server)) { continue; }
+        clDEBUG() << "Language server" << vt.first << "is idle. Stopping it" << clEndl;
+        server->Stop(true);
+    }
 }
 
 void LanguageServerCluster::OnFindSymbold(clCodeCompletionEvent& event)
@@ -53,12 +173,87 @@ void LanguageServerCluster::OnFindSymbold(clCodeCompletionEvent& event)
     CHECK_PTR_RET(editor);
 
     wxStyledTextCtrl* ctrl = editor->GetCtrl();
-    int col = ctrl->GetColumn(ctrl->GetCurrentPos());
+    int col = GetCharacterColumn(ctrl, ctrl->GetCurrentPos());
     int line = ctrl->LineFromPosition(ctrl->GetCurrentPos());
     LanguageServerProtocol::Ptr_t server = GetServerForFile(editor->GetFileName());
     if(server) { server->FindDefinition(editor->GetFileName(), line, col); }
 }
 
+void LanguageServerCluster::OnCodeComplete(clCodeCompletionEvent& event)
+{
+    event.Skip();
+    if(m_servers.empty() || event.IsInsideCommentOrString()) { return; }
+
+    IEditor* editor = dynamic_cast<IEditor*>(event.GetEditor());
+    CHECK_PTR_RET(editor);
+
+    LanguageServerProtocol::Ptr_t server = GetServerForFile(editor->GetFileName());
+    if(!server || !server->IsRunning()) { return; }
+
+    // We handle this one: the completion box is shown once the server replies
+    event.Skip(false);
+    wxStyledTextCtrl* ctrl = editor->GetCtrl();
+    int pos = ctrl->GetCurrentPos();
+    wxString before = ctrl->GetTextRange(ctrl->PositionBefore(ctrl->PositionBefore(pos)), pos);
+    m_memberCompletion = (ctrl->WordStartPosition(pos, true) == pos) &&
+                         (before.EndsWith(".") || before.EndsWith("->") || before.EndsWith("::"));
+    server->CodeComplete(editor->GetFileName(), ctrl->LineFromPosition(pos), GetCharacterColumn(ctrl, pos));
+}
+
+void LanguageServerCluster::OnCompletionReady(LSPEvent& event)
+{
+    // Make sure that the response still matches the editor: same file and the caret did not leave the line
+    IEditor* editor = clGetManager()->GetActiveEditor();
+    CHECK_PTR_RET(editor);
+    if(editor->GetFileName().GetFullPath() != event.GetFileName()) { return; }
+    wxStyledTextCtrl* ctrl = editor->GetCtrl();
+    if(ctrl->LineFromPosition(ctrl->GetCurrentPos()) != event.GetPosition().GetLine()) { return; }
+
+    std::vector<LSP::CompletionItem> items = event.GetCompletions();
+    if(items.empty()) {
+        // The server has nothing for us (or failed): do what the editor does when no plugin handles the request
+        DoBuiltinCodeComplete(editor);
+        return;
+    }
+    std::stable_sort(items.begin(), items.end(), [](const LSP::CompletionItem& a, const LSP::CompletionItem& b) {
+        return a.GetSortText() < b.GetSortText();
+    });
+
+    wxCodeCompletionBoxEntry::Vec_t entries;
+    entries.reserve(items.size());
+    for(const LSP::CompletionItem& item : items) {
+        // Some servers send a blank "insertText" (or "textEdit"): show the label instead
+        wxString text = item.GetInsertText();
+        text.Trim().Trim(false);
+        if(text.IsEmpty()) {
+            text = item.GetLabel();
+            text.Trim().Trim(false);
+        }
+        if(text.IsEmpty()) { continue; }
+        wxCodeCompletionBoxEntry::Ptr_t entry = wxCodeCompletionBoxEntry::New(text);
+        wxString comment = item.GetDetail();
+        if(!item.GetDocumentation().IsEmpty()) { comment << "\n" << item.GetDocumentation(); }
+        entry->SetComment(comment);
+        entries.push_back(entry);
+    }
+    if(entries.empty()) {
+        DoBuiltinCodeComplete(editor);
+        return;
+    }
+    int startPos = ctrl->WordStartPosition(ctrl->GetCurrentPos(), true);
+    wxCodeCompletionBoxManager::Get().ShowCompletionBox(ctrl, entries, wxCodeCompletionBox::kRefreshOnKeyType,
+                                                        startPos);
+}
+
+void LanguageServerCluster::DoBuiltinCodeComplete(IEditor* editor)
+{
+    // The caret may have moved on since the request: member completion only makes sense right after the operator
+    wxStyledTextCtrl* ctrl = editor->GetCtrl();
+    int pos = ctrl->GetCurrentPos();
+    bool memberCompletion = m_memberCompletion && (ctrl->WordStartPosition(pos, true) == pos);
+    editor->BuiltinCodeComplete(memberCompletion);
+}
+
 LanguageServerProtocol::Ptr_t LanguageServerCluster::GetServerForFile(const wxFileName& filename)
 {
     std::unordered_map<wxString, LanguageServerProtocol::Ptr_t>::iterator iter =
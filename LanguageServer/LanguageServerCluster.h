@@ -5,11 +5,24 @@
 #include "LanguageServerProtocol.h"
 #include <wxStringHash.h>
 #include "cl_command_event.h"
+#include "LSP/LSPEvent.h"
 #include <wx/sharedptr.h>
+#include <wx/timer.h>
 
+class IEditor;
+
+/**
+ * @class LanguageServerCluster
+ * @brief the configured language servers. A server is started when the first file of one of its languages is
+ * opened (or in the background when the plugin loads, for "warm standby" servers), stopped once it has nothing to
+ * serve for a while and restarted when it exceeds the memory limit
+ */
 class LanguageServerCluster : public wxEvtHandler
 {
     std::unordered_map<wxString, LanguageServerProtocol::Ptr_t> m_servers;
+    wxTimer* m_healthTimer = nullptr;
+    // The pending completion request was sent after '.', '->' or '::'
+    bool m_memberCompletion = false;
 
 public:
     typedef wxSharedPtr<LanguageServerCluster> Ptr_t;
@@ -17,12 +30,32 @@ public:
 protected:
     LanguageServerProtocol::Ptr_t GetServerForFile(const wxFileName& filename);
 
+    /**
+     * @brief start the server 'name' (if it is not running already)
+     */
+    void DoStartServer(const wxString& name);
+    void DoStartServerForFile(const wxFileName& filename);
+    void DoStartWarmServers();
+    /**
+     * @brief run the built-in (ctags / clang) code completion that the server request replaced
+     */
+    void DoBuiltinCodeComplete(IEditor* editor);
+    /**
+     * @brief is there an open editor that 'server' handles?
+     */
+    bool HasEditorsFor(LanguageServerProtocol::Ptr_t server) const;
+
+    void OnFileLoaded(clCommandEvent& event);
+    void OnHealthCheck(wxTimerEvent& event);
+
 public:
     LanguageServerCluster();
     virtual ~LanguageServerCluster();
 
     void Reload();
     void OnFindSymbold(clCodeCompletionEvent& event);
+    void OnCodeComplete(clCodeCompletionEvent& event);
+    void OnCompletionReady(LSPEvent& event);
 };
 
 #endif // LANGUAGESERVERCLUSTER_H
@@ -32,6 +32,8 @@ void LanguageServerConfig::FromJSON(const JSONItem& json)
 {
     m_servers.clear();
     m_flags = json.namedObject("flags").toSize_t(m_flags);
+    m_idleTimeout = json.namedObject("idleTimeout").toSize_t(m_idleTimeout);
+    m_memoryLimit = json.namedObject("memoryLimit").toSize_t(m_memoryLimit);
     if(json.hasNamedObject("servers")) {
         JSONItem servers = json.namedObject("servers");
         size_t count = servers.arraySize();
@@ -48,6 +50,8 @@ JSONItem LanguageServerConfig::ToJSON() const
 {
     JSONItem json = JSONItem::createObject(GetName());
     json.addProperty("flags", m_flags);
+    json.addProperty("idleTimeout", m_idleTimeout);
+    json.addProperty("memoryLimit", m_memoryLimit);
     JSONItem servers = JSONItem::createArray("servers");
     std::for_each(m_servers.begin(), m_servers.end(),
                   [&](const LanguageServerEntry::Map_t::value_type& vt) { servers.append(vt.second.ToJSON()); });
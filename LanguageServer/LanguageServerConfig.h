@@ -14,6 +14,10 @@ public:
 protected:
     size_t m_flags = 0;
     LanguageServerEntry::Map_t m_servers;
+    // stop a server that has nothing to serve after this number of seconds (0: never)
+    size_t m_idleTimeout = 600;
+    // restart a server that uses more than this amount of memory, in MB (0: no limit)
+    size_t m_memoryLimit = 0;
 
 private:
     LanguageServerConfig();
@@ -49,6 +53,18 @@ public:
         return *this;
     }
     const LanguageServerEntry::Map_t& GetServers() const { return m_servers; }
+    LanguageServerConfig& SetIdleTimeout(size_t idleTimeout)
+    {
+        this->m_idleTimeout = idleTimeout;
+        return *this;
+    }
+    size_t GetIdleTimeout() const { return m_idleTimeout; }
+    LanguageServerConfig& SetMemoryLimit(size_t memoryLimit)
+    {
+        this->m_memoryLimit = memoryLimit;
+        return *this;
+    }
+    size_t GetMemoryLimit() const { return m_memoryLimit; }
     /**
      * @brief add server. erase an existing one with the same name
      */
@@ -12,6 +12,7 @@ void LanguageServerEntry::FromJSON(const JSONItem& json)
     m_workingDirectory = json.namedObject("workingDirectory").toString();
     m_languages = json.namedObject("languages").toArrayString();
     m_enabled = json.namedObject("enabled").toBool(m_enabled);
+    m_warmStandby = json.namedObject("warmStandby").toBool(m_warmStandby);
 }
 
 JSONItem LanguageServerEntry::ToJSON() const
@@ -22,6 +23,7 @@ JSONItem LanguageServerEntry::ToJSON() const
     json.addProperty("args", m_args);
     json.addProperty("languages", m_languages);
     json.addProperty("enabled", m_enabled);
+    json.addProperty("warmStandby", m_warmStandby);
     json.addProperty("workingDirectory", m_workingDirectory);
     return json;
 }
@@ -9,6 +9,7 @@
 class LanguageServerEntry
 {
     bool m_enabled = true;
+    bool m_warmStandby = false;
     wxString m_name;
     wxString m_exepath;
     wxString m_args;
@@ -41,6 +42,16 @@ public:
         return *this;
     }
     bool IsEnabled() const { return m_enabled; }
+    /**
+     * @brief a "warm" server is started in the background when the plugin loads (instead of when the first file
+     * of its languages is opened) and is never stopped for being idle
+     */
+    LanguageServerEntry& SetWarmStandby(bool warmStandby)
+    {
+        this->m_warmStandby = warmStandby;
+        return *this;
+    }
+    bool IsWarmStandby() const { return m_warmStandby; }
     LanguageServerEntry& SetLanguages(const wxArrayString& languages)
     {
         this->m_languages = languages;
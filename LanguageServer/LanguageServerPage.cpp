@@ -12,6 +12,7 @@ LanguageServerPage::LanguageServerPage(wxWindow* parent, const LanguageServerEnt
     m_filePickerExe->SetPath(data.GetExepath());
     m_textCtrlArgs->SetValue(data.GetArgs());
     m_checkBoxEnabled->SetValue(data.IsEnabled());
+    m_warmStandby = data.IsWarmStandby();
     
     const wxArrayString& langs = data.GetLanguages();
     wxStringSet_t checkedLanguages;
@@ -51,6 +52,7 @@ LanguageServerEntry LanguageServerPage::GetData() const
     d.SetWorkingDirectory(m_dirPickerWorkingDir->GetPath());
     d.SetLanguages(GetLanguages());
     d.SetEnabled(m_checkBoxEnabled->IsChecked());
+    d.SetWarmStandby(m_warmStandby);
     return d;
 }
 
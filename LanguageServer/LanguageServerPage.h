@@ -6,6 +6,9 @@
 
 class LanguageServerPage : public LanguageServerPageBase
 {
+    // not editable from this page, keep it
+    bool m_warmStandby = false;
+
 public:
     LanguageServerPage(wxWindow* parent, const LanguageServerEntry& data);
     LanguageServerPage(wxWindow* parent);
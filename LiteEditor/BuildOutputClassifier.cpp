@@ -0,0 +1,348 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// Copyright            : (C) 2015 Eran Ifrah
+// File name            : BuildOutputClassifier.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "BuildOutputClassifier.h"
+#include "file_logger.h"
+#include "globals.h"
+#include <algorithm>
+
+// A pattern that contains none of the regex special characters is a plain string that must appear in the line
+static bool IsPlainLiteral(const wxString& pattern)
+{
+    static const wxString SPECIAL_CHARS = "\\^$.|?*+()[]{}";
+    for(size_t i = 0; i < pattern.length(); ++i) {
+        if(SPECIAL_CHARS.Find(pattern[i]) != wxNOT_FOUND) { return false; }
+    }
+    return !pattern.IsEmpty();
+}
+
+static CmpPatternPtr CompilePattern(const Compiler::CmpInfoPattern& info, LINE_SEVERITY severity)
+{
+    CmpPatternPtr compiledPatternPtr(new CmpPattern(new wxRegEx(info.pattern, wxRE_ADVANCED | wxRE_ICASE),
+                                                    info.fileNameIndex, info.lineNumberIndex, info.columnIndex,
+                                                    severity));
+    if(!compiledPatternPtr->GetRegex()->IsValid()) { return NULL; }
+    return compiledPatternPtr;
+}
+
+BuildOutputClassifier::BuildOutputClassifier(NewBuildTab* owner)
+    : m_owner(owner)
+    , m_usePrefilter(false)
+    , m_generation(0)
+{
+}
+
+BuildOutputClassifier::~BuildOutputClassifier()
+{
+    // Results that were never taken
+    std::for_each(m_results.begin(), m_results.end(), [&](const Line& line) { delete line.info; });
+    m_results.clear();
+}
+
+void BuildOutputClassifier::Setup(CompilerPtr compiler, const wxString& cygwinRoot,
+                                  const wxString& workingDirectory)
+{
+    SetupRequest* req = new SetupRequest();
+    if(compiler) {
+        req->errorPatterns = compiler->GetErrPatterns();
+        req->warningPatterns = compiler->GetWarnPatterns();
+    }
+    req->cygwinRoot = cygwinRoot;
+    req->workingDirectory = workingDirectory;
+    WorkerThread::Add(req);
+}
+
+void BuildOutputClassifier::Clear()
+{
+    ClearRequest* req = new ClearRequest();
+    {
+        // Anything that is still in the queue or in the results belongs to the previous generation
+        wxMutexLocker locker(m_mutex);
+        req->generation = ++m_generation;
+        std::for_each(m_results.begin(), m_results.end(), [&](const Line& line) { delete line.info; });
+        m_results.clear();
+    }
+    WorkerThread::Add(req);
+}
+
+void BuildOutputClassifier::Add(const wxString& text, bool flush, bool isSummaryLine)
+{
+    if(text.IsEmpty() && !flush) { return; }
+    LinesRequest* req = new LinesRequest();
+    req->text = text;
+    req->flush = flush;
+    req->isSummaryLine = isSummaryLine;
+    {
+        wxMutexLocker locker(m_mutex);
+        req->generation = m_generation;
+    }
+    WorkerThread::Add(req);
+}
+
+void BuildOutputClassifier::Flush(int stage)
+{
+    FlushRequest* req = new FlushRequest();
+    req->stage = stage;
+    {
+        wxMutexLocker locker(m_mutex);
+        req->generation = m_generation;
+    }
+    WorkerThread::Add(req);
+}
+
+void BuildOutputClassifier::TakeResults(LineVec_t& lines)
+{
+    wxMutexLocker locker(m_mutex);
+    lines.swap(m_results);
+    m_results.clear();
+}
+
+void BuildOutputClassifier::ProcessRequest(ThreadRequest* request)
+{
+    if(dynamic_cast<SetupRequest*>(request)) {
+        DoSetup(dynamic_cast<SetupRequest*>(request));
+
+    } else if(dynamic_cast<ClearRequest*>(request)) {
+        DoClear();
+
+    } else if(dynamic_cast<LinesRequest*>(request)) {
+        LinesRequest* req = dynamic_cast<LinesRequest*>(request);
+        LineVec_t lines;
+        DoProcessText(req, lines);
+        DoDeliver(lines, req->generation);
+
+    } else if(dynamic_cast<FlushRequest*>(request)) {
+        // The requests are processed in order: everything queued before this one was already delivered. The owner
+        // is always called back, even when the lines were discarded: it finishes the build with it
+        FlushRequest* req = dynamic_cast<FlushRequest*>(request);
+        bool discarded = false;
+        {
+            wxMutexLocker locker(m_mutex);
+            discarded = (req->generation != m_generation);
+        }
+        m_owner->CallAfter(&NewBuildTab::OnClassifierFlushed, req->stage, discarded);
+    }
+}
+
+void BuildOutputClassifier::DoSetup(SetupRequest* req)
+{
+    m_cygwinRoot = req->cygwinRoot;
+    m_workingDirectory = req->workingDirectory;
+    m_normalizedFiles.clear();
+    m_patterns.errorsPatterns.clear();
+    m_patterns.warningPatterns.clear();
+
+    // Lines that contain none of these (case insensitive) can't match any of the patterns, so we don't run the
+    // regular expressions on them. Commands echoed by make are the bulk of a build output and are skipped this way
+    m_prefilter.Clear();
+    m_prefilter.Add(":");
+    m_prefilter.Add("error");
+    m_prefilter.Add("warning");
+    m_usePrefilter = true;
+
+    std::vector<std::pair<Compiler::CmpInfoPattern, LINE_SEVERITY> > patterns;
+    std::for_each(req->errorPatterns.begin(), req->errorPatterns.end(),
+                  [&](const Compiler::CmpInfoPattern& p) { patterns.push_back(std::make_pair(p, SV_ERROR)); });
+    std::for_each(req->warningPatterns.begin(), req->warningPatterns.end(),
+                  [&](const Compiler::CmpInfoPattern& p) { patterns.push_back(std::make_pair(p, SV_WARNING)); });
+
+    for(size_t i = 0; i < patterns.size(); ++i) {
+        const Compiler::CmpInfoPattern& info = patterns[i].first;
+        CmpPatternPtr compiledPatternPtr = CompilePattern(info, patterns[i].second);
+        if(!compiledPatternPtr) { continue; }
+
+        if(patterns[i].second == SV_ERROR) {
+            m_patterns.errorsPatterns.push_back(compiledPatternPtr);
+        } else {
+            m_patterns.warningPatterns.push_back(compiledPatternPtr);
+        }
+
+        wxString lcPattern = info.pattern.Lower();
+        if(IsPlainLiteral(lcPattern)) {
+            m_prefilter.Add(lcPattern);
+
+        } else if(!lcPattern.Contains(":") && !lcPattern.Contains("error") && !lcPattern.Contains("warning")) {
+            // A user defined pattern we know nothing about: run all the patterns on every line
+            clDEBUG1() << "Build output pre-filter disabled by pattern:" << info.pattern;
+            m_usePrefilter = false;
+        }
+    }
+}
+
+void BuildOutputClassifier::DoClear()
+{
+    m_directories.Clear();
+    m_normalizedFiles.clear();
+    m_partialLine.Clear();
+}
+
+void BuildOutputClassifier::DoProcessText(LinesRequest* req, LineVec_t& lines)
+{
+    wxString text;
+    text.swap(m_partialLine);
+    text << req->text;
+
+    // Process only completed lines (i.e. a line that ends with '\n')
+    size_t start = 0;
+    while(start < text.length()) {
+        size_t where = text.find('\n', start);
+        if(where == wxString::npos) {
+            if(req->flush) {
+                DoProcessLine(text.Mid(start), req->isSummaryLine, lines);
+            } else {
+                m_partialLine = text.Mid(start);
+            }
+            break;
+        }
+        DoProcessLine(text.Mid(start, where - start + 1), req->isSummaryLine, lines);
+        start = where + 1;
+    }
+}
+
+void BuildOutputClassifier::DoProcessLine(const wxString& line, bool isSummaryLine, LineVec_t& lines)
+{
+    // If this is a line similar to 'Entering directory `'
+    // add the path in the directories array
+    DoSearchForDirectory(line);
+
+    BuildLineInfo bli;
+    LINE_SEVERITY severity;
+    if(DoClassify(line, bli, severity)) {
+        DoNormalizeFilename(bli);
+    } else {
+        bli.SetSeverity(severity);
+    }
+    BuildLineInfo* buildLineInfo = new BuildLineInfo(bli);
+
+    wxString buildLine = line;
+    if(isSummaryLine) {
+        buildLine.Trim();
+        buildLine.Prepend("====");
+        buildLine.Append("====");
+        buildLineInfo->SetSeverity(SV_NONE);
+    }
+
+    Line classified;
+    buildLine.Trim();
+    ::clStripTerminalColouring(buildLine, classified.text);
+    classified.info = buildLineInfo;
+    lines.push_back(classified);
+}
+
+void BuildOutputClassifier::DoSearchForDirectory(const wxString& line)
+{
+    // Check for makefile directory changes lines
+    wxString currentDir;
+    if(line.Contains(wxT("Entering directory `"))) {
+        currentDir = line.AfterFirst(wxT('`'));
+        currentDir = currentDir.BeforeLast(wxT('\''));
+
+    } else if(line.Contains(wxT("Entering directory '"))) {
+        currentDir = line.AfterFirst(wxT('\''));
+        currentDir = currentDir.BeforeLast(wxT('\''));
+
+    } else {
+        return;
+    }
+
+    // Collect the m_baseDir. A new directory can change how relative file names are resolved
+    m_directories.Add(currentDir);
+    m_normalizedFiles.clear();
+}
+
+bool BuildOutputClassifier::DoClassify(const wxString& line, BuildLineInfo& bli, LINE_SEVERITY& severity)
+{
+    severity = SV_NONE;
+    wxString lcLine = line.Lower();
+    if(lcLine.Contains("entering directory") || lcLine.Contains("leaving directory")) {
+        severity = SV_DIR_CHANGE;
+        return false;
+
+    } else if(line.StartsWith("====")) {
+        return false;
+    }
+
+    if(m_usePrefilter) {
+        bool candidate = false;
+        for(size_t i = 0; i < m_prefilter.size() && !candidate; ++i) {
+            candidate = lcLine.Contains(m_prefilter.Item(i));
+        }
+        if(!candidate) { return false; }
+    }
+
+    // Find *warnings* first
+    for(size_t i = 0; i < m_patterns.warningPatterns.size(); i++) {
+        if(m_patterns.warningPatterns.at(i)->Matches(line, bli)) {
+            severity = SV_WARNING;
+            return true;
+        }
+    }
+
+    // If it is not a warning, maybe it's an error
+    for(size_t i = 0; i < m_patterns.errorsPatterns.size(); i++) {
+        if(m_patterns.errorsPatterns.at(i)->Matches(line, bli)) {
+            severity = SV_ERROR;
+            return true;
+        }
+    }
+    return false;
+}
+
+void BuildOutputClassifier::DoNormalizeFilename(BuildLineInfo& bli)
+{
+    // The same file is usually reported by many lines (an error and its notes, many warnings...). Resolving it
+    // means probing the file system, so we do it once per file name (until the next directory change)
+    const wxString& filename = bli.GetFilename();
+    if(filename.IsEmpty()) { return; }
+
+    std::map<wxString, wxString>::iterator iter = m_normalizedFiles.find(filename);
+    if(iter != m_normalizedFiles.end()) {
+        bli.SetNormalizedFilename(iter->second);
+        return;
+    }
+
+    wxString rawFilename = filename;
+    bli.NormalizeFilename(m_directories, m_cygwinRoot, m_workingDirectory);
+    m_normalizedFiles.insert(std::make_pair(rawFilename, bli.GetFilename()));
+}
+
+void BuildOutputClassifier::DoDeliver(LineVec_t& lines, size_t generation)
+{
+    if(lines.empty()) { return; }
+
+    bool notify = false;
+    {
+        wxMutexLocker locker(m_mutex);
+        if(generation != m_generation) {
+            // The view was cleared while we were working on these lines
+            std::for_each(lines.begin(), lines.end(), [&](const Line& line) { delete line.info; });
+            return;
+        }
+        // Notify the build tab only if it already took the previous lines. Otherwise they are delivered together
+        notify = m_results.empty();
+        m_results.insert(m_results.end(), lines.begin(), lines.end());
+    }
+    if(notify) { m_owner->CallAfter(&NewBuildTab::OnOutputClassified); }
+}
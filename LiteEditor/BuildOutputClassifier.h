@@ -0,0 +1,139 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// Copyright            : (C) 2015 Eran Ifrah
+// File name            : BuildOutputClassifier.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUILDOUTPUTCLASSIFIER_H
+#define BUILDOUTPUTCLASSIFIER_H
+
+#include "compiler.h"
+#include "new_build_tab.h"
+#include "worker_thread.h" // Base class: WorkerThread
+#include <map>
+#include <vector>
+
+/**
+ * @class BuildOutputClassifier
+ * @brief splits the build output into lines and matches them against the compiler error / warning patterns
+ * in the background. The build tab receives the lines ready to be added to the view, each with its BuildLineInfo
+ * (severity, normalized file name and line number)
+ */
+class BuildOutputClassifier : public WorkerThread
+{
+public:
+    struct Line {
+        wxString text;                 ///< The line as it should appear in the view: trimmed and without colours
+        BuildLineInfo* info = nullptr; ///< Allocated by the classifier, owned by the receiver
+    };
+    typedef std::vector<Line> LineVec_t;
+
+protected:
+    struct SetupRequest : public ThreadRequest {
+        Compiler::CmpListInfoPattern errorPatterns;
+        Compiler::CmpListInfoPattern warningPatterns;
+        wxString cygwinRoot;
+        wxString workingDirectory;
+        size_t generation = 0;
+    };
+
+    struct ClearRequest : public ThreadRequest {
+        size_t generation = 0;
+    };
+
+    struct LinesRequest : public ThreadRequest {
+        wxString text;
+        bool flush = false;
+        bool isSummaryLine = false;
+        size_t generation = 0;
+    };
+
+    struct FlushRequest : public ThreadRequest {
+        int stage = 0;
+        size_t generation = 0;
+    };
+
+    NewBuildTab* m_owner;
+
+    // Used by the worker thread only
+    CmpPatterns m_patterns;
+    wxArrayString m_prefilter;
+    bool m_usePrefilter;
+    wxArrayString m_directories;
+    wxString m_cygwinRoot;
+    wxString m_workingDirectory;
+    wxString m_partialLine;
+    std::map<wxString, wxString> m_normalizedFiles;
+
+    // Shared between the threads
+    wxMutex m_mutex;
+    size_t m_generation;
+    LineVec_t m_results;
+
+protected:
+    void DoSetup(SetupRequest* req);
+    void DoClear();
+    void DoProcessText(LinesRequest* req, LineVec_t& lines);
+    void DoProcessLine(const wxString& line, bool isSummaryLine, LineVec_t& lines);
+    void DoSearchForDirectory(const wxString& line);
+    bool DoClassify(const wxString& line, BuildLineInfo& bli, LINE_SEVERITY& severity);
+    void DoNormalizeFilename(BuildLineInfo& bli);
+    void DoDeliver(LineVec_t& lines, size_t generation);
+
+public:
+    BuildOutputClassifier(NewBuildTab* owner);
+    virtual ~BuildOutputClassifier();
+
+    virtual void ProcessRequest(ThreadRequest* request);
+
+    /**
+     * @brief use the error and warning patterns of 'compiler' for the next lines. Called when a build starts
+     * @param workingDirectory the directory the build was started from. Relative file names are resolved against it
+     * (and against the directories make enters), never against the process working directory: the main thread
+     * changes it while we work
+     */
+    void Setup(CompilerPtr compiler, const wxString& cygwinRoot, const wxString& workingDirectory);
+
+    /**
+     * @brief forget the build: directories, partial line and any result that was not taken yet
+     */
+    void Clear();
+
+    /**
+     * @brief queue build output. Only complete lines are classified, unless 'flush' is true
+     * @param isSummaryLine the lines are decorated as a summary line ("====...====") and are never an error
+     */
+    void Add(const wxString& text, bool flush, bool isSummaryLine);
+
+    /**
+     * @brief call NewBuildTab::OnClassifierFlushed(stage, discarded) once all the output queued so far was
+     * classified and delivered. 'discarded' is true when the view was cleared in the meantime
+     */
+    void Flush(int stage);
+
+    /**
+     * @brief move the classified lines into 'lines'. Called from the main thread
+     */
+    void TakeResults(LineVec_t& lines);
+};
+
+#endif // BUILDOUTPUTCLASSIFIER_H
@@ -693,6 +693,7 @@ int CodeLiteApp::OnExit()
     CL_DEBUG(wxT("Bye"));
     EditorConfigST::Free();
     ConfFileLocator::Release();
+    FileLogger::Shutdown();
     return 0;
 }
 
@@ -24,6 +24,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "ColoursAndFontsManager.h"
+#include "LSP/basic_types.h"
 #include "addincludefiledlg.h"
 #include "bookmark_manager.h"
 #include "breakpointdlg.h"
@@ -1721,6 +1722,16 @@ void clEditor::CodeComplete(bool refreshingList)
     }
 }
 
+void clEditor::BuiltinCodeComplete(bool memberCompletion)
+{
+    if(memberCompletion) {
+        m_context->CodeComplete();
+    } else {
+        CodeCompletionManager::Get().SetWordCompletionRefreshNeeded(false);
+        m_context->CompleteWord();
+    }
+}
+
 //----------------------------------------------------------------
 // Demonstrate how to achieve symbol browsing using the CodeLite
 // library, in addition we implements here a memory for allowing
@@ -4351,6 +4362,35 @@ void clEditor::SetEOL()
     SetEOLMode(eol);
 }
 
+void clEditor::DoNotifyTextChanged(wxStyledTextEvent& event)
+{
+    // Both notifications arrive after the document was modified: the text before the change position did not
+    // change, so the start of the range is computed from the current document. The end of a deleted range is
+    // computed from the deleted text. Columns are in UTF-16 code units, as the language servers expect them
+    int pos = event.GetPosition();
+    int line = LineFromPosition(pos);
+    int column = LSP::UTF16Length(GetTextRange(PositionFromLine(line), pos));
+
+    clEditorTextChangedEvent changeEvent(wxEVT_EDITOR_TEXT_CHANGED);
+    changeEvent.SetFileName(GetFileName().GetFullPath());
+    changeEvent.SetStart(line, column);
+    if(event.GetModificationType() & wxSTC_MOD_INSERTTEXT) {
+        changeEvent.SetEnd(line, column);
+        changeEvent.SetText(event.GetText());
+    } else {
+        const wxString& deleted = event.GetText();
+        int lastNewLine = deleted.Find('\n', true);
+        if(lastNewLine == wxNOT_FOUND) {
+            changeEvent.SetEnd(line, column + LSP::UTF16Length(deleted));
+        } else {
+            changeEvent.SetEnd(line + deleted.Freq('\n'), LSP::UTF16Length(deleted.Mid(lastNewLine + 1)));
+        }
+    }
+    // Sent synchronously: a request triggered by this very character (code completion after '.', signature help
+    // after '(') is sent from OnCharAdded and must find the change already queued
+    EventNotifier::Get()->ProcessEvent(changeEvent);
+}
+
 void clEditor::OnChange(wxStyledTextEvent& event)
 {
     event.Skip();
@@ -4373,6 +4413,8 @@ void clEditor::OnChange(wxStyledTextEvent& event)
     eventMod.SetFileName(GetFileName().GetFullPath());
     EventNotifier::Get()->AddPendingEvent(eventMod);
 
+    if((isInsert || isDelete) && !GetReloadingFile()) { DoNotifyTextChanged(event); }
+
     if((m_autoAddNormalBraces && !m_disableSmartIndent) || GetOptions()->GetAutoCompleteDoubleQuotes()) {
         if((event.GetModificationType() & wxSTC_MOD_BEFOREDELETE) &&
            (event.GetModificationType() & wxSTC_PERFORMED_USER)) {
@@ -380,6 +380,11 @@ public:
      */
     void CodeComplete(bool refreshingList = false);
 
+    /**
+     * @brief the built-in code completion, as used when no plugin handles wxEVT_CC_CODE_COMPLETE
+     */
+    virtual void BuiltinCodeComplete(bool memberCompletion);
+
     /**
      * @brief toggle line comment
      * @param commentSymbol the comment symbol to insert (e.g. "//")
@@ -1011,6 +1016,11 @@ private:
     void DoUpdateLineNumbers();
     void UpdateLineNumbers();
 
+    /**
+     * @brief notify about a text insertion or deletion (wxEVT_EDITOR_TEXT_CHANGED)
+     */
+    void DoNotifyTextChanged(wxStyledTextEvent& event);
+
     // Event handlers
     void OpenURL(wxCommandEvent& event);
     void OnHighlightWordChecked(wxCommandEvent& e);
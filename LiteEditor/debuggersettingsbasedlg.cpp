@@ -509,6 +509,31 @@ DbgPageGeneralBase::DbgPageGeneralBase(wxWindow* parent, wxWindowID id, const wx
 
     fgSizer21->Add(m_checkBoxPrintObjectOn, 0, wxALL, WXC_FROM_DIP(5));
 
+    fgSizer21->Add(0, 0, 1, wxEXPAND, WXC_FROM_DIP(5));
+
+    m_staticText203 =
+        new wxStaticText(m_panelDisplay, wxID_ANY, _("Number of children to list at a time for a variable object:"),
+                         wxDefaultPosition, wxDLG_UNIT(m_panelDisplay, wxSize(-1, -1)), 0);
+    m_staticText203->SetToolTip(_("For no limit, set it to 0"));
+
+    fgSizer21->Add(m_staticText203, 0, wxALL | wxALIGN_CENTER_VERTICAL, WXC_FROM_DIP(5));
+
+    m_spinCtrlVarObjChildren = new wxSpinCtrl(m_panelDisplay, wxID_ANY, wxT("100"), wxDefaultPosition,
+                                              wxDLG_UNIT(m_panelDisplay, wxSize(-1, -1)), wxSP_ARROW_KEYS);
+    m_spinCtrlVarObjChildren->SetToolTip(_("For no limit, set it to 0"));
+    m_spinCtrlVarObjChildren->SetRange(0, 10000);
+    m_spinCtrlVarObjChildren->SetValue(100);
+
+    fgSizer21->Add(m_spinCtrlVarObjChildren, 0, wxALL | wxALIGN_CENTER_VERTICAL, WXC_FROM_DIP(5));
+
+    m_checkBoxLazyLocals = new wxCheckBox(m_panelDisplay, wxID_ANY, _("Fetch the value of a local when it is expanded"),
+                                          wxDefaultPosition, wxDLG_UNIT(m_panelDisplay, wxSize(-1, -1)), 0);
+    m_checkBoxLazyLocals->SetValue(false);
+    m_checkBoxLazyLocals->SetToolTip(
+        _("List only the names of the locals. Faster when stepping through functions with many or large locals"));
+
+    fgSizer21->Add(m_checkBoxLazyLocals, 0, wxALL | wxEXPAND, WXC_FROM_DIP(5));
+
     SetName(wxT("DbgPageGeneralBase"));
     SetSize(wxDLG_UNIT(this, wxSize(-1, -1)));
     if(GetSizer()) { GetSizer()->Fit(this); }
@@ -165,6 +165,9 @@ protected:
     wxCheckBox* m_checkBoxCharArrAsPtr;
     wxCheckBox* m_checkBoxUsePrettyPrinting;
     wxCheckBox* m_checkBoxPrintObjectOn;
+    wxStaticText* m_staticText203;
+    wxSpinCtrl* m_spinCtrlVarObjChildren;
+    wxCheckBox* m_checkBoxLazyLocals;
 
 protected:
     virtual void OnBrowse(wxCommandEvent& event) { event.Skip(); }
@@ -191,6 +194,9 @@ public:
     wxCheckBox* GetCheckBoxCharArrAsPtr() { return m_checkBoxCharArrAsPtr; }
     wxCheckBox* GetCheckBoxUsePrettyPrinting() { return m_checkBoxUsePrettyPrinting; }
     wxCheckBox* GetCheckBoxPrintObjectOn() { return m_checkBoxPrintObjectOn; }
+    wxStaticText* GetStaticText203() { return m_staticText203; }
+    wxSpinCtrl* GetSpinCtrlVarObjChildren() { return m_spinCtrlVarObjChildren; }
+    wxCheckBox* GetCheckBoxLazyLocals() { return m_checkBoxLazyLocals; }
     wxPanel* GetPanelDisplay() { return m_panelDisplay; }
     wxNotebook* GetNotebook73() { return m_notebook73; }
     wxPanel* GetPanel6() { return m_panel6; }
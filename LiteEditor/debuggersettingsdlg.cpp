@@ -113,6 +113,8 @@ DebuggerPage::DebuggerPage(wxWindow* parent, wxString title)
         m_checkBoxPrintObjectOn->SetValue(!(info.flags & DebuggerInformation::kPrintObjectOff));
         m_checkBoxRunAsSuperuser->SetValue(info.flags & DebuggerInformation::kRunAsSuperuser);
         m_checkBoxDefaultHexDisplay->SetValue(info.defaultHexDisplay);
+        m_spinCtrlVarObjChildren->SetValue(info.maxVarObjChildren);
+        m_checkBoxLazyLocals->SetValue(info.lazyLocals);
     }
 }
 
@@ -317,6 +319,8 @@ void DebuggerSettingsDlg::OnOk(wxCommandEvent& e)
             info.charArrAsPtr = page->m_checkBoxCharArrAsPtr->IsChecked();
             info.enableGDBPrettyPrinting = page->m_checkBoxUsePrettyPrinting->IsChecked();
             info.defaultHexDisplay = page->m_checkBoxDefaultHexDisplay->IsChecked();
+            info.maxVarObjChildren = page->m_spinCtrlVarObjChildren->GetValue();
+            info.lazyLocals = page->m_checkBoxLazyLocals->IsChecked();
 
             // Update the flags
             if(page->m_checkBoxPrintObjectOn->IsChecked()) {
@@ -262,8 +262,14 @@ void FileViewTree::BuildTree()
             AddWorkspaceFolder(folders.Item(i));
         }
 
+        // Read the folder colours once for the entire workspace and not once per project
+        FolderColour::Map_t coloursMap;
+        FolderColour::List_t coloursList;
+        LocalWorkspaceST::Get()->GetFolderColours(coloursMap);
+        FolderColour::SortToList(coloursMap, coloursList);
+
         for(size_t n = 0; n < list.GetCount(); n++) {
-            BuildProjectNode(list.Item(n));
+            BuildProjectNode(list.Item(n), coloursList);
         }
 
         // set selection to first item
@@ -301,7 +307,7 @@ int FileViewTree::GetIconIndex(const ProjectItem& item)
     return icondIndex;
 }
 
-void FileViewTree::BuildProjectNode(const wxString& projectName)
+void FileViewTree::BuildProjectNode(const wxString& projectName, const FolderColour::List_t& coloursList)
 {
     wxString err_msg;
     ProjectPtr prj = clCxxWorkspaceST::Get()->FindProjectByName(projectName, err_msg);
@@ -309,13 +315,6 @@ void FileViewTree::BuildProjectNode(const wxString& projectName)
     // Add the folder containing this project
     wxTreeItemId rootItem = AddWorkspaceFolder(prj->GetWorkspaceFolder());
 
-    FolderColour::Map_t coloursMap;
-    FolderColour::List_t coloursList;
-    LocalWorkspaceST::Get()->GetFolderColours(coloursMap);
-
-    // Sort the list
-    FolderColour::SortToList(coloursMap, coloursList);
-
     // We only the project node
     bool iconFromPlugin = false;
     int projectIconIndex = wxNOT_FOUND;
@@ -2848,7 +2847,7 @@ void FileViewTree::DoAddChildren(const wxTreeItemId& parentItem)
         DoSetItemBackgroundColour(hti, coloursList, fileItem);
 
         // If the file is disabled for the current build configuration, mark it as such
-        clProjectFile::Ptr_t fileInfo = proj->GetFile(fn.GetFullPath());
+        clProjectFile::Ptr_t fileInfo = proj->GetFile(filepath);
         if(fileInfo && !buildConfName.IsEmpty() && fileInfo->IsExcludeFromConfiguration(buildConfName)) {
             // Set the item text with disabled colour
             ExcludeFileFromBuildUI(hti, true);
@@ -221,7 +221,7 @@ protected:
 
 private:
     // Build project node
-    void BuildProjectNode(const wxString& projectName);
+    void BuildProjectNode(const wxString& projectName, const FolderColour::List_t& coloursList);
     void DoClear();
     void DoAddChildren(const wxTreeItemId& parentItem);
     void DoBuildSubTreeIfNeeded(const wxTreeItemId& parent);
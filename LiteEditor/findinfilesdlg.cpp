@@ -23,6 +23,7 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 #include "FindInFilesLocationsDlg.h"
+#include "clTrigramIndex.h"
 #include "clWorkspaceManager.h"
 #include "dirpicker.h"
 #include "findinfilesdlg.h"
@@ -178,6 +179,13 @@ SearchData FindInFilesDialog::DoGetSearchData()
     data.SetSkipStrings(flags & wxFRD_SKIP_STRINGS);
     data.SetColourComments(flags & wxFRD_COLOUR_COMMENTS);
     data.SetEnablePipeSupport(flags & wxFRD_ENABLE_PIPE_SUPPORT);
+    // Plain literal searches are spread over a pool of worker threads
+    data.SetMultiThreaded(true);
+    if(clCxxWorkspaceST::Get()->IsOpen()) {
+        // Consult the trigram index kept next to the workspace tags database
+        data.SetUseIndex(true);
+        data.SetIndexFile(clTrigramIndex::GetIndexFileName(clCxxWorkspaceST::Get()->GetTagsFileName()).GetFullPath());
+    }
     wxArrayString searchWhere = GetPathsAsArray();
     wxArrayString files;
     wxArrayString rootDirs;
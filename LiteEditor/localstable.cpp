@@ -68,7 +68,27 @@ LocalsTable::LocalsTable(wxWindow* parent)
 
 LocalsTable::~LocalsTable() {}
 
-void LocalsTable::UpdateLocals(const LocalVariables& locals) { DoUpdateLocals(locals, DbgTreeItemData::Locals); }
+void LocalsTable::UpdateLocals(const LocalVariables& locals)
+{
+    DoUpdateLocals(locals, DbgTreeItemData::Locals);
+    DoUpdateVariableObjects();
+}
+
+void LocalsTable::DoUpdateVariableObjects()
+{
+    // The variable objects are kept between steps, ask gdb which of them changed. Only the changed ones are
+    // evaluated again (see OnVariableObjUpdate)
+    IDebugger* dbgr = DoGetDebugger();
+    if(!dbgr) return;
+
+    wxTreeItemIdValue cookie;
+    wxTreeItemId item = m_listTable->GetFirstChild(m_listTable->GetRootItem(), cookie);
+    while(item.IsOk()) {
+        wxString gdbId = DoGetGdbId(item);
+        if(!gdbId.IsEmpty()) { dbgr->UpdateWatch(gdbId); }
+        item = m_listTable->GetNextChild(m_listTable->GetRootItem(), cookie);
+    }
+}
 
 void LocalsTable::UpdateFuncArgs(const LocalVariables& args) { DoUpdateLocals(args, DbgTreeItemData::FuncArgs); }
 
@@ -129,6 +149,8 @@ void LocalsTable::OnListChildren(const DebuggerEventData& event)
     m_listChildItemId.erase(iter);
 
     if(event.m_userReason == m_LIST_CHILDS) {
+        // A next page replaces the "more children" item
+        DoDeleteMoreChildrenItem(item, gdbId);
         if(event.m_varObjChildren.empty() == false) {
             for(size_t i = 0; i < event.m_varObjChildren.size(); i++) {
 
@@ -136,7 +158,11 @@ void LocalsTable::OnListChildren(const DebuggerEventData& event)
                 if(!dbgr) return;
 
                 VariableObjChild ch = event.m_varObjChildren.at(i);
-                if(ch.varName == wxT("public") || ch.varName == wxT("private") || ch.varName == wxT("protected")) {
+                if(ch.nextChildIndex != wxNOT_FOUND) {
+                    DoAppendMoreChildrenItem(item, ch);
+
+                } else if(ch.varName == wxT("public") || ch.varName == wxT("private") ||
+                          ch.varName == wxT("protected")) {
                     // not really a node...
                     // ask for information about this node children
                     dbgr->ListChildren(ch.gdbId, m_LIST_CHILDS);
@@ -188,6 +214,8 @@ void LocalsTable::OnVariableObjUpdate(const DebuggerEventData& event)
 
 void LocalsTable::OnItemExpanding(wxTreeEvent& event)
 {
+    if(DoExpandMoreChildrenItem(event)) { return; }
+
     wxBusyCursor bc;
     wxTreeItemIdValue cookie;
     wxTreeItemId child = m_listTable->GetFirstChild(event.GetItem(), cookie);
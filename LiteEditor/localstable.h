@@ -49,6 +49,7 @@ protected:
     void DoClearNonVariableObjectEntries(wxArrayString& itemsNotRemoved, size_t flags,
                                          std::map<wxString, wxString>& oldValues);
     void DoUpdateLocals(const LocalVariables& locals, size_t kind);
+    void DoUpdateVariableObjects();
 
     // Events
     void OnItemExpanding(wxTreeEvent& event);
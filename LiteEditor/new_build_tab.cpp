@@ -23,6 +23,7 @@
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
+#include "BuildOutputClassifier.h"
 #include "BuildTabTopPanel.h"
 #include "ColoursAndFontsManager.h"
 #include "Notebook.h"
@@ -57,6 +58,9 @@
 #include <wx/settings.h>
 
 #define IS_VALID_LINE(lineNumber) ((lineNumber >= 0 && lineNumber < m_view->GetLineCount()))
+
+// Build output is added to the view at most once per this many ms
+static int OUTPUT_FLUSH_INTERVAL = 40;
 #ifdef __WXMSW__
 #define IS_WINDOWS true
 #else
@@ -101,6 +105,8 @@ NewBuildTab::NewBuildTab(wxWindow* parent)
     , m_buildInProgress(false)
     , m_maxlineWidth(wxNOT_FOUND)
     , m_lastLineColoured(wxNOT_FOUND)
+    , m_outputTimer(NULL)
+    , m_classifier(NULL)
 {
     SetSize(wxNOT_FOUND, 400);
     m_curError = m_errorsAndWarningsList.end();
@@ -112,6 +118,12 @@ NewBuildTab::NewBuildTab(wxWindow* parent)
     InitView();
     Bind(wxEVT_IDLE, &NewBuildTab::OnIdle, this);
 
+    m_outputTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &NewBuildTab::OnOutputTimer, this, m_outputTimer->GetId());
+
+    m_classifier = new BuildOutputClassifier(this);
+    m_classifier->Start();
+
     m_view->Bind(wxEVT_STC_HOTSPOT_CLICK, &NewBuildTab::OnHotspotClicked, this);
     EventNotifier::Get()->Bind(wxEVT_CL_THEME_CHANGED, &NewBuildTab::OnThemeChanged, this);
 
@@ -142,6 +154,11 @@ NewBuildTab::NewBuildTab(wxWindow* parent)
 
 NewBuildTab::~NewBuildTab()
 {
+    m_outputTimer->Stop();
+    wxDELETE(m_outputTimer);
+    m_classifier->Stop();
+    wxDELETE(m_classifier);
+
     EventNotifier::Get()->Unbind(wxEVT_CL_THEME_CHANGED, &NewBuildTab::OnThemeChanged, this);
     EventNotifier::Get()->Disconnect(wxEVT_SHELL_COMMAND_STARTED, clCommandEventHandler(NewBuildTab::OnBuildStarted),
                                      NULL, this);
@@ -163,8 +180,36 @@ void NewBuildTab::OnBuildEnded(clCommandEvent& e)
     CL_DEBUG("Build Ended!");
     m_buildInProgress = false;
 
+    // Flush whatever is still waiting for the output timer. The summary is added once it was classified: the error
+    // count must be final before we report it (and before the next command in the build queue checks it)
+    m_outputTimer->Stop();
     DoProcessOutput(true, false);
+    m_classifier->Flush(kFlushBuildOutput);
+}
+
+void NewBuildTab::OnClassifierFlushed(int stage, bool discarded)
+{
+    if(discarded) {
+        // The view was cleared (workspace closed, a new build...): there is nothing to summarize, but the build did
+        // end. wxEVT_BUILD_ENDED drives the build queue, it must be sent
+        clBuildEvent buildEvent(wxEVT_BUILD_ENDED);
+        buildEvent.SetErrorCount(m_errorCount);
+        buildEvent.SetWarningCount(m_warnCount);
+        EventNotifier::Get()->AddPendingEvent(buildEvent);
+        return;
+    }
+
+    // Lines delivered after the last OnOutputClassified() call
+    OnOutputClassified();
+    if(stage == kFlushBuildOutput) {
+        DoAddSummary();
+    } else {
+        DoBuildEnded();
+    }
+}
 
+void NewBuildTab::DoAddSummary()
+{
     std::vector<clEditor*> editors;
     clMainFrame::Get()->GetMainBook()->GetAllEditors(editors, MainBook::kGetAll_Default);
     for(size_t i = 0; i < editors.size(); i++) {
@@ -192,7 +237,11 @@ void NewBuildTab::OnBuildEnded(clCommandEvent& e)
         m_output = InterruptedMsg;
         DoProcessOutput(true, false);
     }
+    m_classifier->Flush(kFlushSummary);
+}
 
+void NewBuildTab::DoBuildEnded()
+{
     // Hide / Show the build tab according to the settings
     DoToggleWindow();
 
@@ -247,10 +296,7 @@ void NewBuildTab::OnBuildStarted(clCommandEvent& e)
     m_showMe = (BuildTabSettingsData::ShowBuildPane)m_buildTabSettings.GetShowBuildPane();
     m_skipWarnings = m_buildTabSettings.GetSkipWarnings();
 
-    if(e.GetEventType() != wxEVT_SHELL_COMMAND_STARTED_NOCLEAN) {
-        DoClear();
-        DoCacheRegexes();
-    }
+    if(e.GetEventType() != wxEVT_SHELL_COMMAND_STARTED_NOCLEAN) { DoClear(); }
 
     // Show the tab if needed
     OutputPane* opane = clMainFrame::Get()->GetOutputPane();
@@ -282,83 +328,79 @@ void NewBuildTab::OnBuildStarted(clCommandEvent& e)
         buildEvent.SetConfigurationName(bed->GetConfiguration());
         EventNotifier::Get()->AddPendingEvent(buildEvent);
     }
+    // The build process is started from the current directory
+    m_classifier->Setup(m_cmp, m_cygwinRoot, ::wxGetCwd());
 }
 
 void NewBuildTab::OnBuildAddLine(clCommandEvent& e)
 {
     e.Skip(); // Always call skip..
     m_output << e.GetString();
+
+    // Don't touch the view for every chunk: a busy build can send thousands of them per second. Collect the output
+    // and process it in batches, at frame rate
+    if(!m_outputTimer->IsRunning()) { m_outputTimer->Start(OUTPUT_FLUSH_INTERVAL, wxTIMER_ONE_SHOT); }
+}
+
+void NewBuildTab::OnOutputTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
     DoProcessOutput(false, false);
 }
 
-BuildLineInfo* NewBuildTab::DoProcessLine(const wxString& line)
+void NewBuildTab::OnOutputClassified()
 {
-    BuildLineInfo* buildLineInfo = new BuildLineInfo();
-    LINE_SEVERITY severity;
-    // Get the matching regex for this line
-    CmpPatternPtr cmpPatterPtr = GetMatchingRegex(line, severity);
-    buildLineInfo->SetSeverity(severity);
-    BuildLineInfo bli;
-    if(cmpPatterPtr && cmpPatterPtr->Matches(line, bli)) {
-        buildLineInfo->SetFilename(bli.GetFilename());
-        buildLineInfo->SetSeverity(bli.GetSeverity());
-        buildLineInfo->SetLineNumber(bli.GetLineNumber());
-        buildLineInfo->NormalizeFilename(m_directories, m_cygwinRoot);
-        buildLineInfo->SetRegexLineMatch(bli.GetRegexLineMatch());
-        buildLineInfo->SetColumn(bli.GetColumn());
-        if(severity == SV_WARNING) {
-            // Warning
+    BuildOutputClassifier::LineVec_t lines;
+    m_classifier->TakeResults(lines);
+    if(lines.empty()) { return; }
+
+    wxString text;
+    size_t longestLine = 0;
+    int firstLine = m_view->GetLineCount() - 1; // -1 because the view always has 1 extra "\n"
+    for(size_t i = 0; i < lines.size(); ++i) {
+        BuildLineInfo* buildLineInfo = lines[i].info;
+
+        // keep the line info
+        if(!buildLineInfo->GetFilename().IsEmpty()) {
+            m_buildInfoPerFile.insert(std::make_pair(buildLineInfo->GetFilename(), buildLineInfo));
+        }
+
+        if(buildLineInfo->GetSeverity() == SV_WARNING) {
             m_errorsAndWarningsList.push_back(buildLineInfo);
             m_warnCount++;
-        } else {
-            // Error
+
+        } else if(buildLineInfo->GetSeverity() == SV_ERROR) {
             m_errorsAndWarningsList.push_back(buildLineInfo);
             m_errorsList.push_back(buildLineInfo);
             m_errorCount++;
         }
+
+        // Keep the line number in the build tab. The line info is used to colour the line
+        buildLineInfo->SetLineInBuildTab(firstLine + (int)i);
+        m_viewData.insert(std::make_pair(buildLineInfo->GetLineInBuildTab(), buildLineInfo));
+
+        text << lines[i].text << "\n";
+        if(lines[i].text.length() > lines[longestLine].text.length()) { longestLine = i; }
     }
-    return buildLineInfo;
-}
 
-void NewBuildTab::DoCacheRegexes()
-{
-    m_cmpPatterns.clear();
-
-    // Loop over all known compilers and cache the regular expressions
-    BuildSettingsConfigCookie cookie;
-    CompilerPtr cmp = BuildSettingsConfigST::Get()->GetFirstCompiler(cookie);
-    while(cmp) {
-        CmpPatterns cmpPatterns;
-        const Compiler::CmpListInfoPattern& errPatterns = cmp->GetErrPatterns();
-        const Compiler::CmpListInfoPattern& warnPatterns = cmp->GetWarnPatterns();
-        Compiler::CmpListInfoPattern::const_iterator iter;
-        for(iter = errPatterns.begin(); iter != errPatterns.end(); iter++) {
-
-            CmpPatternPtr compiledPatternPtr(new CmpPattern(new wxRegEx(iter->pattern, wxRE_ADVANCED | wxRE_ICASE),
-                                                            iter->fileNameIndex, iter->lineNumberIndex,
-                                                            iter->columnIndex, SV_ERROR));
-            if(compiledPatternPtr->GetRegex()->IsValid()) { cmpPatterns.errorsPatterns.push_back(compiledPatternPtr); }
-        }
+    // Add the whole batch at once
+    m_view->SetEditable(true);
+    m_view->AppendText(text);
 
-        for(iter = warnPatterns.begin(); iter != warnPatterns.end(); iter++) {
+    // Only the longest line of the batch can widen the view
+    int curline = firstLine + (int)longestLine;
+    int endPosition = m_view->GetLineEndPosition(curline); // get character position from begin
+    int beginPosition = m_view->PositionFromLine(curline); // and end of line
 
-            CmpPatternPtr compiledPatternPtr(new CmpPattern(new wxRegEx(iter->pattern, wxRE_ADVANCED | wxRE_ICASE),
-                                                            iter->fileNameIndex, iter->lineNumberIndex,
-                                                            iter->columnIndex, SV_WARNING));
-            if(compiledPatternPtr->GetRegex()->IsValid()) { cmpPatterns.warningPatterns.push_back(compiledPatternPtr); }
-        }
+    wxPoint beginPos = m_view->PointFromPosition(beginPosition);
+    wxPoint endPos = m_view->PointFromPosition(endPosition);
 
-        m_cmpPatterns.insert(std::make_pair(cmp->GetName(), cmpPatterns));
-        cmp = BuildSettingsConfigST::Get()->GetNextCompiler(cookie);
-    }
-}
+    int curLen = (endPos.x - beginPos.x) + 10;
+    m_maxlineWidth = wxMax(m_maxlineWidth, curLen);
+    if(m_maxlineWidth > 0) { m_view->SetScrollWidth(m_maxlineWidth); }
+    m_view->SetEditable(false);
 
-bool NewBuildTab::DoGetCompilerPatterns(const wxString& compilerName, CmpPatterns& patterns)
-{
-    MapCmpPatterns_t::iterator iter = m_cmpPatterns.find(compilerName);
-    if(iter == m_cmpPatterns.end()) { return false; }
-    patterns = iter->second;
-    return true;
+    if(clConfig::Get().Read(kConfigBuildAutoScroll, true)) { m_view->ScrollToEnd(); }
 }
 
 void NewBuildTab::DoClear()
@@ -367,13 +409,13 @@ void NewBuildTab::DoClear()
     m_lastLineColoured = wxNOT_FOUND;
     m_maxlineWidth = wxNOT_FOUND;
     m_buildInterrupted = false;
-    m_directories.Clear();
+    m_output.Clear();
+    m_classifier->Clear();
     m_buildInfoPerFile.clear();
     m_warnCount = 0;
     m_errorCount = 0;
     m_errorsAndWarningsList.clear();
     m_errorsList.clear();
-    m_cmpPatterns.clear();
 
     // Delete all the user data
     std::for_each(m_viewData.begin(), m_viewData.end(), [&](std::pair<int, BuildLineInfo*> p) { delete p.second; });
@@ -479,25 +521,6 @@ void NewBuildTab::MarkEditor(clEditor* editor)
     editor->Refresh();
 }
 
-void NewBuildTab::DoSearchForDirectory(const wxString& line)
-{
-    // Check for makefile directory changes lines
-    if(line.Contains(wxT("Entering directory `"))) {
-        wxString currentDir = line.AfterFirst(wxT('`'));
-        currentDir = currentDir.BeforeLast(wxT('\''));
-
-        // Collect the m_baseDir
-        m_directories.Add(currentDir);
-
-    } else if(line.Contains(wxT("Entering directory '"))) {
-        wxString currentDir = line.AfterFirst(wxT('\''));
-        currentDir = currentDir.BeforeLast(wxT('\''));
-
-        // Collect the m_baseDir
-        m_directories.Add(currentDir);
-    }
-}
-
 void NewBuildTab::OnWorkspaceClosed(wxCommandEvent& e)
 {
     e.Skip();
@@ -514,68 +537,14 @@ void NewBuildTab::OnWorkspaceLoaded(wxCommandEvent& e)
 
 void NewBuildTab::DoProcessOutput(bool compilationEnded, bool isSummaryLine)
 {
-    wxUnusedVar(isSummaryLine);
     if(!compilationEnded && m_output.Find(wxT("\n")) == wxNOT_FOUND) {
         // still dont have a complete line
         return;
     }
 
-    wxArrayString lines = ::wxStringTokenize(m_output, wxT("\n"), wxTOKEN_RET_DELIMS);
+    // The lines are classified in the background and added to the view in OnOutputClassified()
+    m_classifier->Add(m_output, compilationEnded, isSummaryLine);
     m_output.Clear();
-
-    // Process only completed lines (i.e. a line that ends with '\n')
-    for(size_t i = 0; i < lines.GetCount(); ++i) {
-        if(!compilationEnded && !lines.Item(i).EndsWith(wxT("\n"))) {
-            m_output << lines.Item(i);
-            return;
-        }
-
-        wxString buildLine = lines.Item(i); //.Trim().Trim(false);
-        // If this is a line similar to 'Entering directory `'
-        // add the path in the directories array
-        DoSearchForDirectory(buildLine);
-        BuildLineInfo* buildLineInfo = DoProcessLine(buildLine);
-
-        // keep the line info
-        if(buildLineInfo->GetFilename().IsEmpty() == false) {
-            m_buildInfoPerFile.insert(std::make_pair(buildLineInfo->GetFilename(), buildLineInfo));
-        }
-
-        if(isSummaryLine) {
-            buildLine.Trim();
-            buildLine.Prepend("====");
-            buildLine.Append("====");
-            buildLineInfo->SetSeverity(SV_NONE);
-        }
-
-        // Keep the line number in the build tab
-        buildLineInfo->SetLineInBuildTab(m_view->GetLineCount() - 1); // -1 because the view always has 1 extra "\n"
-        // Store the line info *before* we add the text
-        // it is needed in the OnStyle function
-        m_viewData.insert(std::make_pair(buildLineInfo->GetLineInBuildTab(), buildLineInfo));
-
-        m_view->SetEditable(true);
-        buildLine.Trim();
-        wxString modText;
-        ::clStripTerminalColouring(buildLine, modText);
-
-        int curline = m_view->GetLineCount() - 1;
-        m_view->AppendText(modText + "\n");
-
-        // get the newly added line width
-        int endPosition = m_view->GetLineEndPosition(curline); // get character position from begin
-        int beginPosition = m_view->PositionFromLine(curline); // and end of line
-
-        wxPoint beginPos = m_view->PointFromPosition(beginPosition);
-        wxPoint endPos = m_view->PointFromPosition(endPosition);
-
-        int curLen = (endPos.x - beginPos.x) + 10;
-        m_maxlineWidth = wxMax(m_maxlineWidth, curLen);
-        if(m_maxlineWidth > 0) { m_view->SetScrollWidth(m_maxlineWidth); }
-        m_view->SetEditable(false);
-
-        if(clConfig::Get().Read(kConfigBuildAutoScroll, true)) { m_view->ScrollToEnd(); }
-    }
 }
 
 void NewBuildTab::CenterLineInView(int line)
@@ -956,10 +925,9 @@ void NewBuildTab::ColourOutput()
         m_view->StartStyling(startPos, 0x1f);
 #endif
 
-        // Run the regexes
-        wxString lineText = m_view->GetLine(i);
-        LINE_SEVERITY severity;
-        GetMatchingRegex(lineText, severity);
+        // The line was already classified by the BuildOutputClassifier
+        std::map<int, BuildLineInfo*>::const_iterator iter = m_viewData.find(i);
+        LINE_SEVERITY severity = (iter == m_viewData.end()) ? SV_NONE : iter->second->GetSeverity();
         switch(severity) {
         case SV_WARNING:
             m_view->SetStyling((lineEndPos - startPos), LEX_GCC_WARNING);
@@ -982,58 +950,6 @@ void NewBuildTab::ColourOutput()
     m_lastLineColoured = untilLine;
 }
 
-CmpPatternPtr NewBuildTab::GetMatchingRegex(const wxString& lineText, LINE_SEVERITY& severity)
-{
-    if(lineText.Lower().Contains("entering directory") || lineText.Lower().Contains("leaving directory")) {
-        severity = SV_DIR_CHANGE;
-        return NULL;
-
-    } else if(lineText.StartsWith("====")) {
-        severity = SV_NONE;
-        return NULL;
-
-    } else {
-
-        // Find *warnings* first
-        bool isWarning = false;
-
-        if(!m_cmp) {
-            severity = SV_NONE;
-            return NULL;
-        }
-
-        CmpPatterns cmpPatterns;
-        if(!DoGetCompilerPatterns(m_cmp->GetName(), cmpPatterns)) {
-            severity = SV_NONE;
-            return NULL;
-        }
-
-        // If it is not an error, maybe it's a warning
-        for(size_t i = 0; i < cmpPatterns.warningPatterns.size(); i++) {
-            CmpPatternPtr cmpPatterPtr = cmpPatterns.warningPatterns.at(i);
-            BuildLineInfo bli;
-            if(cmpPatterPtr->Matches(lineText, bli)) {
-                severity = SV_WARNING;
-                return cmpPatterPtr;
-            }
-        }
-        if(!isWarning) {
-            for(size_t i = 0; i < cmpPatterns.errorsPatterns.size(); i++) {
-                BuildLineInfo bli;
-                CmpPatternPtr cmpPatterPtr = cmpPatterns.errorsPatterns.at(i);
-                if(cmpPatterPtr->Matches(lineText, bli)) {
-                    severity = SV_ERROR;
-                    return cmpPatterPtr;
-                }
-            }
-        }
-    }
-
-    // Default
-    severity = SV_NONE;
-    return NULL;
-}
-
 void NewBuildTab::OnIdle(wxIdleEvent& event)
 {
     if(m_view->IsEmpty()) { return; }
@@ -1077,7 +993,8 @@ bool CmpPattern::Matches(const wxString& line, BuildLineInfo& lineInfo)
     return true;
 }
 
-void BuildLineInfo::NormalizeFilename(const wxArrayString& directories, const wxString& cygwinPath)
+void BuildLineInfo::NormalizeFilename(const wxArrayString& directories, const wxString& cygwinPath,
+                                      const wxString& workingDirectory)
 {
     wxFileName fn(this->GetFilename());
 
@@ -1093,35 +1010,23 @@ void BuildLineInfo::NormalizeFilename(const wxArrayString& directories, const wx
         return;
     }
 
-    if(directories.IsEmpty()) {
+    if(directories.IsEmpty() && workingDirectory.IsEmpty()) {
         SetFilename(fn.GetFullName());
         return;
     }
 
-    // we got a relative file name
-    int dircount = directories.GetCount();
-    for(int i = dircount - 1; i >= 0; --i) {
-        wxFileName tmp = fn;
-        if(tmp.Normalize(wxPATH_NORM_ALL & ~wxPATH_NORM_LONG)) {
-            // Windows sanity
-            if(IS_WINDOWS && tmp.GetVolume().length() > 1) {
-                // Invalid file path
-                SetFilename("");
-                return;
-            }
-
-            if(tmp.FileExists() && tmp.MakeAbsolute(directories.Item(i))) {
-                SetFilename(tmp.GetFullPath());
-                return;
-            }
-        }
+    // we got a relative file name: try the directory the build was started from first, then the directories that
+    // make entered (the latest first). This runs on the build output thread, so Normalize() must never fall back
+    // to the process working directory
+    wxArrayString bases;
+    if(!workingDirectory.IsEmpty()) { bases.Add(workingDirectory); }
+    for(int i = (int)directories.GetCount() - 1; i >= 0; --i) {
+        bases.Add(directories.Item(i));
     }
 
-    // One more try: the above will fail if the project isn't stored in the cwd that Normalize() assumes
-    // So see if one of 'directories' is the correct path to use
-    for(int i = dircount - 1; i >= 0; --i) {
+    for(size_t i = 0; i < bases.GetCount(); ++i) {
         wxFileName tmp = fn;
-        if(tmp.Normalize(wxPATH_NORM_ALL & ~wxPATH_NORM_LONG, directories.Item(i))) {
+        if(tmp.Normalize(wxPATH_NORM_ALL & ~wxPATH_NORM_LONG, bases.Item(i))) {
             // Windows sanity
             if(IS_WINDOWS && tmp.GetVolume().length() > 1) {
                 // Invalid file path
@@ -32,6 +32,7 @@
 #include <wx/fdrepdlg.h>
 #include <wx/dataview.h>
 #include <wx/stopwatch.h>
+#include <wx/timer.h>
 #include <wx/panel.h> // Base class: wxPanel
 #include "buildtabsettingsdata.h"
 #include "compiler.h"
@@ -41,6 +42,7 @@
 #include <wx/stc/stc.h>
 
 class wxDataViewListCtrl;
+class BuildOutputClassifier;
 
 ///////////////////////////////
 // Holds the information about
@@ -77,13 +79,18 @@ public:
     /**
      * @brief try to expand the file name and normalize it into a fullpath
      */
-    void NormalizeFilename(const wxArrayString& directories, const wxString& cygwinPath);
+    void NormalizeFilename(const wxArrayString& directories, const wxString& cygwinPath,
+                           const wxString& workingDirectory);
 
     void SetColumn(int column) { this->m_column = column; }
     int GetColumn() const { return m_column; }
     void SetRegexLineMatch(int regexLineMatch) { this->m_regexLineMatch = regexLineMatch; }
     int GetRegexLineMatch() const { return m_regexLineMatch; }
     void SetFilename(const wxString& filename);
+    /**
+     * @brief set a file name that is already normalized, without resolving it again
+     */
+    void SetNormalizedFilename(const wxString& filename) { this->m_filename = filename; }
     void SetLineNumber(int line_number) { this->m_line_number = line_number; }
     void SetSeverity(LINE_SEVERITY severity) { this->m_severity = severity; }
     const wxString& GetFilename() const { return m_filename; }
@@ -147,15 +154,14 @@ class clEditor;
 class NewBuildTab : public wxPanel
 {
     enum BuildpaneScrollTo { ScrollToFirstError, ScrollToFirstItem, ScrollToEnd };
+    enum eFlushStage { kFlushBuildOutput, kFlushSummary };
 
-    typedef std::map<wxString, CmpPatterns> MapCmpPatterns_t;
     typedef std::multimap<wxString, BuildLineInfo*> MultimapBuildInfo_t;
     typedef std::list<BuildLineInfo*> BuildInfoList_t;
 
     wxString m_output;
     wxStyledTextCtrl* m_view;
     CompilerPtr m_cmp;
-    MapCmpPatterns_t m_cmpPatterns;
     int m_warnCount;
     int m_errorCount;
     BuildTabSettingsData m_buildTabSettings;
@@ -164,7 +170,6 @@ class NewBuildTab : public wxPanel
     BuildTabSettingsData::ShowBuildPane m_showMe;
     wxStopWatch m_sw;
     MultimapBuildInfo_t m_buildInfoPerFile;
-    wxArrayString m_directories;
     bool m_skipWarnings;
     BuildpaneScrollTo m_buildpaneScrollTo;
     BuildInfoList_t m_errorsAndWarningsList;
@@ -175,15 +180,15 @@ class NewBuildTab : public wxPanel
     std::map<int, BuildLineInfo*> m_viewData;
     int m_maxlineWidth;
     int m_lastLineColoured;
+    wxTimer* m_outputTimer;
+    BuildOutputClassifier* m_classifier;
 
 protected:
     void InitView(const wxString& theme = "");
     void CenterLineInView(int line);
-    void DoCacheRegexes();
-    BuildLineInfo* DoProcessLine(const wxString& line);
     void DoProcessOutput(bool compilationEnded, bool isSummaryLine);
-    void DoSearchForDirectory(const wxString& line);
-    bool DoGetCompilerPatterns(const wxString& compilerName, CmpPatterns& patterns);
+    void DoAddSummary();
+    void DoBuildEnded();
     void DoClear();
     void MarkEditor(clEditor* editor);
     void DoToggleWindow();
@@ -191,7 +196,6 @@ protected:
     wxFont DoGetFont() const;
     void DoCentreErrorLine(BuildLineInfo* bli, clEditor* editor, bool centerLine);
     void ColourOutput();
-    CmpPatternPtr GetMatchingRegex(const wxString& lineText, LINE_SEVERITY& severity);
 
 public:
     NewBuildTab(wxWindow* parent);
@@ -210,6 +214,18 @@ public:
     wxString GetBuildContent() const;
     void AppendLine(const wxString& text);
 
+    /**
+     * @brief called (on the main thread) when the BuildOutputClassifier has lines ready for the view
+     */
+    void OnOutputClassified();
+
+    /**
+     * @brief called (on the main thread) when the BuildOutputClassifier processed everything that was queued before
+     * BuildOutputClassifier::Flush(stage). The build end is handled in stages: first the build output, then the summary
+     * @param discarded the view was cleared since the flush was requested: only wxEVT_BUILD_ENDED is left to send
+     */
+    void OnClassifierFlushed(int stage, bool discarded);
+
 protected:
     void OnThemeChanged(wxCommandEvent& event);
     void OnBuildStarted(clCommandEvent& e);
@@ -227,6 +243,7 @@ protected:
     void OnStyleNeeded(wxStyledTextEvent& event);
     void OnHotspotClicked(wxStyledTextEvent& event);
     void OnIdle(wxIdleEvent& event);
+    void OnOutputTimer(wxTimerEvent& event);
 };
 
 #endif // NEWBUILDTAB_H
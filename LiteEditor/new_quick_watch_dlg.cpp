@@ -84,7 +84,12 @@ void DisplayVariableDlg::OnItemExpanding(wxTreeEvent& event)
                     m_treeCtrl->SetItemText(child, _("Loading..."));
 
                     QWTreeData* data = (QWTreeData*)m_treeCtrl->GetItemData(item);
-                    if(data) {
+                    if(data && data->_voc.nextChildIndex != wxNOT_FOUND) {
+                        // A "more children" node: ask for the next page, it is added to our parent
+                        m_debugger->ListChildren(data->_voc.gdbId, DBG_USERR_QUICKWACTH, data->_voc.nextChildIndex);
+                        m_gdbId2Item[data->_voc.gdbId] = m_treeCtrl->GetItemParent(item);
+
+                    } else if(data) {
                         // Ask the debugger for information
                         m_debugger->ListChildren(data->_voc.gdbId, DBG_USERR_QUICKWACTH);
                         m_gdbId2Item[data->_voc.gdbId] = item;
@@ -126,6 +131,18 @@ void DisplayVariableDlg::AddItems(const wxString& varname, const VariableObjChil
     std::map<wxString, wxTreeItemId>::iterator iter = m_gdbId2Item.find(varname);
     if(iter != m_gdbId2Item.end()) {
         wxTreeItemId item = iter->second;
+
+        // The next page of children replaces the "more children" node of 'varname'
+        wxTreeItemIdValue kookie;
+        wxTreeItemId child = m_treeCtrl->GetFirstChild(item, kookie);
+        while(child.IsOk()) {
+            QWTreeData* data = (QWTreeData*)m_treeCtrl->GetItemData(child);
+            if(data && data->_voc.nextChildIndex != wxNOT_FOUND && data->_voc.gdbId == varname) {
+                m_treeCtrl->Delete(child);
+                break;
+            }
+            child = m_treeCtrl->GetNextChild(item, kookie);
+        }
         DoAddChildren(item, children);
     }
 }
@@ -148,6 +165,13 @@ void DisplayVariableDlg::DoAddChildren(wxTreeItemId& item, const VariableObjChil
     for(size_t i = 0; i < children.size(); i++) {
         VariableObjChild ch = children.at(i);
 
+        if(ch.nextChildIndex != wxNOT_FOUND) {
+            // Placeholder for the children that were not listed yet
+            wxTreeItemId more = m_treeCtrl->AppendItem(item, ch.varName, -1, -1, new QWTreeData(ch));
+            m_treeCtrl->AppendItem(more, wxT("<dummy>"));
+            continue;
+        }
+
         // Dont use ch.isAFake here since it will also returns true of inheritance
         if(ch.varName != wxT("public") && ch.varName != wxT("private") && ch.varName != wxT("protected")) {
             // Real node
@@ -25,6 +25,7 @@
 
 #include "VirtualDirectorySelectorDlg.h"
 #include "clFilesCollector.h"
+#include "cl_config.h"
 #include "event_notifier.h"
 #include "fileutils.h"
 #include "frame.h"
@@ -120,7 +121,7 @@ bool ReconcileProjectDlg::LoadData()
         wxStringSet_t excludeFoldersSet;
         std::for_each(excludeFolders.begin(), excludeFolders.end(),
                       [&](const wxString& folder) { excludeFoldersSet.insert(folder); });
-        if(scanner.Scan(toplevelDir, filesOutput, filespec, ignorefilespec, excludeFoldersSet)) {
+        if(scanner.Scan(toplevelDir, filesOutput, filespec, ignorefilespec, excludeFoldersSet, dlg.GetScanFlags())) {
             m_allfiles.insert(filesOutput.begin(), filesOutput.end());
             DoFindFiles();
         }
@@ -648,6 +649,17 @@ void ReconcileProjectFiletypesDlg::SetData()
     for(size_t n = 0; n < regexes.GetCount(); ++n) {
         SetRegex(regexes[n]);
     }
+
+    m_checkBoxSkipVcs->SetValue(clConfig::Get().Read("ReconcileProject/SkipVcsFolders", false));
+    m_checkBoxGitIgnore->SetValue(clConfig::Get().Read("ReconcileProject/HonourGitIgnore", false));
+}
+
+size_t ReconcileProjectFiletypesDlg::GetScanFlags() const
+{
+    size_t flags = clFilesScanner::kScanDefault;
+    if(m_checkBoxSkipVcs->IsChecked()) { flags |= clFilesScanner::kSkipVcsFolders; }
+    if(m_checkBoxGitIgnore->IsChecked()) { flags |= clFilesScanner::kHonourGitIgnore; }
+    return flags;
 }
 
 void ReconcileProjectFiletypesDlg::GetData(wxString& toplevelDir, wxString& types, wxString& ignoreFiles,
@@ -686,6 +698,8 @@ void ReconcileProjectFiletypesDlg::GetData(wxString& toplevelDir, wxString& type
 
     proj->SetReconciliationData(wxFileName(toplevelDir).GetFullPath(wxPATH_UNIX), types, ignoreFilesArr, excludePaths,
                                 regexes);
+    clConfig::Get().Write("ReconcileProject/SkipVcsFolders", m_checkBoxSkipVcs->IsChecked());
+    clConfig::Get().Write("ReconcileProject/HonourGitIgnore", m_checkBoxGitIgnore->IsChecked());
 }
 
 void ReconcileProjectFiletypesDlg::SetRegex(const wxString& regex)
@@ -104,6 +104,10 @@ public:
     void SetData();
     void GetData(wxString& toplevelDir, wxString& types, wxString& ignoreFiles, wxArrayString& excludePaths,
                  wxArrayString& regexes) const;
+    /**
+     * @brief the clFilesScanner flags selected by the user (skip VCS folders, honour .gitignore)
+     */
+    size_t GetScanFlags() const;
 
 protected:
     void SetRegex(const wxString& regex); // Takes a VD|regex string, splits and inserts into listctrl cols
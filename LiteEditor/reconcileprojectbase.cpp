@@ -385,6 +385,18 @@ ReconcileProjectFiletypesDlgBaseClass::ReconcileProjectFiletypesDlgBaseClass(wxW
     
     boxSizer1245->Add(m_button1257, 0, wxALL|wxEXPAND, WXC_FROM_DIP(5));
     
+    m_checkBoxSkipVcs = new wxCheckBox(this, wxID_ANY, _("Skip version control folders"), wxDefaultPosition, wxDLG_UNIT(this, wxSize(-1,-1)), 0);
+    m_checkBoxSkipVcs->SetValue(false);
+    m_checkBoxSkipVcs->SetToolTip(_("Do not look for files in the .git, .svn, .hg and .bzr folders"));
+    
+    boxSizer114->Add(m_checkBoxSkipVcs, 0, wxALL|wxEXPAND, WXC_FROM_DIP(5));
+    
+    m_checkBoxGitIgnore = new wxCheckBox(this, wxID_ANY, _("Skip files ignored by .gitignore"), wxDefaultPosition, wxDLG_UNIT(this, wxSize(-1,-1)), 0);
+    m_checkBoxGitIgnore->SetValue(false);
+    m_checkBoxGitIgnore->SetToolTip(_("Do not look for files that are ignored by the .gitignore files of the project folders"));
+    
+    boxSizer114->Add(m_checkBoxGitIgnore, 0, wxALL|wxEXPAND, WXC_FROM_DIP(5));
+    
     m_stdBtnSizer120 = new wxStdDialogButtonSizer();
     
     boxSizer114->Add(m_stdBtnSizer120, 0, wxALL|wxALIGN_CENTER_HORIZONTAL, WXC_FROM_DIP(5));
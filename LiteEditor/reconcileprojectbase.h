@@ -29,6 +29,7 @@
 #include <wx/textctrl.h>
 #include <wx/listbox.h>
 #include <wx/listctrl.h>
+#include <wx/checkbox.h>
 #if wxVERSION_NUMBER >= 2900
 #include <wx/persist.h>
 #include <wx/persist/toplevel.h>
@@ -132,6 +133,8 @@ protected:
     wxListCtrl* m_listCtrlRegexes;
     wxButton* m_button119216;
     wxButton* m_button1257;
+    wxCheckBox* m_checkBoxSkipVcs;
+    wxCheckBox* m_checkBoxGitIgnore;
     wxStdDialogButtonSizer* m_stdBtnSizer120;
     wxButton* m_button121;
     wxButton* m_button122;
@@ -164,6 +167,8 @@ public:
     wxListCtrl* GetListCtrlRegexes() { return m_listCtrlRegexes; }
     wxButton* GetButton119216() { return m_button119216; }
     wxButton* GetButton1257() { return m_button1257; }
+    wxCheckBox* GetCheckBoxSkipVcs() { return m_checkBoxSkipVcs; }
+    wxCheckBox* GetCheckBoxGitIgnore() { return m_checkBoxGitIgnore; }
     ReconcileProjectFiletypesDlgBaseClass(wxWindow* parent, wxWindowID id = wxID_ANY, const wxString& title = _("Select filetypes to reconcile"), const wxPoint& pos = wxDefaultPosition, const wxSize& size = wxSize(-1,-1), long style = wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER);
     virtual ~ReconcileProjectFiletypesDlgBaseClass();
 };
@@ -405,13 +405,19 @@ void WatchesTable::OnListChildren(const DebuggerEventData& event)
         if(event.m_varObjChildren.empty() == false) m_listTable->AppendItem(item, wxT("<dummy>"));
 
     } else if(event.m_userReason == m_LIST_CHILDS) {
+        // A next page replaces the "more children" item
+        DoDeleteMoreChildrenItem(item, gdbId);
         if(event.m_varObjChildren.empty() == false) {
             for(size_t i = 0; i < event.m_varObjChildren.size(); i++) {
                 IDebugger* dbgr = DebuggerMgr::Get().GetActiveDebugger();
                 if(!dbgr || !ManagerST::Get()->DbgCanInteract()) return;
 
                 VariableObjChild ch = event.m_varObjChildren.at(i);
-                if(ch.varName == wxT("public") || ch.varName == wxT("private") || ch.varName == wxT("protected")) {
+                if(ch.nextChildIndex != wxNOT_FOUND) {
+                    DoAppendMoreChildrenItem(item, ch);
+
+                } else if(ch.varName == wxT("public") || ch.varName == wxT("private") ||
+                          ch.varName == wxT("protected")) {
                     // not really a node...
                     // ask for information about this node children
                     dbgr->ListChildren(ch.gdbId, m_LIST_CHILDS);
@@ -441,6 +447,8 @@ void WatchesTable::OnListChildren(const DebuggerEventData& event)
 
 void WatchesTable::OnItemExpanding(wxTreeEvent& event)
 {
+    if(DoExpandMoreChildrenItem(event)) { return; }
+
     wxBusyCursor bc;
     wxTreeItemIdValue cookie;
     wxTreeItemId child = m_listTable->GetFirstChild(event.GetItem(), cookie);
@@ -183,6 +183,51 @@ void DebuggerTreeListCtrlBase::DoRefreshItem(IDebugger* dbgr, const wxTreeItemId
     }
 }
 
+void DebuggerTreeListCtrlBase::DoAppendMoreChildrenItem(const wxTreeItemId& parent, const VariableObjChild& more)
+{
+    DbgTreeItemData* data = new DbgTreeItemData();
+    data->_kind = DbgTreeItemData::MoreChildren;
+    data->_isFake = true;
+    data->_parentGdbId = more.gdbId;
+    data->_nextChildIndex = more.nextChildIndex;
+
+    wxTreeItemId item = m_listTable->AppendItem(parent, more.varName, -1, -1, data);
+    m_listTable->SetItemText(item, _("Expand to list more children"), 1);
+    // Add a dummy node so we will get the [+] sign
+    m_listTable->AppendItem(item, wxT("<dummy>"));
+}
+
+void DebuggerTreeListCtrlBase::DoDeleteMoreChildrenItem(const wxTreeItemId& parent, const wxString& gdbId)
+{
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = m_listTable->GetFirstChild(parent, cookie);
+    while(child.IsOk()) {
+        DbgTreeItemData* data = static_cast<DbgTreeItemData*>(m_listTable->GetItemData(child));
+        if(data && data->_kind == DbgTreeItemData::MoreChildren && data->_parentGdbId == gdbId) {
+            m_listTable->Delete(child);
+            return;
+        }
+        child = m_listTable->GetNextChild(parent, cookie);
+    }
+}
+
+bool DebuggerTreeListCtrlBase::DoExpandMoreChildrenItem(wxTreeEvent& event)
+{
+    DbgTreeItemData* data = static_cast<DbgTreeItemData*>(m_listTable->GetItemData(event.GetItem()));
+    if(!data || data->_kind != DbgTreeItemData::MoreChildren) return false;
+
+    // The item is replaced by the next page once it arrives, don't expand it
+    event.Veto();
+
+    IDebugger* dbgr = DoGetDebugger();
+    if(dbgr && data->_nextChildIndex != wxNOT_FOUND) {
+        dbgr->ListChildren(data->_parentGdbId, m_LIST_CHILDS, data->_nextChildIndex);
+        m_listChildItemId[data->_parentGdbId] = m_listTable->GetItemParent(event.GetItem());
+        data->_nextChildIndex = wxNOT_FOUND; // requested
+    }
+    return true;
+}
+
 wxString DebuggerTreeListCtrlBase::DoGetGdbId(const wxTreeItemId& item)
 {
     wxString gdbId;
@@ -53,6 +53,8 @@ public:
     size_t _kind;
     bool _isFake;
     wxString _retValueGdbValue;
+    wxString _parentGdbId; // MoreChildren: the variable object whose children are paged
+    int _nextChildIndex;   // MoreChildren: the index of the first child not listed yet
 
 public:
     enum {
@@ -60,19 +62,22 @@ public:
         FuncArgs = 0x00000002,
         VariableObject = 0x00000004,
         Watch = 0x00000010,
-        FuncRetValue = 0x00000020
+        FuncRetValue = 0x00000020,
+        MoreChildren = 0x00000040
     };
 
 public:
     DbgTreeItemData()
         : _kind(Locals)
         , _isFake(false)
+        , _nextChildIndex(wxNOT_FOUND)
     {
     }
 
     DbgTreeItemData(const wxString& gdbId)
         : _gdbId(gdbId)
         , _isFake(false)
+        , _nextChildIndex(wxNOT_FOUND)
     {
     }
 
@@ -133,6 +138,22 @@ public:
     virtual wxTreeItemId DoFindItemByExpression(const wxString& expr);
     virtual void ResetTableColors();
     virtual wxString GetItemPath(const wxTreeItemId& item);
+
+    //////////////////////////////////////////////
+    // Paged children
+    //////////////////////////////////////////////
+    /**
+     * @brief append an item standing for the children of 'more.gdbId' that were not listed yet
+     */
+    void DoAppendMoreChildrenItem(const wxTreeItemId& parent, const VariableObjChild& more);
+    /**
+     * @brief remove the "more children" item of 'gdbId' from 'parent' (the next page has arrived)
+     */
+    void DoDeleteMoreChildrenItem(const wxTreeItemId& parent, const wxString& gdbId);
+    /**
+     * @brief if the item being expanded is a "more children" item, ask for the next page and return true
+     */
+    bool DoExpandMoreChildrenItem(wxTreeEvent& event);
 };
 
 #endif //__simpletablebase__
@@ -3,6 +3,12 @@
 #include "processreaderthread.h"
 #include "LSP/clJSONRPC.h"
 #include "LSP/GotoDefinitionRequest.h"
+#include "LSP/CompletionRequest.h"
+#include "LSP/HoverRequest.h"
+#include "LSP/SignatureHelpRequest.h"
+#include "LSP/FindReferencesRequest.h"
+#include "LSP/DocumentSymbolsRequest.h"
+#include "LSP/CancelRequest.h"
 #include "LSP/DidOpenTextDocumentRequest.h"
 #include "LSP/DidCloseTextDocumentRequest.h"
 #include "LSP/DidSaveTextDocumentRequest.h"
@@ -16,6 +22,54 @@
 #include "imanager.h"
 #include <wx/stc/stc.h>
 
+// Changes to a document are sent once the user stopped typing for this amount of milliseconds
+#define LSP_CHANGES_DELAY 150
+
+// JSON-RPC error codes
+#define LSP_ERROR_METHOD_NOT_FOUND -32601
+#define LSP_ERROR_REQUEST_CANCELLED -32800
+
+/**
+ * @brief return the position at the end of 'text' when it is inserted at 'start'
+ */
+static LSP::Position GetEndPosition(const LSP::Position& start, const wxString& text)
+{
+    int lastNewLine = text.Find('\n', true);
+    if(lastNewLine == wxNOT_FOUND) {
+        return LSP::Position(start.GetLine(), start.GetCharacter() + LSP::UTF16Length(text));
+    }
+    return LSP::Position(start.GetLine() + text.Freq('\n'), LSP::UTF16Length(text.Mid(lastNewLine + 1)));
+}
+
+static bool IsSamePosition(const LSP::Position& p1, const LSP::Position& p2)
+{
+    return p1.GetLine() == p2.GetLine() && p1.GetCharacter() == p2.GetCharacter();
+}
+
+/**
+ * @brief try to merge 'change' into 'last' (the previous change of the same document)
+ * Typing (consecutive insertions) and backspacing (consecutive deletions ending where the previous one started)
+ * are merged into a single change
+ */
+static bool MergeChange(LSP::TextDocumentContentChangeEvent& last, const LSP::TextDocumentContentChangeEvent& change)
+{
+    const LSP::Range& lastRange = last.GetRange();
+    const LSP::Range& range = change.GetRange();
+    bool lastIsInsert = IsSamePosition(lastRange.GetStart(), lastRange.GetEnd());
+    bool isInsert = IsSamePosition(range.GetStart(), range.GetEnd());
+    if(lastIsInsert && isInsert && !last.GetText().IsEmpty() &&
+       IsSamePosition(range.GetStart(), GetEndPosition(lastRange.GetStart(), last.GetText()))) {
+        last.SetText(last.GetText() + change.GetText());
+        return true;
+    }
+    if(!lastIsInsert && !isInsert && last.GetText().IsEmpty() && change.GetText().IsEmpty() &&
+       IsSamePosition(range.GetEnd(), lastRange.GetStart())) {
+        last.SetRange(LSP::Range(range.GetStart(), lastRange.GetEnd()));
+        return true;
+    }
+    return false;
+}
+
 LanguageServerProtocol::LanguageServerProtocol()
 {
     Bind(wxEVT_ASYNC_PROCESS_TERMINATED, &LanguageServerProtocol::OnProcessTerminated, this);
@@ -25,6 +79,12 @@ LanguageServerProtocol::LanguageServerProtocol()
     EventNotifier::Get()->Bind(wxEVT_FILE_SAVED, &LanguageServerProtocol::OnFileSaved, this);
     EventNotifier::Get()->Bind(wxEVT_FILE_CLOSED, &LanguageServerProtocol::OnFileClosed, this);
     EventNotifier::Get()->Bind(wxEVT_FILE_LOADED, &LanguageServerProtocol::OnFileLoaded, this);
+    EventNotifier::Get()->Bind(wxEVT_EDITOR_TEXT_CHANGED, &LanguageServerProtocol::OnEditorTextChanged, this);
+
+    Bind(wxEVT_LSP_INITIALIZED, &LanguageServerProtocol::OnInitialized, this);
+    m_changesTimer = new wxTimer(this);
+    Bind(wxEVT_TIMER, &LanguageServerProtocol::OnChangesTimer, this, m_changesTimer->GetId());
+    DoRegisterHandlers();
 }
 
 LanguageServerProtocol::~LanguageServerProtocol()
@@ -37,13 +97,54 @@ LanguageServerProtocol::~LanguageServerProtocol()
     EventNotifier::Get()->Unbind(wxEVT_FILE_SAVED, &LanguageServerProtocol::OnFileSaved, this);
     EventNotifier::Get()->Unbind(wxEVT_FILE_CLOSED, &LanguageServerProtocol::OnFileClosed, this);
     EventNotifier::Get()->Unbind(wxEVT_FILE_LOADED, &LanguageServerProtocol::OnFileLoaded, this);
+    EventNotifier::Get()->Unbind(wxEVT_EDITOR_TEXT_CHANGED, &LanguageServerProtocol::OnEditorTextChanged, this);
+    Unbind(wxEVT_LSP_INITIALIZED, &LanguageServerProtocol::OnInitialized, this);
+    Unbind(wxEVT_TIMER, &LanguageServerProtocol::OnChangesTimer, this, m_changesTimer->GetId());
     DoClear();
+    wxDELETE(m_changesTimer);
 }
 
 void LanguageServerProtocol::DoStart()
 {
     m_process = ::CreateAsyncProcess(this, m_command, IProcessCreateDefault | IProcessStderrEvent, m_workingDirectory);
-    if(!m_process) { clWARNING() << "Failed to start Language Server:" << m_command; }
+    if(!m_process) {
+        clWARNING() << "Failed to start Language Server:" << m_command;
+        return;
+    }
+
+    // The "initialize" request must be the first message sent to the server, everything else is queued until we
+    // receive its response
+    LSP::InitializeRequest::Ptr_t req(new LSP::InitializeRequest(m_workingDirectory));
+    m_process->Write(req->ToString());
+    m_requestsSent.insert({ req->GetId(), { req, std::chrono::steady_clock::now() } });
+    m_stats[req->GetMethod()].sent++;
+    m_lastActivity = time(nullptr);
+
+    // (Re)open the documents that are already open in the editors
+    DoOpenEditors();
+}
+
+void LanguageServerProtocol::DoOpenEditors()
+{
+    IEditor::List_t editors;
+    clGetManager()->GetAllEditors(editors);
+    for(IEditor* editor : editors) {
+        if(!CanHandle(editor->GetFileName()) || m_filesSent.count(editor->GetFileName().GetFullPath())) { continue; }
+        FileOpened(editor->GetFileName(), editor->GetCtrl()->GetText(), GetLanguageId(editor->GetFileName()));
+    }
+}
+
+void LanguageServerProtocol::OnInitialized(clCommandEvent& event)
+{
+    m_syncKind = event.GetInt();
+    m_initialized = true;
+    LSP::InitializedNotification().Send(this);
+
+    wxArrayString queue;
+    queue.swap(m_outgoingQueue);
+    for(const wxString& message : queue) {
+        Send(message);
+    }
 }
 
 void LanguageServerProtocol::Start(const wxString& command, const wxString& workingDirectory,
@@ -52,6 +153,12 @@ void LanguageServerProtocol::Start(const wxString& command, const wxString& work
     if(m_process) { return; }
     m_languages.clear();
     std::for_each(languages.begin(), languages.end(), [&](const wxString& lang) { m_languages.insert(lang); });
+    if(m_goingDown) {
+        // Stop(true) unbound the process events, the server is started again
+        Bind(wxEVT_ASYNC_PROCESS_TERMINATED, &LanguageServerProtocol::OnProcessTerminated, this);
+        Bind(wxEVT_ASYNC_PROCESS_OUTPUT, &LanguageServerProtocol::OnProcessOutput, this);
+        Bind(wxEVT_ASYNC_PROCESS_STDERR, &LanguageServerProtocol::OnProcessStderr, this);
+    }
     m_goingDown = false;
     m_command = command;
     m_workingDirectory = workingDirectory;
@@ -70,25 +177,152 @@ void LanguageServerProtocol::OnProcessStderr(clProcessEvent& event) { clDEBUG1()
 
 void LanguageServerProtocol::OnProcessOutput(clProcessEvent& event)
 {
-    clDEBUG() << event.GetOutput();
-    const wxString& buffer = event.GetOutput();
-    m_outputBuffer << buffer;
+    // The framer needs the bytes as the server sent them: decoding a chunk that ends in the middle of a UTF-8
+    // sequence (and encoding it back) changes its length
+    const std::string& bytes = event.GetOutputBytes();
+    clDEBUG1() << event.GetOutput();
+    m_framer.Append(bytes.data(), bytes.length());
+    while(true) {
+        wxSharedPtr<JSON> json = m_framer.Next();
+        if(!json) { break; }
+        LSP::ResponseMessage message(json);
+        if(message.IsOk()) { DoDispatch(message); }
+    }
+}
+
+void LanguageServerProtocol::DoDispatch(const LSP::ResponseMessage& message)
+{
+    if(!message.Has("method")) {
+        // a response: let the originating request to handle it
+        auto iter = m_requestsSent.find(message.GetId());
+        if(iter == m_requestsSent.end()) {
+            // a cancelled request
+            return;
+        }
+        LSP::RequestMessage::Ptr_t req = iter->second.request;
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - iter->second.sent;
+        m_requestsSent.erase(iter);
 
-    LSP::ResponseMessage res(m_outputBuffer);
-    if(res.IsOk() && m_requestsSent.count(res.GetId())) {
-        // let the originating request to handle it
-        m_requestsSent[res.GetId()]->OnReponse(res, this);
-        m_requestsSent.erase(res.GetId());
+        auto latest = m_latestRequest.find(req->GetMethod());
+        if(latest != m_latestRequest.end() && latest->second == req->GetId()) { m_latestRequest.erase(latest); }
+
+        RequestStats& stats = m_stats[req->GetMethod()];
+        if(message.Has("error")) {
+            JSONItem error = message.Get("error");
+            if(error.namedObject("code").toInt() == LSP_ERROR_REQUEST_CANCELLED) {
+                stats.cancelled++;
+            } else {
+                stats.failed++;
+                clDEBUG() << "Language server request" << req->GetMethod()
+                          << "failed:" << error.namedObject("message").toString();
+                req->OnError(message, this);
+            }
+            return;
+        }
+
+        stats.completed++;
+        stats.totalMs += elapsed.count();
+        stats.maxMs = wxMax(stats.maxMs, elapsed.count());
+        clDEBUG1() << req->GetMethod() << "completed in" << (int)elapsed.count() << "ms";
+        req->OnReponse(message, this);
+        return;
+    }
+
+    wxString method = message.GetMethod();
+    bool isRequest = message.Has("id");
+    auto iter = m_handlers.find(method);
+    if(iter != m_handlers.end()) {
+        iter->second(message);
+    } else if(isRequest) {
+        // the server is waiting for a reply
+        DoReplyError(message, LSP_ERROR_METHOD_NOT_FOUND, "Method not supported: " + method);
+    } else {
+        clDEBUG1() << "Language server notification ignored:" << method;
     }
 }
 
+void LanguageServerProtocol::DoRegisterHandlers()
+{
+    m_handlers["window/logMessage"] = [](const LSP::ResponseMessage& message) {
+        clDEBUG() << "Language server:" << message.Get("params").namedObject("message").toString();
+    };
+    m_handlers["window/showMessage"] = [](const LSP::ResponseMessage& message) {
+        // MessageType.Error == 1
+        JSONItem params = message.Get("params");
+        if(params.namedObject("type").toInt() == 1) {
+            clWARNING() << "Language server:" << params.namedObject("message").toString();
+        } else {
+            clDEBUG() << "Language server:" << params.namedObject("message").toString();
+        }
+    };
+    m_handlers["textDocument/publishDiagnostics"] = [](const LSP::ResponseMessage& message) {
+        JSONItem params = message.Get("params");
+        clDEBUG1() << "Language server:" << params.namedObject("diagnostics").arraySize() << "diagnostics for"
+                   << params.namedObject("uri").toString();
+    };
+
+    // Requests sent by the server. We don't support dynamic registration, configuration or progress reports, but
+    // the server expects a reply anyways
+    MessageHandler_t acknowledge = [this](const LSP::ResponseMessage& message) { DoReply(message, "null"); };
+    m_handlers["client/registerCapability"] = acknowledge;
+    m_handlers["client/unregisterCapability"] = acknowledge;
+    m_handlers["window/workDoneProgress/create"] = acknowledge;
+    m_handlers["workspace/configuration"] = [this](const LSP::ResponseMessage& message) {
+        // one (null) configuration per requested item
+        int count = message.Get("params").namedObject("items").arraySize();
+        wxString result = "[";
+        for(int i = 0; i < count; ++i) {
+            result << (i ? ",null" : "null");
+        }
+        result << "]";
+        DoReply(message, result);
+    };
+}
+
+void LanguageServerProtocol::DoReply(const LSP::ResponseMessage& request, const wxString& result)
+{
+    wxString json;
+    json << "{\"jsonrpc\":\"2.0\",\"id\":" << request.Get("id").format(false) << ",\"result\":" << result << "}";
+    DoSendRaw(json);
+}
+
+void LanguageServerProtocol::DoReplyError(const LSP::ResponseMessage& request, int code, const wxString& message)
+{
+    JSON root(cJSON_Object);
+    JSONItem error = root.toElement();
+    error.addProperty("code", code);
+    error.addProperty("message", message);
+    wxString json;
+    json << "{\"jsonrpc\":\"2.0\",\"id\":" << request.Get("id").format(false) << ",\"error\":" << error.format(false)
+         << "}";
+    DoSendRaw(json);
+}
+
+void LanguageServerProtocol::DoSendRaw(const wxString& json)
+{
+    wxString buffer;
+    buffer << "Content-Length: " << json.utf8_str().length() << "\r\n\r\n" << json;
+    Send(buffer);
+}
+
 void LanguageServerProtocol::Send(const wxString& message)
 {
-    if(m_process) { m_process->Write(message); }
+    if(!m_process) { return; }
+    if(!m_initialized) {
+        m_outgoingQueue.Add(message);
+    } else {
+        m_process->Write(message);
+    }
 }
 
 void LanguageServerProtocol::Stop(bool goingDown)
 {
+    for(const auto& vt : m_stats) {
+        const RequestStats& stats = vt.second;
+        clDEBUG() << "Language server" << vt.first << "requests: sent" << stats.sent << "completed" << stats.completed
+                  << "cancelled" << stats.cancelled << "failed" << stats.failed << "average"
+                  << (int)stats.GetAverageMs() << "ms max" << (int)stats.maxMs << "ms";
+    }
     m_goingDown = goingDown;
     if(m_goingDown) {
         // Unbound the events so we dont get the 'terminated' process event
@@ -102,6 +336,7 @@ void LanguageServerProtocol::Stop(bool goingDown)
             wxString dummy;
             m_process->WaitForTerminate(dummy);
             wxDELETE(m_process);
+            DoClear();
         }
     }
 }
@@ -138,11 +373,75 @@ wxString LanguageServerProtocol::GetLanguageId(const wxString& fn)
 // Protocol implementation
 //===--------------------------------------------------
 
-void LanguageServerProtocol::FindDefinition(const wxFileName& filename, size_t line, size_t column)
+void LanguageServerProtocol::DoSendRequest(LSP::RequestMessage::Ptr_t req, const wxString& filename)
 {
-    LSP::GotoDefinitionRequest::Ptr_t req(new LSP::GotoDefinitionRequest(filename, line, column));
+    if(!IsRunning()) { return; }
+    DoFlushChanges(filename);
+
+    if(IsSupersedable(req->GetMethod())) {
+        auto iter = m_latestRequest.find(req->GetMethod());
+        if(iter != m_latestRequest.end()) { DoCancelRequest(iter->second); }
+        m_latestRequest[req->GetMethod()] = req->GetId();
+    }
+
     req->Send(this);
-    m_requestsSent.insert({ req->GetId(), req });
+    m_requestsSent.insert({ req->GetId(), { req, std::chrono::steady_clock::now() } });
+    m_stats[req->GetMethod()].sent++;
+    m_lastActivity = time(nullptr);
+}
+
+void LanguageServerProtocol::DoCancelRequest(int id)
+{
+    auto iter = m_requestsSent.find(id);
+    if(iter == m_requestsSent.end()) { return; }
+    m_stats[iter->second.request->GetMethod()].cancelled++;
+    m_requestsSent.erase(iter);
+
+    // The server still replies (with a result or an error), we ignore it
+    LSP::CancelRequest(id).Send(this);
+}
+
+bool LanguageServerProtocol::IsSupersedable(const wxString& method)
+{
+    // Requests sent while the user types: only the one for the current caret position is of interest
+    return method == "textDocument/completion" || method == "textDocument/signatureHelp" ||
+           method == "textDocument/hover";
+}
+
+void LanguageServerProtocol::FindDefinition(const wxFileName& filename, size_t line, size_t column)
+{
+    LSP::RequestMessage::Ptr_t req(new LSP::GotoDefinitionRequest(filename, line, column));
+    DoSendRequest(req, filename.GetFullPath());
+}
+
+void LanguageServerProtocol::CodeComplete(const wxFileName& filename, size_t line, size_t column)
+{
+    LSP::RequestMessage::Ptr_t req(new LSP::CompletionRequest(filename, line, column));
+    DoSendRequest(req, filename.GetFullPath());
+}
+
+void LanguageServerProtocol::Hover(const wxFileName& filename, size_t line, size_t column)
+{
+    LSP::RequestMessage::Ptr_t req(new LSP::HoverRequest(filename, line, column));
+    DoSendRequest(req, filename.GetFullPath());
+}
+
+void LanguageServerProtocol::SignatureHelp(const wxFileName& filename, size_t line, size_t column)
+{
+    LSP::RequestMessage::Ptr_t req(new LSP::SignatureHelpRequest(filename, line, column));
+    DoSendRequest(req, filename.GetFullPath());
+}
+
+void LanguageServerProtocol::FindReferences(const wxFileName& filename, size_t line, size_t column)
+{
+    LSP::RequestMessage::Ptr_t req(new LSP::FindReferencesRequest(filename, line, column));
+    DoSendRequest(req, filename.GetFullPath());
+}
+
+void LanguageServerProtocol::DocumentSymbols(const wxFileName& filename)
+{
+    LSP::RequestMessage::Ptr_t req(new LSP::DocumentSymbolsRequest(filename));
+    DoSendRequest(req, filename.GetFullPath());
 }
 
 void LanguageServerProtocol::FileOpened(const wxFileName& filename, const wxString& fileContent,
@@ -156,7 +455,9 @@ void LanguageServerProtocol::FileOpened(const wxFileName& filename, const wxStri
 
         LSP::DidOpenTextDocumentRequest req(filename, fileContent, languageId);
         req.Send(this);
+        m_lastActivity = time(nullptr);
         m_filesSent.insert(filename.GetFullPath());
+        m_documentVersions[filename.GetFullPath()] = 1;
     }
 }
 
@@ -167,15 +468,18 @@ void LanguageServerProtocol::FileClosed(const wxFileName& filename)
         return;
     }
 
+    DoFlushChanges(filename.GetFullPath());
     LSP::DidCloseTextDocumentRequest req(filename);
     req.Send(this);
     m_filesSent.erase(filename.GetFullPath());
+    m_documentVersions.erase(filename.GetFullPath());
 }
 
 void LanguageServerProtocol::OnFileLoaded(clCommandEvent& event)
 {
     event.Skip();
-    IEditor* editor = clGetManager()->GetActiveEditor();
+    if(!IsRunning() || !CanHandle(event.GetFileName())) { return; }
+    IEditor* editor = clGetManager()->FindEditor(event.GetFileName());
     if(editor) {
         FileOpened(editor->GetFileName(), editor->GetCtrl()->GetText(), GetLanguageId(editor->GetFileName()));
     }
@@ -191,25 +495,87 @@ void LanguageServerProtocol::DoClear()
 {
     m_filesSent.clear();
     m_requestsSent.clear();
+    m_latestRequest.clear();
+    m_framer.Clear();
+    m_initialized = false;
+    m_outgoingQueue.clear();
+    m_syncKind = LSP::kSyncFull;
+    m_documentVersions.clear();
+    m_pendingChanges.clear();
+    if(m_changesTimer) { m_changesTimer->Stop(); }
 }
 
 void LanguageServerProtocol::OnFileSaved(clCommandEvent& event)
 {
     event.Skip();
     const wxString& filename = event.GetFileName();
-    IEditor* editor = clGetManager()->FindEditor(filename);
-    if(editor) {
-        // We should have called here FileSaved(), however, clangd-7 does not support this yet...
-        FileChanged(editor->GetFileName(), editor->GetCtrl()->GetText());
-    }
+    // We should have called here FileSaved(), however, clangd-7 does not support this yet...
+    // The server already has the document content as long as we send the changes
+    DoFlushChanges(filename);
 }
 
 void LanguageServerProtocol::FileChanged(const wxFileName& filename, const wxString& fileContent)
 {
-    LSP::DidChangeTextDocumentRequest req(filename, fileContent);
+    // The full content replaces any pending change
+    m_pendingChanges.erase(filename.GetFullPath());
+    LSP::DidChangeTextDocumentRequest req(filename, ++m_documentVersions[filename.GetFullPath()],
+                                          { LSP::TextDocumentContentChangeEvent(fileContent) });
     req.Send(this);
 }
 
+void LanguageServerProtocol::OnEditorTextChanged(clEditorTextChangedEvent& event)
+{
+    event.Skip();
+    const wxString& filename = event.GetFileName();
+    if(m_filesSent.count(filename) == 0 || m_syncKind == LSP::kSyncNone) { return; }
+
+    LSP::Range range(LSP::Position(event.GetStartLine(), event.GetStartColumn()),
+                     LSP::Position(event.GetEndLine(), event.GetEndColumn()));
+    LSP::TextDocumentContentChangeEvent change(range, event.GetText());
+    std::vector<LSP::TextDocumentContentChangeEvent>& changes = m_pendingChanges[filename];
+    if(changes.empty() || !MergeChange(changes.back(), change)) { changes.push_back(change); }
+    m_lastActivity = time(nullptr);
+
+    // Restart the timer: the changes are sent once the user stops typing
+    m_changesTimer->Start(LSP_CHANGES_DELAY, true);
+}
+
+void LanguageServerProtocol::OnChangesTimer(wxTimerEvent& event) { DoFlushAllChanges(); }
+
+void LanguageServerProtocol::DoFlushAllChanges()
+{
+    std::vector<wxString> files;
+    for(const auto& vt : m_pendingChanges) {
+        files.push_back(vt.first);
+    }
+    for(const wxString& filename : files) {
+        DoFlushChanges(filename);
+    }
+}
+
+void LanguageServerProtocol::DoFlushChanges(const wxString& filename)
+{
+    auto iter = m_pendingChanges.find(filename);
+    if(iter == m_pendingChanges.end()) { return; }
+    std::vector<LSP::TextDocumentContentChangeEvent> changes;
+    changes.swap(iter->second);
+    m_pendingChanges.erase(iter);
+    if(changes.empty() || m_filesSent.count(filename) == 0) { return; }
+
+    switch(m_syncKind) {
+    case LSP::kSyncIncremental: {
+        LSP::DidChangeTextDocumentRequest req(filename, ++m_documentVersions[filename], changes);
+        req.Send(this);
+    } break;
+    case LSP::kSyncFull: {
+        IEditor* editor = clGetManager()->FindEditor(filename);
+        if(editor) { FileChanged(editor->GetFileName(), editor->GetCtrl()->GetText()); }
+    } break;
+    default:
+        break;
+    }
+}
+
 void LanguageServerProtocol::FileSaved(const wxFileName& filename, const wxString& fileContent)
 {
     LSP::DidSaveTextDocumentRequest req(filename, fileContent);
@@ -218,6 +584,8 @@ void LanguageServerProtocol::FileSaved(const wxFileName& filename, const wxStrin
 
 bool LanguageServerProtocol::IsRunning() const { return m_process != nullptr; }
 
+int LanguageServerProtocol::GetProcessId() const { return m_process ? m_process->GetPid() : wxNOT_FOUND; }
+
 bool LanguageServerProtocol::CanHandle(const wxFileName& filename) const
 {
     wxString lang = GetLanguageId(filename);
@@ -10,17 +10,67 @@
 #include "macros.h"
 #include <map>
 #include "LSP/RequestMessage.h"
+#include "LSP/InitializeRequest.h"
+#include "LSP/MessageFramer.h"
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <wx/timer.h>
 
 class WXDLLIMPEXP_SDK LanguageServerProtocol : public LSP::Sender
 {
+public:
+    /**
+     * @brief per method request counters
+     */
+    struct RequestStats {
+        size_t sent = 0;
+        size_t completed = 0;
+        size_t cancelled = 0; // superseded by a newer request or cancelled by the server
+        size_t failed = 0;
+        double totalMs = 0.0; // the total latency of the completed requests
+        double maxMs = 0.0;
+        double GetAverageMs() const { return completed ? (totalMs / completed) : 0.0; }
+    };
+
+protected:
+    struct PendingRequest {
+        LSP::RequestMessage::Ptr_t request;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    /**
+     * @brief handles a notification (or a request) sent by the server
+     */
+    typedef std::function<void(const LSP::ResponseMessage&)> MessageHandler_t;
+
     IProcess* m_process = NULL;
     wxString m_command;
     wxString m_workingDirectory;
     bool m_goingDown = false;
     wxStringSet_t m_filesSent;
     wxStringSet_t m_languages;
-    std::unordered_map<int, LSP::RequestMessage::Ptr_t> m_requestsSent;
-    wxString m_outputBuffer;
+    // the requests waiting for a response, by ID
+    std::unordered_map<int, PendingRequest> m_requestsSent;
+    // for methods where only the latest request matters (e.g. completion): the ID of the outstanding request
+    std::unordered_map<wxString, int> m_latestRequest;
+    std::unordered_map<wxString, RequestStats> m_stats;
+    LSP::MessageFramer m_framer;
+    // server notifications and requests handlers, by method
+    std::unordered_map<wxString, MessageHandler_t> m_handlers;
+
+    // Set once the server replied to the "initialize" request. Messages sent before that are kept in m_outgoingQueue
+    bool m_initialized = false;
+    wxArrayString m_outgoingQueue;
+    int m_syncKind = LSP::kSyncFull;
+
+    // The version of every document opened on the server side and the changes not sent yet
+    std::unordered_map<wxString, int> m_documentVersions;
+    std::unordered_map<wxString, std::vector<LSP::TextDocumentContentChangeEvent> > m_pendingChanges;
+    wxTimer* m_changesTimer = nullptr;
+
+    // the last time we sent something to the server (other than a response)
+    time_t m_lastActivity = 0;
 
 public:
     typedef wxSharedPtr<LanguageServerProtocol> Ptr_t;
@@ -32,10 +82,42 @@ protected:
     void OnFileLoaded(clCommandEvent& event);
     void OnFileClosed(clCommandEvent& event);
     void OnFileSaved(clCommandEvent& event);
+    void OnEditorTextChanged(clEditorTextChangedEvent& event);
+    void OnChangesTimer(wxTimerEvent& event);
+    void OnInitialized(clCommandEvent& event);
 
 protected:
     void DoClear();
 
+    /**
+     * @brief route a message received from the server: responses go to the originating request, notifications and
+     * requests to the handler registered for their method
+     */
+    void DoDispatch(const LSP::ResponseMessage& message);
+    void DoRegisterHandlers();
+
+    /**
+     * @brief reply to a request sent by the server. 'result' is a JSON value
+     */
+    void DoReply(const LSP::ResponseMessage& request, const wxString& result);
+    void DoReplyError(const LSP::ResponseMessage& request, int code, const wxString& message);
+    void DoSendRaw(const wxString& json);
+
+    /**
+     * @brief send a request and track it until its response arrives. Pending changes of 'filename' are sent first,
+     * so the server sees the document as the user does. If the request supersedes an outstanding one (a newer
+     * completion, hover or signature help request), the old one is cancelled
+     */
+    void DoSendRequest(LSP::RequestMessage::Ptr_t req, const wxString& filename);
+    void DoCancelRequest(int id);
+    static bool IsSupersedable(const wxString& method);
+
+    /**
+     * @brief send the pending changes of a file (textDocument/didChange)
+     */
+    void DoFlushChanges(const wxString& filename);
+    void DoFlushAllChanges();
+
     static wxString GetLanguageId(const wxFileName& fn) { return GetLanguageId(fn.GetFullName()); }
     static wxString GetLanguageId(const wxString& fn);
 
@@ -62,6 +144,11 @@ protected:
 
     void DoStart();
 
+    /**
+     * @brief send didOpen for the files that are opened in the editors and handled by this server
+     */
+    void DoOpenEditors();
+
 public:
     LanguageServerProtocol();
     virtual ~LanguageServerProtocol();
@@ -87,8 +174,20 @@ public:
      */
     bool IsRunning() const;
 
+    /**
+     * @brief the server process ID (wxNOT_FOUND when not running)
+     */
+    int GetProcessId() const;
+
+    /**
+     * @brief the last time a request, a document or a change was sent to the server
+     */
+    time_t GetLastActivity() const { return m_lastActivity; }
+
     /**
      * @brief stop the language server
+     * @param goingDown when false, the server is restarted once it terminates. When true, it stays down until the
+     * next call to Start()
      */
     void Stop(bool goingDown);
 
@@ -104,6 +203,36 @@ public:
      * @param column the current caret column (0 based)
      */
     void FindDefinition(const wxFileName& filename, size_t line, size_t column);
+
+    /**
+     * @brief request code completion at a given position. The response is sent as wxEVT_LSP_COMPLETION_READY
+     */
+    void CodeComplete(const wxFileName& filename, size_t line, size_t column);
+
+    /**
+     * @brief request the hover information at a given position. The response is sent as wxEVT_LSP_HOVER
+     */
+    void Hover(const wxFileName& filename, size_t line, size_t column);
+
+    /**
+     * @brief request the signature help at a given position. The response is sent as wxEVT_LSP_SIGNATURE_HELP
+     */
+    void SignatureHelp(const wxFileName& filename, size_t line, size_t column);
+
+    /**
+     * @brief find all references to the symbol at a given position. The response is sent as wxEVT_LSP_REFERENCES
+     */
+    void FindReferences(const wxFileName& filename, size_t line, size_t column);
+
+    /**
+     * @brief request the symbols of a document. The response is sent as wxEVT_LSP_DOCUMENT_SYMBOLS
+     */
+    void DocumentSymbols(const wxFileName& filename);
+
+    /**
+     * @brief the request counters (sent, completed, cancelled, latency), by method
+     */
+    const std::unordered_map<wxString, RequestStats>& GetRequestStats() const { return m_stats; }
 };
 
 #endif // CLLANGUAGESERVER_H
@@ -43,8 +43,12 @@
 #include "macros.h"
 #include "wx/sstream.h"
 #include "wx/tokenzr.h"
+#include "wxmd5.h"
 #include <algorithm>
+#include <wx/ffile.h>
+#include <wx/file.h>
 #include <wx/stopwatch.h>
+#include <wx/xml/xml.h>
 
 static bool OS_WINDOWS = wxGetOsVersion() & wxOS_WINDOWS ? true : false;
 
@@ -72,6 +76,52 @@ static wxString GetMakeDirCmd(BuildConfigPtr bldConf, const wxString& relPath =
     return text;
 }
 
+static const wxString MAKEFILE_FINGERPRINT_PREFIX = "## Fingerprint: ";
+
+// Write 'content' only if the file does not already hold it, so make does not see a newer file for nothing.
+// The content goes to a temporary file which is renamed over the target, make never reads a half written file
+static bool WriteFileIfChanged(const wxString& filename, const wxString& content)
+{
+    wxString current;
+    if(wxFileName::FileExists(filename) && ReadFileWithConversion(filename, current) && current == content) {
+        clDEBUG1() << "Makefile" << filename << "is unchanged";
+        return true;
+    }
+
+    wxTempFile file(filename);
+    if(!file.IsOpened() || !file.Write(content) || !file.Commit()) {
+        clWARNING() << "Failed to write makefile:" << filename;
+        return false;
+    }
+    return true;
+}
+
+// Return the fingerprint line of a makefile that we generated
+static wxString ReadMakefileFingerprint(const wxString& filename)
+{
+    // The fingerprint is written at the top of the makefile
+    wxFFile fp(filename, "rb");
+    if(!fp.IsOpened()) { return wxEmptyString; }
+
+    char buffer[1024];
+    size_t bytes = fp.Read(buffer, sizeof(buffer));
+    wxString header = wxString::From8BitData(buffer, bytes);
+    int where = header.Find(MAKEFILE_FINGERPRINT_PREFIX);
+    if(where == wxNOT_FOUND) { return wxEmptyString; }
+    return header.Mid(where + MAKEFILE_FINGERPRINT_PREFIX.length()).BeforeFirst('\n').Trim();
+}
+
+// Serialize (and free) an XML node
+static wxString XmlToString(wxXmlNode* node)
+{
+    wxXmlDocument doc;
+    doc.SetRoot(node);
+    wxString xml;
+    wxStringOutputStream sos(&xml);
+    doc.Save(sos);
+    return xml;
+}
+
 BuilderGnuMake::BuilderGnuMake()
     : Builder("Default")
     , m_objectChunks(1)
@@ -186,7 +236,7 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
     wxFileName wspfile(clCxxWorkspaceST::Get()->GetWorkspaceFileName());
 
     text << wxT(".PHONY: clean All\n\n");
-    text << wxT("All:\n");
+    BuildTargetVec_t buildTargets;
 
     // iterate over the dependencies projects and generate makefile
     wxString buildTool = GetBuildToolCommand(project, confToBuild, arguments, false);
@@ -219,8 +269,13 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
                 continue;
             }
 
-            text << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << dependProj->GetName() << wxT(" - ")
-                 << projectSelConf << wxT(" ]----------\"\n");
+            BuildTarget buildTarget;
+            buildTarget.project = dependProj->GetName();
+            buildTarget.configuration = projectSelConf;
+            wxString& recipe = buildTarget.recipe;
+
+            recipe << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << dependProj->GetName()
+                   << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n");
             // make the paths relative, if it's sensible to do so
             wxFileName fn(dependProj->GetFileName());
             MakeRelativeIfSensible(fn, wspfile.GetPath());
@@ -238,11 +293,11 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
                 e.SetConfigurationName(projectSelConf);
                 e.SetProjectOnly(false);
                 EventNotifier::Get()->ProcessEvent(e);
-                text << wxT("\t") << e.GetCommand() << wxT("\n");
+                recipe << wxT("\t") << e.GetCommand() << wxT("\n");
 
             } else if(isCustom) {
 
-                CreateCustomPreBuildEvents(dependProjbldConf, text);
+                CreateCustomPreBuildEvents(dependProjbldConf, recipe);
 
                 wxString customWd = dependProjbldConf->GetCustomBuildWorkingDir();
                 wxString build_cmd = dependProjbldConf->GetCustomBuildCmd();
@@ -266,8 +321,8 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
                     customWdCmd << GetCdCmd(wspfile, fn);
                 }
 
-                text << wxT("\t") << customWdCmd << build_cmd << wxT("\n");
-                CreateCustomPostBuildEvents(dependProjbldConf, text);
+                recipe << wxT("\t") << customWdCmd << build_cmd << wxT("\n");
+                CreateCustomPostBuildEvents(dependProjbldConf, recipe);
 
             } else {
                 // generate the dependency project makefile
@@ -276,8 +331,9 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
                 depsProjs.Add(dep_file);
 
                 GenerateMakefile(dependProj, projectSelConf, confToBuild.IsEmpty() ? force : true, wxArrayString());
-                text << GetProjectMakeCommand(wspfile, fn, dependProj, projectSelConf);
+                recipe << GetProjectMakeCommand(wspfile, fn, dependProj, projectSelConf);
             }
+            buildTargets.push_back(buildTarget);
         }
     }
 
@@ -295,8 +351,11 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
         projectSelConf = confToBuild;
     }
 
-    text << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << project << wxT(" - ") << projectSelConf
-         << wxT(" ]----------\"\n");
+    BuildTarget mainTarget;
+    mainTarget.project = project;
+    mainTarget.configuration = projectSelConf;
+    mainTarget.recipe << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << project << wxT(" - ")
+                      << projectSelConf << wxT(" ]----------\"\n");
 
     // make the paths relative, if it's sensible to do so
     wxFileName projectPath(proj->GetFileName());
@@ -315,12 +374,15 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
         EventNotifier::Get()->ProcessEvent(e);
 
         cmd = e.GetCommand();
-        text << wxT("\t") << cmd << wxT("\n");
+        mainTarget.recipe << wxT("\t") << cmd << wxT("\n");
 
     } else {
-        text << GetProjectMakeCommand(wspfile, projectPath, proj, projectSelConf);
+        mainTarget.recipe << GetProjectMakeCommand(wspfile, projectPath, proj, projectSelConf);
     }
 
+    buildTargets.push_back(mainTarget);
+    CreateWorkspaceBuildTargets(buildTargets, text);
+
     // create the clean target
     text << wxT("clean:\n");
     if(!isProjectOnly) {
@@ -422,14 +484,19 @@ bool BuilderGnuMake::Export(const wxString& project, const wxString& confToBuild
     }
 
     // dump the content to file
-    wxFileOutputStream output(fn);
-    wxStringInputStream content(text);
-    output << content;
+    WriteFileIfChanged(fn, text);
 
     CL_DEBUG("Generating Makefile...is completed");
     return true;
 }
 
+void BuilderGnuMake::CreateWorkspaceBuildTargets(const BuildTargetVec_t& targets, wxString& text)
+{
+    // build the projects one after the other, dependencies first
+    text << wxT("All:\n");
+    std::for_each(targets.begin(), targets.end(), [&](const BuildTarget& target) { text << target.recipe; });
+}
+
 void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBuild, bool force,
                                       const wxArrayString& depsProj)
 {
@@ -468,11 +535,19 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBui
     wxString fn(path);
     fn << PATH_SEP << proj->GetName() << wxT(".mk");
 
-    // skip the next test if the makefile does not exist
-    if(wxFileName::FileExists(fn)) {
-        if(!force) {
-            if(proj->IsModified() == false) { return; }
-        }
+    // Let the plugins add their compile flags. Asked once: they are part of the fingerprint and of the makefile
+    clBuildEvent e(wxEVT_GET_ADDITIONAL_COMPILEFLAGS);
+    e.SetProjectName(proj->GetName());
+    e.SetConfigurationName(bldConf->GetName());
+    EventNotifier::Get()->ProcessEvent(e);
+    wxString additionalCompileFlags = e.GetCommand();
+
+    // Nothing to do if the makefile was generated from the same settings. A forced generation skips the comparison
+    // but still writes the fingerprint, so the next build can skip it
+    wxString fingerprint = GetMakefileFingerprint(proj, bldConf, depsProj, additionalCompileFlags);
+    if(!force && wxFileName::FileExists(fn) && ReadMakefileFingerprint(fn) == fingerprint) {
+        proj->SetModified(false);
+        return;
     }
 
     // Load the current project files
@@ -485,10 +560,11 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBui
     text << wxT("##") << wxT("\n");
     text << wxT("## Auto Generated makefile by CodeLite IDE") << wxT("\n");
     text << wxT("## any manual changes will be erased      ") << wxT("\n");
+    text << MAKEFILE_FINGERPRINT_PREFIX << fingerprint << wxT("\n");
     text << wxT("##") << wxT("\n");
 
     // Create the makefile variables
-    CreateConfigsVariables(proj, bldConf, text);
+    CreateConfigsVariables(proj, bldConf, additionalCompileFlags, text);
 
     //----------------------------------------------------------
     // copy environment variables to the makefile
@@ -540,17 +616,44 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString& confToBui
     CreateCleanTargets(proj, confToBuild, text);
 
     // dump the content to a file
-    wxFFile output;
-    output.Open(fn, wxT("w+"));
-    if(output.IsOpened()) {
-        output.Write(text);
-        output.Close();
-    }
+    WriteFileIfChanged(fn, text);
 
     // mark the project as non-modified one
     proj->SetModified(false);
 }
 
+wxString BuilderGnuMake::GetMakefileFingerprint(ProjectPtr proj, BuildConfigPtr bldConf, const wxArrayString& depsProj,
+                                                const wxString& additionalCompileFlags)
+{
+    // Everything the project makefile is generated from: the project XML (settings and file list), the build
+    // configuration as merged with the workspace settings, the compiler, the environment variables and whatever the
+    // plugins add to the compile flags
+    wxString data;
+    data << GetName() << "\n";
+    data << clCxxWorkspaceST::Get()->GetWorkspaceFileName().GetFullPath() << "\n";
+    data << proj->GetXmlString() << "\n";
+    data << XmlToString(bldConf->ToXml()) << "\n";
+
+    CompilerPtr cmp = BuildSettingsConfigST::Get()->GetCompiler(bldConf->GetCompilerType());
+    if(cmp) { data << XmlToString(cmp->ToXml()) << "\n"; }
+
+    EvnVarList vars;
+    EnvironmentConfig::Instance()->ReadObject(wxT("Variables"), &vars);
+    EnvMap varMap = vars.GetVariables(wxT(""), true, proj->GetName(), bldConf->GetName());
+    for(size_t i = 0; i < varMap.GetCount(); i++) {
+        wxString name, value;
+        varMap.Get(i, name, value);
+        data << name << "=" << value << "\n";
+    }
+
+    data << additionalCompileFlags << "\n";
+
+    for(size_t i = 0; i < depsProj.GetCount(); ++i) {
+        data << depsProj.Item(i) << "\n";
+    }
+    return wxMD5::GetDigest(data);
+}
+
 void BuilderGnuMake::CreateMakeDirsTarget(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& targetName,
                                           wxString& text)
 {
@@ -705,6 +808,7 @@ void BuilderGnuMake::CreateFileTargets(ProjectPtr proj, const wxString& confToBu
     // get the compiler settings
     CompilerPtr cmp = BuildSettingsConfigST::Get()->GetCompiler(cmpType);
     bool generateDependenciesFiles = cmp->GetGenerateDependeciesFile() && !cmp->GetDependSuffix().IsEmpty();
+    bool dependenciesFromCompilation = generateDependenciesFiles && IsDependencyFileWrittenByCompiler();
     bool supportPreprocessOnlyFiles =
         !cmp->GetSwitch(wxT("PreprocessOnly")).IsEmpty() && !cmp->GetPreprocessSuffix().IsEmpty();
 
@@ -789,9 +893,15 @@ void BuilderGnuMake::CreateFileTargets(ProjectPtr proj, const wxString& confToBu
                 }
 
                 // set the file rule
-                text << objectName << wxT(": ") << rel_paths.at(i).GetFullPath(wxPATH_UNIX) << wxT(" ") << dependFile
-                     << wxT("\n");
-                text << wxT("\t") << compilationLine << wxT("\n");
+                if(dependenciesFromCompilation) {
+                    // the dependency file is a by-product of the compilation, no need for a separate rule
+                    text << objectName << wxT(": ") << rel_paths.at(i).GetFullPath(wxPATH_UNIX) << wxT("\n");
+                    text << wxT("\t") << compilationLine << wxT(" -MMD -MP -MF") << dependFile << wxT("\n");
+                } else {
+                    text << objectName << wxT(": ") << rel_paths.at(i).GetFullPath(wxPATH_UNIX) << wxT(" ")
+                         << dependFile << wxT("\n");
+                    text << wxT("\t") << compilationLine << wxT("\n");
+                }
 
                 wxString cmpOptions(wxT("$(CXXFLAGS) $(IncludePCH)"));
                 if(isCFile) { cmpOptions = wxT("$(CFLAGS)"); }
@@ -801,7 +911,7 @@ void BuilderGnuMake::CreateFileTargets(ProjectPtr proj, const wxString& confToBu
                 ::WrapWithQuotes(source_file_to_compile);
 
                 wxString compilerMacro = DoGetCompilerMacro(rel_paths.at(i).GetFullPath(wxPATH_UNIX));
-                if(generateDependenciesFiles) {
+                if(generateDependenciesFiles && !dependenciesFromCompilation) {
                     text << dependFile << wxT(": ") << rel_paths.at(i).GetFullPath(wxPATH_UNIX) << wxT("\n");
                     text << wxT("\t") << wxT("@") << compilerMacro << wxT(" ") << cmpOptions
                          << wxT(" $(IncludePath) -MG -MP -MT") << objectName << wxT(" -MF") << dependFile
@@ -1118,7 +1228,8 @@ void BuilderGnuMake::CreatePreBuildEvents(ProjectPtr proj, BuildConfigPtr bldCon
     }
 }
 
-void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text)
+void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf,
+                                            const wxString& additionalCompileFlags, wxString& text)
 {
     wxString name = bldConf->GetName();
     name = NormalizeConfigName(name);
@@ -1156,7 +1267,6 @@ void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldC
     text << "CurrentFilePath        :=\n"; // TODO:: Need implementation
     text << "CurrentFileFullPath    :=\n"; // TODO:: Need implementation
     text << "User                   :=" << wxGetUserName() << "\n";
-    text << "Date                   :=" << wxDateTime::Now().FormatDate() << "\n";
     text << "CodeLitePath           :=" << ::WrapWithQuotes(startupdir) << "\n";
     text << "LinkerName             :=" << cmp->GetTool("LinkerName") << "\n";
     text << "SharedObjectLinkerName :=" << cmp->GetTool("SharedObjectLinkerName") << "\n";
@@ -1204,13 +1314,7 @@ void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldC
     wxString asOptions = bldConf->GetAssmeblerOptions();
     asOptions.Replace(";", " ");
 
-    // Let the plugins add their content here
-    clBuildEvent e(wxEVT_GET_ADDITIONAL_COMPILEFLAGS);
-    e.SetProjectName(proj->GetName());
-    e.SetConfigurationName(bldConf->GetName());
-    EventNotifier::Get()->ProcessEvent(e);
-
-    wxString additionalCompileFlags = e.GetCommand();
+    // The plugins content (wxEVT_GET_ADDITIONAL_COMPILEFLAGS)
     if(additionalCompileFlags.IsEmpty() == false) {
         buildOpts << wxT(" ") << additionalCompileFlags;
         cBuildOpts << wxT(" ") << additionalCompileFlags;
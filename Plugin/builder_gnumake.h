@@ -29,6 +29,7 @@
 #include "codelite_exports.h"
 #include "project.h"
 #include "workspace.h"
+#include <vector>
 #include <wx/txtstrm.h>
 #include <wx/wfstream.h>
 /*
@@ -48,6 +49,13 @@ protected:
         kIncludePostBuild = (1 << 3),
     };
 
+    struct BuildTarget {
+        wxString project;
+        wxString configuration;
+        wxString recipe; ///< The commands (tab indented lines) that build the project
+    };
+    typedef std::vector<BuildTarget> BuildTargetVec_t;
+
 public:
     BuilderGnuMake();
     BuilderGnuMake(const wxString& name, const wxString& buildTool, const wxString& buildToolOptions);
@@ -74,6 +82,15 @@ protected:
     virtual void CreateLinkTargets(const wxString& type, BuildConfigPtr bldConf, wxString& text, wxString& targetName,
                                    const wxString& projName, const wxArrayString& depsProj);
     virtual void CreateFileTargets(ProjectPtr proj, const wxString& confToBuild, wxString& text);
+    /**
+     * @brief write the 'All' target of the workspace Makefile. 'targets' holds the projects to build, dependencies
+     * first and the project being built last. The default implementation builds them one after the other
+     */
+    virtual void CreateWorkspaceBuildTargets(const BuildTargetVec_t& targets, wxString& text);
+    /**
+     * @brief when true, the object rules pass -MMD to the compiler instead of running a separate -MM pass per file
+     */
+    virtual bool IsDependencyFileWrittenByCompiler() const { return false; }
     void CreateCleanTargets(ProjectPtr proj, const wxString& confToBuild, wxString& text);
     // Override default methods defined in the builder interface
     virtual wxString GetBuildToolCommand(const wxString& project, const wxString& confToBuild,
@@ -83,7 +100,14 @@ protected:
 
 private:
     void GenerateMakefile(ProjectPtr proj, const wxString& confToBuild, bool force, const wxArrayString& depsProj);
-    void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text);
+    /**
+     * @brief return a hash of all the settings the project makefile is generated from. It is written to the makefile
+     * so the next build can skip generating a makefile that would come out the same
+     */
+    wxString GetMakefileFingerprint(ProjectPtr proj, BuildConfigPtr bldConf, const wxArrayString& depsProj,
+                                    const wxString& additionalCompileFlags);
+    void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& additionalCompileFlags,
+                                wxString& text);
     void CreateMakeDirsTarget(ProjectPtr proj, BuildConfigPtr bldConf, const wxString& targetName, wxString& text);
     void CreateTargets(const wxString& type, BuildConfigPtr bldConf, wxString& text, const wxString& projName);
     void CreatePreBuildEvents(ProjectPtr proj, BuildConfigPtr bldConf, wxString& text);
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2015 Eran Ifrah
+// file name            : builder_gnumake_parallel.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+#include "builder_gnumake_parallel.h"
+#include "environmentconfig.h"
+#include "procutils.h"
+#include "workspace.h"
+#include <map>
+#include <set>
+#include <wx/regex.h>
+
+// Project names may contain characters that have a meaning to make (spaces, colons...)
+static wxString GetProjectTargetName(const wxString& project)
+{
+    wxString target("Project_");
+    for(size_t i = 0; i < project.length(); ++i) {
+        wxChar ch = project[i];
+        target << ((wxIsalnum(ch) || ch == wxT('_') || ch == wxT('-') || ch == wxT('.')) ? ch : wxT('_'));
+    }
+    return target;
+}
+
+// --output-sync was added in GNU make 4.0, older versions (e.g. the make that ships with macOS) reject it
+static bool IsOutputSyncSupported(const wxString& buildTool)
+{
+    static std::map<wxString, bool> s_supported;
+    std::map<wxString, bool>::iterator iter = s_supported.find(buildTool);
+    if(iter != s_supported.end()) { return iter->second; }
+
+    static wxRegEx reVersion("GNU Make ([0-9]+)\\.");
+    wxArrayString out;
+    ProcUtils::SafeExecuteCommand(buildTool + " --version", out);
+    long major = 0;
+    if(!out.IsEmpty() && reVersion.Matches(out.Item(0))) { reVersion.GetMatch(out.Item(0), 1).ToLong(&major); }
+    s_supported.insert(std::make_pair(buildTool, major >= 4));
+    return major >= 4;
+}
+
+BuilderGnuMakeParallel::BuilderGnuMakeParallel()
+    : BuilderGnuMake(wxT("GNU makefile parallel build"), wxT("make"), wxT("-f"))
+{
+}
+
+BuilderGnuMakeParallel::~BuilderGnuMakeParallel() {}
+
+wxString BuilderGnuMakeParallel::GetBuildToolCommand(const wxString& project, const wxString& confToBuild,
+                                                     const wxString& arguments, bool isCommandlineCommand) const
+{
+    wxString command = BuilderGnuMake::GetBuildToolCommand(project, confToBuild, arguments, isCommandlineCommand);
+    // Only the top level make needs the flag, the sub-makes run under it
+    if(!isCommandlineCommand || !command.EndsWith(" -e -f ")) { return command; }
+
+    BuildConfigPtr bldConf = clCxxWorkspaceST::Get()->GetProjBuildConf(project, confToBuild);
+    if(!bldConf) { return command; }
+
+    CompilerPtr compiler = bldConf->GetCompiler();
+    if(!compiler) { return command; }
+
+    wxString buildTool = EnvironmentConfig::Instance()->ExpandVariables(compiler->GetTool("MAKE"), true);
+    if(!IsOutputSyncSupported(buildTool)) { return command; }
+
+    command.RemoveLast(3); // "-f "
+    command << "--output-sync=recurse -f ";
+    return command;
+}
+
+void BuilderGnuMakeParallel::CreateWorkspaceBuildTargets(const BuildTargetVec_t& targets, wxString& text)
+{
+    if(targets.empty()) {
+        BuilderGnuMake::CreateWorkspaceBuildTargets(targets, text);
+        return;
+    }
+
+    // Assign a unique make target to every project
+    std::map<wxString, wxString> targetNames;
+    std::set<wxString> usedNames;
+    for(size_t i = 0; i < targets.size(); ++i) {
+        wxString name = GetProjectTargetName(targets[i].project);
+        wxString uniqueName = name;
+        for(size_t n = 2; usedNames.count(uniqueName); ++n) {
+            uniqueName = wxString::Format("%s_%u", name, (unsigned int)n);
+        }
+        usedNames.insert(uniqueName);
+        targetNames.insert(std::make_pair(targets[i].project, uniqueName));
+    }
+
+    const BuildTarget& mainTarget = targets.back();
+    text << wxT(".PHONY:");
+    for(size_t i = 0; i < targets.size(); ++i) {
+        text << wxT(" ") << targetNames[targets[i].project];
+    }
+    text << wxT("\n\n");
+    text << wxT("All: ") << targetNames[mainTarget.project] << wxT("\n\n");
+
+    for(size_t i = 0; i < targets.size(); ++i) {
+        const BuildTarget& target = targets[i];
+        wxString prerequisites;
+        if(&target == &mainTarget) {
+            // The project we build waits for everything on its build order list
+            for(size_t j = 0; j < i; ++j) {
+                prerequisites << wxT(" ") << targetNames[targets[j].project];
+            }
+
+        } else {
+            // A dependency project waits only for the projects it depends on (and that are part of this build).
+            // Projects that do not depend on each other are built in parallel
+            wxString errMsg;
+            ProjectPtr proj = clCxxWorkspaceST::Get()->FindProjectByName(target.project, errMsg);
+            wxArrayString deps;
+            if(proj) { deps = proj->GetDependencies(target.configuration); }
+            for(size_t j = 0; j < deps.GetCount(); ++j) {
+                std::map<wxString, wxString>::iterator iter = targetNames.find(deps.Item(j));
+                if(iter == targetNames.end() || iter->first == target.project) { continue; }
+                prerequisites << wxT(" ") << iter->second;
+            }
+        }
+        text << targetNames[target.project] << wxT(":") << prerequisites << wxT("\n");
+        text << target.recipe << wxT("\n");
+    }
+}
@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2015 Eran Ifrah
+// file name            : builder_gnumake_parallel.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUILDER_GNUMAKE_PARALLEL_H
+#define BUILDER_GNUMAKE_PARALLEL_H
+
+#include "builder_gnumake.h"
+#include "codelite_exports.h"
+
+/*
+ * A GNU makefile builder that lets make schedule the whole workspace build as one graph:
+ * the workspace Makefile has a target per project which depends only on the projects it declares as dependencies,
+ * so with the jobserver of the build tool ("make -j N") independent projects are built concurrently and all the
+ * sub-makes share the same N jobs.
+ * The object rules also let the compiler write the header dependencies (-MMD) as part of the compilation.
+ * When the build tool supports it (GNU make 4.0 and later), make runs with --output-sync=recurse so the output of
+ * the sub-makes that run at the same time is not interleaved: each project's output is printed as a block once the
+ * project is done
+ */
+class WXDLLIMPEXP_SDK BuilderGnuMakeParallel : public BuilderGnuMake
+{
+public:
+    BuilderGnuMakeParallel();
+    virtual ~BuilderGnuMakeParallel();
+
+protected:
+    virtual void CreateWorkspaceBuildTargets(const BuildTargetVec_t& targets, wxString& text);
+    virtual bool IsDependencyFileWrittenByCompiler() const { return true; }
+    virtual wxString GetBuildToolCommand(const wxString& project, const wxString& confToBuild,
+                                         const wxString& arguments, bool isCommandlineCommand) const;
+};
+#endif // BUILDER_GNUMAKE_PARALLEL_H
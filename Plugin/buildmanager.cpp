@@ -26,6 +26,7 @@
 #include "builder.h"
 #include "builder_gnumake.h"
 #include "builder_gnumake_onestep.h"
+#include "builder_gnumake_parallel.h"
 #include "builder_NMake.h"
 
 BuildManager::BuildManager()
@@ -33,6 +34,7 @@ BuildManager::BuildManager()
     // register all builders here
     AddBuilder(new BuilderGnuMake());
     AddBuilder(new BuilderGnuMakeOneStep());
+    AddBuilder(new BuilderGnuMakeParallel());
 #ifdef __WXMSW__
     AddBuilder(new BuilderNMake());
 #endif
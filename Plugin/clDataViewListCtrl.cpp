@@ -365,6 +365,7 @@ void clDataViewListCtrl::SetSortFunction(const clSortFunc_t& CompareFunc)
 
     // Step 3: sort the children
     std::sort(children.begin(), children.end(), CompareFunc);
+    root->RebuildChildrenRows();
 
     // Now, reconnect the children, starting with the root
     clRowEntry* prev = root;
@@ -385,11 +386,8 @@ int clDataViewListCtrl::ItemToRow(const wxDataViewItem& item) const
     clRowEntry* root = m_model.GetRoot();
     if(!root) { return wxNOT_FOUND; }
 
-    const clRowEntry::Vec_t& children = root->GetChildren();
-    for(size_t i = 0; i < children.size(); ++i) {
-        if(children[i] == pItem) { return i; }
-    }
-    return wxNOT_FOUND;
+    if(pItem->GetParent() != root) { return wxNOT_FOUND; }
+    return pItem->GetIndexInParent();
 }
 
 void clDataViewListCtrl::Select(const wxDataViewItem& item)
@@ -25,6 +25,53 @@ int clRowEntry::X_SPACER = 5;
 int clRowEntry::Y_SPACER = 3;
 #endif
 
+//===------------------------------------------------------------
+// Fenwick (binary indexed) tree helpers, the indexes are 0 based
+//===------------------------------------------------------------
+static inline size_t LowBit(size_t i) { return i & (~i + 1); }
+
+static void FenwickAdd(std::vector<int>& tree, size_t index, int delta)
+{
+    for(size_t i = index + 1; i <= tree.size(); i += LowBit(i)) {
+        tree[i - 1] += delta;
+    }
+}
+
+// The sum of the first 'count' entries
+static int FenwickSum(const std::vector<int>& tree, size_t count)
+{
+    int sum = 0;
+    for(size_t i = count; i > 0; i -= LowBit(i)) {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+// Append an entry in O(log n)
+static void FenwickPushBack(std::vector<int>& tree, int value)
+{
+    size_t i = tree.size() + 1;
+    tree.push_back(value + FenwickSum(tree, i - 1) - FenwickSum(tree, i - LowBit(i)));
+}
+
+// Return the number of leading entries whose sum is <= 'value' and subtract their sum from 'value'
+// The entries must be positive
+static size_t FenwickFind(const std::vector<int>& tree, int& value)
+{
+    size_t pos = 0;
+    size_t mask = 1;
+    while((mask << 1) <= tree.size()) {
+        mask <<= 1;
+    }
+    for(; mask; mask >>= 1) {
+        if((pos + mask) <= tree.size() && tree[pos + mask - 1] <= value) {
+            pos += mask;
+            value -= tree[pos - 1];
+        }
+    }
+    return pos;
+}
+
 #ifdef __WXOSX__
 #define IS_OSX 1
 #else
@@ -132,29 +179,32 @@ void clRowEntry::InsertChild(clRowEntry* child, clRowEntry* prev)
     child->SetIndentsCount(GetIndentsCount() + 1);
 
     // We need the last item of this subtree (prev 'this' is the root)
-    if(prev == nullptr) {
-        // make it the first item
-        m_children.insert(m_children.begin(), child);
+    size_t where = 0;
+    if(prev && prev->GetParent() == this && m_children[prev->m_indexInParent] == prev) {
+        // Insert the item after 'prev'
+        where = prev->m_indexInParent + 1;
+    } else if(prev) {
+        // 'prev' is not one of our children: append the item
+        where = m_children.size();
+    }
+    m_children.insert(m_children.begin() + where, child);
+
+    // Update the rows bookkeeping
+    if(where == (m_children.size() - 1)) {
+        child->m_indexInParent = where;
+        FenwickPushBack(m_childrenRows, child->m_rows);
     } else {
-        // Insert the item in the parent children list
-        clRowEntry::Vec_t::iterator iter = m_children.end();
-        iter = std::find_if(m_children.begin(), m_children.end(), [&](clRowEntry* c) { return c == prev; });
-        if(iter != m_children.end()) { ++iter; }
-        // if iter is end(), than the is actually appending the item
-        m_children.insert(iter, child);
+        RebuildChildrenRows(where);
     }
+    DoUpdateRows();
 
     // Connect the linked list for sequential iteration
-    clRowEntry::Vec_t::iterator iterCur =
-        std::find_if(m_children.begin(), m_children.end(), [&](clRowEntry* c) { return c == child; });
-
     clRowEntry* nodeBefore = nullptr;
     // Find the item before and after
-    if(iterCur == m_children.begin()) {
+    if(where == 0) {
         nodeBefore = child->GetParent(); // "this"
     } else {
-        --iterCur;
-        clRowEntry* prevSibling = (*iterCur);
+        clRowEntry* prevSibling = m_children[where - 1];
         while(prevSibling && prevSibling->HasChildren()) {
             prevSibling = prevSibling->GetLastChild();
         }
@@ -177,31 +227,90 @@ void clRowEntry::DeleteChild(clRowEntry* child)
     // first remove all of its children
     // do this in a while loop since 'child->RemoveChild(c);' will alter
     // the array and will invalidate all iterators
-    while(!child->m_children.empty()) {
-        clRowEntry* c = child->m_children[0];
-        child->DeleteChild(c);
-    }
+    // (we remove them from the end, which is cheaper)
+    child->DeleteAllChildren();
+
     // Connect the list
     clRowEntry* prev = child->m_prev;
     clRowEntry* next = child->m_next;
     if(prev) { prev->m_next = next; }
     if(next) { next->m_prev = prev; }
     // Now disconnect this child from this node
-    clRowEntry::Vec_t::iterator iter =
-        std::find_if(m_children.begin(), m_children.end(), [&](clRowEntry* c) { return c == child; });
-    if(iter != m_children.end()) { m_children.erase(iter); }
+    size_t where = child->m_indexInParent;
+    if(where < m_children.size() && m_children[where] == child) {
+        m_children.erase(m_children.begin() + where);
+        if(where == m_children.size()) {
+            // The last child: the tree entries of the other children are not affected by it
+            m_childrenRows.pop_back();
+        } else {
+            RebuildChildrenRows(where);
+        }
+        DoUpdateRows();
+    }
     wxDELETE(child);
 }
 
-int clRowEntry::GetExpandedLines() const
+void clRowEntry::DoUpdateRows()
+{
+    int rows = (IsHidden() ? 0 : 1) + (IsExpanded() ? GetChildrenRows() : 0);
+    int delta = rows - m_rows;
+    if(delta == 0) { return; }
+    m_rows = rows;
+    if(m_parent) { m_parent->DoChildRowsChanged(m_indexInParent, delta); }
+}
+
+void clRowEntry::DoChildRowsChanged(size_t index, int delta)
 {
-    clRowEntry* node = const_cast<clRowEntry*>(this);
-    int counter = 0;
-    while(node) {
-        if(node->IsVisible()) { ++counter; }
-        node = node->m_next;
+    FenwickAdd(m_childrenRows, index, delta);
+    DoUpdateRows();
+}
+
+void clRowEntry::RebuildChildrenRows(size_t from)
+{
+    for(size_t i = from; i < m_children.size(); ++i) {
+        m_children[i]->m_indexInParent = i;
+    }
+
+    // Build the tree in O(n)
+    m_childrenRows.assign(m_children.size(), 0);
+    for(size_t i = 0; i < m_children.size(); ++i) {
+        m_childrenRows[i] += m_children[i]->m_rows;
+        size_t parent = i + LowBit(i + 1);
+        if(parent < m_childrenRows.size()) { m_childrenRows[parent] += m_childrenRows[i]; }
+    }
+}
+
+int clRowEntry::GetChildrenRows() const { return FenwickSum(m_childrenRows, m_childrenRows.size()); }
+
+int clRowEntry::GetRowOffset(const clRowEntry* ancestor) const
+{
+    int offset = 0;
+    const clRowEntry* node = this;
+    while(node != ancestor && node->m_parent) {
+        const clRowEntry* parent = node->m_parent;
+        // The rows of the previous siblings
+        offset += FenwickSum(parent->m_childrenRows, node->m_indexInParent);
+        // And the parent row itself
+        if(!parent->IsHidden()) { ++offset; }
+        node = parent;
+    }
+    return offset;
+}
+
+clRowEntry* clRowEntry::GetRowAt(int row) const
+{
+    const clRowEntry* node = this;
+    while(row >= 0 && row < node->m_rows) {
+        if(!node->IsHidden()) {
+            if(row == 0) { return const_cast<clRowEntry*>(node); }
+            --row;
+        }
+        // 'row' is within the children rows, find the child that contains it
+        size_t index = FenwickFind(node->m_childrenRows, row);
+        if(index >= node->m_children.size()) { break; }
+        node = node->m_children[index];
     }
-    return counter;
+    return nullptr;
 }
 
 void clRowEntry::GetNextItems(int count, clRowEntry::Vec_t& items, bool selfIncluded)
@@ -258,6 +367,7 @@ bool clRowEntry::SetExpanded(bool b)
     if(IsHidden()) {
         // Hidden node do not fire events
         SetFlag(kNF_Expanded, b);
+        DoUpdateRows();
         return true;
     }
 
@@ -269,6 +379,7 @@ bool clRowEntry::SetExpanded(bool b)
     if(!m_model->NodeExpanding(this, b)) { return false; }
 
     SetFlag(kNF_Expanded, b);
+    DoUpdateRows();
     m_model->NodeExpanded(this, b);
     return true;
 }
@@ -519,7 +630,7 @@ bool clRowEntry::IsVisible() const
 void clRowEntry::DeleteAllChildren()
 {
     while(!m_children.empty()) {
-        clRowEntry* c = m_children[0];
+        clRowEntry* c = m_children.back();
         // DeleteChild will remove it from the array
         DeleteChild(c);
     }
@@ -546,6 +657,7 @@ void clRowEntry::SetHidden(bool b)
     } else {
         m_indentsCount = 0;
     }
+    DoUpdateRows();
 }
 
 int clRowEntry::CalcItemWidth(wxDC& dc, int rowHeight, size_t col)
@@ -66,6 +66,12 @@ protected:
     clRowEntry* m_next = nullptr;
     clRowEntry* m_prev = nullptr;
     int m_indentsCount = 0;
+    // Row index bookkeeping. m_rows is the number of rows this subtree occupies when this item is visible
+    // (this item, unless hidden, plus the rows of its children when expanded). m_childrenRows is a Fenwick
+    // tree over the children's m_rows, so the model can convert between an item and its row index in O(log n)
+    int m_rows = 1;
+    size_t m_indexInParent = 0;
+    std::vector<int> m_childrenRows;
     wxRect m_rowRect;
     wxRect m_buttonRect;
     clMatchResult m_higlightInfo;
@@ -95,6 +101,15 @@ protected:
     void RenderCheckBox(wxWindow* win, wxDC& dc, const clColours& colours, const wxRect& rect, bool checked);
     int GetCheckBoxWidth(wxWindow* win);
 
+    /**
+     * @brief re-calculate m_rows and propagate the change up to the root
+     */
+    void DoUpdateRows();
+    /**
+     * @brief the rows of the child at 'index' were changed by 'delta'
+     */
+    void DoChildRowsChanged(size_t index, int delta);
+
 public:
     clRowEntry* GetLastChild() const;
     clRowEntry* GetFirstChild() const;
@@ -205,7 +220,32 @@ public:
         this->m_clientObject = clientData;
     }
     size_t GetChildrenCount(bool recurse) const;
-    int GetExpandedLines() const;
+    /**
+     * @brief the number of rows this subtree occupies when this item is visible (this item included)
+     */
+    int GetExpandedLines() const { return m_rows; }
+    /**
+     * @brief the number of rows the children of this item occupy (i.e. when this item is expanded)
+     */
+    int GetChildrenRows() const;
+    /**
+     * @brief the number of rows before this item, counting from 'ancestor' (included). This item must be
+     * a descendant of 'ancestor' and all the items in between must be expanded
+     */
+    int GetRowOffset(const clRowEntry* ancestor) const;
+    /**
+     * @brief return the item at 'row' counting from this item (row 0 is this item, unless it is hidden)
+     */
+    clRowEntry* GetRowAt(int row) const;
+    /**
+     * @brief re-number the children starting at 'from' and rebuild the children rows tree. Call this after
+     * re-ordering the GetChildren() array directly
+     */
+    void RebuildChildrenRows(size_t from = 0);
+    /**
+     * @brief the position of this item in its parent's children array
+     */
+    size_t GetIndexInParent() const { return m_indexInParent; }
     void GetNextItems(int count, clRowEntry::Vec_t& items, bool selfIncluded = true);
     void GetPrevItems(int count, clRowEntry::Vec_t& items, bool selfIncluded = true);
     void SetIndentsCount(int count) { this->m_indentsCount = count; }
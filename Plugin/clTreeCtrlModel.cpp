@@ -299,14 +299,17 @@ int clTreeCtrlModel::GetItemIndex(clRowEntry* item) const
 {
     if(item == NULL) { return wxNOT_FOUND; }
     if(!m_root) { return wxNOT_FOUND; }
-    int counter = 0;
-    clRowEntry* current = m_root;
-    while(current) {
-        if(current == item) { return counter; }
-        if(current->IsVisible()) { ++counter; }
-        current = current->GetNext();
+
+    // An item inside a collapsed subtree comes right after the row of the top-most collapsed item
+    clRowEntry* collapsed = nullptr;
+    clRowEntry* top = item;
+    while(top->GetParent()) {
+        top = top->GetParent();
+        if(!top->IsExpanded()) { collapsed = top; }
     }
-    return wxNOT_FOUND;
+    if(top != m_root) { return wxNOT_FOUND; }
+    if(collapsed) { return collapsed->GetRowOffset(m_root) + 1; }
+    return item->GetRowOffset(m_root);
 }
 
 bool clTreeCtrlModel::GetRange(clRowEntry* from, clRowEntry* to, clRowEntry::Vec_t& items) const
@@ -331,6 +334,17 @@ bool clTreeCtrlModel::GetRange(clRowEntry* from, clRowEntry* to, clRowEntry::Vec
 
     clRowEntry* start_item = index1 > index2 ? to : from;
     clRowEntry* end_item = index1 > index2 ? from : to;
+    if(start_item->IsVisible() && end_item->IsVisible()) {
+        // Both items are visible, get the range by their row index
+        int first = std::min(index1, index2);
+        int last = std::max(index1, index2);
+        items.reserve(last - first + 1);
+        for(int i = first; i <= last; ++i) {
+            items.push_back(GetItemFromIndex(i));
+        }
+        return true;
+    }
+
     clRowEntry* current = start_item;
     while(current) {
         if(current == end_item) {
@@ -353,14 +367,7 @@ clRowEntry* clTreeCtrlModel::GetItemFromIndex(int index) const
 {
     if(index < 0) { return nullptr; }
     if(!m_root) { return nullptr; }
-    int curIndex = -1;
-    clRowEntry* current = m_root;
-    while(current) {
-        if(current->IsVisible()) { ++curIndex; }
-        if(curIndex == index) { return current; }
-        current = current->GetNext();
-    }
-    return nullptr;
+    return m_root->GetRowAt(index);
 }
 
 void clTreeCtrlModel::SelectChildren(const wxTreeItemId& item)
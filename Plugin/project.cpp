@@ -306,6 +306,14 @@ void Project::RecursiveAdd(wxXmlNode* xmlNode, ProjectTreePtr& ptp, ProjectTreeN
     SetModified(true);
 }
 
+wxString Project::GetXmlString() const
+{
+    wxString projectXml;
+    wxStringOutputStream sos(&projectXml);
+    m_doc.Save(sos);
+    return projectXml;
+}
+
 bool Project::SaveXmlFile()
 {
     wxString projectXml;
@@ -1756,10 +1764,7 @@ bool Project::IsVirtualDirectoryEmpty(const wxString& vdFullPath) const
 
     // Its faster to check first the files list
     if(!folder->GetFiles().empty()) { return false; }
-
-    wxArrayString folders;
-    folder->GetSubfolders(folders, false);
-    return folders.IsEmpty();
+    return !folder->HasSubfolders();
 }
 
 bool Project::IsFileExcludedFromConfig(const wxString& filename, const wxString& configName) const
@@ -1914,6 +1919,15 @@ void clProjectFolder::GetSubfolders(wxArrayString& folders, bool recursive) cons
     std::for_each(foldersV.begin(), foldersV.end(), [&](const wxString& s) { folders.Add(s); });
 }
 
+bool clProjectFolder::HasSubfolders() const
+{
+    if(!m_xmlNode) { return false; }
+    for(wxXmlNode* child = m_xmlNode->GetChildren(); child; child = child->GetNext()) {
+        if(child->GetName() == "VirtualDirectory") { return true; }
+    }
+    return false;
+}
+
 void clProjectFolder::DeleteRecursive(Project* project)
 {
     wxArrayString folders;
@@ -265,6 +265,11 @@ public:
      */
     void GetSubfolders(wxArrayString& folders, bool recursive = true) const;
 
+    /**
+     * @brief return true if this folder has at least one direct child folder
+     */
+    bool HasSubfolders() const;
+
     /**
      * @brief delete this folder and all its children
      */
@@ -534,6 +539,11 @@ public:
      */
     void Save();
 
+    /**
+     * @brief return the project XML (settings and files) as it is held in memory
+     */
+    wxString GetXmlString() const;
+
     /**
      * @brief return the file meta data. The file names on the list
      * are in fullpath
@@ -12,6 +12,7 @@
 #include "macros.h"
 #include "wxCodeCompletionBox.h"
 #include "wxCodeCompletionBoxManager.h"
+#include <algorithm>
 #include <wx/app.h>
 #include <wx/dcbuffer.h>
 #include <wx/dcmemory.h>
@@ -27,10 +28,55 @@ static int Y_SPACER = 2;
 static int SCROLLBAR_WIDTH = 12;
 static int BOX_WIDTH = 400 + SCROLLBAR_WIDTH;
 
+// Entries created from tags are kept here once the box that used them is destroyed
+// so the next box can reuse them instead of allocating a new entry per tag
+static wxCodeCompletionBoxEntry::Vec_t s_entriesPool;
+static size_t MAX_POOLED_ENTRIES = 50000;
+
+// The match ranks, best first
+enum eMatchRank {
+    kMatchExact = 0,
+    kMatchExactNoCase,
+    kMatchStartsWith,
+    kMatchStartsWithNoCase,
+    kMatchContains,
+    kMatchContainsNoCase,
+    kMatchFuzzy,
+};
+
+static bool IsUpperAscii(char ch) { return ch >= 'A' && ch <= 'Z'; }
+
+/**
+ * @brief score a fuzzy match of a lowercased filter against an entry key. The filter characters must appear in the
+ * key in the same order. Characters that follow the previous match or that start a word score higher
+ * @return the score or wxNOT_FOUND if the filter is not a subsequence of the key
+ */
+static int FuzzyScore(const std::string& key, const std::string& lcKey, const std::string& lcFilter)
+{
+    int score = 0;
+    size_t pos = 0;
+    size_t prev = std::string::npos;
+    for(size_t i = 0; i < lcFilter.length(); ++i) {
+        pos = lcKey.find(lcFilter[i], pos);
+        if(pos == std::string::npos) { return wxNOT_FOUND; }
+
+        score += 1;
+        if(prev != std::string::npos && pos == prev + 1) { score += 3; }
+        if(pos == 0 || key[pos - 1] == '_' || key[pos - 1] == ':' ||
+           (IsUpperAscii(key[pos]) && !IsUpperAscii(key[pos - 1]))) {
+            score += 2;
+        }
+        prev = pos;
+        ++pos;
+    }
+    return score;
+}
+
 wxCodeCompletionBox::BmpVec_t wxCodeCompletionBox::m_defaultBitmaps;
 
 wxCodeCompletionBox::wxCodeCompletionBox(wxWindow* parent, wxEvtHandler* eventObject, size_t flags)
     : wxCodeCompletionBoxBase(parent)
+    , m_prefixMatches(0)
     , m_index(0)
     , m_stc(NULL)
     , m_startPos(wxNOT_FOUND)
@@ -151,6 +197,7 @@ wxCodeCompletionBox::~wxCodeCompletionBox()
     m_canvas->Unbind(wxEVT_LEFT_DCLICK, &wxCodeCompletionBox::OnLeftDClick, this);
     m_canvas->Unbind(wxEVT_MOUSEWHEEL, &wxCodeCompletionBox::OnMouseScroll, this);
     DoDestroyTipWindow();
+    DoRecycleEntries();
 }
 
 void wxCodeCompletionBox::OnEraseBackground(wxEraseEvent& event) { wxUnusedVar(event); }
@@ -300,11 +347,14 @@ void wxCodeCompletionBox::ShowCompletionBox(wxStyledTextCtrl* ctrl, const wxCode
     // Filter all duplicate entries from the list (based on simple string match)
     RemoveDuplicateEntries();
 
+    // Index the entries once, the filter runs on every key stroke
+    DoBuildFilterIndex();
+
     // Filter results based on user input
     FilterResults();
 
-    // If we got a single match - insert it
-    if((m_entries.size() == 1) && (m_flags & kInsertSingleMatch)) {
+    // If we got a single match - insert it. A "contains" or a fuzzy match is only a guess: let the user confirm it
+    if((m_entries.size() == 1) && (m_prefixMatches == 1) && (m_flags & kInsertSingleMatch)) {
         // single match
         InsertSelection();
         DoDestroy();
@@ -452,52 +502,79 @@ bool wxCodeCompletionBox::FilterResults()
     wxString word = GetFilter();
     if(word.IsEmpty()) {
         m_entries = m_allEntries;
+        m_prefixMatches = m_entries.size();
+        m_candidates.clear();
+        m_lastFilter.clear();
         return false;
     }
 
-    m_entries.clear();
-    wxString lcFilter = word.Lower();
+    std::string filter = word.mb_str(wxConvUTF8).data();
+    std::string lcFilter = word.Lower().mb_str(wxConvUTF8).data();
+
+    // Typing more characters can only remove matches, so when the new filter extends the previous one
+    // we only need to check the entries that matched the previous filter
+    bool narrow = !m_lastFilter.empty() && (lcFilter.compare(0, m_lastFilter.length(), m_lastFilter) == 0);
+    size_t count = narrow ? m_candidates.size() : m_allEntries.size();
+
     // Smart sorting:
     // We preare the list of matches in the following order:
     // Exact matches
     // Starts with
     // Contains
-    wxCodeCompletionBoxEntry::Vec_t exactMatches, exactMatchesI, startsWith, startsWithI, contains, containsI;
-    for(size_t i = 0; i < m_allEntries.size(); ++i) {
-        wxString entryText = m_allEntries.at(i)->GetText().BeforeFirst('(');
-        entryText.Trim().Trim(false);
-        wxString lcEntryText = entryText.Lower();
-
-        // Exact match:
-        if(word == entryText) {
-            exactMatches.push_back(m_allEntries.at(i));
-
-        } else if(lcEntryText == lcFilter) {
-            exactMatchesI.push_back(m_allEntries.at(i));
-
-        } else if(entryText.StartsWith(word)) {
-            startsWith.push_back(m_allEntries.at(i));
-
-        } else if(lcEntryText.StartsWith(lcFilter)) {
-            startsWithI.push_back(m_allEntries.at(i));
-
-        } else if(entryText.Contains(word)) {
-            contains.push_back(m_allEntries.at(i));
-
-        } else if(lcEntryText.Contains(lcFilter)) {
-            containsI.push_back(m_allEntries.at(i));
+    // Fuzzy (the filter characters appear in the entry in the same order)
+    // Entries of the same rank are sorted by their usage weight and then keep their original order
+    struct Match {
+        int rank;
+        int score;
+        int weight;
+        size_t index;
+    };
+    std::vector<Match> matches;
+    for(size_t i = 0; i < count; ++i) {
+        size_t index = narrow ? m_candidates[i] : i;
+        const std::string& key = m_keys[index];
+        const std::string& lcKey = m_lcKeys[index];
+
+        int score = FuzzyScore(key, lcKey, lcFilter);
+        if(score == wxNOT_FOUND) { continue; }
+
+        int rank = kMatchFuzzy;
+        if(key == filter) {
+            rank = kMatchExact;
+        } else if(lcKey == lcFilter) {
+            rank = kMatchExactNoCase;
+        } else if(key.compare(0, filter.length(), filter) == 0) {
+            rank = kMatchStartsWith;
+        } else if(lcKey.compare(0, lcFilter.length(), lcFilter) == 0) {
+            rank = kMatchStartsWithNoCase;
+        } else if(key.find(filter) != std::string::npos) {
+            rank = kMatchContains;
+        } else if(lcKey.find(lcFilter) != std::string::npos) {
+            rank = kMatchContainsNoCase;
         }
+        matches.push_back({ rank, rank == kMatchFuzzy ? score : 0, m_allEntries[index]->GetWeight(), index });
     }
 
-    // Merge the results
-    m_entries.insert(m_entries.end(), exactMatches.begin(), exactMatches.end());
-    m_entries.insert(m_entries.end(), exactMatchesI.begin(), exactMatchesI.end());
-    m_entries.insert(m_entries.end(), startsWith.begin(), startsWith.end());
-    m_entries.insert(m_entries.end(), startsWithI.begin(), startsWithI.end());
-    m_entries.insert(m_entries.end(), contains.begin(), contains.end());
-    m_entries.insert(m_entries.end(), containsI.begin(), containsI.end());
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+        if(a.rank != b.rank) { return a.rank < b.rank; }
+        if(a.score != b.score) { return a.score > b.score; }
+        if(a.weight != b.weight) { return a.weight > b.weight; }
+        return a.index < b.index;
+    });
+
+    m_entries.clear();
+    m_entries.reserve(matches.size());
+    m_candidates.clear();
+    m_candidates.reserve(matches.size());
+    m_prefixMatches = 0;
+    for(size_t i = 0; i < matches.size(); ++i) {
+        m_entries.push_back(m_allEntries[matches[i].index]);
+        m_candidates.push_back(matches[i].index);
+        if(matches[i].rank <= kMatchStartsWithNoCase) { ++m_prefixMatches; }
+    }
+    m_lastFilter.swap(lcFilter);
     m_index = 0;
-    return exactMatches.empty() && exactMatchesI.empty() && startsWith.empty() && startsWithI.empty();
+    return matches.empty() || (matches[0].rank > kMatchStartsWithNoCase);
 }
 
 void wxCodeCompletionBox::InsertSelection()
@@ -553,14 +630,25 @@ void wxCodeCompletionBox::OnLeftDClick(wxMouseEvent& event)
 wxCodeCompletionBoxEntry::Vec_t wxCodeCompletionBox::TagsToEntries(const TagEntryPtrVector_t& tags)
 {
     wxCodeCompletionBoxEntry::Vec_t entries;
+    entries.reserve(tags.size());
     for(size_t i = 0; i < tags.size(); ++i) {
         TagEntryPtr tag = tags.at(i);
         wxString text = tag->GetDisplayName().Trim().Trim(false);
         int imgIndex = GetImageId(tag);
-        wxCodeCompletionBoxEntry::Ptr_t entry = wxCodeCompletionBoxEntry::New(text, imgIndex);
+        wxCodeCompletionBoxEntry::Ptr_t entry;
+        if(s_entriesPool.empty()) {
+            entry = wxCodeCompletionBoxEntry::New(text, imgIndex);
+        } else {
+            // Reuse an entry from a previous box
+            entry = s_entriesPool.back();
+            s_entriesPool.pop_back();
+            entry->m_text = text;
+            entry->m_imgIndex = imgIndex;
+        }
         entry->m_tag = tag;
         entries.push_back(entry);
     }
+    m_tagEntries.insert(m_tagEntries.end(), entries.begin(), entries.end());
     return entries;
 }
 
@@ -746,6 +834,47 @@ void wxCodeCompletionBox::RemoveDuplicateEntries()
     m_allEntries.swap(uniqueList);
 }
 
+void wxCodeCompletionBox::DoBuildFilterIndex()
+{
+    m_keys.clear();
+    m_lcKeys.clear();
+    m_candidates.clear();
+    m_lastFilter.clear();
+
+    m_keys.reserve(m_allEntries.size());
+    m_lcKeys.reserve(m_allEntries.size());
+    for(size_t i = 0; i < m_allEntries.size(); ++i) {
+        wxString entryText = m_allEntries.at(i)->GetText().BeforeFirst('(');
+        entryText.Trim().Trim(false);
+        m_keys.push_back(entryText.mb_str(wxConvUTF8).data());
+        m_lcKeys.push_back(entryText.Lower().mb_str(wxConvUTF8).data());
+    }
+}
+
+void wxCodeCompletionBox::DoRecycleEntries()
+{
+    // Drop our own references first, an entry that is still referenced elsewhere (e.g. by a plugin) is not recycled
+    m_entries.clear();
+    m_allEntries.clear();
+    for(size_t i = 0; i < m_tagEntries.size() && s_entriesPool.size() < MAX_POOLED_ENTRIES; ++i) {
+        wxCodeCompletionBoxEntry::Ptr_t entry = m_tagEntries.at(i);
+        m_tagEntries.at(i).reset();
+        if(!entry.unique()) { continue; }
+
+        // Release everything the entry holds so a pooled entry does not keep its tag alive
+        entry->m_tag.Reset(NULL);
+        entry->m_text.Clear();
+        entry->m_comment.Clear();
+        entry->m_weight = 0;
+        entry->m_imgIndex = wxNOT_FOUND;
+        entry->m_itemRect = wxRect();
+        entry->m_alternateBitmap = wxNullBitmap;
+        entry->SetClientData(NULL);
+        s_entriesPool.push_back(entry);
+    }
+    m_tagEntries.clear();
+}
+
 wxBitmap wxCodeCompletionBox::GetBitmap(TagEntryPtr tag)
 {
     InitializeDefaultBitmaps();
@@ -32,6 +32,7 @@
 #include <wx/sharedptr.h>
 #include <vector>
 #include <list>
+#include <string>
 #include <wx/bitmap.h>
 #include <wx/stc/stc.h>
 #include <wx/font.h>
@@ -60,6 +61,20 @@ public:
 protected:
     wxCodeCompletionBoxEntry::Vec_t m_allEntries;
     wxCodeCompletionBoxEntry::Vec_t m_entries;
+
+    /// Entries created by this box from tags. They are returned to a shared pool once the box is destroyed
+    wxCodeCompletionBoxEntry::Vec_t m_tagEntries;
+
+    /// The filter index, built once per session. Both arrays are parallel to m_allEntries and hold
+    /// the UTF-8 text of the entry (up to the first '(') as-is and lowercased
+    std::vector<std::string> m_keys;
+    std::vector<std::string> m_lcKeys;
+
+    /// Indices into m_allEntries that matched m_lastFilter, used to narrow the next filter pass
+    std::vector<size_t> m_candidates;
+    std::string m_lastFilter;
+    /// Number of entries in m_entries that are an exact or a "starts with" match of the filter
+    size_t m_prefixMatches;
     wxCodeCompletionBox::BmpVec_t m_bitmaps;
     static wxCodeCompletionBox::BmpVec_t m_defaultBitmaps;
 
@@ -171,6 +186,14 @@ protected:
      */
     bool FilterResults();
     void RemoveDuplicateEntries();
+    /**
+     * @brief build the filter index for m_allEntries
+     */
+    void DoBuildFilterIndex();
+    /**
+     * @brief return the entries created from tags to the shared pool so the next box can reuse them
+     */
+    void DoRecycleEntries();
     void InsertSelection();
     wxString GetFilter();
 
@@ -19,15 +19,15 @@ void csCodeCompletePhpHandler::DoProcessCommand(const JSONElement& options)
     CHECK_STR_PARAM("symbols-path", m_symbolsPath);
 
     // Guess the symbols db path
-    PHPLookupTable lookup;
     if(wxFileName::DirExists(m_symbolsPath)) {
         // the provided path is the folder, build the symbols path
         m_symbolsPath << wxFileName::GetPathSeparator() << ".codelite" << wxFileName::GetPathSeparator()
                       << "phpsymbols.db";
     }
     clDEBUG() << "Using symbols db:" << m_symbolsPath;
-    lookup.Open(wxFileName(m_symbolsPath));
+    PHPLookupTable& lookup = m_manager->GetPHPLookupTable(wxFileName(m_symbolsPath));
     if(!lookup.IsOpened()) {
+        m_manager->WriteOutput("[]");
         return;
     }
 
@@ -46,10 +46,10 @@ void csCodeCompletePhpHandler::DoProcessCommand(const JSONElement& options)
         JSONElement arr = root.toElement();
         std::for_each(matches.begin(), matches.end(), [&](PHPEntityBase::Ptr_t e) { arr.arrayAppend(e->ToJSON()); });
         char* result = arr.FormatRawString(m_manager->GetConfig().IsPrettyJSON());
-        std::cout << result << std::endl;
+        m_manager->WriteOutput(wxString(result, wxConvUTF8));
         free(result);
 
     } else {
-        std::cout << "[]" << std::endl;
+        m_manager->WriteOutput("[]");
     }
 }
@@ -18,6 +18,8 @@ void csCommandHandlerBase::NotifyCompletion()
 
 void csCommandHandlerBase::Process(const JSONElement& options)
 {
+    // Handlers are reused in daemon mode, so a previous command must not affect this one
+    m_notifyOnExit = true;
     DoProcessCommand(options);
     if(m_notifyOnExit) {
         // Make sure we call 'NotifyCompletion' here if needed
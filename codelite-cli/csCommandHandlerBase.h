@@ -14,7 +14,7 @@ wxDECLARE_EVENT(wxEVT_COMMAND_PROCESSED, clCommandEvent);
 #define CHECK_STR_PARAM(str_option, sVal)                       \
     if(!options.hasNamedObject(str_option)) {                   \
         clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
+        SetNotifyCompletion(true);                              \
         return;                                                 \
     }                                                           \
     sVal = options.namedObject(str_option).toString();
@@ -22,7 +22,7 @@ wxDECLARE_EVENT(wxEVT_COMMAND_PROCESSED, clCommandEvent);
 #define CHECK_INT_PARAM(str_option, iVal)                       \
     if(!options.hasNamedObject(str_option)) {                   \
         clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
+        SetNotifyCompletion(true);                              \
         return;                                                 \
     }                                                           \
     iVal = options.namedObject(str_option).toInt();
@@ -30,7 +30,7 @@ wxDECLARE_EVENT(wxEVT_COMMAND_PROCESSED, clCommandEvent);
 #define CHECK_BOOL_PARAM(str_option, bVal)                      \
     if(!options.hasNamedObject(str_option)) {                   \
         clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
+        SetNotifyCompletion(true);                              \
         return;                                                 \
     }                                                           \
     bVal = options.namedObject(str_option).toBool();
@@ -38,7 +38,7 @@ wxDECLARE_EVENT(wxEVT_COMMAND_PROCESSED, clCommandEvent);
 #define CHECK_ARRSTR_PARAM(str_option, arrVal)                  \
     if(!options.hasNamedObject(str_option)) {                   \
         clERROR() << "Command is missing field:" << str_option; \
-        NotifyCompletion();                                     \
+        SetNotifyCompletion(true);                              \
         return;                                                 \
     }                                                           \
     arrVal = options.namedObject(str_option).toArrayString();
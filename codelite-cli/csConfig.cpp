@@ -22,4 +22,14 @@ void csConfig::Load()
     bool pretty_json = false;
     ini.Read("pretty_json", &pretty_json);
     EnableFlag(kPrettyJSON, pretty_json);
+
+    // The address the daemon listens on
+#ifdef __WXMSW__
+    wxString defaultConnectionString = "tcp://127.0.0.1:5555";
+#else
+    wxFileName socketPath(clStandardPaths::Get().GetUserDataDir(), "codelite-cli.sock");
+    wxString defaultConnectionString = "unix://" + socketPath.GetFullPath();
+#endif
+    ini.Read("connection_string", &m_connectionString, defaultConnectionString);
+    clDEBUG() << "connection_string =" << m_connectionString;
 }
@@ -1,6 +1,7 @@
 #include "csFindInFilesCommandHandler.h"
 #include "search_thread.h"
 #include "csManager.h"
+#include "clTrigramIndex.h"
 
 csFindInFilesCommandHandler::csFindInFilesCommandHandler(csManager* manager)
     : csCommandHandlerBase(manager)
@@ -17,6 +18,9 @@ void csFindInFilesCommandHandler::DoProcessCommand(const JSONElement& options)
     CHECK_STR_PARAM("mask", m_mask);
     CHECK_BOOL_PARAM("case", m_case);
     CHECK_BOOL_PARAM("word", m_word);
+    // Optional: the workspace tags database, used to locate its trigram index
+    m_tagsDb.clear();
+    CHECK_STR_PARAM_OPTIONAL("tags_db", m_tagsDb);
 
     if(m_folder.IsEmpty() || !wxFileName::DirExists(m_folder)) {
         clERROR() << "Invalid input directory:" << m_folder;
@@ -37,6 +41,11 @@ void csFindInFilesCommandHandler::DoProcessCommand(const JSONElement& options)
     req->SetFindString(m_what);
     req->SetMatchCase(m_case);
     req->SetMatchWholeWord(m_word);
+    req->SetMultiThreaded(true);
+    if(!m_tagsDb.IsEmpty()) {
+        req->SetUseIndex(true);
+        req->SetIndexFile(clTrigramIndex::GetIndexFileName(m_tagsDb).GetFullPath());
+    }
     wxArrayString folders;
     folders.Add(m_folder);
     req->SetRootDirs(folders);
@@ -11,6 +11,7 @@ class csFindInFilesCommandHandler : public csCommandHandlerBase
     wxString m_mask;
     bool m_case;
     bool m_word;
+    wxString m_tagsDb;
 
 public:
     virtual void DoProcessCommand(const JSONElement& options);
@@ -1,3 +1,4 @@
+#include "SocketAPI/clSocketBase.h"
 #include "csCodeCompleteHandler.h"
 #include "csFindInFilesCommandHandler.h"
 #include "csListCommandHandler.h"
@@ -15,6 +16,10 @@
 csManager::csManager()
     : m_startupCalled(false)
     , m_exitNow(false)
+    , m_daemon(false)
+    , m_networkThread(nullptr)
+    , m_client(nullptr)
+    , m_busy(false)
 {
     m_handlers.Register("list", csCommandHandlerBase::Ptr_t(new csListCommandHandler(this)));
     m_handlers.Register("find", csCommandHandlerBase::Ptr_t(new csFindInFilesCommandHandler(this)));
@@ -36,7 +41,18 @@ csManager::~csManager()
         Unbind(wxEVT_SEARCH_THREAD_SEARCHSTARTED, &csManager::OnSearchThreadStarted, this);
         Unbind(wxEVT_SEARCH_THREAD_SEARCHCANCELED, &csManager::OnSearchThreadCancelled, this);
         Unbind(wxEVT_SEARCH_THREAD_SEARCHEND, &csManager::OnSearchThreadEneded, this);
+        if(m_daemon) {
+            Unbind(wxEVT_SOCKET_SERVER_ERROR, &csManager::OnServerError, this);
+            Unbind(wxEVT_SOCKET_CONNECTION_READY, &csManager::OnNewConnection, this);
+            Unbind(wxEVT_SOCKET_COMMAND_RECEIVED, &csManager::OnClientCommand, this);
+            Unbind(wxEVT_THREAD_GOING_DOWN, &csManager::OnClientGoingDown, this);
+        }
     }
+
+    // Stop accepting new connections and disconnect the clients
+    wxDELETE(m_networkThread);
+    std::for_each(m_readers.begin(), m_readers.end(), [&](csNetworkReaderThread* reader) { delete reader; });
+    m_readers.clear();
     SearchThreadST::Get()->Stop();
 }
 
@@ -56,32 +72,73 @@ bool csManager::Startup()
 
     m_startupCalled = true;
 
+    if(m_daemon) {
+        // Keep running and serve commands sent over the socket
+        Bind(wxEVT_SOCKET_SERVER_ERROR, &csManager::OnServerError, this);
+        Bind(wxEVT_SOCKET_CONNECTION_READY, &csManager::OnNewConnection, this);
+        Bind(wxEVT_SOCKET_COMMAND_RECEIVED, &csManager::OnClientCommand, this);
+        Bind(wxEVT_THREAD_GOING_DOWN, &csManager::OnClientGoingDown, this);
+
+        clDEBUG() << "Starting daemon on:" << m_config.GetConnectionString();
+        m_networkThread = new csNetworkThread(this, m_config);
+        m_networkThread->Start();
+        return true;
+    }
+
     clDEBUG() << "Command:" << GetCommand();
     clDEBUG() << "Options:" << GetOptions();
 
+    JSONRoot root(m_options);
+    JSONElement options = root.toElement();
+    return DoProcessCommand(m_command, options);
+}
+
+bool csManager::DoProcessCommand(const wxString& command, const JSONElement& options)
+{
     // Make sure we know how to handle this command
-    csCommandHandlerBase::Ptr_t handler = m_handlers.FindHandler(m_command);
+    csCommandHandlerBase::Ptr_t handler = m_handlers.FindHandler(command);
     if(handler == nullptr) {
-        clERROR() << "Don't know how to handle command:" << m_command;
+        clERROR() << "Don't know how to handle command:" << command;
         return false;
     }
-
-    JSONRoot root(m_options);
-    JSONElement options = root.toElement();
     handler->Process(options);
     return true;
 }
 
-void csManager::OnCommandProcessedCompleted(clCommandEvent& event) { wxExit(); }
+void csManager::OnCommandProcessedCompleted(clCommandEvent& event)
+{
+    if(!m_daemon) {
+        wxExit();
+        return;
+    }
+
+    // Let the client know that there is no more output for this command
+    JSONRoot reply(cJSON_Object);
+    reply.toElement().addProperty("command", m_command).addProperty("status", wxString("done"));
+    WriteOutput(reply.toElement().format(false));
+
+    m_client = nullptr;
+    m_busy = false;
+    DoProcessNextCommand();
+}
 
 void csManager::OnSearchThreadMatch(wxCommandEvent& event)
 {
     SearchResultList* res = reinterpret_cast<SearchResultList*>(event.GetClientData());
-    SearchResultList::iterator iter = res->begin();
-    JSONElement arr = m_findInFilesMatches->toElement();
-    while(iter != res->end()) {
-        arr.arrayAppend(iter->ToJSON());
-        ++iter;
+    if(m_daemon) {
+        // Stream the matches to the client as they arrive
+        JSONRoot batch(cJSON_Array);
+        JSONElement arr = batch.toElement();
+        std::for_each(res->begin(), res->end(), [&](const SearchResult& result) { arr.arrayAppend(result.ToJSON()); });
+        WriteOutput(arr.format(GetConfig().IsPrettyJSON()));
+
+    } else {
+        SearchResultList::iterator iter = res->begin();
+        JSONElement arr = m_findInFilesMatches->toElement();
+        while(iter != res->end()) {
+            arr.arrayAppend(iter->ToJSON());
+            ++iter;
+        }
     }
     wxDELETE(res);
 }
@@ -97,13 +154,17 @@ void csManager::OnSearchThreadCancelled(wxCommandEvent& event) { OnSearchThreadE
 void csManager::OnSearchThreadEneded(wxCommandEvent& event)
 {
     SearchSummary* summary = reinterpret_cast<SearchSummary*>(event.GetClientData());
+    // In daemon mode the matches were already streamed and the array holds only the summary
     m_findInFilesMatches->toElement().arrayAppend(summary->ToJSON());
     wxDELETE(summary);
     wxString output = m_findInFilesMatches->toElement().format(GetConfig().IsPrettyJSON());
-    std::cout << output << std::endl;
+    WriteOutput(output);
     clDEBUG1() << output;
     clDEBUG() << "Search completed";
-    wxExit();
+
+    // The find handler does not notify completion by itself, it waits for the search thread
+    clCommandEvent completedEvent(wxEVT_COMMAND_PROCESSED);
+    AddPendingEvent(completedEvent);
 }
 
 void csManager::LoadCommandFromINI()
@@ -113,3 +174,97 @@ void csManager::LoadCommandFromINI()
 }
 
 void csManager::OnExit() { wxExit(); }
+
+void csManager::WriteOutput(const wxString& output)
+{
+    if(!m_daemon) {
+        std::cout << output.mb_str(wxConvUTF8).data() << std::endl;
+        return;
+    }
+
+    // The client might have disconnected while its command was running
+    if(!m_client) { return; }
+    try {
+        m_client->GetConnection()->WriteMessage(output);
+    } catch(clSocketException& e) {
+        clWARNING() << "Failed to write reply:" << e.what();
+    }
+}
+
+PHPLookupTable& csManager::GetPHPLookupTable(const wxFileName& dbpath)
+{
+    if(!m_phpLookup.IsOpened() || (m_phpLookupPath != dbpath)) {
+        m_phpLookup.Close();
+        m_phpLookup.Open(dbpath);
+        m_phpLookupPath = dbpath;
+    }
+    return m_phpLookup;
+}
+
+void csManager::DoProcessNextCommand()
+{
+    // Commands run one at a time. A command is done once its handler fires wxEVT_COMMAND_PROCESSED
+    while(!m_busy && !m_pendingCommands.empty()) {
+        std::pair<csNetworkReaderThread*, wxString> request = m_pendingCommands.front();
+        m_pendingCommands.pop_front();
+
+        // A request is in the form of: { "command": "...", "options": { ... } }
+        JSONRoot root(request.second);
+        JSONElement json = root.toElement();
+        m_client = request.first;
+        m_command = json.namedObject("command").toString();
+        clDEBUG() << "Command:" << m_command;
+
+        m_busy = DoProcessCommand(m_command, json.namedObject("options"));
+        if(!m_busy) {
+            JSONRoot reply(cJSON_Object);
+            reply.toElement().addProperty("command", m_command).addProperty("status", wxString("error"));
+            WriteOutput(reply.toElement().format(false));
+            m_client = nullptr;
+        }
+    }
+}
+
+void csManager::OnServerError(clCommandEvent& event)
+{
+    std::cerr << "codelite-cli: failed to start server on " << m_config.GetConnectionString().mb_str(wxConvUTF8).data()
+              << ". " << event.GetString().mb_str(wxConvUTF8).data() << std::endl;
+    wxExit();
+}
+
+void csManager::OnNewConnection(clCommandEvent& event)
+{
+    clSocketBase* conn = reinterpret_cast<clSocketBase*>(event.GetClientData());
+    CHECK_PTR_RET(conn);
+
+    // The reader thread owns the connection from now on
+    csNetworkReaderThread* reader = new csNetworkReaderThread(this, conn);
+    m_readers.insert(reader);
+    reader->Start();
+    clDEBUG() << "New client connected." << m_readers.size() << "clients";
+}
+
+void csManager::OnClientCommand(clCommandEvent& event)
+{
+    csNetworkReaderThread* client = reinterpret_cast<csNetworkReaderThread*>(event.GetClientData());
+    if(m_readers.count(client) == 0) { return; }
+    m_pendingCommands.push_back({ client, event.GetString() });
+    DoProcessNextCommand();
+}
+
+void csManager::OnClientGoingDown(clCommandEvent& event)
+{
+    csNetworkReaderThread* client = reinterpret_cast<csNetworkReaderThread*>(event.GetClientData());
+    if(m_readers.count(client) == 0) { return; }
+    m_readers.erase(client);
+
+    // Drop any command this client is still waiting for
+    m_pendingCommands.erase(std::remove_if(m_pendingCommands.begin(), m_pendingCommands.end(),
+                                           [&](const std::pair<csNetworkReaderThread*, wxString>& request) {
+                                               return request.first == client;
+                                           }),
+                            m_pendingCommands.end());
+    if(m_client == client) { m_client = nullptr; }
+    wxDELETE(client);
+    clDEBUG() << "Client disconnected." << m_readers.size() << "clients";
+}
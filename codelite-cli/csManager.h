@@ -1,14 +1,18 @@
 #ifndef CSMANAGER_H
 #define CSMANAGER_H
 
+#include "PHPLookupTable.h"
 #include "codelite_events.h"
 #include "csCommandHandlerManager.h"
 #include "csConfig.h"
 #include "file_logger.h"
 #include <cl_command_event.h>
+#include <deque>
 #include <unordered_set>
 #include <wx/event.h>
 
+class csNetworkThread;
+class csNetworkReaderThread;
 class csManager : public wxEvtHandler
 {
     csConfig m_config;
@@ -20,6 +24,20 @@ class csManager : public wxEvtHandler
     wxSharedPtr<JSONRoot> m_findInFilesMatches;
     bool m_exitNow;
 
+    // Daemon mode
+    bool m_daemon;
+    csNetworkThread* m_networkThread;
+    std::unordered_set<csNetworkReaderThread*> m_readers;
+    /// Commands waiting for the current command to complete, along with the client that sent them
+    std::deque<std::pair<csNetworkReaderThread*, wxString> > m_pendingCommands;
+    /// The client whose command is currently running (nullptr if it disconnected meanwhile)
+    csNetworkReaderThread* m_client;
+    bool m_busy;
+
+    /// The PHP symbols database, kept open between commands
+    PHPLookupTable m_phpLookup;
+    wxFileName m_phpLookupPath;
+
 public:
     csManager();
     virtual ~csManager();
@@ -32,10 +50,26 @@ public:
     const csConfig& GetConfig() const { return m_config; }
     void LoadCommandFromINI();
     void SetExitNow(bool b) { m_exitNow = b; }
-    
+    void SetDaemon(bool b) { m_daemon = b; }
+    bool IsDaemon() const { return m_daemon; }
+
+    /**
+     * @brief write a command result. When running a single command the result is printed to the stdout,
+     * in daemon mode it is sent as a message to the client that sent the command
+     */
+    void WriteOutput(const wxString& output);
+
+    /**
+     * @brief return the PHP lookup table opened on 'dbpath'. The table is only re-opened when a different database
+     * is requested, so in daemon mode consecutive commands reuse the open database
+     */
+    PHPLookupTable& GetPHPLookupTable(const wxFileName& dbpath);
+
 protected:
     void OnExit();
-    
+    bool DoProcessCommand(const wxString& command, const JSONElement& options);
+    void DoProcessNextCommand();
+
     // The handler completed
     void OnCommandProcessedCompleted(clCommandEvent& event);
 
@@ -44,6 +78,12 @@ protected:
     void OnSearchThreadStarted(wxCommandEvent& event);
     void OnSearchThreadCancelled(wxCommandEvent& event);
     void OnSearchThreadEneded(wxCommandEvent& event);
+
+    // Daemon events
+    void OnServerError(clCommandEvent& event);
+    void OnNewConnection(clCommandEvent& event);
+    void OnClientCommand(clCommandEvent& event);
+    void OnClientGoingDown(clCommandEvent& event);
 };
 
 #endif // CSMANAGER_H
@@ -1,22 +1,22 @@
 #include "csNetworkReaderThread.h"
 #include "SocketAPI/clSocketBase.h"
-#include "clNetworkMessage.h"
-#include "csCommandHandlerBase.h"
-#include "csListCommandHandler.h"
-#include "json_node.h"
 #include <file_logger.h>
-#include <wx/dir.h>
 
 wxDEFINE_EVENT(wxEVT_SOCKET_READ_ERROR, clCommandEvent);
+wxDEFINE_EVENT(wxEVT_SOCKET_COMMAND_RECEIVED, clCommandEvent);
 
 csNetworkReaderThread::csNetworkReaderThread(wxEvtHandler* manager, clSocketBase* conn)
     : csJoinableThread(manager)
     , m_conn(conn)
 {
-    // m_handlers.Register("list", csCommandHandlerBase::Ptr_t(new csListCommandHandler()));
 }
 
-csNetworkReaderThread::~csNetworkReaderThread() { wxDELETE(m_conn); }
+csNetworkReaderThread::~csNetworkReaderThread()
+{
+    // Make sure the thread is no longer using the connection before we delete it
+    Stop();
+    wxDELETE(m_conn);
+}
 
 void* csNetworkReaderThread::Entry()
 {
@@ -43,14 +43,11 @@ void* csNetworkReaderThread::Entry()
 
 void csNetworkReaderThread::ProcessCommand(const wxString& str)
 {
-    wxUnusedVar(str);
-    //    clDEBUG() << "Read:" << str;
-    //    clNetworkMessage message(str);
-    //    const wxString& command = message["command"];
-    //    csCommandHandlerBase::Ptr_t handler = m_handlers.FindHandler(command);
-    //    if(handler) {
-    //        handler->Process(message, m_conn);
-    //    } else {
-    //        clWARNING() << "Don't know how to handle command:" << command;
-    //    }
+    // Commands are executed by the manager on the main thread, one at a time. The reader only queues them
+    // so a client can send its next command while the previous one is still running
+    clDEBUG1() << "Read:" << str;
+    clCommandEvent event(wxEVT_SOCKET_COMMAND_RECEIVED);
+    event.SetString(str);
+    event.SetClientData(this);
+    m_manager->AddPendingEvent(event);
 }
@@ -1,18 +1,17 @@
 #ifndef CSNETWORKREADERTHREAD_H
 #define CSNETWORKREADERTHREAD_H
 
-#include "csCommandHandlerManager.h"
 #include "csJoinableThread.h"
 #include <cl_command_event.h>
 #include <wx/event.h>
 
 wxDECLARE_EVENT(wxEVT_SOCKET_READ_ERROR, clCommandEvent);
+wxDECLARE_EVENT(wxEVT_SOCKET_COMMAND_RECEIVED, clCommandEvent);
 
 class clSocketBase;
 class csNetworkReaderThread : public csJoinableThread
 {
     clSocketBase* m_conn;
-    csCommandHandlerManager m_handlers;
 
 public:
     csNetworkReaderThread(wxEvtHandler* manager, clSocketBase* conn);
@@ -1,4 +1,5 @@
 #include "PHPLookupTable.h"
+#include "csManager.h"
 #include "csParsePHPFolderHandler.h"
 #include <wx/filename.h>
 
@@ -15,7 +16,6 @@ void csParsePHPFolderHandler::DoProcessCommand(const JSONElement& options)
     CHECK_STR_PARAM("mask", m_mask);
     CHECK_STR_PARAM_OPTIONAL("symbols-path", m_dbpath);
 
-    PHPLookupTable lookup;
     // Build the default symbols db path
     wxFileName dbpath(m_folder, "phpsymbols.db");
     dbpath.AppendDir(".codelite");
@@ -29,7 +29,7 @@ void csParsePHPFolderHandler::DoProcessCommand(const JSONElement& options)
     }
     
     clDEBUG() << "Using symbols db:" << dbpath;
-    lookup.Open(dbpath);
+    PHPLookupTable& lookup = m_manager->GetPHPLookupTable(dbpath);
     if(!lookup.IsOpened()) {
         clERROR() << "Could not open file:" << dbpath;
         return;
@@ -12,6 +12,8 @@ IMPLEMENT_APP_CONSOLE(MainApp)
 static const wxCmdLineEntryDesc cmdLineDesc[] = {
     { wxCMD_LINE_SWITCH, "v", "version", "Print current version", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_SWITCH, "h", "help", "Print usage", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
+    { wxCMD_LINE_SWITCH, "d", "daemon", "Keep running and serve commands sent over the socket set in codelite-cli.ini",
+      wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_PARAM, "c", "command", "command", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_PARAM, "o", "options", "options", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL },
     { wxCMD_LINE_NONE }
@@ -28,6 +30,7 @@ int MainApp::OnExit()
 {
     clDEBUG() << "Going down";
     wxDELETE(m_manager);
+    FileLogger::Shutdown();
     return TRUE;
 }
 
@@ -77,6 +80,12 @@ bool MainApp::DoParseCommandLine(wxCmdLineParser& parser)
         return true;
     }
 
+    if(parser.Found("d")) {
+        // Commands will arrive over the socket
+        m_manager->SetDaemon(true);
+        return true;
+    }
+
     if(m_manager->GetCommand().IsEmpty()) {
         // Try to fetch the options from the INI file
         m_manager->LoadCommandFromINI();
@@ -30,11 +30,13 @@ int main(int argc, char **argv)
 	int  requests(0);
 	long parent_pid (0);
 	if(argc < 2){
-		printf("Usage: %s <string> [--pid]\n",    argv[0]);
+		printf("Usage: %s <string> [--pid [<parent pid>]]\n",    argv[0]);
 		printf("Usage: %s --batch <file_list> <output file>\n", argv[0]);
 		printf("   <string> - a unique string that identifies this indexer from other instances               \n");
 		printf("   --pid    - when set, <string> is handled as process number and the indexer will            \n");
 		printf("              check if this process alive. If it is down, the indexer will go down as well\n");
+		printf("              When <parent pid> is provided, it is used instead of <string> (this allows running   \n");
+		printf("              multiple indexers for the same parent process)                                     \n");
 		printf("   --batch  - when set, batch parsing is done using list of files set in file_list argument   \n");
 		return 1;
 	}
@@ -48,6 +50,10 @@ int main(int argc, char **argv)
 	if ( argc == 3 && strcmp( argv[2], "--pid") == 0 ) {
 		parent_pid = atol( argv[1] );
 		printf("INFO: parent PID is set on %s\n", argv[1]);
+
+	} else if ( argc == 4 && strcmp( argv[2], "--pid") == 0 ) {
+		parent_pid = atol( argv[3] );
+		printf("INFO: parent PID is set on %s\n", argv[3]);
 	}
 
 	// create the connection factory
@@ -146,6 +146,7 @@ bool wxcApp::OnInit()
 int wxcApp::OnExit()
 {
     wxDELETE(m_wxcPlugin);
+    FileLogger::Shutdown();
     return TRUE;
 }
 